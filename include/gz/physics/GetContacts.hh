@@ -100,6 +100,71 @@ class GZ_PHYSICS_VISIBLE GetContactsFromLastStepFeature
         const Identity &_worldID) const = 0;
   };
 };
+
+/// \brief GetContactPairChangesFromLastStepFeature is a feature for
+/// retrieving the pairs of collision shapes that started or stopped being in
+/// contact in the previous simulation step. Systems that track contact
+/// state can use it instead of comparing the full list of contacts of
+/// consecutive steps.
+class GZ_PHYSICS_VISIBLE GetContactPairChangesFromLastStepFeature
+    : public virtual FeatureWithRequirements<ForwardStep>
+{
+  public: template <typename PolicyT, typename FeaturesT>
+  class World : public virtual Feature::World<PolicyT, FeaturesT>
+  {
+    public: using ShapePtrType = ShapePtr<PolicyT, FeaturesT>;
+
+    public: struct ContactPair
+    {
+      /// \brief Collision shape of the first body
+      ShapePtrType collision1;
+      /// \brief Collision shape of the second body
+      ShapePtrType collision2;
+    };
+
+    public: struct ContactPairChanges
+    {
+      /// \brief Pairs in contact in the previous step that were not in
+      /// contact in the step before it
+      std::vector<ContactPair> added;
+      /// \brief Pairs not in contact in the previous step that were in
+      /// contact in the step before it. Pairs with a shape that no longer
+      /// exists are not reported.
+      std::vector<ContactPair> removed;
+      /// \brief Number of pairs in contact in both steps
+      std::size_t persistingCount = 0u;
+    };
+
+    /// \brief Get the changes in the pairs of shapes in contact made by the
+    /// previous simulation step
+    public: ContactPairChanges GetContactPairChangesFromLastStep() const;
+  };
+
+  public: template <typename PolicyT>
+  class Implementation : public virtual Feature::Implementation<PolicyT>
+  {
+    public: struct ContactPairInternal
+    {
+      /// \brief Identity of the collision shape of the first body
+      Identity collision1;
+      /// \brief Identity of the collision shape of the second body
+      Identity collision2;
+    };
+
+    public: struct ContactPairChangesInternal
+    {
+      /// \brief Pairs that started being in contact
+      std::vector<ContactPairInternal> added;
+      /// \brief Pairs that stopped being in contact
+      std::vector<ContactPairInternal> removed;
+      /// \brief Number of pairs that stayed in contact
+      std::size_t persistingCount = 0u;
+    };
+
+    public: virtual ContactPairChangesInternal
+        GetContactPairChangesFromLastStep(const Identity &_worldID) const = 0;
+  };
+};
 }
 }
 
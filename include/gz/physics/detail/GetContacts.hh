@@ -67,6 +67,33 @@ auto GetContactsFromLastStepFeature::World<
   return output;
 }
 
+/////////////////////////////////////////////////
+template <typename PolicyT, typename FeaturesT>
+auto GetContactPairChangesFromLastStepFeature::World<
+    PolicyT, FeaturesT>::GetContactPairChangesFromLastStep() const
+    -> ContactPairChanges
+{
+  auto changesInternal =
+      this->template Interface<GetContactPairChangesFromLastStepFeature>()
+          ->GetContactPairChangesFromLastStep(this->identity);
+
+  ContactPairChanges output;
+  output.added.reserve(changesInternal.added.size());
+  for (const auto &pair : changesInternal.added)
+  {
+    output.added.push_back({ShapePtrType(this->pimpl, pair.collision1),
+                            ShapePtrType(this->pimpl, pair.collision2)});
+  }
+  output.removed.reserve(changesInternal.removed.size());
+  for (const auto &pair : changesInternal.removed)
+  {
+    output.removed.push_back({ShapePtrType(this->pimpl, pair.collision1),
+                              ShapePtrType(this->pimpl, pair.collision2)});
+  }
+  output.persistingCount = changesInternal.persistingCount;
+  return output;
+}
+
 }  // namespace physics
 }  // namespace gz
 
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Helpers.hh>
+#include <gz/math/Pose3.hh>
+
+#include "lib/src/Utils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Random boxes and poses to transform
+struct BoxesAndPoses
+{
+  /// \brief Local boxes
+  std::vector<math::AxisAlignedBox> boxes;
+
+  /// \brief Pose of each box
+  std::vector<math::Pose3d> poses;
+};
+
+/// \brief Generate random boxes and poses
+/// \param[in] _count Number of boxes
+/// \return Boxes and poses
+BoxesAndPoses RandomBoxes(std::size_t _count)
+{
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> coord(-100.0, 100.0);
+  std::uniform_real_distribution<double> size(0.1, 2.0);
+  std::uniform_real_distribution<double> angle(-GZ_PI, GZ_PI);
+  BoxesAndPoses data;
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    math::Vector3d half(size(gen), size(gen), size(gen));
+    data.boxes.push_back(math::AxisAlignedBox(-half, half));
+    data.poses.push_back(math::Pose3d(coord(gen), coord(gen), coord(gen),
+        angle(gen), angle(gen), angle(gen)));
+  }
+  return data;
+}
+
+/// \brief Transform boxes one at a time by transforming their 8 corners.
+/// Arguments: number of boxes.
+void BM_TpeTransformAabbCorners(benchmark::State &_state)
+{
+  const BoxesAndPoses data = RandomBoxes(_state.range(0));
+  std::vector<math::AxisAlignedBox> result(data.boxes.size());
+  for (auto _ : _state)
+  {
+    for (std::size_t i = 0; i < data.boxes.size(); ++i)
+      result[i] = transformAxisAlignedBox(data.boxes[i], data.poses[i]);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+BENCHMARK(BM_TpeTransformAabbCorners)
+  ->ArgNames({"boxes"})
+  ->Arg(1000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMicrosecond);
+
+/// \brief Transform boxes in batches with the center and extents
+/// formulation.
+/// Arguments: number of boxes.
+void BM_TpeTransformAabbBatch(benchmark::State &_state)
+{
+  const BoxesAndPoses data = RandomBoxes(_state.range(0));
+  std::vector<math::AxisAlignedBox> result;
+  for (auto _ : _state)
+  {
+    transformAxisAlignedBoxes(data.boxes, data.poses, result);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+
+BENCHMARK(BM_TpeTransformAabbBatch)
+  ->ArgNames({"boxes"})
+  ->Arg(1000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
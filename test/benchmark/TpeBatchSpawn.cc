@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Spawn a grid of box models with one link and one collision each
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+/// \param[in] _reserve True to reserve storage for the models first
+/// \return Ids of the models
+std::vector<std::size_t> SpawnBoxes(World &_world, int _count, bool _reserve)
+{
+  if (_reserve)
+    _world.ReserveModels(_count, _count);
+
+  const int side = 100;
+  std::vector<std::size_t> ids;
+  ids.reserve(_count);
+  BoxShape box;
+  box.SetSize(math::Vector3d(1, 1, 1));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = test::AddShapeModel(_world, math::Pose3d(
+        (i % side) * 2.0, (i / side) * 2.0, 0.5, 0, 0, 0), box);
+    model.SetName("model_" + std::to_string(i));
+    ids.push_back(model.GetId());
+  }
+  return ids;
+}
+
+/// \brief Spawn models into an empty world and step once to add them to
+/// the collision detector.
+/// Arguments: number of models, whether storage is reserved first.
+void BM_TpeSpawnModels(benchmark::State &_state)
+{
+  const int count = static_cast<int>(_state.range(0));
+  const bool reserve = _state.range(1) != 0;
+  for (auto _ : _state)
+  {
+    // the destruction of the world is not timed
+    World world;
+    auto start = std::chrono::steady_clock::now();
+    SpawnBoxes(world, count, reserve);
+    world.Step();
+    auto end = std::chrono::steady_clock::now();
+    _state.SetIterationTime(
+        std::chrono::duration<double>(end - start).count());
+  }
+}
+
+BENCHMARK(BM_TpeSpawnModels)
+  ->ArgNames({"models", "reserve"})
+  ->ArgsProduct({{10000, 100000}, {0, 1}})
+  ->UseManualTime()
+  ->Unit(benchmark::kMillisecond);
+
+/// \brief Remove all the models of a world, either one by one or in one
+/// batch, and step once to remove them from the collision detector.
+/// Arguments: number of models, whether the models are removed in a batch.
+void BM_TpeRemoveModels(benchmark::State &_state)
+{
+  const int count = static_cast<int>(_state.range(0));
+  const bool batch = _state.range(1) != 0;
+  for (auto _ : _state)
+  {
+    World world;
+    const std::vector<std::size_t> ids = SpawnBoxes(world, count, true);
+    world.Step();
+
+    auto start = std::chrono::steady_clock::now();
+    if (batch)
+    {
+      world.RemoveChildrenById(ids);
+    }
+    else
+    {
+      for (std::size_t id : ids)
+        world.RemoveChildById(id);
+    }
+    world.Step();
+    auto end = std::chrono::steady_clock::now();
+    _state.SetIterationTime(
+        std::chrono::duration<double>(end - start).count());
+  }
+}
+
+BENCHMARK(BM_TpeRemoveModels)
+  ->ArgNames({"models", "batch"})
+  ->ArgsProduct({{10000, 100000}, {0, 1}})
+  ->UseManualTime()
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
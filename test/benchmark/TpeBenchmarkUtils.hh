@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TEST_BENCHMARK_TPEBENCHMARKUTILS_HH_
+#define GZ_PHYSICS_TEST_BENCHMARK_TPEBENCHMARKUTILS_HH_
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Collision.hh"
+#include "lib/src/Link.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+namespace gz
+{
+  namespace physics
+  {
+    namespace test
+    {
+      /////////////////////////////////////////////////
+      /// \brief Add a link with one collision to a model
+      /// \param[in] _model Model to add the link to
+      /// \param[in] _shape Shape of the collision, which is copied
+      /// \return The collision
+      inline tpelib::Collision &AddLinkCollision(tpelib::Model &_model,
+          const tpelib::Shape &_shape)
+      {
+        auto &link = static_cast<tpelib::Link &>(_model.AddLink());
+        auto &collision =
+            static_cast<tpelib::Collision &>(link.AddCollision());
+        collision.SetShape(_shape);
+        return collision;
+      }
+
+      /////////////////////////////////////////////////
+      /// \brief Add a model with one link and one collision to a world
+      /// \param[in] _world World to add the model to
+      /// \param[in] _pose Pose of the model
+      /// \param[in] _shape Shape of the collision, which is copied
+      /// \return The model
+      inline tpelib::Model &AddShapeModel(tpelib::World &_world,
+          const math::Pose3d &_pose, const tpelib::Shape &_shape)
+      {
+        auto &model = static_cast<tpelib::Model &>(_world.AddModel());
+        model.SetPose(_pose);
+        AddLinkCollision(model, _shape);
+        return model;
+      }
+
+      /////////////////////////////////////////////////
+      /// \brief Add a model with one link and one box collision to a world
+      /// \param[in] _world World to add the model to
+      /// \param[in] _pose Pose of the model
+      /// \param[in] _size Size of the box
+      /// \return The model
+      inline tpelib::Model &AddBoxModel(tpelib::World &_world,
+          const math::Pose3d &_pose, const math::Vector3d &_size)
+      {
+        tpelib::BoxShape box;
+        box.SetSize(_size);
+        return AddShapeModel(_world, _pose, box);
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/plugin/Loader.hh>
+
+#include <gz/physics/GetEntities.hh>
+#include <gz/physics/RequestEngine.hh>
+#include <gz/physics/sdf/ConstructLink.hh>
+#include <gz/physics/sdf/ConstructModel.hh>
+#include <gz/physics/sdf/ConstructNestedModel.hh>
+#include <gz/physics/sdf/ConstructWorld.hh>
+
+#include <sdf/Root.hh>
+#include <sdf/World.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+#include "plugin/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz::physics::tpelib;
+
+struct BroadphaseFeatureList : gz::physics::FeatureList<
+    gz::physics::tpeplugin::RetrieveWorld,
+    gz::physics::GetModelFromWorld,
+    gz::physics::sdf::ConstructSdfLink,
+    gz::physics::sdf::ConstructSdfModel,
+    gz::physics::sdf::ConstructSdfNestedModel,
+    gz::physics::sdf::ConstructSdfWorld
+> { };
+
+/// \brief Load a world from test/common_test/worlds with the TPE plugin
+/// \param[in] _fileName Name of the world file
+/// \return The TPE world or nullptr if the world could not be loaded
+std::shared_ptr<World> LoadCommonTestWorld(const std::string &_fileName)
+{
+  static gz::plugin::PluginPtr tpePlugin;
+  if (!tpePlugin)
+  {
+    gz::plugin::Loader loader;
+    loader.LoadLib(tpe_plugin_LIB);
+    tpePlugin = loader.Instantiate("gz::physics::tpeplugin::Plugin");
+  }
+
+  auto engine =
+      gz::physics::RequestEngine3d<BroadphaseFeatureList>::From(tpePlugin);
+  if (!engine)
+    return nullptr;
+
+  ::sdf::Root root;
+  if (!root.Load(std::string(TEST_WORLD_DIR) + _fileName).empty() ||
+      root.WorldCount() == 0u)
+  {
+    return nullptr;
+  }
+
+  auto world = engine->ConstructWorld(*root.WorldByIndex(0));
+  if (!world)
+    return nullptr;
+
+  return world->GetTpeLibWorld();
+}
+
+/// \brief Build a warehouse-like world: a static floor with robots of
+/// similar size driving around on it.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of robots
+void AddWarehouse(World &_world, int _count)
+{
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> speed(-1.0, 1.0);
+  std::uniform_real_distribution<double> size(0.4, 0.6);
+
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  const double spacing = 1.5;
+
+  Model &floor = gz::physics::test::AddBoxModel(_world,
+      gz::math::Pose3d(side * spacing * 0.5, side * spacing * 0.5, -0.05,
+      0, 0, 0), gz::math::Vector3d(side * spacing, side * spacing, 0.1));
+  floor.SetStatic(true);
+
+  // the robots are slightly above the floor so the contacts are only
+  // between robots
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = gz::physics::test::AddBoxModel(_world,
+        gz::math::Pose3d((i % side) * spacing, (i / side) * spacing, 0.3,
+        0, 0, 0), gz::math::Vector3d(size(gen), size(gen), 0.5));
+    model.SetLinearVelocity(gz::math::Vector3d(speed(gen), speed(gen), 0));
+  }
+}
+
+/// \brief Step a synthetic warehouse world.
+/// Arguments: number of robots, broadphase type.
+void BM_TpeBroadphaseWarehouse(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  world.SetBroadphaseType(static_cast<BroadphaseType>(_state.range(1)));
+  AddWarehouse(world, static_cast<int>(_state.range(0)));
+
+  // add all the models to the broadphase
+  world.Step();
+
+  std::size_t contacts = 0u;
+  for (auto _ : _state)
+  {
+    world.Step();
+    contacts += world.GetContacts().size();
+  }
+  _state.counters["contacts_per_step"] = benchmark::Counter(
+      static_cast<double>(contacts) /
+      static_cast<double>(_state.iterations()));
+}
+
+BENCHMARK(BM_TpeBroadphaseWarehouse)
+  ->ArgNames({"robots", "broadphase"})
+  ->ArgsProduct({{100, 1000, 10000},
+      {static_cast<int>(BroadphaseType::AABB_TREE),
+       static_cast<int>(BroadphaseType::SWEEP_AND_PRUNE),
+       static_cast<int>(BroadphaseType::SPATIAL_HASH)}});
+
+/// \brief Step a world from test/common_test/worlds.
+/// Arguments: broadphase type.
+/// \param[in] _fileName Name of the world file
+void BM_TpeBroadphaseCommonWorld(benchmark::State &_state,
+    const std::string &_fileName)
+{
+  auto world = LoadCommonTestWorld(_fileName);
+  if (!world)
+  {
+    _state.SkipWithError(("Unable to load " + _fileName).c_str());
+    return;
+  }
+  world->SetBroadphaseType(static_cast<BroadphaseType>(_state.range(0)));
+  world->Step();
+
+  for (auto _ : _state)
+  {
+    world->Step();
+  }
+}
+
+#define TPE_BROADPHASE_COMMON_WORLD(name, file) \
+  BENCHMARK_CAPTURE(BM_TpeBroadphaseCommonWorld, name, std::string(file)) \
+    ->ArgName("broadphase") \
+    ->Arg(static_cast<int>(BroadphaseType::AABB_TREE)) \
+    ->Arg(static_cast<int>(BroadphaseType::SWEEP_AND_PRUNE)) \
+    ->Arg(static_cast<int>(BroadphaseType::SPATIAL_HASH))
+
+TPE_BROADPHASE_COMMON_WORLD(contact, "contact.sdf");
+TPE_BROADPHASE_COMMON_WORLD(falling, "falling.world");
+TPE_BROADPHASE_COMMON_WORLD(shapes, "shapes.world");
+TPE_BROADPHASE_COMMON_WORLD(shapes_bitmask, "shapes_bitmask.sdf");
+TPE_BROADPHASE_COMMON_WORLD(nested_model, "world_with_nested_model.sdf");
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "lib/src/Link.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/World.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Number of links in each model
+const int kLinkCount = 4;
+
+/// \brief Add named models with named links to a world, as when a world is
+/// loaded from SDF.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+void AddNamedModels(World &_world, int _count)
+{
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = static_cast<Model &>(_world.AddModel());
+    model.SetName("model_" + std::to_string(i));
+    for (int j = 0; j < kLinkCount; ++j)
+      model.AddLink().SetName("link_" + std::to_string(j));
+  }
+}
+
+/// \brief Resolve every link of a world by model and link name, as the
+/// plugin does when the entities are resolved at startup.
+/// Arguments: number of models.
+void BM_TpeLinkByName(benchmark::State &_state)
+{
+  World world;
+  const int count = static_cast<int>(_state.range(0));
+  AddNamedModels(world, count);
+
+  std::vector<std::string> modelNames;
+  for (int i = 0; i < count; ++i)
+    modelNames.push_back("model_" + std::to_string(i));
+  std::vector<std::string> linkNames;
+  for (int j = 0; j < kLinkCount; ++j)
+    linkNames.push_back("link_" + std::to_string(j));
+
+  for (auto _ : _state)
+  {
+    for (const auto &modelName : modelNames)
+    {
+      Entity &model = world.GetChildByName(modelName);
+      for (const auto &linkName : linkNames)
+        benchmark::DoNotOptimize(&model.GetChildByName(linkName));
+    }
+  }
+
+  _state.counters["lookups"] = benchmark::Counter(
+      static_cast<double>(count) * (kLinkCount + 1) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+
+/// \brief Resolve every link of a world by model and link index.
+/// Arguments: number of models.
+void BM_TpeLinkByIndex(benchmark::State &_state)
+{
+  World world;
+  const int count = static_cast<int>(_state.range(0));
+  AddNamedModels(world, count);
+
+  for (auto _ : _state)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      Entity &model = world.GetChildByIndex(i);
+      for (int j = 0; j < kLinkCount; ++j)
+        benchmark::DoNotOptimize(&model.GetChildByIndex(j));
+    }
+  }
+
+  _state.counters["lookups"] = benchmark::Counter(
+      static_cast<double>(count) * (kLinkCount + 1) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+
+/// \brief Spawn models one at a time and resolve each new model by name
+/// right after it is added, as when models are spawned at runtime.
+/// Arguments: number of models.
+void BM_TpeSpawnAndResolve(benchmark::State &_state)
+{
+  const int count = static_cast<int>(_state.range(0));
+  for (auto _ : _state)
+  {
+    World world;
+    for (int i = 0; i < count; ++i)
+    {
+      std::string name = "model_" + std::to_string(i);
+      world.AddModel().SetName(name);
+      benchmark::DoNotOptimize(&world.GetChildByName(name));
+    }
+  }
+}
+
+BENCHMARK(BM_TpeLinkByName)
+  ->ArgNames({"models"})
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TpeLinkByIndex)
+  ->ArgNames({"models"})
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TpeSpawnAndResolve)
+  ->ArgNames({"models"})
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
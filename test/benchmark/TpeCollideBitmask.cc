@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Collision.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Step swarms of boxes that fly through the same space but are in
+/// mutually exclusive collide groups, e.g. the robots of different teams in
+/// separate simulations sharing a world. Each group has its own bit, so
+/// almost all overlapping AABBs belong to boxes that cannot collide.
+/// Arguments: broadphase type, number of groups, boxes per group.
+void BM_TpeCollideGroupsStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  world.SetCollisionMargin(0.01);
+  world.SetBroadphaseType(static_cast<BroadphaseType>(_state.range(0)));
+
+  // the boxes of a group are on a grid and do not overlap each other. The
+  // grids of the groups are shifted so that each box overlaps boxes of
+  // most of the other groups.
+  const int groups = static_cast<int>(_state.range(1));
+  const int boxes = static_cast<int>(_state.range(2));
+  const int side = static_cast<int>(std::ceil(std::sqrt(boxes)));
+  BoxShape box;
+  box.SetSize(math::Vector3d(0.9, 0.9, 0.9));
+  for (int g = 0; g < groups; ++g)
+  {
+    const double shift = static_cast<double>(g) / groups;
+    for (int i = 0; i < boxes; ++i)
+    {
+      Model &model = static_cast<Model &>(world.AddModel());
+      model.SetPose(math::Pose3d((i % side) + shift, (i / side) + shift,
+          0.5, 0, 0, 0));
+      model.SetLinearVelocity(math::Vector3d((g % 2) ? 0.5 : -0.5, 0, 0));
+      Collision &collision = test::AddLinkCollision(model, box);
+      collision.SetCollideBitmask(static_cast<uint16_t>(1u << g));
+    }
+  }
+
+  // add all the models to the broadphase
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeCollideGroupsStep)
+  ->ArgNames({"broadphase", "groups", "boxes"})
+  ->ArgsProduct({
+      {static_cast<int>(BroadphaseType::AABB_TREE),
+       static_cast<int>(BroadphaseType::SWEEP_AND_PRUNE),
+       static_cast<int>(BroadphaseType::SPATIAL_HASH)},
+      {4, 16}, {1000}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add a fleet of box models moving at a constant velocity to a
+/// world. The models are laid out on a square grid and move in lanes.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+void AddFleet(World &_world, int _count)
+{
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = test::AddBoxModel(_world,
+        math::Pose3d((i % side) * 2.0, (i / side) * 2.0, 0, 0, 0, 0),
+        math::Vector3d(1, 1, 1));
+
+    // alternate lanes move in opposite directions at slightly different
+    // speeds so models overtake each other
+    double speed = 0.5 + 0.01 * (i % 7);
+    model.SetLinearVelocity(
+        math::Vector3d((i / side) % 2 == 0 ? speed : -speed, 0, 0));
+  }
+}
+
+/// \brief Step a fleet of constant velocity models and report the number of
+/// broadphase tree updates per step.
+/// Arguments: number of models, margin in mm, prediction steps.
+void BM_TpeFleetStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  world.SetCollisionMargin(_state.range(1) * 1e-3);
+  world.SetCollisionPredictionSteps(
+      static_cast<unsigned int>(_state.range(2)));
+  AddFleet(world, static_cast<int>(_state.range(0)));
+
+  // add all the models to the broadphase tree
+  world.Step();
+  std::size_t reinsertStart = world.GetBroadphaseReinsertCount();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  std::size_t reinserts =
+      world.GetBroadphaseReinsertCount() - reinsertStart;
+  _state.counters["tree_updates_per_step"] = benchmark::Counter(
+      static_cast<double>(reinserts) /
+      static_cast<double>(_state.iterations()));
+}
+
+BENCHMARK(BM_TpeFleetStep)
+  ->ArgNames({"models", "margin_mm", "steps"})
+  ->Args({1000, 0, 0})
+  ->Args({1000, 10, 0})
+  ->Args({1000, 0, 20})
+  ->Args({1000, 10, 20})
+  ->Args({10000, 0, 0})
+  ->Args({10000, 10, 20});
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
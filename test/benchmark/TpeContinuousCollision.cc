@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Number of thin walls crossed by each vehicle
+const int kWallCount = 9;
+
+/// \brief Distance between two walls in meters
+const double kWallSpacing = 5.0;
+
+/// \brief Speed of the vehicles in m/s
+const double kSpeed = 50.0;
+
+/// \brief Add fast vehicles driving in parallel lanes through a row of
+/// thin static walls to a world. Each vehicle crosses all the walls in one
+/// second.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of vehicles
+void AddWallCrossing(World &_world, int _count)
+{
+  BoxShape wallBox;
+  wallBox.SetSize(math::Vector3d(0.05, _count * 2.0, 1));
+  for (int i = 1; i <= kWallCount; ++i)
+  {
+    Model &wall = test::AddShapeModel(_world,
+        math::Pose3d(i * kWallSpacing, _count - 1.0, 0.5, 0, 0, 0), wallBox);
+    wall.SetStatic(true);
+  }
+
+  BoxShape box;
+  box.SetSize(math::Vector3d(0.5, 0.5, 0.5));
+  for (int i = 0; i < _count; ++i)
+  {
+    // stagger the vehicles so they reach the walls at different times
+    test::AddShapeModel(_world,
+        math::Pose3d(-0.1 * (i % 10), i * 2.0, 0.5, 0, 0, 0), box);
+  }
+}
+
+/// \brief Simulate one second of vehicles crossing thin walls with
+/// different time steps, with and without continuous collision detection.
+/// Without it, steps longer than the time a vehicle overlaps a wall miss
+/// some of the wall crossings.
+/// Arguments: number of vehicles, time step in ms, continuous collision.
+void BM_TpeWallCrossing(benchmark::State &_state)
+{
+  const int count = static_cast<int>(_state.range(0));
+  const double timeStep = _state.range(1) * 1e-3;
+  const int steps = static_cast<int>(1.0 / timeStep + 0.5);
+  std::size_t hits = 0u;
+  for (auto _ : _state)
+  {
+    _state.PauseTiming();
+    auto world = std::make_unique<World>();
+    world->SetTimeStep(timeStep);
+    world->SetNarrowPhaseEnabled(true);
+    world->SetContinuousCollisionEnabled(_state.range(2) != 0);
+    AddWallCrossing(*world, count);
+    world->Step();
+    for (auto &it : world->GetChildren())
+    {
+      if (!it.second->GetStatic())
+        it.second->SetLinearVelocity(math::Vector3d(kSpeed, 0, 0));
+    }
+    _state.ResumeTiming();
+
+    hits = 0u;
+    for (int s = 0; s < steps; ++s)
+    {
+      world->Step();
+      hits += world->GetAddedContactPairs().size();
+    }
+
+    _state.PauseTiming();
+    world.reset();
+    _state.ResumeTiming();
+  }
+
+  _state.counters["steps"] = benchmark::Counter(steps);
+  _state.counters["hit_ratio"] = benchmark::Counter(
+      static_cast<double>(hits) / (count * kWallCount));
+}
+
+BENCHMARK(BM_TpeWallCrossing)
+  ->ArgNames({"vehicles", "step_ms", "ccd"})
+  ->ArgsProduct({{1000}, {1, 5, 10, 20, 40}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "lib/src/Collision.hh"
+#include "lib/src/Link.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/World.hh"
+#include "plugin/src/Base.hh"
+
+using namespace gz;
+using namespace physics;
+
+/// \brief Spawn models with a link and a collision each, registering them
+/// with the plugin as they are created, then enumerate the models of the
+/// world by index and get the index of each model back, as done when an
+/// ECS resolves the entities of a large world.
+/// Arguments: number of models.
+void BM_TpeSpawnAndEnumerate(benchmark::State &_state)
+{
+  const std::size_t count = static_cast<std::size_t>(_state.range(0));
+  std::size_t found = 0u;
+  for (auto _ : _state)
+  {
+    tpeplugin::Base<FeaturePolicy3d> base;
+    auto world = std::make_shared<tpelib::World>();
+    std::size_t worldId = world->GetId();
+    base.AddWorld(world);
+
+    for (std::size_t i = 0u; i < count; ++i)
+    {
+      auto *model = static_cast<tpelib::Model *>(&world->AddModel());
+      base.AddModel(worldId, *model);
+      auto *link = static_cast<tpelib::Link *>(&model->AddLink());
+      base.AddLink(model->GetId(), *link);
+      auto *collision =
+          static_cast<tpelib::Collision *>(&link->AddCollision());
+      base.AddCollision(link->GetId(), *collision);
+    }
+
+    for (std::size_t i = 0u; i < count; ++i)
+    {
+      auto model = base.indexInContainerToId(worldId, i, base.models);
+      auto link = base.indexInContainerToId(model.first, 0u, base.links);
+      if (base.idToIndexInContainer(model.first) == i &&
+          base.idToIndexInContainer(link.first) == 0u)
+      {
+        ++found;
+      }
+    }
+  }
+
+  _state.counters["entities"] = benchmark::Counter(
+      3.0 * static_cast<double>(count) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+  _state.counters["found"] = benchmark::Counter(
+      static_cast<double>(found) / static_cast<double>(_state.iterations()));
+}
+
+BENCHMARK(BM_TpeSpawnAndEnumerate)
+  ->ArgNames({"models"})
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(50000)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Size of the terrain in meters
+const double kTerrainSize = 1000.0;
+
+/// \brief Add a rolling terrain and a fleet of box vehicles driving on it
+/// to a world. The vehicles rest on the terrain at their start position.
+/// \param[in] _world World to add the models to
+/// \param[in] _vertexCount Number of vertices along each side of the
+/// terrain grid
+/// \param[in] _count Number of vehicles
+void AddTerrainFleet(World &_world, unsigned int _vertexCount, int _count)
+{
+  auto height = [](double _x, double _y)
+  {
+    return 10.0 * std::sin(_x * 0.01) * std::cos(_y * 0.013);
+  };
+
+  std::vector<float> heights;
+  double spacing = kTerrainSize / (_vertexCount - 1u);
+  for (unsigned int r = 0u; r < _vertexCount; ++r)
+  {
+    for (unsigned int c = 0u; c < _vertexCount; ++c)
+    {
+      heights.push_back(static_cast<float>(height(
+          -kTerrainSize * 0.5 + c * spacing,
+          kTerrainSize * 0.5 - r * spacing)));
+    }
+  }
+
+  HeightmapShape heightmap;
+  heightmap.SetHeights(heights, _vertexCount,
+      math::Vector3d(kTerrainSize, kTerrainSize, 0));
+  Model &terrain =
+      test::AddShapeModel(_world, math::Pose3d::Zero, heightmap);
+  terrain.SetStatic(true);
+
+  BoxShape box;
+  box.SetSize(math::Vector3d(4, 2, 1.5));
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  const double step = kTerrainSize * 0.8 / side;
+  for (int i = 0; i < _count; ++i)
+  {
+    double x = -kTerrainSize * 0.4 + (i % side) * step;
+    double y = -kTerrainSize * 0.4 + (i / side) * step;
+    Model &model = test::AddShapeModel(_world,
+        math::Pose3d(x, y, height(x, y) + 0.7, 0, 0, 0), box);
+    model.SetLinearVelocity(math::Vector3d(5, 0, 0));
+  }
+}
+
+/// \brief Step a fleet of vehicles on terrains of increasing resolution.
+/// The contacts with the terrain are found from the grid cells under each
+/// vehicle, so the step time grows with the number of cells a vehicle
+/// covers and not with the number of cells of the terrain.
+/// Arguments: number of vehicles, terrain vertices per side, narrow phase.
+void BM_TpeTerrainStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.01);
+  world.SetNarrowPhaseEnabled(_state.range(2) != 0);
+  AddTerrainFleet(world, static_cast<unsigned int>(_state.range(1)),
+      static_cast<int>(_state.range(0)));
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeTerrainStep)
+  ->ArgNames({"models", "vertices", "narrow_phase"})
+  ->ArgsProduct({{1000, 10000}, {129, 1025, 4097}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include <gz/common/Mesh.hh>
+#include <gz/common/SubMesh.hh>
+#include <gz/math/Helpers.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Create a sphere mesh of radius 0.5 m
+/// \param[in] _rings Number of rings of vertices. The mesh has twice as
+/// many vertices per ring.
+/// \param[out] _mesh Mesh to add the vertices to
+void MakeSphereMesh(int _rings, common::Mesh &_mesh)
+{
+  common::SubMesh subMesh;
+  for (int i = 0; i <= _rings; ++i)
+  {
+    double polar = GZ_PI * i / _rings;
+    for (int j = 0; j < 2 * _rings; ++j)
+    {
+      double azimuth = GZ_PI * j / _rings;
+      subMesh.AddVertex(math::Vector3d(
+          0.5 * std::sin(polar) * std::cos(azimuth),
+          0.5 * std::sin(polar) * std::sin(azimuth),
+          0.5 * std::cos(polar)));
+    }
+  }
+  _mesh.AddSubMesh(subMesh);
+}
+
+/// \brief Add a grid of models with a mesh collision to a world. The models
+/// are 0.9 m apart, so the spheres of neighboring models overlap, and only
+/// the bounding boxes of diagonal neighbors do.
+/// \param[in] _world World to add the models to
+/// \param[in] _mesh Mesh of the models
+/// \param[in] _count Number of models
+void AddMeshModels(World &_world, const common::Mesh &_mesh, int _count)
+{
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  for (int i = 0; i < _count; ++i)
+  {
+    MeshShape shape;
+    shape.SetMesh(_mesh);
+    test::AddShapeModel(_world, math::Pose3d((i % side) * 0.9,
+        (i / side) * 0.9, 0.5, 0, 0, 0), shape);
+  }
+}
+
+/// \brief Spawn many instances of the same mesh. The hull of the mesh is
+/// only computed for the first instance, so the spawn time does not grow
+/// with the number of vertices of the mesh.
+/// Arguments: number of models, number of rings of the sphere mesh.
+void BM_TpeMeshSpawn(benchmark::State &_state)
+{
+  common::Mesh mesh;
+  MakeSphereMesh(static_cast<int>(_state.range(1)), mesh);
+  for (auto _ : _state)
+  {
+    World world;
+    AddMeshModels(world, mesh, static_cast<int>(_state.range(0)));
+    world.Step();
+  }
+}
+
+/// \brief Step a grid of sphere meshes with the narrow phase. The meshes
+/// are tested with their hull instead of their bounding box, so only the
+/// spheres of neighboring models are in contact, not diagonal ones.
+/// Arguments: number of models, number of rings of the sphere mesh.
+void BM_TpeMeshStep(benchmark::State &_state)
+{
+  common::Mesh mesh;
+  MakeSphereMesh(static_cast<int>(_state.range(1)), mesh);
+  World world;
+  world.SetNarrowPhaseEnabled(true);
+  AddMeshModels(world, mesh, static_cast<int>(_state.range(0)));
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeMeshSpawn)
+  ->ArgNames({"models", "rings"})
+  ->ArgsProduct({{1000, 10000}, {16, 128}})
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TpeMeshStep)
+  ->ArgNames({"models", "rings"})
+  ->ArgsProduct({{1000, 10000}, {16, 128}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
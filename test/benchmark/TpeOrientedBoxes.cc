@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include <gz/math/Helpers.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add rows of long forklift-like vehicles driving diagonally
+/// through an aisle to a world. The vehicles of neighboring rows are 1.5 m
+/// apart, so their rotated AABBs overlap while the vehicles do not.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of vehicles
+void AddDiagonalFleet(World &_world, int _count)
+{
+  BoxShape box;
+  box.SetSize(math::Vector3d(4, 1, 1));
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  const double angle = GZ_PI * 0.25;
+  const double c = std::cos(angle);
+  for (int i = 0; i < _count; ++i)
+  {
+    // rows are spaced across the direction of travel, and vehicles along
+    // a row are 6 m apart
+    double across = (i / side) * 1.5;
+    double along = (i % side) * 6.0;
+    Model &model = test::AddShapeModel(_world,
+        math::Pose3d(c * (along - across), c * (along + across), 0.5,
+        0, 0, angle), box);
+    model.SetLinearVelocity(math::Vector3d(c, c, 0));
+  }
+}
+
+/// \brief Step a fleet of rotated vehicles without the narrow phase. With
+/// the oriented box check, the candidate pairs from their overlapping AABBs
+/// are discarded by testing the oriented boxes of the vehicles, so no false
+/// contacts are reported.
+/// Arguments: number of vehicles, 1 to enable the oriented box check.
+void BM_TpeDiagonalFleet(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.01);
+  world.SetOrientedBoxesEnabled(_state.range(1) != 0);
+  AddDiagonalFleet(world, static_cast<int>(_state.range(0)));
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeDiagonalFleet)
+  ->ArgNames({"models", "obb"})
+  ->ArgsProduct({{1000, 10000}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
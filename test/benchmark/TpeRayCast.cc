@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <gz/math/Helpers.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/RayCast.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add static models of various shapes to a world. The models are
+/// laid out on a square grid centered at the origin, leaving the center
+/// free for the sensor.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+void AddScene(World &_world, int _count)
+{
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count + 1)));
+  const double spacing = 2.0;
+  const double offset = (side - 1) * spacing * 0.5;
+
+  BoxShape box;
+  box.SetSize(math::Vector3d(1, 0.6, 1));
+  SphereShape sphere;
+  sphere.SetRadius(0.5);
+  CylinderShape cylinder;
+  cylinder.SetRadius(0.4);
+  cylinder.SetLength(1.0);
+  CapsuleShape capsule;
+  capsule.SetRadius(0.3);
+  capsule.SetLength(0.6);
+  const Shape *shapes[] = {&box, &sphere, &cylinder, &capsule};
+
+  for (int i = 0, cell = 0; i < _count; ++cell)
+  {
+    math::Vector3d pos((cell % side) * spacing - offset,
+        (cell / side) * spacing - offset, 0.5);
+    if (pos.X() * pos.X() + pos.Y() * pos.Y() < 1.0)
+      continue;
+
+    Model &model = test::AddShapeModel(_world,
+        math::Pose3d(pos, math::Quaterniond(0, 0, i * 0.3)), *shapes[i % 4]);
+    model.SetStatic(true);
+    ++i;
+  }
+}
+
+/// \brief Create the rays of a spinning 3D lidar at the origin, with a
+/// vertical field of view of 30 degrees and a range of 100 m.
+/// \param[in] _channels Number of vertical channels
+/// \param[in] _samples Number of horizontal samples per channel
+/// \return Rays ordered by horizontal sample, then by channel
+std::vector<Ray> LidarRays(int _channels, int _samples)
+{
+  std::vector<Ray> rays;
+  rays.reserve(static_cast<std::size_t>(_channels) * _samples);
+  for (int s = 0; s < _samples; ++s)
+  {
+    double yaw = 2.0 * GZ_PI * s / _samples;
+    for (int c = 0; c < _channels; ++c)
+    {
+      double pitch = (-15.0 + 30.0 * c / std::max(1, _channels - 1)) *
+          GZ_PI / 180.0;
+      Ray ray;
+      ray.origin = math::Vector3d(0, 0, 0.5);
+      ray.direction = math::Vector3d(std::cos(pitch) * std::cos(yaw),
+          std::cos(pitch) * std::sin(yaw), std::sin(pitch));
+      ray.maxDistance = 100.0;
+      rays.push_back(ray);
+    }
+  }
+  return rays;
+}
+
+/// \brief Cast the rays of a lidar scan against a scene with a number of
+/// threads. Arguments: number of channels, number of horizontal samples,
+/// number of models, number of threads.
+void BM_TpeLidarScan(benchmark::State &_state)
+{
+  World world;
+  world.SetThreadCount(static_cast<unsigned int>(_state.range(3)));
+  AddScene(world, static_cast<int>(_state.range(2)));
+  std::vector<Ray> rays = LidarRays(static_cast<int>(_state.range(0)),
+      static_cast<int>(_state.range(1)));
+  std::vector<RayHit> hits;
+
+  // rays are cast against the broadphase built by the step
+  world.Step();
+
+  std::size_t hitCount = 0u;
+  for (auto _ : _state)
+  {
+    world.CastRays(rays, hits);
+    hitCount += static_cast<std::size_t>(std::count_if(hits.begin(),
+        hits.end(), [](const RayHit &_hit)
+        {
+          return _hit.entity != kNullEntityId;
+        }));
+  }
+
+  _state.counters["rays"] = benchmark::Counter(
+      static_cast<double>(rays.size()) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+  _state.counters["hit_ratio"] = benchmark::Counter(
+      static_cast<double>(hitCount) / static_cast<double>(rays.size()) /
+      static_cast<double>(_state.iterations()));
+}
+
+/// \brief Lidar resolutions and scene sizes with thread counts from 1 to
+/// the number of hardware threads, doubling at each step.
+/// \param[in] _benchmark Benchmark to add the arguments to
+void LidarArgs(benchmark::internal::Benchmark *_benchmark)
+{
+  const int maxThreads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (auto [channels, samples] : {std::pair{64, 1024}, std::pair{128, 2048}})
+  {
+    for (int models : {1000, 10000})
+    {
+      for (int threads = 1; threads < maxThreads; threads *= 2)
+        _benchmark->Args({channels, samples, models, threads});
+      _benchmark->Args({channels, samples, models, maxThreads});
+    }
+  }
+}
+
+// the work is spread over several threads so measure wall clock time
+BENCHMARK(BM_TpeLidarScan)
+  ->ArgNames({"channels", "samples", "models", "threads"})
+  ->Apply(LidarArgs)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/plugin/Loader.hh>
+
+#include <gz/physics/BoxShape.hh>
+#include <gz/physics/ConstructEmpty.hh>
+#include <gz/physics/FeatureList.hh>
+#include <gz/physics/ForwardStep.hh>
+#include <gz/physics/FreeGroup.hh>
+#include <gz/physics/RequestEngine.hh>
+
+#include "lib/src/aabb_tree/FixedAABB.h"
+#include "lib/src/AABBTree.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+#include "plugin/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics::tpelib;
+
+/// \brief Size in bytes of the nodes of a tree of boxes. A tree of n boxes
+/// has 2n - 1 nodes.
+/// \param[in] _state Benchmark state whose first argument is the number of
+/// boxes and whose second argument is 1 for single precision bounds
+/// \return Node size times node count
+double TreeBytes(const benchmark::State &_state)
+{
+  double nodeSize = _state.range(1) != 0 ?
+      sizeof(aabb::FixedNode<3, float>) : sizeof(aabb::FixedNode<3, double>);
+  return nodeSize * (2.0 * static_cast<double>(_state.range(0)) - 1.0);
+}
+
+/// \brief Add a crowd of pedestrians walking in random directions on a
+/// square plaza to a world
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of pedestrians
+void AddPedestrians(World &_world, int _count)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> angle(-GZ_PI, GZ_PI);
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  BoxShape box;
+  box.SetSize(math::Vector3d(0.5, 0.5, 1.8));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = physics::test::AddShapeModel(_world,
+        math::Pose3d((i % side) * 0.8, (i / side) * 0.8, 0.9, 0, 0, 0), box);
+    double a = angle(gen);
+    model.SetLinearVelocity(
+        math::Vector3d(1.4 * std::cos(a), 1.4 * std::sin(a), 0));
+  }
+}
+
+/// \brief Step the same crowd with double and single precision AABB tree
+/// broadphases.
+/// Arguments: number of pedestrians, single precision.
+void BM_TpeCrowdStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.01);
+  world.SetBroadphaseType(_state.range(1) != 0 ?
+      BroadphaseType::AABB_TREE_FLOAT : BroadphaseType::AABB_TREE);
+  AddPedestrians(world, static_cast<int>(_state.range(0)));
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["tree_bytes"] = benchmark::Counter(TreeBytes(_state),
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+/// \brief Find the overlapping pairs of the same boxes in double and single
+/// precision AABB trees. This isolates the broadphase traversal, whose cost
+/// is dominated by reading the tree nodes.
+/// Arguments: number of boxes, single precision.
+void BM_TpeTreePairs(benchmark::State &_state)
+{
+  std::mt19937 gen(7);
+  const double extent = std::sqrt(static_cast<double>(_state.range(0)));
+  std::uniform_real_distribution<double> coord(0.0, extent);
+  std::vector<std::size_t> ids;
+  std::vector<math::AxisAlignedBox> boxes;
+  for (std::size_t i = 0u; i < static_cast<std::size_t>(_state.range(0)); ++i)
+  {
+    math::Vector3d min(coord(gen), coord(gen), 0);
+    ids.push_back(i);
+    boxes.push_back(math::AxisAlignedBox(min,
+        min + math::Vector3d(0.5, 0.5, 1.8)));
+  }
+
+  AABBTree treeDouble;
+  AABBTreef treeFloat;
+  Broadphase &tree = _state.range(1) != 0 ?
+      static_cast<Broadphase &>(treeFloat) :
+      static_cast<Broadphase &>(treeDouble);
+  tree.AddNodes(ids, boxes, {});
+
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  for (auto _ : _state)
+  {
+    tree.CollisionPairs(pairs);
+    benchmark::DoNotOptimize(pairs.data());
+  }
+
+  _state.counters["tree_bytes"] = benchmark::Counter(TreeBytes(_state),
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+  _state.counters["pairs"] = benchmark::Counter(
+      static_cast<double>(pairs.size()));
+}
+
+struct CrowdFeatureList : physics::FeatureList<
+    physics::AttachBoxShapeFeature,
+    physics::ConstructEmptyLinkFeature,
+    physics::ConstructEmptyModelFeature,
+    physics::ConstructEmptyWorldFeature,
+    physics::FindFreeGroupFeature,
+    physics::ForwardStep,
+    physics::SetFreeGroupWorldPose,
+    physics::SetFreeGroupWorldVelocity,
+    physics::tpeplugin::RetrieveWorld
+> { };
+
+/// \brief Load a TPE plugin by name. The double and single precision
+/// plugins are registered in the same library.
+/// \param[in] _name Name of the plugin class
+/// \return The plugin instance
+plugin::PluginPtr LoadTpePlugin(const std::string &_name)
+{
+  plugin::Loader loader;
+  loader.LoadLib(tpe_plugin_LIB);
+  return loader.Instantiate(_name);
+}
+
+/// \brief Step the same crowd through the double and single precision TPE
+/// plugins and read back the changed poses, as a simulator does after every
+/// step. The world is built through the plugin API so each plugin converts
+/// its own scalar type to and from tpelib.
+/// Arguments: number of pedestrians.
+template <typename PolicyT>
+void BM_TpePluginCrowdStep(benchmark::State &_state)
+{
+  using Scalar = typename PolicyT::Scalar;
+  using PoseType =
+      typename physics::FromPolicy<PolicyT>::template Use<physics::Pose>;
+  using VectorType = typename physics::FromPolicy<PolicyT>
+      ::template Use<physics::LinearVector>;
+
+  const bool single = std::is_same_v<Scalar, float>;
+  auto engine = physics::RequestEngine<PolicyT, CrowdFeatureList>::From(
+      LoadTpePlugin(single ? "gz::physics::tpeplugin::Plugin3f" :
+          "gz::physics::tpeplugin::Plugin"));
+  if (!engine)
+  {
+    _state.SkipWithError("Unable to load the TPE plugin");
+    return;
+  }
+
+  auto world = engine->ConstructEmptyWorld("crowd");
+  world->GetTpeLibWorld()->SetTimeStep(0.01);
+
+  // same crowd as AddPedestrians
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> angle(-GZ_PI, GZ_PI);
+  const int count = static_cast<int>(_state.range(0));
+  const int side = static_cast<int>(std::ceil(std::sqrt(count)));
+  for (int i = 0; i < count; ++i)
+  {
+    auto model = world->ConstructEmptyModel("pedestrian_" + std::to_string(i));
+    auto link = model->ConstructEmptyLink("body");
+    link->AttachBoxShape("box", VectorType(0.5, 0.5, 1.8));
+
+    PoseType pose = PoseType::Identity();
+    pose.translation() = VectorType(static_cast<Scalar>((i % side) * 0.8),
+        static_cast<Scalar>((i / side) * 0.8), static_cast<Scalar>(0.9));
+    const double a = angle(gen);
+    auto freeGroup = model->FindFreeGroup();
+    freeGroup->SetWorldPose(pose);
+    freeGroup->SetWorldLinearVelocity(VectorType(
+        static_cast<Scalar>(1.4 * std::cos(a)),
+        static_cast<Scalar>(1.4 * std::sin(a)), 0));
+  }
+
+  physics::ForwardStep::Output output;
+  physics::ForwardStep::State state;
+  physics::ForwardStep::Input input;
+  input.Get<std::chrono::steady_clock::duration>() =
+      std::chrono::milliseconds(10);
+  world->Step(output, state, input);
+
+  for (auto _ : _state)
+  {
+    world->Step(output, state, input);
+    benchmark::DoNotOptimize(
+        output.Get<physics::ChangedWorldPoses>().entries.data());
+  }
+
+  const auto tpeWorld = world->GetTpeLibWorld();
+  const double nodeSize =
+      tpeWorld->GetBroadphaseType() == BroadphaseType::AABB_TREE_FLOAT ?
+      sizeof(aabb::FixedNode<3, float>) : sizeof(aabb::FixedNode<3, double>);
+  _state.counters["tree_bytes"] = benchmark::Counter(
+      nodeSize * (2.0 * count - 1.0),
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+  _state.counters["pose_bytes"] = benchmark::Counter(
+      static_cast<double>(sizeof(PoseType)) * count,
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+BENCHMARK(BM_TpeCrowdStep)
+  ->ArgNames({"models", "float"})
+  ->ArgsProduct({{10000, 100000}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TpeTreePairs)
+  ->ArgNames({"boxes", "float"})
+  ->ArgsProduct({{10000, 100000, 1000000}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_TpePluginCrowdStep, physics::FeaturePolicy3d)
+  ->ArgNames({"models"})
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_TpePluginCrowdStep, physics::FeaturePolicy3f)
+  ->ArgNames({"models"})
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
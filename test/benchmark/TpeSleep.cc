@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add a static ground and a densely parked fleet of box models to a
+/// world. Neighboring models touch each other and the ground.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+/// \param[in] _movingPercent Percentage of the models that drive around
+void AddParkedFleet(World &_world, int _count, int _movingPercent)
+{
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+
+  Model &ground = test::AddBoxModel(_world,
+      math::Pose3d(side * 0.5, side * 0.5, -0.5, 0, 0, 0),
+      math::Vector3d(side * 2.0, side * 2.0, 1));
+  ground.SetStatic(true);
+
+  BoxShape box;
+  box.SetSize(math::Vector3d(1, 1, 1));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = test::AddShapeModel(_world,
+        math::Pose3d((i % side) * 0.99, (i / side) * 0.99, 0.5, 0, 0, 0),
+        box);
+    if ((i % 100) < _movingPercent)
+      model.SetLinearVelocity(math::Vector3d(0.5, 0, 0));
+  }
+}
+
+/// \brief Step a mostly parked fleet with and without sleeping.
+/// Arguments: number of models, percentage of moving models, sleep steps.
+void BM_TpeParkedFleetStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  world.SetNarrowPhaseEnabled(true);
+  world.SetSleepSteps(static_cast<unsigned int>(_state.range(2)));
+  AddParkedFleet(world, static_cast<int>(_state.range(0)),
+      static_cast<int>(_state.range(1)));
+
+  // let the parked models fall asleep
+  for (int i = 0; i <= _state.range(2); ++i)
+    world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["sleeping"] = benchmark::Counter(
+      static_cast<double>(world.GetSleepingModelCount()));
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeParkedFleetStep)
+  ->ArgNames({"models", "moving_pct", "sleep_steps"})
+  ->ArgsProduct({{1000, 10000}, {0, 10}, {0, 10}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
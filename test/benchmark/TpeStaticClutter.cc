@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Step a fleet of robots driving through a warehouse of static
+/// shelves, and report the step time for increasing amounts of shelves.
+/// Arguments: number of robots, number of shelves.
+void BM_TpeWarehouseStep(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  world.SetCollisionMargin(0.01);
+
+  // shelves on a grid spanning the same area as the robots
+  const int robots = static_cast<int>(_state.range(0));
+  const int shelves = static_cast<int>(_state.range(1));
+  const double extent = 2.0 * std::ceil(std::sqrt(robots));
+  const int shelfSide = static_cast<int>(std::ceil(std::sqrt(shelves)));
+  const double shelfSpacing = extent / std::max(1, shelfSide);
+  for (int i = 0; i < shelves; ++i)
+  {
+    Model &shelf = test::AddBoxModel(world,
+        math::Pose3d((i % shelfSide) * shelfSpacing,
+        (i / shelfSide) * shelfSpacing, 2.0, 0, 0, 0),
+        math::Vector3d(0.5 * shelfSpacing, 0.2 * shelfSpacing, 1));
+    shelf.SetStatic(true);
+  }
+
+  const int side = static_cast<int>(std::ceil(std::sqrt(robots)));
+  for (int i = 0; i < robots; ++i)
+  {
+    Model &robot = test::AddBoxModel(world,
+        math::Pose3d((i % side) * 2.0, (i / side) * 2.0, 0.5, 0, 0, 0),
+        math::Vector3d(0.8, 0.8, 1));
+    robot.SetLinearVelocity(math::Vector3d(0.5, (i % 3) * 0.1, 0));
+  }
+
+  // add all the models to the broadphase
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeWarehouseStep)
+  ->ArgNames({"robots", "shelves"})
+  ->ArgsProduct({{1000}, {0, 1000, 10000, 100000}})
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
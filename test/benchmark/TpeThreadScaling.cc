@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add a crowd of box models to a world. The models are laid out
+/// on a square grid and move and spin in different directions so they
+/// collide with each other.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of models
+void AddCrowd(World &_world, int _count)
+{
+  const int side = static_cast<int>(std::ceil(std::sqrt(_count)));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model &model = test::AddBoxModel(_world,
+        math::Pose3d((i % side) * 1.5, (i / side) * 1.5, 0, 0, 0, 0),
+        math::Vector3d(1, 1, 1));
+    model.SetLinearVelocity(
+        math::Vector3d((i % 3) - 1.0, ((i / 3) % 3) - 1.0, 0) * 0.5);
+    model.SetAngularVelocity(math::Vector3d(0, 0, (i % 5) * 0.1));
+  }
+}
+
+/// \brief Step a crowd of moving models with a number of threads.
+/// Arguments: number of models, number of threads.
+void BM_TpeWorldStepThreads(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.01);
+  world.SetCollisionMargin(0.05);
+  world.SetThreadCount(static_cast<unsigned int>(_state.range(1)));
+  AddCrowd(world, static_cast<int>(_state.range(0)));
+
+  // add all the models to the broadphase
+  world.Step();
+
+  std::size_t contacts = 0u;
+  for (auto _ : _state)
+  {
+    world.Step();
+    contacts += world.GetContacts().size();
+  }
+
+  _state.counters["contacts_per_step"] = benchmark::Counter(
+      static_cast<double>(contacts) /
+      static_cast<double>(_state.iterations()));
+}
+
+/// \brief Thread counts from 1 to the number of hardware threads, doubling
+/// at each step.
+/// \param[in] _benchmark Benchmark to add the arguments to
+void ThreadArgs(benchmark::internal::Benchmark *_benchmark)
+{
+  const int maxThreads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (int models : {1000, 10000, 100000})
+  {
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+      _benchmark->Args({models, threads});
+    _benchmark->Args({models, maxThreads});
+  }
+}
+
+// the work is spread over several threads so measure wall clock time
+BENCHMARK(BM_TpeWorldStepThreads)
+  ->ArgNames({"models", "threads"})
+  ->Apply(ThreadArgs)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
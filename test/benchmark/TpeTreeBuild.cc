@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/AABBTree.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Generate random boxes spread over a large flat area, like the
+/// models of a large SDF world
+/// \param[in] _count Number of boxes
+/// \param[out] _ids Node ids
+/// \param[out] _boxes Boxes
+void RandomBoxes(std::size_t _count, std::vector<std::size_t> &_ids,
+    std::vector<math::AxisAlignedBox> &_boxes)
+{
+  std::mt19937 gen(1);
+  const double extent = 2.0 * std::sqrt(static_cast<double>(_count));
+  std::uniform_real_distribution<double> pos(0.0, extent);
+  std::uniform_real_distribution<double> size(0.2, 2.0);
+  for (std::size_t i = 0u; i < _count; ++i)
+  {
+    math::Vector3d center(pos(gen), pos(gen), pos(gen) * 0.01);
+    math::Vector3d half = 0.5 * math::Vector3d(size(gen), size(gen),
+        size(gen));
+    _ids.push_back(i);
+    _boxes.emplace_back(center - half, center + half);
+  }
+}
+
+/// \brief Build a tree by adding the nodes one at a time, or all at once
+/// \param[in] _bulk True to add the nodes all at once
+/// \param[in] _ids Node ids
+/// \param[in] _boxes Boxes
+/// \param[out] _tree Tree
+void BuildTree(bool _bulk, const std::vector<std::size_t> &_ids,
+    const std::vector<math::AxisAlignedBox> &_boxes, AABBTree &_tree)
+{
+  _tree.SetRebuildFactor(0.0);
+  if (_bulk)
+  {
+    _tree.AddNodes(_ids, _boxes, {});
+    return;
+  }
+  for (std::size_t i = 0u; i < _ids.size(); ++i)
+    _tree.AddNode(_ids[i], _boxes[i]);
+}
+
+/// \brief Time to build a tree of random boxes.
+/// Arguments: 1 to add the nodes all at once, number of nodes.
+void BM_TpeTreeBuild(benchmark::State &_state)
+{
+  std::vector<std::size_t> ids;
+  std::vector<math::AxisAlignedBox> boxes;
+  RandomBoxes(static_cast<std::size_t>(_state.range(1)), ids, boxes);
+
+  for (auto _ : _state)
+  {
+    AABBTree tree;
+    BuildTree(_state.range(0) != 0, ids, boxes, tree);
+    benchmark::DoNotOptimize(tree.NodeCount());
+  }
+}
+
+BENCHMARK(BM_TpeTreeBuild)
+  ->ArgNames({"bulk", "nodes"})
+  ->ArgsProduct({{0, 1}, {10000, 100000}})
+  ->Unit(benchmark::kMillisecond);
+
+/// \brief Cost of finding all the candidate pairs and of querying a box per
+/// node in a tree of random boxes, and surface area ratio of the tree.
+/// Arguments: 1 to add the nodes all at once, number of nodes.
+void BM_TpeTreeQuery(benchmark::State &_state)
+{
+  std::vector<std::size_t> ids;
+  std::vector<math::AxisAlignedBox> boxes;
+  RandomBoxes(static_cast<std::size_t>(_state.range(1)), ids, boxes);
+  AABBTree tree;
+  BuildTree(_state.range(0) != 0, ids, boxes, tree);
+
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  std::vector<std::size_t> hits;
+  for (auto _ : _state)
+  {
+    tree.CollisionPairs(pairs);
+    for (const auto &box : boxes)
+      tree.Query(box, hits);
+    benchmark::DoNotOptimize(pairs.data());
+    benchmark::DoNotOptimize(hits.data());
+  }
+
+  _state.counters["pairs"] = benchmark::Counter(
+      static_cast<double>(pairs.size()));
+  _state.counters["sah_ratio"] = benchmark::Counter(tree.SurfaceAreaRatio());
+}
+
+BENCHMARK(BM_TpeTreeQuery)
+  ->ArgNames({"bulk", "nodes"})
+  ->ArgsProduct({{0, 1}, {10000, 100000}})
+  ->Unit(benchmark::kMillisecond);
+
+/// \brief Load a large world of static and dynamic models and report the
+/// time of the first step, which adds all the models to the broadphase,
+/// and of the following steps.
+/// Arguments: number of models.
+void BM_TpeLargeWorldStep(benchmark::State &_state)
+{
+  std::vector<std::size_t> ids;
+  std::vector<math::AxisAlignedBox> boxes;
+  RandomBoxes(static_cast<std::size_t>(_state.range(0)), ids, boxes);
+
+  World world;
+  world.SetTimeStep(0.001);
+  for (std::size_t i = 0u; i < boxes.size(); ++i)
+  {
+    Model &model = test::AddBoxModel(world,
+        math::Pose3d(boxes[i].Center(), math::Quaterniond::Identity),
+        boxes[i].Size());
+    model.SetStatic(i % 4u != 0u);
+    if (!model.GetStatic())
+      model.SetLinearVelocity(math::Vector3d(0.5, 0, 0));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  world.Step();
+  std::chrono::duration<double, std::milli> firstStep =
+      std::chrono::steady_clock::now() - start;
+
+  for (auto _ : _state)
+  {
+    world.Step();
+  }
+
+  _state.counters["first_step_ms"] = benchmark::Counter(firstStep.count());
+  _state.counters["contacts"] = benchmark::Counter(
+      static_cast<double>(world.GetContacts().size()));
+}
+
+BENCHMARK(BM_TpeLargeWorldStep)
+  ->ArgNames({"models"})
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+
+#include "lib/src/Collision.hh"
+#include "lib/src/Model.hh"
+#include "lib/src/Shape.hh"
+#include "lib/src/World.hh"
+
+#include "TpeBenchmarkUtils.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Add moving models to a world, each with a chain of nested models.
+/// Every model in the chain has a link with a box collision, as in the
+/// nested model test worlds.
+/// \param[in] _world World to add the models to
+/// \param[in] _count Number of top level models
+/// \param[in] _depth Number of nested models below each top level model
+/// \param[out] _entities Links and collisions of all the models
+void AddNestedModels(World &_world, int _count, int _depth,
+    std::vector<Entity *> &_entities)
+{
+  BoxShape box;
+  box.SetSize(math::Vector3d(0.2, 0.2, 0.2));
+  for (int i = 0; i < _count; ++i)
+  {
+    Model *model = static_cast<Model *>(&_world.AddModel());
+    model->SetPose(math::Pose3d(i * 2.0, 0, 0, 0, 0, 0));
+    model->SetLinearVelocity(math::Vector3d(0, 0.1, 0));
+    model->SetAngularVelocity(math::Vector3d(0, 0, 0.1));
+    for (int d = 0; d <= _depth; ++d)
+    {
+      Collision &collision = test::AddLinkCollision(*model, box);
+      Entity *link = collision.GetParent();
+      link->SetPose(math::Pose3d(0, 0, 0.1, 0, 0, 0));
+      _entities.push_back(link);
+      _entities.push_back(&collision);
+      if (d < _depth)
+      {
+        model = static_cast<Model *>(&model->AddModel());
+        model->SetPose(math::Pose3d(0, 0, 0.3, 0, 0, 0.2));
+      }
+    }
+  }
+}
+
+/// \brief Query the world poses of all the links and collisions several
+/// times, as the frame semantics of the plugin do when poses are read back
+/// after a step.
+/// \param[in] _entities Entities to query
+/// \return Sum of the positions to keep the queries from being optimized out
+double QueryWorldPoses(const std::vector<Entity *> &_entities)
+{
+  double sum = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    for (const Entity *e : _entities)
+      sum += e->GetWorldPose().Pos().Z();
+  }
+  return sum;
+}
+
+/// \brief Query world poses repeatedly without moving the models.
+/// Arguments: number of top level models, nesting depth.
+void BM_TpeWorldPoseQuery(benchmark::State &_state)
+{
+  World world;
+  std::vector<Entity *> entities;
+  AddNestedModels(world, static_cast<int>(_state.range(0)),
+      static_cast<int>(_state.range(1)), entities);
+  world.Step();
+
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(QueryWorldPoses(entities));
+
+  _state.counters["queries"] = benchmark::Counter(
+      3.0 * static_cast<double>(entities.size()) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+
+/// \brief Step moving models and query the world poses after each step.
+/// Arguments: number of top level models, nesting depth.
+void BM_TpeWorldPoseStepQuery(benchmark::State &_state)
+{
+  World world;
+  world.SetTimeStep(0.001);
+  std::vector<Entity *> entities;
+  AddNestedModels(world, static_cast<int>(_state.range(0)),
+      static_cast<int>(_state.range(1)), entities);
+  world.Step();
+
+  for (auto _ : _state)
+  {
+    world.Step();
+    benchmark::DoNotOptimize(QueryWorldPoses(entities));
+  }
+
+  _state.counters["queries"] = benchmark::Counter(
+      3.0 * static_cast<double>(entities.size()) *
+      static_cast<double>(_state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_TpeWorldPoseQuery)
+  ->ArgNames({"models", "depth"})
+  ->ArgsProduct({{100, 1000}, {1, 4, 8}})
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_TpeWorldPoseStepQuery)
+  ->ArgNames({"models", "depth"})
+  ->ArgsProduct({{100, 1000}, {1, 4, 8}})
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
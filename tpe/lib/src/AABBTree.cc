@@ -15,11 +15,19 @@
  *
 */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <set>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <gz/common/Console.hh>
+#include <gz/common/Profiler.hh>
 
-#include "aabb_tree/AABB.h"
+#include "aabb_tree/FixedAABB.h"
 
 #include "AABBTree.hh"
 
@@ -27,15 +35,59 @@ namespace gz {
 namespace physics {
 namespace tpelib {
 
-/// \brief Private data class for AABBTree
+/// \brief Private data class for AABBTreeT
+template <typename Scalar>
 class AABBTreePrivate
 {
-  /// \brief Pointer to the AABB tree
-  public: std::unique_ptr<aabb::Tree> aabbTree;
+  /// \brief Fixed size 3D AABB tree type
+  public: using Tree3 = aabb::FixedTree<3, Scalar>;
 
-  /// \brief A map of node id and its AABB object in the tree
-  // public: std::unordered_map<std::size_t, unsigned int> nodeIds;
-  public: std::set<std::size_t> nodeIds;
+  /// \brief Convert a math::AxisAlignedBox to the tree's AABB type. Single
+  /// precision bounds are rounded outward.
+  /// \param[in] _aabb Axis aligned bounding box
+  /// \return AABB that can be inserted into the tree
+  public: static typename Tree3::AABBType Convert(
+      const math::AxisAlignedBox &_aabb);
+
+  /// \brief Convert the tree's AABB type to a math::AxisAlignedBox
+  /// \param[in] _aabb AABB stored in the tree
+  /// \return Axis aligned bounding box
+  public: static math::AxisAlignedBox Convert(
+      const typename Tree3::AABBType &_aabb);
+
+  /// \brief The AABB tree. Nodes are stored contiguously and the tree does
+  /// not allocate when adding, updating or querying nodes unless its node
+  /// pool needs to grow.
+  public: Tree3 aabbTree{0.0, 1024u};
+
+  /// \brief Check the quality of the tree after a node was added, removed
+  /// or reinserted, and rebuild the tree if it degraded too much
+  /// \param[in,out] _tree Tree to rebuild
+  public: void NodeChanged(AABBTreeT<Scalar> &_tree);
+
+  /// \brief Growth factor of the surface area ratio that triggers a rebuild
+  public: double rebuildFactor{1.5};
+
+  /// \brief Surface area ratio after the last rebuild. 0 if the tree has
+  /// not been rebuilt yet.
+  public: double builtRatio{0.0};
+
+  /// \brief Number of nodes added, removed or reinserted since the last
+  /// quality check
+  public: std::size_t changeCount{0u};
+
+  /// \brief Number of rebuilds
+  public: std::size_t rebuildCount{0u};
+
+  /// \brief Buffer of the ids of the nodes added by AddNodes
+  public: std::vector<std::size_t> ids;
+
+  /// \brief Buffers used to convert the nodes added by AddNodes
+  public: std::vector<typename Tree3::AABBType> aabbs;
+
+  /// \brief Buffers used to convert the enlarged AABBs of the nodes added
+  /// by AddNodes
+  public: std::vector<typename Tree3::AABBType> fatAABBs;
 };
 }
 }
@@ -45,122 +97,400 @@ using namespace gz;
 using namespace physics;
 using namespace tpelib;
 
+namespace
+{
+/// \brief Minimum number of node changes between two quality checks
+const std::size_t kMinQualityCheckInterval = 64u;
+
 //////////////////////////////////////////////////
-AABBTree::AABBTree()
-  : dataPtr(new ::tpelib::AABBTreePrivate)
+/// \brief Convert a lower bound to the scalar type of a tree, rounding it
+/// down if it is not representable
+/// \param[in] _value Lower bound
+/// \return Largest value of the scalar type not greater than _value
+template <typename Scalar>
+Scalar roundDown(double _value)
 {
-  this->dataPtr->aabbTree = std::make_unique<aabb::Tree>(3, 0.0, 100000);
+  if constexpr (std::is_same_v<Scalar, double>)
+  {
+    return _value;
+  }
+  else
+  {
+    using Limits = std::numeric_limits<Scalar>;
+    if (_value < Limits::lowest())
+      return -Limits::infinity();
+    if (_value > Limits::max())
+      return Limits::max();
+    Scalar value = static_cast<Scalar>(_value);
+    return value > _value ? std::nextafter(value, -Limits::infinity()) : value;
+  }
 }
 
 //////////////////////////////////////////////////
-AABBTree::~AABBTree() = default;
+/// \brief Convert an upper bound to the scalar type of a tree, rounding it
+/// up if it is not representable
+/// \param[in] _value Upper bound
+/// \return Smallest value of the scalar type not less than _value
+template <typename Scalar>
+Scalar roundUp(double _value)
+{
+  return -roundDown<Scalar>(-_value);
+}
+}
 
 //////////////////////////////////////////////////
-void AABBTree::AddNode(std::size_t _id, const math::AxisAlignedBox &_aabb)
+template <typename Scalar>
+typename AABBTreePrivate<Scalar>::Tree3::AABBType
+AABBTreePrivate<Scalar>::Convert(const math::AxisAlignedBox &_aabb)
 {
-  std::vector<double> lowerBound(3);
-  lowerBound[0] = _aabb.Min().X();
-  lowerBound[1] = _aabb.Min().Y();
-  lowerBound[2] = _aabb.Min().Z();
+  typename Tree3::AABBType aabb;
+  aabb.lowerBound = {roundDown<Scalar>(_aabb.Min().X()),
+      roundDown<Scalar>(_aabb.Min().Y()), roundDown<Scalar>(_aabb.Min().Z())};
+  aabb.upperBound = {roundUp<Scalar>(_aabb.Max().X()),
+      roundUp<Scalar>(_aabb.Max().Y()), roundUp<Scalar>(_aabb.Max().Z())};
+  aabb.surfaceArea = aabb.computeSurfaceArea();
+  return aabb;
+}
 
-  std::vector<double> upperBound(3);
-  upperBound[0] = _aabb.Max().X();
-  upperBound[1] = _aabb.Max().Y();
-  upperBound[2] = _aabb.Max().Z();
+//////////////////////////////////////////////////
+template <typename Scalar>
+math::AxisAlignedBox AABBTreePrivate<Scalar>::Convert(
+    const typename Tree3::AABBType &_aabb)
+{
+  return math::AxisAlignedBox(
+      math::Vector3d(
+      _aabb.lowerBound[0], _aabb.lowerBound[1], _aabb.lowerBound[2]),
+      math::Vector3d(
+      _aabb.upperBound[0], _aabb.upperBound[1], _aabb.upperBound[2]));
+}
 
-  this->dataPtr->aabbTree->insertParticle(_id, lowerBound, upperBound);
-  this->dataPtr->nodeIds.insert(_id);
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreePrivate<Scalar>::NodeChanged(AABBTreeT<Scalar> &_tree)
+{
+  // the check walks all the nodes so it is only done once a quarter of the
+  // tree changed
+  ++this->changeCount;
+  if (this->rebuildFactor <= 0.0 ||
+      this->changeCount < std::max(kMinQualityCheckInterval,
+      static_cast<std::size_t>(this->aabbTree.nParticles() / 4u)))
+  {
+    return;
+  }
+
+  // a tree that was only built incrementally is rebuilt at the first check.
+  // Trees with infinite nodes have no meaningful ratio.
+  this->changeCount = 0u;
+  double ratio = _tree.SurfaceAreaRatio();
+  if (ratio > 0.0 && (this->builtRatio <= 0.0 ||
+      ratio > this->rebuildFactor * this->builtRatio))
+  {
+    _tree.Rebuild();
+  }
 }
 
 //////////////////////////////////////////////////
-bool AABBTree::RemoveNode(std::size_t _id)
+template <typename Scalar>
+AABBTreeT<Scalar>::AABBTreeT()
+  : dataPtr(new AABBTreePrivate<Scalar>)
 {
-  auto it = this->dataPtr->nodeIds.find(_id);
-  if (it == this->dataPtr->nodeIds.end())
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+AABBTreeT<Scalar>::~AABBTreeT() = default;
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::AddNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
+{
+  if (this->dataPtr->aabbTree.hasParticle(_id))
+  {
+    gzerr << "Unable to add node '" << _id << "'. "
+           << "Node already exists." << std::endl;
+    return;
+  }
+
+  this->dataPtr->aabbTree.insertParticle(_id,
+      AABBTreePrivate<Scalar>::Convert(_aabb),
+      AABBTreePrivate<Scalar>::Convert(this->Fatten(_aabb, _displacement)),
+      kDefaultCollideBitmask);
+  this->dataPtr->NodeChanged(*this);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::AddNodes(const std::vector<std::size_t> &_ids,
+    const std::vector<math::AxisAlignedBox> &_aabbs,
+    const std::vector<math::Vector3d> &_displacements)
+{
+  GZ_PROFILE("tpelib::AABBTree::AddNodes");
+  // small batches are cheaper to insert one at a time
+  if (_ids.size() < kMinQualityCheckInterval ||
+      _ids.size() < this->dataPtr->aabbTree.nParticles() / 4u)
+  {
+    Broadphase::AddNodes(_ids, _aabbs, _displacements);
+    return;
+  }
+
+  // nodes that already exist, or that appear twice in the batch, are
+  // skipped like AddNode does, and the others are still added
+  std::unordered_set<std::size_t> added;
+  added.reserve(_ids.size());
+  this->dataPtr->ids.clear();
+  this->dataPtr->aabbs.clear();
+  this->dataPtr->fatAABBs.clear();
+  for (std::size_t i = 0u; i < _ids.size(); ++i)
+  {
+    if (this->dataPtr->aabbTree.hasParticle(_ids[i]) ||
+        !added.insert(_ids[i]).second)
+    {
+      gzerr << "Unable to add node '" << _ids[i] << "'. "
+             << "Node already exists." << std::endl;
+      continue;
+    }
+
+    this->dataPtr->ids.push_back(_ids[i]);
+    this->dataPtr->aabbs.push_back(
+        AABBTreePrivate<Scalar>::Convert(_aabbs[i]));
+    this->dataPtr->fatAABBs.push_back(AABBTreePrivate<Scalar>::Convert(
+        this->Fatten(_aabbs[i], _displacements.empty() ?
+        math::Vector3d::Zero : _displacements[i])));
+  }
+  if (this->dataPtr->ids.empty())
+    return;
+
+  this->dataPtr->aabbTree.insertParticles(this->dataPtr->ids,
+      this->dataPtr->aabbs, this->dataPtr->fatAABBs);
+  this->dataPtr->builtRatio = this->SurfaceAreaRatio();
+  this->dataPtr->changeCount = 0u;
+  ++this->dataPtr->rebuildCount;
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+bool AABBTreeT<Scalar>::RemoveNode(std::size_t _id)
+{
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
   {
     gzerr << "Unable to remove node '" << _id << "'. "
            << "Node not found." << std::endl;
     return false;
   }
 
-  this->dataPtr->aabbTree->removeParticle(_id);
-  this->dataPtr->nodeIds.erase(it);
+  this->dataPtr->aabbTree.removeParticle(_id);
+  this->dataPtr->NodeChanged(*this);
   return true;
 }
 
 //////////////////////////////////////////////////
-bool AABBTree::UpdateNode(std::size_t _id,
-    const math::AxisAlignedBox &_aabb)
+template <typename Scalar>
+bool AABBTreeT<Scalar>::UpdateNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
 {
-  auto it = this->dataPtr->nodeIds.find(_id);
-  if (it == this->dataPtr->nodeIds.end())
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
   {
     gzerr << "Unable to update node '" << _id << "'. "
            << "Node not found." << std::endl;
     return false;
   }
 
-  std::vector<double> lowerBound(3);
-  lowerBound[0] = _aabb.Min().X();
-  lowerBound[1] = _aabb.Min().Y();
-  lowerBound[2] = _aabb.Min().Z();
-
-  std::vector<double> upperBound(3);
-  upperBound[0] = _aabb.Max().X();
-  upperBound[1] = _aabb.Max().Y();
-  upperBound[2] = _aabb.Max().Z();
-
-
-  this->dataPtr->aabbTree->updateParticle(_id, lowerBound, upperBound);
+  if (this->dataPtr->aabbTree.updateParticle(_id,
+      AABBTreePrivate<Scalar>::Convert(_aabb),
+      AABBTreePrivate<Scalar>::Convert(this->Fatten(_aabb, _displacement))))
+  {
+    ++this->reinsertCount;
+    this->dataPtr->NodeChanged(*this);
+  }
   return true;
 }
 
 //////////////////////////////////////////////////
-unsigned int AABBTree::NodeCount() const
+template <typename Scalar>
+unsigned int AABBTreeT<Scalar>::NodeCount() const
 {
-  return this->dataPtr->nodeIds.size();
+  return this->dataPtr->aabbTree.nParticles();
 }
 
 //////////////////////////////////////////////////
-std::set<std::size_t> AABBTree::Collisions(std::size_t _id) const
+template <typename Scalar>
+std::set<std::size_t> AABBTreeT<Scalar>::Collisions(std::size_t _id) const
 {
   std::set<std::size_t> result;
-  auto it = this->dataPtr->nodeIds.find(_id);
-  if (it == this->dataPtr->nodeIds.end())
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
   {
     gzerr << "Unable to compute collisions for node '" << _id << "'. "
            << "Node not found." << std::endl;
     return result;
   }
 
-  auto collisions  = this->dataPtr->aabbTree->query(_id);
+  // each thread queries the tree with its own buffer
+  thread_local std::vector<std::size_t> collisions;
+  this->dataPtr->aabbTree.query(_id, collisions);
   result = std::set<std::size_t>(collisions.begin(), collisions.end());
   return result;
 }
 
 //////////////////////////////////////////////////
-math::AxisAlignedBox AABBTree::AABB(std::size_t _id) const
+template <typename Scalar>
+void AABBTreeT<Scalar>::Query(const math::AxisAlignedBox &_aabb,
+    std::vector<std::size_t> &_ids) const
+{
+  this->dataPtr->aabbTree.query(
+      AABBTreePrivate<Scalar>::Convert(_aabb), _ids);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::Query(const math::AxisAlignedBox &_aabb,
+    uint16_t _bitmask, std::vector<std::size_t> &_ids) const
 {
-  auto it = this->dataPtr->nodeIds.find(_id);
-  if (it == this->dataPtr->nodeIds.end())
+  this->dataPtr->aabbTree.query(
+      AABBTreePrivate<Scalar>::Convert(_aabb), _bitmask, _ids);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+bool AABBTreeT<Scalar>::SetCollideBitmask(std::size_t _id,
+    uint16_t _bitmask)
+{
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
+  {
+    gzerr << "Unable to set collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  // internal nodes store the union of the bitmasks below them so the pair
+  // traversal skips sub-trees that cannot collide with each other
+  this->dataPtr->aabbTree.setParticleMask(_id, _bitmask);
+  return true;
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+uint16_t AABBTreeT<Scalar>::CollideBitmask(std::size_t _id) const
+{
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
+  {
+    gzerr << "Unable to get collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return 0u;
+  }
+
+  return this->dataPtr->aabbTree.getParticleMask(_id);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::CollisionPairs(
+    std::vector<std::pair<std::size_t, std::size_t>> &_pairs) const
+{
+  this->dataPtr->aabbTree.queryPairs(_pairs);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::RayQuery(RayPacket &_packet,
+    const std::function<void(std::size_t, unsigned int)> &_callback) const
+{
+  // each thread traverses the tree with its own stack
+  thread_local std::vector<unsigned int> stack;
+  this->dataPtr->aabbTree.queryRays(_packet.size, _packet.origins.data(),
+      _packet.invDirections.data(), _packet.maxDistances.data(), stack,
+      _callback);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+math::AxisAlignedBox AABBTreeT<Scalar>::AABB(std::size_t _id) const
+{
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
   {
     gzerr << "Unable to get AABB for node '" << _id << "'. "
            << "Node not found." << std::endl;
     return math::AxisAlignedBox();
   }
 
-  auto aabb = this->dataPtr->aabbTree->getAABB(_id);
+  return AABBTreePrivate<Scalar>::Convert(
+      this->dataPtr->aabbTree.getParticleAABB(_id));
+}
 
-  return math::AxisAlignedBox(
-      math::Vector3d(
-      aabb.lowerBound[0], aabb.lowerBound[1], aabb.lowerBound[2]),
-      math::Vector3d(
-      aabb.upperBound[0], aabb.upperBound[1], aabb.upperBound[2]));
+//////////////////////////////////////////////////
+template <typename Scalar>
+math::AxisAlignedBox AABBTreeT<Scalar>::FatAABB(std::size_t _id) const
+{
+  if (!this->dataPtr->aabbTree.hasParticle(_id))
+  {
+    gzerr << "Unable to get AABB for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return math::AxisAlignedBox();
+  }
+
+  return AABBTreePrivate<Scalar>::Convert(
+      this->dataPtr->aabbTree.getAABB(_id));
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+bool AABBTreeT<Scalar>::HasNode(std::size_t _id) const
+{
+  return this->dataPtr->aabbTree.hasParticle(_id);
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+void AABBTreeT<Scalar>::Rebuild()
+{
+  GZ_PROFILE("tpelib::AABBTree::Rebuild");
+  this->dataPtr->aabbTree.rebuild();
+  this->dataPtr->builtRatio = this->SurfaceAreaRatio();
+  this->dataPtr->changeCount = 0u;
+  ++this->dataPtr->rebuildCount;
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+double AABBTreeT<Scalar>::SurfaceAreaRatio() const
+{
+  double ratio = this->dataPtr->aabbTree.computeSurfaceAreaRatio();
+  return std::isfinite(ratio) ? ratio : 0.0;
 }
 
 //////////////////////////////////////////////////
-bool AABBTree::HasNode(std::size_t _id) const
+template <typename Scalar>
+void AABBTreeT<Scalar>::SetRebuildFactor(double _factor)
 {
-  auto it = this->dataPtr->nodeIds.find(_id);
-  return it != this->dataPtr->nodeIds.end();
+  if (_factor != 0.0 && !(_factor > 1.0))
+  {
+    gzerr << "Invalid rebuild factor '" << _factor << "'. "
+          << "Factor must be greater than 1, or 0 to disable rebuilds."
+          << std::endl;
+    return;
+  }
+  this->dataPtr->rebuildFactor = _factor;
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+double AABBTreeT<Scalar>::RebuildFactor() const
+{
+  return this->dataPtr->rebuildFactor;
+}
+
+//////////////////////////////////////////////////
+template <typename Scalar>
+std::size_t AABBTreeT<Scalar>::RebuildCount() const
+{
+  return this->dataPtr->rebuildCount;
+}
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+template class AABBTreeT<double>;
+template class AABBTreeT<float>;
+}
+}
 }
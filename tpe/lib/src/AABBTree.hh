@@ -20,67 +20,158 @@
 
 #include <memory>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Vector3.hh>
 #include <gz/utils/SuppressWarning.hh>
 
 #include "gz/physics/tpelib/Export.hh"
 
+#include "Broadphase.hh"
+
 namespace gz {
 namespace physics {
 namespace tpelib {
 
 // forward declaration
+template <typename Scalar>
 class AABBTreePrivate;
 
-class GZ_PHYSICS_TPELIB_VISIBLE AABBTree
+/// \brief Broadphase based on a dynamic AABB tree
+/// \tparam Scalar Type of the bounds stored in the tree, double or float.
+/// Float bounds are rounded outward, so the tree nodes take less memory
+/// and the AABBs of the nodes contain the boxes they were given.
+template <typename Scalar>
+class GZ_PHYSICS_TPELIB_VISIBLE AABBTreeT : public Broadphase
 {
   /// \brief Constructor
-  public: AABBTree();
+  public: AABBTreeT();
 
   /// \brief Destructor
-  public: ~AABBTree();
-
-  /// \brief Add a node to the tree
-  /// \param[in] _aabb Axis aligned bounding box of the node
-  /// \param[in] _id Unique id of this node
-  public: void AddNode(std::size_t _id, const math::AxisAlignedBox &_aabb);
-
-  /// \brief Remove a node from the tree
-  /// \param[in] _id Node id
-  /// \return True if the node was successfully removed, false otherwise
-  public: bool RemoveNode(std::size_t _id);
-
-  /// \brief Update a node's axis aligned bounding box
-  /// \param[in] _id Node id
-  /// \param[in] _aabb New axis aligned bounding box
-  /// \return True if the update was successful, false otherwise
-  public: bool UpdateNode(std::size_t _id, const math::AxisAlignedBox &_aabb);
-
-  /// \brief Get the number of nodes in the tree
-  /// \return Number of nodes
-  public: unsigned int NodeCount() const;
+  public: ~AABBTreeT() override;
+
+  // Documentation inherited
+  public: void AddNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  /// \brief Add several nodes at once. When the batch is at least a
+  /// quarter of the tree size, the tree is rebuilt around the new nodes,
+  /// see Rebuild, otherwise the nodes are inserted one at a time. Either
+  /// way, ids that are already in the tree or repeated in the batch are
+  /// skipped and the other nodes are added.
+  /// \param[in] _ids Unique ids of the nodes
+  /// \param[in] _aabbs Axis aligned bounding box of each node
+  /// \param[in] _displacements Expected displacement of each node, or an
+  /// empty vector if the nodes are not expected to move
+  public: void AddNodes(const std::vector<std::size_t> &_ids,
+      const std::vector<math::AxisAlignedBox> &_aabbs,
+      const std::vector<math::Vector3d> &_displacements) override;
+
+  // Documentation inherited
+  public: bool RemoveNode(std::size_t _id) override;
+
+  // Documentation inherited
+  public: bool UpdateNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  // Documentation inherited
+  public: unsigned int NodeCount() const override;
 
   /// \brief Get all the nodes that collide / intersect with input node
   /// \param[in] _id Input node id
   /// \return A set of node ids that collide with the input node
   public: std::set<std::size_t> Collisions(std::size_t _id) const;
 
-  /// \brief Get the AABB for a node
-  /// \param[in] _id Node id
-  /// \return Node's AABB
-  public: math::AxisAlignedBox AABB(std::size_t _id) const;
-
-  /// \brief Get whether the tree has a node with specified id
-  /// \param[in] _id Node id
-  /// \return True if tree has node, false otherwise
-  public: bool HasNode(std::size_t _id) const;
+  /// \brief Get the nodes whose enlarged AABBs overlap a box. Each thread
+  /// traverses the tree with its own stack, so it can be queried from
+  /// several threads at once.
+  /// \param[in] _aabb Box to test
+  /// \param[out] _ids Vector to be cleared and filled with the node ids
+  public: void Query(const math::AxisAlignedBox &_aabb,
+      std::vector<std::size_t> &_ids) const;
+
+  /// \brief Get the nodes whose enlarged AABBs overlap a box and whose
+  /// collide bitmasks share a bit with a bitmask. Sub-trees without a
+  /// common bit are skipped. Each thread traverses the tree with its own
+  /// stack, so it can be queried from several threads at once.
+  /// \param[in] _aabb Box to test
+  /// \param[in] _bitmask Collide bitmask
+  /// \param[out] _ids Vector to be cleared and filled with the node ids
+  public: void Query(const math::AxisAlignedBox &_aabb, uint16_t _bitmask,
+      std::vector<std::size_t> &_ids) const;
+
+  // Documentation inherited
+  public: bool SetCollideBitmask(std::size_t _id, uint16_t _bitmask)
+      override;
+
+  // Documentation inherited
+  public: uint16_t CollideBitmask(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: void CollisionPairs(
+      std::vector<std::pair<std::size_t, std::size_t>> &_pairs)
+      const override;
+
+  // Documentation inherited
+  public: void RayQuery(RayPacket &_packet,
+      const std::function<void(std::size_t, unsigned int)> &_callback)
+      const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox AABB(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox FatAABB(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: bool HasNode(std::size_t _id) const override;
+
+  /// \brief Rebuild the whole tree with a top-down surface area heuristic.
+  /// The tree built by adding nodes one at a time, and the tree after the
+  /// nodes have moved for a while, are more expensive to query.
+  public: void Rebuild();
+
+  /// \brief Get the quality of the tree, computed as the sum of the surface
+  /// areas of all the tree nodes divided by the surface area of the root.
+  /// This is proportional to the expected cost of a query, so lower is
+  /// better.
+  /// \return Surface area ratio, or 0 if the tree is empty
+  public: double SurfaceAreaRatio() const;
+
+  /// \brief Set how much the surface area ratio may grow relative to its
+  /// value after the last rebuild before the tree is rebuilt again. The
+  /// ratio is checked each time a quarter of the nodes have been added,
+  /// removed or reinserted.
+  /// \param[in] _factor Growth factor, must be greater than 1. Set to 0 to
+  /// never rebuild the tree automatically. Defaults to 1.5.
+  public: void SetRebuildFactor(double _factor);
+
+  /// \brief Get how much the surface area ratio may grow before the tree
+  /// is rebuilt.
+  /// \return Growth factor, or 0 if the tree is never rebuilt automatically
+  public: double RebuildFactor() const;
+
+  /// \brief Get the number of times the tree was rebuilt, by Rebuild, by
+  /// AddNodes or because its surface area ratio grew too much.
+  /// \return Number of rebuilds
+  public: std::size_t RebuildCount() const;
 
   /// \brief Pointer to the private data
   GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
-  private: std::unique_ptr<AABBTreePrivate> dataPtr;
+  private: std::unique_ptr<AABBTreePrivate<Scalar>> dataPtr;
   GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
 };
+
+extern template class AABBTreeT<double>;
+extern template class AABBTreeT<float>;
+
+/// \brief AABB tree with double precision bounds
+using AABBTree = AABBTreeT<double>;
+
+/// \brief AABB tree with single precision bounds
+using AABBTreef = AABBTreeT<float>;
 }
 }
 }
@@ -17,6 +17,14 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "AABBTree.hh"
 
 using namespace gz;
@@ -163,3 +171,645 @@ TEST(AABBTree, AABBTree)
   result = tree.Collisions(eId);
   EXPECT_EQ(0u, result.size());
 }
+
+/////////////////////////////////////////////////
+TEST(AABBTree, CollisionPairs)
+{
+  AABBTree tree;
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+
+  // empty tree
+  tree.CollisionPairs(pairs);
+  EXPECT_TRUE(pairs.empty());
+
+  // single node does not collide with itself
+  math::AxisAlignedBox a(-math::Vector3d::One, math::Vector3d::One);
+  std::size_t aId = 1u;
+  tree.AddNode(aId, a);
+  tree.CollisionPairs(pairs);
+  EXPECT_TRUE(pairs.empty());
+
+  math::AxisAlignedBox b(math::Vector3d(-3, -3, -3),
+     math::Vector3d(-2, -2, -2));
+  std::size_t bId = 2u;
+  tree.AddNode(bId, b);
+
+  // c overlaps with a and b
+  math::AxisAlignedBox c(math::Vector3d(-2.5, -2.5, -2.5),
+      math::Vector3d(0.5, 0.5, 0.5));
+  std::size_t cId = 3u;
+  tree.AddNode(cId, c);
+
+  // d overlaps with a only
+  math::AxisAlignedBox d(math::Vector3d(0.55, 0.55, 0.55),
+      math::Vector3d(0.75, 0.75, 0.75));
+  std::size_t dId = 4u;
+  tree.AddNode(dId, d);
+
+  // e does not overlap with any node
+  math::AxisAlignedBox e(math::Vector3d(2.55, 2.55, 2.55),
+      math::Vector3d(3.75, 3.75, 3.75));
+  std::size_t eId = 5u;
+  tree.AddNode(eId, e);
+
+  // each overlapping pair is reported once with the smaller id first
+  tree.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(pairs.size(), result.size());
+  EXPECT_EQ(3u, result.size());
+  EXPECT_EQ(1u, result.count({aId, cId}));
+  EXPECT_EQ(1u, result.count({aId, dId}));
+  EXPECT_EQ(1u, result.count({bId, cId}));
+
+  // update node c so it no longer overlaps with a or b
+  EXPECT_TRUE(tree.UpdateNode(cId, math::AxisAlignedBox(
+    math::Vector3d(-40, -40, -40),
+    math::Vector3d(-10, -10, -10))));
+  tree.CollisionPairs(pairs);
+  ASSERT_EQ(1u, pairs.size());
+  EXPECT_EQ(aId, pairs[0].first);
+  EXPECT_EQ(dId, pairs[0].second);
+
+  // remove node a, no more collisions
+  EXPECT_TRUE(tree.RemoveNode(aId));
+  tree.CollisionPairs(pairs);
+  EXPECT_TRUE(pairs.empty());
+
+  // the pairs must match the per node queries for a larger set of nodes
+  AABBTree grid;
+  const int n = 8;
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      math::Vector3d center(i * 0.9, j * 0.9, 0);
+      grid.AddNode(static_cast<std::size_t>(i * n + j),
+          math::AxisAlignedBox(center - math::Vector3d(0.5, 0.5, 0.5),
+                               center + math::Vector3d(0.5, 0.5, 0.5)));
+    }
+  }
+  grid.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> gridPairs(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(pairs.size(), gridPairs.size());
+
+  std::size_t expectedCount = 0u;
+  for (std::size_t id = 0u; id < static_cast<std::size_t>(n * n); ++id)
+  {
+    for (auto other : grid.Collisions(id))
+    {
+      if (id < other)
+      {
+        EXPECT_EQ(1u, gridPairs.count({id, other}));
+        ++expectedCount;
+      }
+    }
+  }
+  EXPECT_EQ(expectedCount, gridPairs.size());
+
+  // horizontal, vertical and diagonal neighbors in the 8x8 grid
+  EXPECT_EQ(210u, gridPairs.size());
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, ManyNodes)
+{
+  // add more nodes than the initial capacity of the tree's node pool and
+  // use ids that do not fit in 32 bits
+  AABBTree tree;
+  const std::size_t n = 3000u;
+  const std::size_t offset = std::size_t(1u) << 40u;
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    math::Vector3d center(static_cast<double>(i), 0, 0);
+    tree.AddNode(offset + i,
+        math::AxisAlignedBox(center - math::Vector3d(0.6, 0.5, 0.5),
+                             center + math::Vector3d(0.6, 0.5, 0.5)));
+  }
+  EXPECT_EQ(n, tree.NodeCount());
+  EXPECT_TRUE(tree.HasNode(offset));
+  EXPECT_FALSE(tree.HasNode(0u));
+
+  // each node overlaps with its two neighbors only
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  tree.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(n - 1u, result.size());
+  for (std::size_t i = 0u; i + 1u < n; ++i)
+    EXPECT_EQ(1u, result.count({offset + i, offset + i + 1u}));
+
+  EXPECT_EQ(std::set<std::size_t>({offset + 9u, offset + 11u}),
+      tree.Collisions(offset + 10u));
+
+  // remove every other node, leaving no overlaps
+  for (std::size_t i = 1u; i < n; i += 2u)
+    EXPECT_TRUE(tree.RemoveNode(offset + i));
+  EXPECT_EQ(n / 2u, tree.NodeCount());
+  tree.CollisionPairs(pairs);
+  EXPECT_TRUE(pairs.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, ConcurrentQueries)
+{
+  // a row of nodes queried from several threads at once. Each query must
+  // give the same result as when run alone.
+  AABBTree tree;
+  const std::size_t n = 500u;
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    math::Vector3d center(static_cast<double>(i), 0, 0);
+    tree.AddNode(i, math::AxisAlignedBox(center - math::Vector3d(0.6, 0.5, 0.5),
+        center + math::Vector3d(0.6, 0.5, 0.5)));
+  }
+  std::vector<std::pair<std::size_t, std::size_t>> expectedPairs;
+  tree.CollisionPairs(expectedPairs);
+  ASSERT_EQ(n - 1u, expectedPairs.size());
+
+  const unsigned int threadCount = 4u;
+  std::vector<unsigned int> failures(threadCount, 0u);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0u; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      std::vector<std::size_t> ids;
+      std::vector<std::pair<std::size_t, std::size_t>> pairs;
+      for (std::size_t i = 0u; i < n; ++i)
+      {
+        math::Vector3d center(static_cast<double>(i), 0, 0);
+        tree.Query(math::AxisAlignedBox(center - math::Vector3d::One * 0.1,
+            center + math::Vector3d::One * 0.1), ids);
+        failures[t] += std::set<std::size_t>(ids.begin(), ids.end()) !=
+            std::set<std::size_t>({i});
+        if (i > 0u && i + 1u < n)
+        {
+          failures[t] += tree.Collisions(i) !=
+              std::set<std::size_t>({i - 1u, i + 1u});
+        }
+        if (i % 100u == 0u)
+        {
+          tree.CollisionPairs(pairs);
+          failures[t] += pairs.size() != expectedPairs.size();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (unsigned int t = 0u; t < threadCount; ++t)
+    EXPECT_EQ(0u, failures[t]);
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, Margin)
+{
+  AABBTree tree;
+  EXPECT_DOUBLE_EQ(0.0, tree.Margin());
+  tree.SetMargin(0.5);
+  EXPECT_DOUBLE_EQ(0.5, tree.Margin());
+
+  // negative margins are not allowed
+  tree.SetMargin(-1.0);
+  EXPECT_DOUBLE_EQ(0.5, tree.Margin());
+
+  math::AxisAlignedBox a(math::Vector3d(-1, -1, -1),
+      math::Vector3d(1, 1, 1));
+  std::size_t aId = 1u;
+  tree.AddNode(aId, a);
+  EXPECT_EQ(a, tree.AABB(aId));
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-1.5, -1.5, -1.5),
+      math::Vector3d(1.5, 1.5, 1.5)), tree.FatAABB(aId));
+
+  // b is within the margin of a. It is reported as a candidate pair but its
+  // AABB does not intersect with a's AABB
+  math::AxisAlignedBox b(math::Vector3d(1.2, -1, -1),
+      math::Vector3d(3.2, 1, 1));
+  std::size_t bId = 2u;
+  tree.AddNode(bId, b);
+  EXPECT_EQ(std::set<std::size_t>({bId}), tree.Collisions(aId));
+  EXPECT_FALSE(tree.AABB(aId).Intersects(tree.AABB(bId)));
+
+  // moving a within its enlarged AABB does not reinsert it in the tree
+  EXPECT_EQ(0u, tree.ReinsertCount());
+  math::AxisAlignedBox a2(math::Vector3d(-0.7, -1, -1),
+      math::Vector3d(1.3, 1, 1));
+  EXPECT_TRUE(tree.UpdateNode(aId, a2));
+  EXPECT_EQ(0u, tree.ReinsertCount());
+  EXPECT_EQ(a2, tree.AABB(aId));
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-1.5, -1.5, -1.5),
+      math::Vector3d(1.5, 1.5, 1.5)), tree.FatAABB(aId));
+  EXPECT_TRUE(tree.AABB(aId).Intersects(tree.AABB(bId)));
+
+  // moving a outside of its enlarged AABB reinserts it. The new enlarged
+  // AABB is extended along the displacement
+  math::AxisAlignedBox a3(math::Vector3d(0, -1, -1),
+      math::Vector3d(2, 1, 1));
+  EXPECT_TRUE(tree.UpdateNode(aId, a3, math::Vector3d(2, 0, -1)));
+  EXPECT_EQ(1u, tree.ReinsertCount());
+  EXPECT_EQ(a3, tree.AABB(aId));
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-0.5, -1.5, -2.5),
+      math::Vector3d(4.5, 1.5, 1.5)), tree.FatAABB(aId));
+
+  // keep moving a along the displacement without reinserting it
+  for (int i = 1; i <= 2; ++i)
+  {
+    math::Vector3d offset(i, 0, 0);
+    EXPECT_TRUE(tree.UpdateNode(aId, math::AxisAlignedBox(
+        a3.Min() + offset, a3.Max() + offset), math::Vector3d(2, 0, -1)));
+  }
+  EXPECT_EQ(1u, tree.ReinsertCount());
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, RayGrazingFace)
+{
+  // rays along an axis that start on the plane of a face of a box. Their
+  // inverse direction is infinite along the other axes, where the origin
+  // lies on the bounds of the box.
+  math::AxisAlignedBox box(math::Vector3d::Zero, math::Vector3d::One);
+  RayPacket packet;
+  packet.size = 5u;
+  packet.origins[0] = {-1, 1, 0.5};
+  packet.invDirections[0] = {1, math::INF_D, math::INF_D};
+  packet.origins[1] = {2, 0, 0.5};
+  packet.invDirections[1] = {-1, -math::INF_D, math::INF_D};
+  packet.origins[2] = {1, 0.5, 5};
+  packet.invDirections[2] = {math::INF_D, math::INF_D, -1};
+  packet.origins[3] = {0, 0, -1};
+  packet.invDirections[3] = {-math::INF_D, math::INF_D, 1};
+  // just outside the face
+  packet.origins[4] = {-1, 1.001, 0.5};
+  packet.invDirections[4] = {1, math::INF_D, math::INF_D};
+  packet.maxDistances.fill(10.0);
+
+  std::array<double, 3> min = {0, 0, 0};
+  std::array<double, 3> max = {1, 1, 1};
+  for (unsigned int i = 0u; i < 4u; ++i)
+    EXPECT_TRUE(packet.Hits(i, min, max)) << i;
+  EXPECT_FALSE(packet.Hits(4u, min, max));
+
+  AABBTree tree;
+  AABBTreef treeFloat;
+  tree.AddNode(1u, box);
+  treeFloat.AddNode(1u, box);
+  for (const Broadphase *broadphase :
+      {static_cast<const Broadphase *>(&tree),
+      static_cast<const Broadphase *>(&treeFloat)})
+  {
+    std::set<unsigned int> rays;
+    RayPacket p = packet;
+    broadphase->RayQuery(p, [&](std::size_t _id, unsigned int _ray)
+    {
+      EXPECT_EQ(1u, _id);
+      rays.insert(_ray);
+    });
+    EXPECT_EQ(std::set<unsigned int>({0u, 1u, 2u, 3u}), rays);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, CollideBitmask)
+{
+  AABBTree tree;
+  math::AxisAlignedBox box(math::Vector3d(-1, -1, -1),
+      math::Vector3d(1, 1, 1));
+  tree.AddNode(1u, box);
+  tree.AddNode(2u, box);
+  tree.AddNode(3u, box);
+  EXPECT_EQ(kDefaultCollideBitmask, tree.CollideBitmask(1u));
+
+  // nodes 1 and 2 do not share a bit, node 3 shares a bit with both
+  EXPECT_TRUE(tree.SetCollideBitmask(1u, 0x01));
+  EXPECT_TRUE(tree.SetCollideBitmask(2u, 0x02));
+  EXPECT_TRUE(tree.SetCollideBitmask(3u, 0x03));
+  EXPECT_EQ(0x01, tree.CollideBitmask(1u));
+  EXPECT_EQ(0x02, tree.CollideBitmask(2u));
+  EXPECT_FALSE(tree.SetCollideBitmask(4u, 0x01));
+  EXPECT_EQ(0u, tree.CollideBitmask(4u));
+
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  tree.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ((std::set<std::pair<std::size_t, std::size_t>>{{1u, 3u},
+      {2u, 3u}}), result);
+
+  std::vector<std::size_t> ids;
+  tree.Query(box, 0x02, ids);
+  EXPECT_EQ(std::set<std::size_t>({2u, 3u}),
+      std::set<std::size_t>(ids.begin(), ids.end()));
+  tree.Query(box, 0x04, ids);
+  EXPECT_TRUE(ids.empty());
+
+  // a node without any bit never collides
+  EXPECT_TRUE(tree.SetCollideBitmask(3u, 0x00));
+  tree.CollisionPairs(pairs);
+  EXPECT_TRUE(pairs.empty());
+
+  // the tree stores the bitmasks with the width of the broadphase bitmasks,
+  // so the highest bit is kept
+  EXPECT_TRUE(tree.SetCollideBitmask(1u, 0x8000));
+  EXPECT_TRUE(tree.SetCollideBitmask(2u, 0x8000));
+  EXPECT_EQ(0x8000, tree.CollideBitmask(1u));
+  tree.CollisionPairs(pairs);
+  result = std::set<std::pair<std::size_t, std::size_t>>(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ((std::set<std::pair<std::size_t, std::size_t>>{{1u, 2u}}),
+      result);
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, CollideBitmaskRandom)
+{
+  // overlapping random boxes in random groups, moved, removed and added
+  // back so that the tree is restructured. The pruned traversal must
+  // report the overlapping pairs that share a bit.
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> pos(0.0, 10.0);
+  std::uniform_real_distribution<double> step(-0.5, 0.5);
+  std::uniform_int_distribution<int> group(0, 5);
+
+  AABBTree tree;
+  const std::size_t n = 200u;
+  std::vector<math::AxisAlignedBox> boxes;
+  std::vector<uint16_t> masks;
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    math::Vector3d center(pos(gen), pos(gen), pos(gen) * 0.1);
+    boxes.emplace_back(center - math::Vector3d::One * 0.5,
+        center + math::Vector3d::One * 0.5);
+    masks.push_back(static_cast<uint16_t>(1u << group(gen)));
+    tree.AddNode(i, boxes.back());
+    tree.SetCollideBitmask(i, masks.back());
+  }
+
+  for (int iter = 0; iter < 10; ++iter)
+  {
+    std::set<std::pair<std::size_t, std::size_t>> expected;
+    for (std::size_t i = 0u; i < n; ++i)
+    {
+      for (std::size_t j = i + 1u; j < n; ++j)
+      {
+        if ((masks[i] & masks[j]) != 0 && boxes[i].Intersects(boxes[j]))
+          expected.insert({i, j});
+      }
+    }
+    EXPECT_FALSE(expected.empty());
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    tree.CollisionPairs(pairs);
+    std::set<std::pair<std::size_t, std::size_t>> result(
+        pairs.begin(), pairs.end());
+    EXPECT_EQ(expected, result);
+
+    for (std::size_t i = 0u; i < n; ++i)
+    {
+      math::Vector3d offset(step(gen), step(gen), 0);
+      boxes[i] = math::AxisAlignedBox(boxes[i].Min() + offset,
+          boxes[i].Max() + offset);
+      EXPECT_TRUE(tree.UpdateNode(i, boxes[i]));
+    }
+    for (std::size_t i = iter; i < n; i += 17u)
+    {
+      EXPECT_TRUE(tree.RemoveNode(i));
+      tree.AddNode(i, boxes[i]);
+      masks[i] = static_cast<uint16_t>(1u << group(gen));
+      EXPECT_TRUE(tree.SetCollideBitmask(i, masks[i]));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, BulkBuild)
+{
+  // random boxes added one at a time to a tree and all at once to another
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> pos(0.0, 100.0);
+  std::uniform_real_distribution<double> size(0.1, 2.0);
+
+  std::vector<std::size_t> ids;
+  std::vector<math::AxisAlignedBox> boxes;
+  for (std::size_t i = 0u; i < 2000u; ++i)
+  {
+    math::Vector3d center(pos(gen), pos(gen), pos(gen) * 0.05);
+    math::Vector3d half(size(gen), size(gen), size(gen));
+    ids.push_back(i * 3u);
+    boxes.emplace_back(center - half * 0.5, center + half * 0.5);
+  }
+
+  AABBTree incremental;
+  incremental.SetRebuildFactor(0.0);
+  for (std::size_t i = 0u; i < ids.size(); ++i)
+    incremental.AddNode(ids[i], boxes[i]);
+  EXPECT_EQ(0u, incremental.RebuildCount());
+
+  AABBTree bulk;
+  bulk.AddNodes(ids, boxes, {});
+  EXPECT_EQ(1u, bulk.RebuildCount());
+  EXPECT_EQ(ids.size(), bulk.NodeCount());
+  for (std::size_t i = 0u; i < ids.size(); ++i)
+  {
+    EXPECT_TRUE(bulk.HasNode(ids[i]));
+    EXPECT_EQ(boxes[i], bulk.AABB(ids[i]));
+  }
+
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  incremental.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> expected(
+      pairs.begin(), pairs.end());
+  EXPECT_FALSE(expected.empty());
+  bulk.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(expected, result);
+
+  // the surface area heuristic gives a cheaper tree to query
+  EXPECT_GT(incremental.SurfaceAreaRatio(), 0.0);
+  EXPECT_LT(bulk.SurfaceAreaRatio(), incremental.SurfaceAreaRatio());
+  incremental.Rebuild();
+  EXPECT_EQ(1u, incremental.RebuildCount());
+  EXPECT_LT(incremental.SurfaceAreaRatio(), 1.1 * bulk.SurfaceAreaRatio());
+  incremental.CollisionPairs(pairs);
+  result = std::set<std::pair<std::size_t, std::size_t>>(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(expected, result);
+
+  // ids of the batch must not be in the tree yet
+  bulk.AddNodes(ids, boxes, {});
+  EXPECT_EQ(ids.size(), bulk.NodeCount());
+
+  // a small batch is inserted one node at a time
+  bulk.AddNodes({1u, 2u}, {boxes[0], boxes[1]}, {});
+  EXPECT_EQ(ids.size() + 2u, bulk.NodeCount());
+  EXPECT_EQ(1u, bulk.RebuildCount());
+
+  // ids already in the tree or repeated in a large batch are skipped and
+  // the other nodes of the batch are still added
+  std::vector<std::size_t> batchIds;
+  std::vector<math::AxisAlignedBox> batchBoxes;
+  for (std::size_t i = 1u; i <= 600u; ++i)
+  {
+    batchIds.push_back(i * 3u + 2u);
+    batchBoxes.push_back(boxes[i]);
+  }
+  batchIds.push_back(ids[0]);
+  batchBoxes.push_back(boxes[1]);
+  batchIds.push_back(batchIds[0]);
+  batchBoxes.push_back(boxes[2]);
+  bulk.AddNodes(batchIds, batchBoxes, {});
+  EXPECT_EQ(2u, bulk.RebuildCount());
+  EXPECT_EQ(ids.size() + 2u + 600u, bulk.NodeCount());
+  for (std::size_t i = 0u; i < 600u; ++i)
+  {
+    EXPECT_TRUE(bulk.HasNode(batchIds[i]));
+    EXPECT_EQ(batchBoxes[i], bulk.AABB(batchIds[i]));
+  }
+  EXPECT_EQ(boxes[0], bulk.AABB(ids[0]));
+
+  // identical boxes are split evenly
+  AABBTree stacked;
+  std::vector<std::size_t> stackedIds(100u);
+  for (std::size_t i = 0u; i < stackedIds.size(); ++i)
+    stackedIds[i] = i;
+  stacked.AddNodes(stackedIds, std::vector<math::AxisAlignedBox>(
+      stackedIds.size(), boxes[0]), {});
+  EXPECT_EQ(stackedIds.size(), stacked.NodeCount());
+  stacked.CollisionPairs(pairs);
+  EXPECT_EQ(stackedIds.size() * (stackedIds.size() - 1u) / 2u, pairs.size());
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, RebuildFactor)
+{
+  AABBTree tree;
+  EXPECT_DOUBLE_EQ(1.5, tree.RebuildFactor());
+  tree.SetRebuildFactor(0.5);
+  EXPECT_DOUBLE_EQ(1.5, tree.RebuildFactor());
+  tree.SetRebuildFactor(2.0);
+  EXPECT_DOUBLE_EQ(2.0, tree.RebuildFactor());
+  EXPECT_DOUBLE_EQ(0.0, tree.SurfaceAreaRatio());
+
+  // random boxes added one at a time. The tree is rebuilt while it grows.
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> pos(0.0, 100.0);
+  std::uniform_real_distribution<double> step(-1.0, 1.0);
+  const std::size_t n = 2000u;
+  std::vector<math::Vector3d> centers;
+  AABBTree incremental;
+  incremental.SetRebuildFactor(0.0);
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    centers.emplace_back(pos(gen), pos(gen), 0);
+    math::AxisAlignedBox box(centers[i] - math::Vector3d::One * 0.5,
+        centers[i] + math::Vector3d::One * 0.5);
+    tree.AddNode(i, box);
+    incremental.AddNode(i, box);
+  }
+  EXPECT_LT(0u, tree.RebuildCount());
+  EXPECT_EQ(0u, incremental.RebuildCount());
+  EXPECT_LT(tree.SurfaceAreaRatio(), incremental.SurfaceAreaRatio());
+
+  // random walk of all the boxes, with a factor low enough for the tree
+  // to be rebuilt as it degrades
+  tree.SetRebuildFactor(1.01);
+  std::size_t rebuildCount = tree.RebuildCount();
+  for (int iter = 0; iter < 10; ++iter)
+  {
+    for (std::size_t i = 0u; i < n; ++i)
+    {
+      centers[i] += math::Vector3d(step(gen), step(gen), 0);
+      EXPECT_TRUE(tree.UpdateNode(i, math::AxisAlignedBox(
+          centers[i] - math::Vector3d::One * 0.5,
+          centers[i] + math::Vector3d::One * 0.5)));
+    }
+  }
+  EXPECT_LT(rebuildCount, tree.RebuildCount());
+
+  // no automatic rebuild when disabled
+  tree.SetRebuildFactor(0.0);
+  rebuildCount = tree.RebuildCount();
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    EXPECT_TRUE(tree.UpdateNode(i, math::AxisAlignedBox(
+        centers[i] - math::Vector3d::One * 5,
+        centers[i] + math::Vector3d::One * 5)));
+  }
+  EXPECT_EQ(n * 11u, tree.ReinsertCount());
+  EXPECT_EQ(rebuildCount, tree.RebuildCount());
+}
+
+/////////////////////////////////////////////////
+TEST(AABBTree, SinglePrecision)
+{
+  // boxes far from the origin whose bounds are not representable as
+  // floats are rounded outward
+  AABBTreef tree;
+  math::AxisAlignedBox a(math::Vector3d(1000.1, 2000.2, -0.3),
+      math::Vector3d(1001.1, 2001.2, 0.7));
+  tree.AddNode(1u, a);
+  math::AxisAlignedBox stored = tree.AABB(1u);
+  EXPECT_TRUE(stored.Contains(a.Min()));
+  EXPECT_TRUE(stored.Contains(a.Max()));
+  EXPECT_TRUE(stored.Min().Equal(a.Min(), 1e-3));
+  EXPECT_TRUE(stored.Max().Equal(a.Max(), 1e-3));
+  EXPECT_EQ(stored, tree.FatAABB(1u));
+
+  // boxes that touch in double precision still overlap
+  math::AxisAlignedBox b(math::Vector3d(1001.1, 2000.2, -0.3),
+      math::Vector3d(1002.1, 2001.2, 0.7));
+  tree.AddNode(2u, b);
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  tree.CollisionPairs(pairs);
+  ASSERT_EQ(1u, pairs.size());
+
+  // infinite boxes stay infinite
+  math::AxisAlignedBox inf(
+      -math::Vector3d(math::INF_D, math::INF_D, math::INF_D),
+      math::Vector3d(math::INF_D, math::INF_D, 0));
+  tree.AddNode(3u, inf);
+  stored = tree.AABB(3u);
+  EXPECT_TRUE(std::isinf(stored.Min().X()));
+  EXPECT_TRUE(std::isinf(stored.Max().Y()));
+  EXPECT_DOUBLE_EQ(0.0, stored.Max().Z());
+  EXPECT_EQ(std::set<std::size_t>({1u, 2u}), tree.Collisions(3u));
+
+  // rays are tested in double precision against the stored boxes
+  RayPacket packet;
+  packet.size = 1u;
+  packet.origins[0] = {1000.5, 2000.5, 10};
+  packet.invDirections[0] = {math::INF_D, math::INF_D, -1};
+  packet.maxDistances[0] = 9.3;
+  std::vector<std::size_t> hits;
+  tree.RayQuery(packet, [&](std::size_t _id, unsigned int)
+  {
+    hits.push_back(_id);
+  });
+  EXPECT_EQ(std::vector<std::size_t>({1u}), hits);
+
+  // the double and float trees report the same pairs for random boxes
+  AABBTree treeDouble;
+  AABBTreef treeFloat;
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> coord(-500.0, 500.0);
+  std::uniform_real_distribution<double> size(0.1, 20.0);
+  for (std::size_t i = 0u; i < 500u; ++i)
+  {
+    math::Vector3d min(coord(gen), coord(gen), coord(gen) * 0.01);
+    math::AxisAlignedBox box(min,
+        min + math::Vector3d(size(gen), size(gen), size(gen)));
+    treeDouble.AddNode(i, box);
+    treeFloat.AddNode(i, box);
+  }
+  std::vector<std::pair<std::size_t, std::size_t>> pairsDouble;
+  treeDouble.CollisionPairs(pairsDouble);
+  treeFloat.CollisionPairs(pairs);
+  EXPECT_LT(0u, pairs.size());
+  std::set<std::pair<std::size_t, std::size_t>> expected(
+      pairsDouble.begin(), pairsDouble.end());
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(expected, result);
+}
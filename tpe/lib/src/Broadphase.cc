@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <gz/common/Console.hh>
+
+#include "Broadphase.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+//////////////////////////////////////////////////
+bool RayPacket::Hits(unsigned int _ray, const std::array<double, 3> &_min,
+    const std::array<double, 3> &_max) const
+{
+  const auto &origin = this->origins[_ray];
+  const auto &invDirection = this->invDirections[_ray];
+  double tMin = 0.0;
+  double tMax = this->maxDistances[_ray];
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    // a ray parallel to the slab of an axis only hits the box if it starts
+    // within the slab. This also avoids 0 * inf when it starts on a face.
+    if (std::isinf(invDirection[i]))
+    {
+      if (origin[i] < _min[i] || origin[i] > _max[i])
+        return false;
+      continue;
+    }
+    double t1 = (_min[i] - origin[i]) * invDirection[i];
+    double t2 = (_max[i] - origin[i]) * invDirection[i];
+    tMin = std::max(tMin, std::min(t1, t2));
+    tMax = std::min(tMax, std::max(t1, t2));
+  }
+  return tMin <= tMax;
+}
+
+//////////////////////////////////////////////////
+Broadphase::~Broadphase() = default;
+
+//////////////////////////////////////////////////
+void Broadphase::SetMargin(double _margin)
+{
+  if (_margin < 0.0)
+  {
+    gzerr << "Invalid broadphase margin '" << _margin << "'. "
+          << "Margin must not be negative." << std::endl;
+    return;
+  }
+  this->margin = _margin;
+}
+
+//////////////////////////////////////////////////
+double Broadphase::Margin() const
+{
+  return this->margin;
+}
+
+//////////////////////////////////////////////////
+void Broadphase::AddNodes(const std::vector<std::size_t> &_ids,
+    const std::vector<math::AxisAlignedBox> &_aabbs,
+    const std::vector<math::Vector3d> &_displacements)
+{
+  for (std::size_t i = 0u; i < _ids.size(); ++i)
+  {
+    this->AddNode(_ids[i], _aabbs[i], _displacements.empty() ?
+        math::Vector3d::Zero : _displacements[i]);
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t Broadphase::ReinsertCount() const
+{
+  return this->reinsertCount;
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox Broadphase::Fatten(const math::AxisAlignedBox &_aabb,
+    const math::Vector3d &_displacement) const
+{
+  math::Vector3d min = _aabb.Min() - this->margin;
+  math::Vector3d max = _aabb.Max() + this->margin;
+
+  // extend the box in the direction of motion only
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    if (_displacement[i] < 0.0)
+      min[i] += _displacement[i];
+    else
+      max[i] += _displacement[i];
+  }
+  return math::AxisAlignedBox(min, max);
+}
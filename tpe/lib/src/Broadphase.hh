@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_BROADPHASE_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_BROADPHASE_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Vector3.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+/// \enum BroadphaseType
+/// \brief The set of broadphase collision detection algorithms.
+enum class GZ_PHYSICS_TPELIB_VISIBLE BroadphaseType
+{
+  /// \brief Dynamic AABB tree. Works well for scenes with entities of very
+  /// different sizes.
+  AABB_TREE = 0,
+
+  /// \brief Incremental sort and sweep along the axis of largest spread.
+  /// Works well for large numbers of similar size entities spread over a
+  /// plane.
+  SWEEP_AND_PRUNE = 1,
+
+  /// \brief Uniform grid of hashed cells. Works well for very large worlds
+  /// with many entities of similar size.
+  SPATIAL_HASH = 2,
+
+  /// \brief Dynamic AABB tree storing single precision bounds. The tree
+  /// nodes take less memory than those of AABB_TREE. The bounds are
+  /// rounded outward, so the AABBs used to check the candidate pairs are
+  /// larger than the entities by up to a float rounding error.
+  AABB_TREE_FLOAT = 3,
+};
+
+/// \brief Packet of rays queried together against a broadphase. Each ray is
+/// the segment from its origin along its direction up to its maximum
+/// distance. Rays close to each other, e.g. neighboring lidar beams, visit
+/// mostly the same nodes so they are cheaper to query as a packet.
+struct GZ_PHYSICS_TPELIB_VISIBLE RayPacket
+{
+  /// \brief Maximum number of rays in a packet
+  static constexpr unsigned int kMaxSize = 8u;
+
+  /// \brief Test whether a ray hits an axis aligned box
+  /// \param[in] _ray Index of the ray
+  /// \param[in] _min Lower bound of the box
+  /// \param[in] _max Upper bound of the box
+  /// \return True if the ray hits the box or starts inside it
+  bool Hits(unsigned int _ray, const std::array<double, 3> &_min,
+      const std::array<double, 3> &_max) const;
+
+  /// \brief Number of rays in the packet
+  unsigned int size = 0u;
+
+  /// \brief Origin of each ray
+  std::array<std::array<double, 3>, kMaxSize> origins;
+
+  /// \brief Component-wise inverse of the unit direction of each ray. It
+  /// is infinite along the axes the ray is parallel to.
+  std::array<std::array<double, 3>, kMaxSize> invDirections;
+
+  /// \brief Maximum distance of each ray
+  std::array<double, kMaxSize> maxDistances;
+};
+
+/// \brief Collide bitmask of the nodes added to a broadphase. A node with
+/// this bitmask can collide with any other node.
+constexpr uint16_t kDefaultCollideBitmask = 0xFFFF;
+
+/// \brief Interface for broadphase collision detection algorithms. A
+/// broadphase keeps track of the axis aligned bounding boxes of a set of
+/// nodes and finds the pairs of nodes whose boxes may overlap.
+///
+/// Implementations store an enlarged AABB for each node, see SetMargin.
+/// Node pairs are reported based on the enlarged AABBs and the actual AABBs
+/// can be retrieved with AABB to check the candidate pairs.
+class GZ_PHYSICS_TPELIB_VISIBLE Broadphase
+{
+  /// \brief Destructor
+  public: virtual ~Broadphase();
+
+  /// \brief Set the margin used to enlarge the node AABBs. A node's
+  /// enlarged AABB is only recomputed when its AABB moves outside of it.
+  /// \param[in] _margin Margin in meters added to each side of the AABB.
+  /// Defaults to 0.
+  public: void SetMargin(double _margin);
+
+  /// \brief Get the margin used to enlarge the node AABBs.
+  /// \return Margin in meters
+  public: double Margin() const;
+
+  /// \brief Get the number of times a node's enlarged AABB was recomputed
+  /// because its AABB moved outside of it.
+  /// \return Total number of enlarged AABB updates done by UpdateNode
+  public: std::size_t ReinsertCount() const;
+
+  /// \brief Add a node
+  /// \param[in] _id Unique id of this node
+  /// \param[in] _aabb Axis aligned bounding box of the node
+  /// \param[in] _displacement Expected displacement of the node. The
+  /// enlarged AABB of the node is extended along this vector.
+  public: virtual void AddNode(std::size_t _id,
+      const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) = 0;
+
+  /// \brief Add several nodes at once. Implementations may build their
+  /// structure from scratch when the batch is large, which is faster and
+  /// gives better queries than adding the nodes one at a time, e.g. when a
+  /// world is loaded or many models are spawned.
+  /// \param[in] _ids Unique ids of the nodes
+  /// \param[in] _aabbs Axis aligned bounding box of each node
+  /// \param[in] _displacements Expected displacement of each node, or an
+  /// empty vector if the nodes are not expected to move
+  public: virtual void AddNodes(const std::vector<std::size_t> &_ids,
+      const std::vector<math::AxisAlignedBox> &_aabbs,
+      const std::vector<math::Vector3d> &_displacements);
+
+  /// \brief Remove a node
+  /// \param[in] _id Node id
+  /// \return True if the node was successfully removed, false otherwise
+  public: virtual bool RemoveNode(std::size_t _id) = 0;
+
+  /// \brief Update a node's axis aligned bounding box
+  /// \param[in] _id Node id
+  /// \param[in] _aabb New axis aligned bounding box
+  /// \param[in] _displacement Expected displacement of the node. If the
+  /// node's enlarged AABB needs to be recomputed, it is extended along this
+  /// vector.
+  /// \return True if the update was successful, false otherwise
+  public: virtual bool UpdateNode(std::size_t _id,
+      const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) = 0;
+
+  /// \brief Get the number of nodes
+  /// \return Number of nodes
+  public: virtual unsigned int NodeCount() const = 0;
+
+  /// \brief Get whether there is a node with specified id
+  /// \param[in] _id Node id
+  /// \return True if the node exists, false otherwise
+  public: virtual bool HasNode(std::size_t _id) const = 0;
+
+  /// \brief Set the collide bitmask of a node. Nodes whose bitmasks do not
+  /// share a bit are never reported as a pair, and implementations may skip
+  /// whole groups of such nodes without testing their AABBs.
+  /// \param[in] _id Node id
+  /// \param[in] _bitmask Collide bitmask. Nodes are added with all bits
+  /// set, see kDefaultCollideBitmask.
+  /// \return True if the bitmask was set, false if the node does not exist
+  public: virtual bool SetCollideBitmask(std::size_t _id,
+      uint16_t _bitmask) = 0;
+
+  /// \brief Get the collide bitmask of a node
+  /// \param[in] _id Node id
+  /// \return Collide bitmask of the node, or 0 if the node does not exist
+  public: virtual uint16_t CollideBitmask(std::size_t _id) const = 0;
+
+  /// \brief Get all pairs of nodes whose enlarged AABBs overlap and whose
+  /// collide bitmasks share a bit. Each pair is reported only once, with the
+  /// smaller node id first.
+  /// \param[out] _pairs Vector to be cleared and filled with the pairs.
+  /// Its capacity is kept so it can be reused across calls.
+  public: virtual void CollisionPairs(
+      std::vector<std::pair<std::size_t, std::size_t>> &_pairs) const = 0;
+
+  /// \brief Find the nodes whose AABBs are hit by a packet of rays. The
+  /// broadphase is not modified so it can be queried from several threads
+  /// at once.
+  /// \param[in,out] _packet Rays. The callback can shorten the maximum
+  /// distance of a ray when it finds a hit so that the nodes beyond it are
+  /// skipped.
+  /// \param[in] _callback Called with the node id and the index of the ray
+  /// in the packet for each ray that hits the AABB of a node.
+  public: virtual void RayQuery(RayPacket &_packet,
+      const std::function<void(std::size_t, unsigned int)> &_callback)
+      const = 0;
+
+  /// \brief Get the AABB for a node
+  /// \param[in] _id Node id
+  /// \return Node's AABB
+  public: virtual math::AxisAlignedBox AABB(std::size_t _id) const = 0;
+
+  /// \brief Get the enlarged AABB for a node
+  /// \param[in] _id Node id
+  /// \return Node's enlarged AABB
+  /// \sa SetMargin
+  public: virtual math::AxisAlignedBox FatAABB(std::size_t _id) const = 0;
+
+  /// \brief Compute the enlarged AABB of a node
+  /// \param[in] _aabb Node AABB
+  /// \param[in] _displacement Expected displacement of the node
+  /// \return AABB grown by the margin on each side and extended along the
+  /// displacement
+  protected: math::AxisAlignedBox Fatten(const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement) const;
+
+  /// \brief Margin added to each side of the node AABBs
+  protected: double margin{0.0};
+
+  /// \brief Total number of enlarged AABB updates
+  protected: std::size_t reinsertCount{0u};
+};
+}
+}
+}
+
+#endif
@@ -103,10 +103,23 @@ void Collision::SetShape(const Shape &_shape)
     const MeshShape *typedShape = dynamic_cast<const MeshShape *>(&_shape);
     this->dataPtr->shape.reset(new MeshShape(*typedShape));
   }
+  else if (_shape.GetType() == ShapeType::HEIGHTMAP)
+  {
+    const HeightmapShape *typedShape =
+      static_cast<const HeightmapShape *>(&_shape);
+    this->dataPtr->shape.reset(new HeightmapShape(*typedShape));
+  }
   else
   {
     gzwarn << "Failed to set shape." << std::endl;
+    return;
   }
+
+  // the parents cache the bounding box and whether they have heightmaps,
+  // and wake up so that their contacts are computed again from the new
+  // shape
+  if (this->GetParent())
+    this->GetParent()->ChildrenChanged();
 }
 
 //////////////////////////////////////////////////
@@ -131,6 +144,13 @@ void Collision::SetCollideBitmask(uint16_t _mask)
     this->GetParent()->ChildrenChanged();
 }
 
+//////////////////////////////////////////////////
+bool Collision::HasHeightmap() const
+{
+  return this->dataPtr->shape &&
+      this->dataPtr->shape->GetType() == ShapeType::HEIGHTMAP;
+}
+
 //////////////////////////////////////////////////
 uint16_t Collision::GetCollideBitmask() const
 {
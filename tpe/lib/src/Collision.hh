@@ -69,6 +69,9 @@ class GZ_PHYSICS_TPELIB_VISIBLE Collision : public Entity
   // Documentation Inherited
   public: uint16_t GetCollideBitmask() const override;
 
+  // Documentation inherited
+  public: bool HasHeightmap() const override;
+
   // Documentation inherited
   public: math::AxisAlignedBox GetBoundingBox(bool _force) override;
 
@@ -15,37 +15,466 @@
  *
 */
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <gz/common/Profiler.hh>
 
+#include "Collision.hh"
 #include "CollisionDetector.hh"
+#include "NarrowPhase.hh"
 #include "Utils.hh"
 
 #include "AABBTree.hh"
+#include "SpatialHashGrid.hh"
+#include "SweepAndPrune.hh"
 
 /// \brief Private data class for CollisionDetector
 class gz::physics::tpelib::CollisionDetectorPrivate
 {
-  /// \brief Helper function to check if collisions for a pair of nodes have
-  /// already been recorded or not
-  /// \param[in] _a Node A Id
-  /// \param[in] _b Node B Id
-  /// \return True if this is a duplicate collision
-  public: bool CheckDuplicateCollisionPair(std::size_t _a, std::size_t _b);
+  /// \brief Change to apply to an entity's broadphase node
+  public: struct NodeUpdate
+  {
+    /// \brief Type of change
+    enum class Type
+    {
+      /// \brief Node does not change
+      NONE,
+
+      /// \brief Node is added to the broadphase
+      ADD,
+
+      /// \brief Node is updated in the broadphase
+      UPDATE,
+
+      /// \brief Node is removed because the entity has no bounding box
+      REMOVE
+    };
+
+    /// \brief Type of change
+    Type type{Type::NONE};
+
+    /// \brief True if the node belongs to the static tree
+    bool isStatic{false};
+
+    /// \brief Collide bitmask of the entity
+    uint16_t collideBitmask{kDefaultCollideBitmask};
+
+    /// \brief True if the collide bitmask of the node needs to be set
+    bool bitmaskDirty{false};
+
+    /// \brief True if the entity has a heightmap collision
+    bool heightmap{false};
+
+    /// \brief World AABB of the entity
+    math::AxisAlignedBox aabb;
+
+    /// \brief Expected displacement of the entity
+    math::Vector3d displacement;
+
+    /// \brief True if the node is the union of the AABBs of the entity
+    /// before and after its move, for continuous collision detection
+    bool swept{false};
+
+    /// \brief World AABB of the entity before its move. Only set when
+    /// swept is true.
+    math::AxisAlignedBox startAabb;
+  };
+
+  /// \brief Primitive of a collision shape checked by the narrow phase
+  public: struct CollisionPrimitive
+  {
+    /// \brief Id of the collision
+    std::size_t id{kNullEntityId};
+
+    /// \brief Collide bitmask of the collision
+    uint16_t collideBitmask{0xFF};
+
+    /// \brief Primitive of the collision shape in world frame. Only its
+    /// pose and AABB are set for heightmaps.
+    ConvexPrimitive primitive;
+
+    /// \brief Heightmap of the collision, or null for convex shapes
+    const HeightmapShape *heightmap{nullptr};
+  };
+
+  /// \brief Box of an entity in its own frame, which is tighter than its
+  /// world AABB when the entity is rotated
+  public: struct OrientedBox
+  {
+    /// \brief World pose of the center of the box
+    math::Pose3d pose;
+
+    /// \brief Half extents of the box
+    math::Vector3d halfSize;
+
+    /// \brief False if the entity has no bounding box
+    bool valid{false};
+  };
+
+  /// \brief Get the pairs of nodes whose enlarged AABBs overlap, sorted so
+  /// that the order of the contacts does not depend on the broadphase
+  public: void CollectPairs();
+
+  /// \brief Find the entities of each candidate pair, and compute the
+  /// collision primitives of the entities whose pairs are checked with
+  /// the narrow phase or against a heightmap, and the oriented boxes of
+  /// the entities whose pairs are checked with them
+  public: void PreparePairs();
+
+  /// \brief Compute the world primitives of the collisions of the stored
+  /// entities whose primitives are needed
+  public: void ComputePrimitives();
+
+  /// \brief Compute the oriented boxes of the stored entities whose
+  /// oriented boxes are needed
+  public: void ComputeOrientedBoxes();
+
+  /// \brief Check whether the oriented boxes of two entities overlap.
+  /// Entities without an oriented box overlap all others.
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \return True if the oriented boxes overlap
+  public: bool OrientedBoxesIntersect(std::size_t _index1,
+      std::size_t _index2) const;
+
+  /// \brief Check a candidate pair of entities for contact
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[in] _singleContact Value passed to CheckCollisions
+  /// \param[out] _contacts Contacts to append to
+  public: void CheckPair(std::size_t _index1, std::size_t _index2,
+      bool _singleContact, std::vector<Contact> &_contacts) const;
+
+  /// \brief Check a pair of entities for contact using their AABBs. The
+  /// contacts are the intersection points of the AABBs.
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[in] _singleContact Value passed to CheckCollisions
+  /// \param[out] _contacts Contacts to append to
+  public: void CheckAABBs(std::size_t _index1, std::size_t _index2,
+      bool _singleContact, std::vector<Contact> &_contacts) const;
+
+  /// \brief Check a pair of entities for contact by testing the primitives
+  /// of their collisions against each other. One contact is reported for
+  /// each pair of collisions in contact.
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[in] _singleContact Value passed to CheckCollisions
+  /// \param[out] _contacts Contacts to append to
+  public: void CheckPrimitives(std::size_t _index1, std::size_t _index2,
+      bool _singleContact, std::vector<Contact> &_contacts) const;
+
+  /// \brief Check an entity against the heightmaps of a terrain entity
+  /// using its AABB. The contacts only have a point.
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[in] _singleContact Value passed to CheckCollisions
+  /// \param[out] _contacts Contacts to append to
+  public: void CheckHeightmap(std::size_t _index1, std::size_t _index2,
+      bool _singleContact, std::vector<Contact> &_contacts) const;
 
-  /// \brief AABB tree
-  public: AABBTree aabbTree;
+  /// \brief Get a vector of intersection points between two axis aligned
+  /// boxes, see CollisionDetector::GetIntersectionPoints
+  /// \param[in] _b1 Axis aligned box 1
+  /// \param[in] _b2 Axis aligned box 2
+  /// \param[out] _points Intersection points to be filled
+  /// \param[in] _singleContact Get only 1 intersection point at center of
+  /// all points
+  /// \return True if the boxes intersect
+  public: static bool IntersectionPoints(const math::AxisAlignedBox &_b1,
+      const math::AxisAlignedBox &_b2,
+      std::vector<math::Vector3d> &_points, bool _singleContact);
 
-  /// \brief Set of entity id
+  /// \brief Create a broadphase
+  /// \param[in] _type Broadphase type
+  /// \return New broadphase
+  public: static std::unique_ptr<Broadphase> CreateBroadphase(
+      BroadphaseType _type);
+
+  /// \brief Broadphase used to find candidate pairs of colliding entities
+  /// among the dynamic entities
+  public: std::unique_ptr<Broadphase> broadphase;
+
+  /// \brief Type of broadphase
+  public: BroadphaseType broadphaseType{BroadphaseType::AABB_TREE};
+
+  /// \brief Tree of the static entities. It is kept separate from the
+  /// broadphase of the dynamic entities so that static geometry does not
+  /// make the dynamic entities more expensive to update, and it is only
+  /// modified when static entities change.
+  public: AABBTree staticTree;
+
+  /// \brief Ids of the nodes in the static tree
+  public: std::set<std::size_t> staticNodeIds;
+
+  /// \brief Buffer of static node ids reused across static tree queries
+  public: std::vector<std::size_t> staticHits;
+
+  /// \brief Nodes added to a broadphase in one call to UpdateBroadphase
+  public: struct NodeBatch
+  {
+    /// \brief Node ids
+    std::vector<std::size_t> ids;
+
+    /// \brief World AABB of each node
+    std::vector<math::AxisAlignedBox> aabbs;
+
+    /// \brief Expected displacement of each node
+    std::vector<math::Vector3d> displacements;
+  };
+
+  /// \brief Dynamic nodes added in the current call to UpdateBroadphase.
+  /// They are added together so that the broadphase can be built at once
+  /// when many entities are added, e.g. when a world is loaded.
+  public: NodeBatch addedNodes;
+
+  /// \brief Static nodes added in the current call to UpdateBroadphase
+  public: NodeBatch addedStaticNodes;
+
+  /// \brief Remove the nodes of the entities that are not checked anymore
+  /// from a broadphase. Called after entityIds is filled.
+  /// \param[in,out] _ids Ids of the nodes in the broadphase
+  /// \param[in,out] _broadphase Broadphase
+  public: void RemoveMissingNodes(std::set<std::size_t> &_ids,
+      Broadphase &_broadphase);
+
+  /// \brief Get the AABB of an entity from the tree it belongs to
+  /// \param[in] _index Index of the entity in entities
+  /// \return World AABB of the entity
+  public: math::AxisAlignedBox NodeAABB(std::size_t _index) const;
+
+  /// \brief Get the AABB of an entity at the end of its last move. It
+  /// differs from the AABB of its node when the node is swept.
+  /// \param[in] _index Index of the entity in entities
+  /// \return World AABB of the entity
+  public: math::AxisAlignedBox EndAABB(std::size_t _index) const;
+
+  /// \brief Get the AABB of an entity at the start of its last move
+  /// \param[in] _index Index of the entity in entities
+  /// \return World AABB of the entity
+  public: math::AxisAlignedBox StartAABB(std::size_t _index) const;
+
+  /// \brief Find when the AABBs of two entities started touching during
+  /// their last move, for continuous collision detection
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[out] _contact Contact whose time of impact is set, along with
+  /// the point and normal of the contact of the AABBs at that time
+  /// \return True if the AABBs touched during the move
+  public: bool SweptContact(std::size_t _index1, std::size_t _index2,
+      Contact &_contact) const;
+
+  /// \brief Add the pairs of dynamic and static entities whose enlarged
+  /// AABBs overlap to the candidate pairs. The enlarged AABB of each
+  /// dynamic entity is queried against the static tree.
+  public: void AddStaticPairs();
+
+  /// \brief Get the expected displacement of an entity
+  /// \param[in] _entity Entity
+  /// \return Displacement of the entity over the prediction time
+  public: math::Vector3d Displacement(const Entity &_entity) const;
+
+  /// \brief Collect the primitives of the collisions of an entity and of
+  /// its descendants
+  /// \param[in] _entity Entity
+  /// \param[in] _pose World pose of the entity
+  /// \param[out] _primitives Primitives to append to
+  public: static void CollectPrimitives(Entity &_entity,
+      const math::Pose3d &_pose,
+      std::vector<CollisionPrimitive> &_primitives);
+
+  /// \brief Test two collision primitives for contact. Heightmaps are
+  /// tested against the AABB of the other primitive.
+  /// \param[in] _p1 First primitive
+  /// \param[in] _p2 Second primitive
+  /// \param[out] _contact Contact between the primitives
+  /// \return True if the primitives are in contact
+  public: static bool CollidePrimitives(const CollisionPrimitive &_p1,
+      const CollisionPrimitive &_p2, PrimitiveContact &_contact);
+
+  /// \brief Add, update and remove the broadphase nodes of a list of
+  /// entities, and store the entities in the order of their ids
+  /// \param[in] _entities List of entities
+  public: void UpdateBroadphase(
+      const std::map<std::size_t, std::shared_ptr<Entity>> &_entities);
+
+  /// \brief Get the index of an entity in the stored entities
+  /// \param[in] _id Entity id
+  /// \return Index of the entity, or the number of entities if not found
+  public: std::size_t EntityIndex(std::size_t _id) const;
+
+  /// \brief Update the pairs in contact and their changes from the
+  /// contacts of the current call to CheckCollisions
+  /// \param[in] _contacts Contacts
+  public: void UpdateContactPairs(const std::vector<Contact> &_contacts);
+
+  /// \brief Get whether an entity does not move, i.e. it is asleep, or it
+  /// is static and was neither added nor moved since the last call
+  /// \param[in] _index Index of the entity in entities
+  /// \return True if the entity does not move
+  public: bool Resting(std::size_t _index) const;
+
+  /// \brief Get whether the contacts of a candidate pair are reported from
+  /// the cache instead of being checked again, i.e. both entities are
+  /// resting and at least one of them is asleep
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \return True if the cached contacts of the pair are reported
+  public: bool Cached(std::size_t _index1, std::size_t _index2) const;
+
+  /// \brief Append the contacts of a pair from the previous call to
+  /// CheckCollisions
+  /// \param[in] _index1 Index of the first entity in entities
+  /// \param[in] _index2 Index of the second entity in entities
+  /// \param[out] _contacts Contacts to append to
+  public: void AppendCachedContacts(std::size_t _index1, std::size_t _index2,
+      std::vector<Contact> &_contacts) const;
+
+  /// \brief Wake up the sleeping entities in contact with entities that
+  /// moved in this step
+  /// \param[in] _contacts Contacts
+  public: void WakeTouchedEntities(const std::vector<Contact> &_contacts);
+
+  /// \brief Keep the contacts of the current call to CheckCollisions so
+  /// that they can be reported again for the pairs of resting entities
+  /// \param[in] _contacts Contacts
+  /// \param[in] _singleContact Value passed to CheckCollisions
+  public: void CacheContacts(const std::vector<Contact> &_contacts,
+      bool _singleContact);
+
+  /// \brief Time used to predict the motion of models
+  public: double predictionTime{0.0};
+
+  /// \brief Ids of the nodes in the broadphase of the dynamic entities
   public: std::set<std::size_t> nodeIds;
 
-  /// \brief Keep track of pairs of node ids that collided. The map is cleared
-  /// after each collision detection iteration. The key and value are:
-  ///   std::unorderd_map<node_a_id, std::unordered_map<node_b_id, collided>
-  public: std::unordered_map<std::size_t, std::unordered_map<std::size_t, bool>>
-    collisionStateMap;
+  /// \brief Pairs of overlapping node ids from the broadphase. Kept as a
+  /// member so the buffer is reused across collision detection iterations.
+  public: std::vector<std::pair<std::size_t, std::size_t>> pairs;
+
+  /// \brief Entities being checked, in the order of their ids
+  public: std::vector<Entity *> entities;
+
+  /// \brief Ids of the entities being checked, sorted
+  public: std::vector<std::size_t> entityIds;
+
+  /// \brief World pose of each entity when the broadphase was last
+  /// updated. Rays are cast against the entities at these poses.
+  public: std::vector<math::Pose3d> poses;
+
+  /// \brief Broadphase update computed for each entity
+  public: std::vector<NodeUpdate> updates;
+
+  /// \brief Local AABBs transformed to world frame by one task of
+  /// UpdateBroadphase
+  public: struct BoxTransformBatch
+  {
+    /// \brief Indices in entities of the entities whose AABB is transformed
+    std::vector<std::size_t> indices;
+
+    /// \brief Local AABB of each entity
+    std::vector<math::AxisAlignedBox> boxes;
+
+    /// \brief Pose of each entity
+    std::vector<math::Pose3d> poses;
+
+    /// \brief World AABB of each entity
+    std::vector<math::AxisAlignedBox> worldBoxes;
+  };
+
+  /// \brief AABBs transformed by each task of UpdateBroadphase. They are
+  /// transformed together once the entities of the task are visited.
+  public: std::vector<BoxTransformBatch> taskBoxTransforms;
+
+  /// \brief Contacts found by each task in the narrow phase
+  public: std::vector<std::vector<Contact>> taskContacts;
+
+  /// \brief True to check the candidate pairs with the narrow phase
+  public: bool narrowPhase{false};
+
+  /// \brief True to sweep the AABBs of moving entities
+  public: bool continuous{false};
+
+  /// \brief True to check the oriented boxes of the candidate pairs whose
+  /// AABBs overlap, when the narrow phase is disabled
+  public: bool orientedBoxCheck{false};
+
+  /// \brief AABB at the end of the move of each dynamic entity whose node
+  /// is swept, by entity id. The node is shrunk back to this AABB once the
+  /// entity stops moving.
+  public: std::unordered_map<std::size_t, math::AxisAlignedBox> sweptNodes;
+
+  /// \brief Indices in entities of the entities of each candidate pair
+  public: std::vector<std::pair<std::size_t, std::size_t>> pairIndices;
+
+  /// \brief Whether the collision primitives of each entity are needed
+  public: std::vector<unsigned char> needsPrimitives;
+
+  /// \brief Collision primitives of each entity whose primitives are needed
+  public: std::vector<std::vector<CollisionPrimitive>> primitives;
+
+  /// \brief Whether the oriented box of each entity is needed
+  public: std::vector<unsigned char> needsOrientedBoxes;
+
+  /// \brief Oriented box of each entity whose oriented box is needed
+  public: std::vector<OrientedBox> orientedBoxes;
+
+  /// \brief Sorted pairs in contact in the last call to CheckCollisions
+  public: std::vector<ContactPair> contactPairs;
+
+  /// \brief Sorted pairs in contact in the call before the last one. Kept
+  /// as a member so the buffer is reused.
+  public: std::vector<ContactPair> prevContactPairs;
+
+  /// \brief Pairs that started being in contact in the last call
+  public: std::vector<ContactPair> addedContactPairs;
+
+  /// \brief Pairs that stopped being in contact in the last call
+  public: std::vector<ContactPair> removedContactPairs;
+
+  /// \brief Worker pool used to check collisions in parallel
+  public: std::shared_ptr<common::WorkerPool> workerPool;
+
+  /// \brief Maximum number of tasks run in parallel
+  public: unsigned int threadCount{1u};
+
+  /// \brief Number of steps after which an entity that keeps the same
+  /// pose falls asleep. 0 disables sleeping.
+  public: unsigned int sleepSteps{0u};
+
+  /// \brief Whether each entity in entities is asleep
+  public: std::vector<unsigned char> sleeping;
+
+  /// \brief Number of sleeping entities
+  public: std::size_t sleepingCount{0u};
+
+  /// \brief Contacts of the last call to CheckCollisions, in the order of
+  /// the candidate pairs
+  public: std::vector<Contact> cachedContacts;
+
+  /// \brief Candidate pair of each cached contact, with the smaller
+  /// entity id first. Sorted since the contacts are in pair order.
+  public: std::vector<std::pair<std::size_t, std::size_t>> cachedPairs;
+
+  /// \brief True if the cached contacts were computed with the current
+  /// settings and can be reported again
+  public: bool cacheValid{false};
+
+  /// \brief Value of _singleContact used to compute the cached contacts
+  public: bool cachedSingleContact{false};
+
+  /// \brief True if the cached contacts are used in the current call to
+  /// CheckCollisions
+  public: bool useCache{false};
 };
 
 using namespace gz;
@@ -53,134 +482,1165 @@ using namespace physics;
 using namespace tpelib;
 
 //////////////////////////////////////////////////
-CollisionDetector::CollisionDetector()
-  : dataPtr(new CollisionDetectorPrivate)
+std::unique_ptr<Broadphase> CollisionDetectorPrivate::CreateBroadphase(
+    BroadphaseType _type)
 {
+  switch (_type)
+  {
+    case BroadphaseType::SWEEP_AND_PRUNE:
+      return std::make_unique<SweepAndPrune>();
+    case BroadphaseType::SPATIAL_HASH:
+      return std::make_unique<SpatialHashGrid>();
+    case BroadphaseType::AABB_TREE_FLOAT:
+      return std::make_unique<AABBTreef>();
+    case BroadphaseType::AABB_TREE:
+    default:
+      return std::make_unique<AABBTree>();
+  }
 }
 
 //////////////////////////////////////////////////
-CollisionDetector::~CollisionDetector() = default;
-
-//////////////////////////////////////////////////
-std::vector<Contact> CollisionDetector::CheckCollisions(
-    const std::map<std::size_t, std::shared_ptr<Entity>> &_entities,
-    bool _singleContact)
+math::Vector3d CollisionDetectorPrivate::Displacement(
+    const Entity &_entity) const
 {
-  GZ_PROFILE("tpelib::CollisionDetector::CheckCollisions");
+  if (this->predictionTime <= 0.0)
+    return math::Vector3d::Zero;
 
-  // contacts to be filled and returned
-  std::vector<Contact> contacts;
+  return _entity.GetLinearVelocity() * this->predictionTime;
+}
 
-  // update AABB tree
-  // remove nodes that no longer exist
-  auto nodesToCheckForRemoval = this->dataPtr->nodeIds;
-  for (auto id : nodesToCheckForRemoval)
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CollectPrimitives(Entity &_entity,
+    const math::Pose3d &_pose, std::vector<CollisionPrimitive> &_primitives)
+{
+  for (auto &it : _entity.GetChildren())
   {
-    if (_entities.find(id) == _entities.end())
+    Entity *child = it.second.get();
+    math::Pose3d pose = _pose * child->GetPose();
+    Collision *collision = dynamic_cast<Collision *>(child);
+    if (nullptr == collision)
+    {
+      CollectPrimitives(*child, pose, _primitives);
+      continue;
+    }
+
+    Shape *shape = collision->GetShape();
+    CollisionPrimitive p;
+    if (nullptr != shape && shape->GetType() == ShapeType::HEIGHTMAP)
+    {
+      p.heightmap = static_cast<HeightmapShape *>(shape);
+      p.primitive.type = ShapeType::HEIGHTMAP;
+      p.primitive.pose = pose;
+      p.primitive.aabb = transformAxisAlignedBox(shape->GetBoundingBox(),
+          pose);
+    }
+    else if (nullptr == shape || !convexPrimitive(*shape, pose, p.primitive))
     {
-      this->dataPtr->aabbTree.RemoveNode(id);
-      this->dataPtr->nodeIds.erase(id);
+      continue;
     }
+    p.id = collision->GetId();
+    p.collideBitmask = collision->GetCollideBitmask();
+    _primitives.push_back(p);
+  }
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::CollidePrimitives(const CollisionPrimitive &_p1,
+    const CollisionPrimitive &_p2, PrimitiveContact &_contact)
+{
+  if (nullptr == _p1.heightmap && nullptr == _p2.heightmap)
+    return collidePrimitives(_p1.primitive, _p2.primitive, _contact);
+
+  // heightmaps do not collide with each other
+  if (nullptr != _p1.heightmap && nullptr != _p2.heightmap)
+    return false;
+
+  if (nullptr != _p2.heightmap)
+  {
+    return collideHeightmap(*_p2.heightmap, _p2.primitive.pose,
+        _p1.primitive.aabb, _contact);
+  }
+  if (!collideHeightmap(*_p1.heightmap, _p1.primitive.pose,
+      _p2.primitive.aabb, _contact))
+  {
+    return false;
   }
+  _contact.normal = -_contact.normal;
+  return true;
+}
 
-  // add and update nodes in the tree
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::UpdateBroadphase(
+    const std::map<std::size_t, std::shared_ptr<Entity>> &_entities)
+{
+  GZ_PROFILE("tpelib::CollisionDetector::UpdateBroadphase");
+  this->entities.clear();
+  this->entityIds.clear();
+  this->poses.clear();
   for (auto it = _entities.begin(); it != _entities.end(); ++it)
   {
-    std::shared_ptr<Entity> e = it->second;
-    // add new nodes
-    if (!this->dataPtr->aabbTree.HasNode(it->first))
+    this->entities.push_back(it->second.get());
+    this->entityIds.push_back(it->first);
+    this->poses.push_back(it->second->GetPose());
+  }
+
+  // remove nodes that no longer exist
+  this->RemoveMissingNodes(this->nodeIds, *this->broadphase);
+  this->RemoveMissingNodes(this->staticNodeIds, this->staticTree);
+
+  // compute the world AABBs of new and moved entities. Each entity and its
+  // children are only accessed by one task.
+  auto &updates = this->updates;
+  using UpdateType = CollisionDetectorPrivate::NodeUpdate::Type;
+  updates.resize(this->entities.size());
+  this->sleeping.resize(this->entities.size());
+  this->taskBoxTransforms.resize(this->threadCount);
+
+  auto computeUpdates = [&](unsigned int _task, std::size_t _begin,
+      std::size_t _end)
+  {
+    auto &transforms = this->taskBoxTransforms[_task];
+    transforms.indices.clear();
+    transforms.boxes.clear();
+    transforms.poses.clear();
+    for (std::size_t i = _begin; i < _end; ++i)
     {
-      math::AxisAlignedBox b = e->GetBoundingBox();
+      Entity *e = this->entities[i];
+      auto &update = updates[i];
+      update.type = UpdateType::NONE;
+      update.swept = false;
+      update.displacement = math::Vector3d::Zero;
+
+      // the collide bitmask is cached so the narrow phase only reads it
+      update.collideBitmask = e->GetCollideBitmask();
+      update.heightmap = e->HasHeightmap();
+
+      // entities that kept the same pose for long enough fall asleep
+      this->sleeping[i] = this->sleepSteps > 0u && !e->GetStatic() &&
+          e->GetIdleSteps() >= this->sleepSteps;
+
+      // add new nodes, and nodes that became static or dynamic, to their
+      // tree and update existing nodes that moved
+      update.isStatic = e->GetStatic();
+      Broadphase &tree = update.isStatic ?
+          static_cast<Broadphase &>(this->staticTree) : *this->broadphase;
+      bool add = !tree.HasNode(e->GetId());
 
+      // the broadphase skips pairs of nodes whose bitmasks share no bit
+      update.bitmaskDirty = add ||
+          tree.CollideBitmask(e->GetId()) != update.collideBitmask;
+
+      // entities whose collisions were all removed lose their node, in
+      // whichever tree it is, even if they did not move. The bounding box
+      // is cached so resting entities do not recompute it.
+      math::AxisAlignedBox b = e->GetBoundingBox();
       if (b == math::AxisAlignedBox())
+      {
+        if (this->nodeIds.count(e->GetId()) > 0u ||
+            this->staticNodeIds.count(e->GetId()) > 0u)
+        {
+          update.type = UpdateType::REMOVE;
+        }
+        continue;
+      }
+
+      if (!add && !e->PoseDirty())
+      {
+        auto sweptIt = this->sweptNodes.find(e->GetId());
+        if (sweptIt != this->sweptNodes.end())
+        {
+          update.aabb = sweptIt->second;
+          update.displacement = this->Displacement(*e);
+          update.type = UpdateType::UPDATE;
+        }
         continue;
+      }
+
+      // the aabb is converted to world frame below
+      transforms.indices.push_back(i);
+      transforms.boxes.push_back(b);
+      transforms.poses.push_back(e->GetPose());
+      if (!update.isStatic)
+        update.displacement = this->Displacement(*e);
+      update.type = add ? UpdateType::ADD : UpdateType::UPDATE;
+
+      // entities that moved with a velocity sweep their AABB from where
+      // the last call left it. Teleported entities do not.
+      update.swept = this->continuous && !add && !update.isStatic &&
+          e->GetLinearVelocity() != math::Vector3d::Zero;
+      if (update.swept)
+      {
+        auto sweptIt = this->sweptNodes.find(e->GetId());
+        update.startAabb = sweptIt != this->sweptNodes.end() ?
+            sweptIt->second : tree.AABB(e->GetId());
+      }
+    }
 
-      // convert to world aabb
-      math::AxisAlignedBox aabb;
-      math::Pose3d p = e->GetPose();
-      aabb = transformAxisAlignedBox(b, p);
-      this->dataPtr->aabbTree.AddNode(e->GetId(), aabb);
+    // convert to world aabbs
+    transformAxisAlignedBoxes(transforms.boxes, transforms.poses,
+        transforms.worldBoxes);
+    for (std::size_t k = 0u; k < transforms.indices.size(); ++k)
+      updates[transforms.indices[k]].aabb = transforms.worldBoxes[k];
+  };
+  parallelFor(this->workerPool.get(), this->threadCount,
+      this->entities.size(), computeUpdates);
 
-      this->dataPtr->nodeIds.insert(it->first);
+  // apply the updates in the order of the entity ids
+  this->sleepingCount = 0u;
+  for (auto *batch : {&this->addedNodes, &this->addedStaticNodes})
+  {
+    batch->ids.clear();
+    batch->aabbs.clear();
+    batch->displacements.clear();
+  }
+  for (std::size_t i = 0u; i < this->entities.size(); ++i)
+  {
+    this->sleepingCount += this->sleeping[i];
+    const auto &update = updates[i];
+    std::size_t id = this->entityIds[i];
+    if (update.type == UpdateType::REMOVE)
+    {
+      if (this->nodeIds.erase(id) > 0u)
+        this->broadphase->RemoveNode(id);
+      if (this->staticNodeIds.erase(id) > 0u)
+        this->staticTree.RemoveNode(id);
     }
-    // update existing nodes
-    else if (e->PoseDirty())
+    else if (update.type == UpdateType::ADD && update.isStatic)
     {
-      math::AxisAlignedBox b = e->GetBoundingBox();
+      if (this->nodeIds.erase(id) > 0u)
+        this->broadphase->RemoveNode(id);
+      this->addedStaticNodes.ids.push_back(id);
+      this->addedStaticNodes.aabbs.push_back(update.aabb);
+      this->staticNodeIds.insert(id);
+    }
+    else if (update.type == UpdateType::ADD)
+    {
+      if (this->staticNodeIds.erase(id) > 0u)
+        this->staticTree.RemoveNode(id);
+      this->addedNodes.ids.push_back(id);
+      this->addedNodes.aabbs.push_back(update.aabb);
+      this->addedNodes.displacements.push_back(update.displacement);
+      this->nodeIds.insert(id);
+    }
+    else if (update.type == UpdateType::UPDATE && update.isStatic)
+    {
+      this->staticTree.UpdateNode(id, update.aabb);
+    }
+    else if (update.type == UpdateType::UPDATE && update.swept)
+    {
+      this->broadphase->UpdateNode(id, update.startAabb + update.aabb,
+          update.displacement);
+    }
+    else if (update.type == UpdateType::UPDATE)
+    {
+      this->broadphase->UpdateNode(id, update.aabb, update.displacement);
+    }
+  }
+  this->sweptNodes.clear();
+  for (std::size_t i = 0u; i < this->entities.size(); ++i)
+  {
+    if (updates[i].swept)
+      this->sweptNodes.emplace(this->entityIds[i], updates[i].aabb);
+  }
+  this->staticTree.AddNodes(this->addedStaticNodes.ids,
+      this->addedStaticNodes.aabbs, this->addedStaticNodes.displacements);
+  this->broadphase->AddNodes(this->addedNodes.ids, this->addedNodes.aabbs,
+      this->addedNodes.displacements);
 
-      if (b == math::AxisAlignedBox())
-        continue;
+  // set the bitmasks once the new nodes are in the broadphase
+  for (std::size_t i = 0u; i < this->entities.size(); ++i)
+  {
+    const auto &update = updates[i];
+    if (!update.bitmaskDirty)
+      continue;
+    Broadphase &tree = update.isStatic ?
+        static_cast<Broadphase &>(this->staticTree) : *this->broadphase;
+    if (tree.HasNode(this->entityIds[i]))
+      tree.SetCollideBitmask(this->entityIds[i], update.collideBitmask);
+  }
+}
 
-      // convert to world aabb
-      math::AxisAlignedBox aabb;
-      math::Pose3d p = e->GetPose();
-      aabb = transformAxisAlignedBox(b, p);
-      this->dataPtr->aabbTree.UpdateNode(e->GetId(), aabb);
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::RemoveMissingNodes(std::set<std::size_t> &_ids,
+    Broadphase &_broadphase)
+{
+  // the node ids and the entities are both sorted by id so they are
+  // walked together
+  auto e = this->entityIds.begin();
+  for (auto it = _ids.begin(); it != _ids.end();)
+  {
+    while (e != this->entityIds.end() && *e < *it)
+      ++e;
+    if (e != this->entityIds.end() && *e == *it)
+    {
+      ++it;
+      continue;
     }
+    _broadphase.RemoveNode(*it);
+    it = _ids.erase(it);
   }
+}
 
-  // query AABB tree for collisions
-  for (auto it = _entities.begin(); it != _entities.end(); ++it)
+//////////////////////////////////////////////////
+math::AxisAlignedBox CollisionDetectorPrivate::NodeAABB(
+    std::size_t _index) const
+{
+  if (this->entities[_index]->GetStatic())
+    return this->staticTree.AABB(this->entityIds[_index]);
+  return this->broadphase->AABB(this->entityIds[_index]);
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox CollisionDetectorPrivate::EndAABB(
+    std::size_t _index) const
+{
+  if (this->updates[_index].swept)
+    return this->updates[_index].aabb;
+  return this->NodeAABB(_index);
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox CollisionDetectorPrivate::StartAABB(
+    std::size_t _index) const
+{
+  if (this->updates[_index].swept)
+    return this->updates[_index].startAabb;
+  return this->NodeAABB(_index);
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::SweptContact(std::size_t _index1,
+    std::size_t _index2, Contact &_contact) const
+{
+  math::AxisAlignedBox start1 = this->StartAABB(_index1);
+  math::AxisAlignedBox end1 = this->EndAABB(_index1);
+  math::AxisAlignedBox start2 = this->StartAABB(_index2);
+  math::AxisAlignedBox end2 = this->EndAABB(_index2);
+  double time;
+  math::Vector3d normal;
+  if (!timeOfImpact(start1, end1, start2, end2, time, normal))
+    return false;
+
+  // the contact point is the center of the overlap of the AABBs at the
+  // time of impact
+  auto lerp = [time](double _start, double _end)
+  {
+    return _start + (_end - _start) * time;
+  };
+  math::Vector3d min;
+  math::Vector3d max;
+  for (int k = 0; k < 3; ++k)
+  {
+    min[k] = std::max(lerp(start1.Min()[k], end1.Min()[k]),
+        lerp(start2.Min()[k], end2.Min()[k]));
+    max[k] = std::min(lerp(start1.Max()[k], end1.Max()[k]),
+        lerp(start2.Max()[k], end2.Max()[k]));
+  }
+  _contact.point = min + 0.5 * (max - min);
+  _contact.normal = normal;
+  _contact.timeOfImpact = time;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::AddStaticPairs()
+{
+  GZ_PROFILE("tpelib::CollisionDetector::AddStaticPairs");
+  if (this->staticNodeIds.empty())
+    return;
+
+  for (std::size_t id : this->nodeIds)
   {
-    std::shared_ptr<Entity> e = it->second;
-    // Skip if the entity is static
-    if (e->GetStatic())
+    this->staticTree.Query(this->broadphase->FatAABB(id),
+        this->broadphase->CollideBitmask(id), this->staticHits);
+    for (std::size_t staticId : this->staticHits)
+      this->pairs.emplace_back(std::min(id, staticId), std::max(id, staticId));
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t CollisionDetectorPrivate::EntityIndex(std::size_t _id) const
+{
+  auto it = std::lower_bound(this->entityIds.begin(), this->entityIds.end(),
+      _id);
+  if (it == this->entityIds.end() || *it != _id)
+    return this->entityIds.size();
+  return static_cast<std::size_t>(it - this->entityIds.begin());
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CollectPairs()
+{
+  GZ_PROFILE("tpelib::CollisionDetector::CollectPairs");
+  // pairs of dynamic entities come from their broadphase, and pairs of
+  // dynamic and static entities from the static tree. Static entities never
+  // collide with each other. Each pair is reported once so there is no need
+  // to filter out duplicates.
+  this->broadphase->CollisionPairs(this->pairs);
+  this->AddStaticPairs();
+  std::sort(this->pairs.begin(), this->pairs.end());
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::PreparePairs()
+{
+  GZ_PROFILE("tpelib::CollisionDetector::PreparePairs");
+  // the world primitives of the collisions are only computed for the
+  // entities in candidate pairs that are checked. Without the narrow
+  // phase, only the heightmaps are needed, and the oriented boxes of the
+  // other entities when they are checked.
+  this->pairIndices.resize(this->pairs.size());
+  this->needsPrimitives.assign(this->entities.size(), 0);
+  this->needsOrientedBoxes.assign(this->entities.size(), 0);
+  bool anyPrimitives = false;
+  bool anyOrientedBoxes = false;
+  for (std::size_t i = 0u; i < this->pairs.size(); ++i)
+  {
+    const auto &[id1, id2] = this->pairs[i];
+    std::size_t idx1 = this->EntityIndex(id1);
+    std::size_t idx2 = this->EntityIndex(id2);
+    this->pairIndices[i] = {idx1, idx2};
+    if (idx1 >= this->entities.size() || idx2 >= this->entities.size() ||
+        this->Cached(idx1, idx2))
+    {
       continue;
+    }
+    const auto &update1 = this->updates[idx1];
+    const auto &update2 = this->updates[idx2];
+    if (this->narrowPhase)
+    {
+      this->needsPrimitives[idx1] = 1;
+      this->needsPrimitives[idx2] = 1;
+      anyPrimitives = true;
+    }
+    else if (update1.heightmap || update2.heightmap)
+    {
+      this->needsPrimitives[idx1] |= update1.heightmap;
+      this->needsPrimitives[idx2] |= update2.heightmap;
+      anyPrimitives = true;
+    }
+    else if (this->orientedBoxCheck)
+    {
+      this->needsOrientedBoxes[idx1] = 1;
+      this->needsOrientedBoxes[idx2] = 1;
+      anyOrientedBoxes = true;
+    }
+  }
+  if (anyPrimitives)
+    this->ComputePrimitives();
+  if (anyOrientedBoxes)
+    this->ComputeOrientedBoxes();
+}
 
-    math::AxisAlignedBox b = e->GetBoundingBox();
-    if (b == math::AxisAlignedBox())
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::ComputePrimitives()
+{
+  GZ_PROFILE("tpelib::CollisionDetector::ComputePrimitives");
+  // as with the AABBs, each entity is only accessed by one task
+  this->primitives.resize(this->entities.size());
+  auto computePrimitives = [&](unsigned int, std::size_t _begin,
+      std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      this->primitives[i].clear();
+      if (this->needsPrimitives[i])
+      {
+        CollectPrimitives(*this->entities[i], this->entities[i]->GetPose(),
+            this->primitives[i]);
+      }
+    }
+  };
+  parallelFor(this->workerPool.get(), this->threadCount,
+      this->entities.size(), computePrimitives);
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::ComputeOrientedBoxes()
+{
+  GZ_PROFILE("tpelib::CollisionDetector::ComputeOrientedBoxes");
+  this->orientedBoxes.resize(this->entities.size());
+  auto computeOrientedBoxes = [&](unsigned int, std::size_t _begin,
+      std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      if (!this->needsOrientedBoxes[i])
+        continue;
+      OrientedBox &box = this->orientedBoxes[i];
+      math::AxisAlignedBox local = this->entities[i]->GetBoundingBox();
+      box.valid = local != math::AxisAlignedBox();
+      if (!box.valid)
         continue;
+      box.pose = this->entities[i]->GetPose() *
+          math::Pose3d(local.Center(), math::Quaterniond::Identity);
+      box.halfSize = local.Size() * 0.5;
+    }
+  };
+  parallelFor(this->workerPool.get(), this->threadCount,
+      this->entities.size(), computeOrientedBoxes);
+}
 
-    // check collisions
-    auto result = this->dataPtr->aabbTree.Collisions(e->GetId());
-    if (result.empty())
-      continue;
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::OrientedBoxesIntersect(std::size_t _index1,
+    std::size_t _index2) const
+{
+  const OrientedBox &box1 = this->orientedBoxes[_index1];
+  const OrientedBox &box2 = this->orientedBoxes[_index2];
+  if (!box1.valid || !box2.valid)
+    return true;
+  return intersectOrientedBoxes(box1.pose, box1.halfSize, box2.pose,
+      box2.halfSize);
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CheckPair(std::size_t _index1,
+    std::size_t _index2, bool _singleContact,
+    std::vector<Contact> &_contacts) const
+{
+  if (_index1 >= this->entities.size() || _index2 >= this->entities.size())
+    return;
+
+  // Skip if both entities are static. Otherwise make sure the non-static
+  // entity comes first
+  if (this->entities[_index1]->GetStatic())
+  {
+    if (this->entities[_index2]->GetStatic())
+      return;
+    std::swap(_index1, _index2);
+  }
+
+  // collision filtering using collide bitmask
+  if ((this->entities[_index1]->GetCollideBitmask() &
+      this->entities[_index2]->GetCollideBitmask()) == 0)
+  {
+    return;
+  }
+
+  // report the contacts of the previous call for resting entities
+  if (this->Cached(_index1, _index2))
+  {
+    this->AppendCachedContacts(_index1, _index2, _contacts);
+    return;
+  }
 
-    math::AxisAlignedBox wb1 = this->dataPtr->aabbTree.AABB(e->GetId());
+  // models are tested against the heights of the terrain under them
+  // instead of its AABB, which covers everything
+  const bool heightmap = this->updates[_index1].heightmap ||
+      this->updates[_index2].heightmap;
+  std::size_t first = _contacts.size();
+  if (this->narrowPhase)
+    this->CheckPrimitives(_index1, _index2, _singleContact, _contacts);
+  else if (heightmap)
+    this->CheckHeightmap(_index1, _index2, _singleContact, _contacts);
+  else
+    this->CheckAABBs(_index1, _index2, _singleContact, _contacts);
+
+  // with continuous collision detection, the contacts of a pair get the
+  // time at which its AABBs started touching. A pair whose AABBs touched
+  // during the move but not at its end passed through each other, so it
+  // gets a contact at that time. Pairs with a heightmap are skipped since
+  // its AABB covers the whole terrain.
+  if (!this->continuous || heightmap)
+    return;
+  Contact sweptContact;
+  sweptContact.entity1 = this->entityIds[_index1];
+  sweptContact.entity2 = this->entityIds[_index2];
+  if (!this->SweptContact(_index1, _index2, sweptContact))
+    return;
+  for (std::size_t i = first; i < _contacts.size(); ++i)
+    _contacts[i].timeOfImpact = sweptContact.timeOfImpact;
+  if (first == _contacts.size() && sweptContact.timeOfImpact > 0.0 &&
+      !this->EndAABB(_index1).Intersects(this->EndAABB(_index2)))
+  {
+    _contacts.push_back(sweptContact);
+  }
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CheckAABBs(std::size_t _index1,
+    std::size_t _index2, bool _singleContact,
+    std::vector<Contact> &_contacts) const
+{
+  // the actual AABBs are used to check the candidate pairs. The AABBs of
+  // rotated entities are larger than the entities, so the pairs whose
+  // AABBs overlap are optionally also checked with their oriented boxes.
+  // Each thread reuses its own buffer of points.
+  thread_local std::vector<math::Vector3d> points;
+  points.clear();
+  math::AxisAlignedBox wb1 = this->EndAABB(_index1);
+  math::AxisAlignedBox wb2 = this->EndAABB(_index2);
+  if (!wb1.Intersects(wb2) ||
+      (this->orientedBoxCheck &&
+      !this->OrientedBoxesIntersect(_index1, _index2)) ||
+      !IntersectionPoints(wb1, wb2, points, _singleContact))
+  {
+    return;
+  }
 
-    // Get collide bitmask for entity 1
-    uint16_t cb1 = e->GetCollideBitmask();
+  Contact c;
+  // TPE checks collisions in the model level so contacts are associated
+  // with models and not collisions!
+  c.entity1 = this->entityIds[_index1];
+  c.entity2 = this->entityIds[_index2];
+  for (const auto &p : points)
+  {
+    c.point = p;
+    _contacts.push_back(c);
+  }
+}
 
-    // Check intersection
-    for (const auto &nId : result)
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CheckPrimitives(std::size_t _index1,
+    std::size_t _index2, bool _singleContact,
+    std::vector<Contact> &_contacts) const
+{
+  // check each pair of collisions of the two entities, stopping at the
+  // first contact when a single contact is requested
+  PrimitiveContact primitiveContact;
+  std::size_t first = _contacts.size();
+  for (const auto &p1 : this->primitives[_index1])
+  {
+    if (_singleContact && first != _contacts.size())
+      break;
+    for (const auto &p2 : this->primitives[_index2])
     {
-      // skip if we have already checked collision for this pair of nodes
-      if (this->dataPtr->CheckDuplicateCollisionPair(e->GetId(), nId))
+      if ((p1.collideBitmask & p2.collideBitmask) == 0)
         continue;
+      if (!CollidePrimitives(p1, p2, primitiveContact))
+        continue;
+      Contact c;
+      c.entity1 = this->entityIds[_index1];
+      c.entity2 = this->entityIds[_index2];
+      c.collision1 = p1.id;
+      c.collision2 = p2.id;
+      c.point = primitiveContact.point;
+      c.normal = primitiveContact.normal;
+      c.depth = primitiveContact.depth;
+      _contacts.push_back(c);
+      if (_singleContact)
+        break;
+    }
+  }
+}
 
-      // Get collide bitmask for entity 2
-      uint16_t cb2 = _entities.at(nId)->GetCollideBitmask();
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CheckHeightmap(std::size_t _index1,
+    std::size_t _index2, bool _singleContact,
+    std::vector<Contact> &_contacts) const
+{
+  // heightmaps do not collide with each other
+  if (this->updates[_index1].heightmap && this->updates[_index2].heightmap)
+    return;
 
-      // collision filtering using collide bitmask
-      if ((cb1 & cb2) == 0)
-        continue;
+  std::size_t terrainIndex =
+      this->updates[_index1].heightmap ? _index1 : _index2;
+  std::size_t otherIndex = terrainIndex == _index1 ? _index2 : _index1;
+  math::AxisAlignedBox box = this->EndAABB(otherIndex);
+  PrimitiveContact primitiveContact;
+  for (const auto &p : this->primitives[terrainIndex])
+  {
+    if (nullptr == p.heightmap ||
+        !collideHeightmap(*p.heightmap, p.primitive.pose, box,
+        primitiveContact))
+    {
+      continue;
+    }
+    Contact c;
+    c.entity1 = this->entityIds[_index1];
+    c.entity2 = this->entityIds[_index2];
+    c.point = primitiveContact.point;
+    _contacts.push_back(c);
+    if (_singleContact)
+      break;
+  }
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::Resting(std::size_t _index) const
+{
+  // static entities that were just added or moved may touch sleeping
+  // entities that they did not touch in the previous call
+  return this->sleeping[_index] || (this->entities[_index]->GetStatic() &&
+      this->updates[_index].type == NodeUpdate::Type::NONE);
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::Cached(std::size_t _index1,
+    std::size_t _index2) const
+{
+  return this->useCache &&
+      (this->sleeping[_index1] || this->sleeping[_index2]) &&
+      this->Resting(_index1) && this->Resting(_index2);
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::AppendCachedContacts(std::size_t _index1,
+    std::size_t _index2, std::vector<Contact> &_contacts) const
+{
+  std::pair<std::size_t, std::size_t> pair(
+      std::min(this->entityIds[_index1], this->entityIds[_index2]),
+      std::max(this->entityIds[_index1], this->entityIds[_index2]));
+  auto range = std::equal_range(this->cachedPairs.begin(),
+      this->cachedPairs.end(), pair);
+  auto first = this->cachedContacts.begin() +
+      (range.first - this->cachedPairs.begin());
+  auto last = this->cachedContacts.begin() +
+      (range.second - this->cachedPairs.begin());
+  _contacts.insert(_contacts.end(), first, last);
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::WakeTouchedEntities(
+    const std::vector<Contact> &_contacts)
+{
+  if (this->sleepingCount == 0u)
+    return;
 
-      std::vector<math::Vector3d> points;
-      math::AxisAlignedBox wb2 = this->dataPtr->aabbTree.AABB(nId);
-      if (this->GetIntersectionPoints(wb1, wb2, points, _singleContact))
+  // only entities whose pose changed in this step, and static entities
+  // that were added or moved, wake up the sleeping ones, so that two
+  // resting entities in contact can both fall asleep
+  auto moved = [this](std::size_t _index)
+  {
+    return !this->Resting(_index) && (this->entities[_index]->GetStatic() ||
+        this->entities[_index]->GetIdleSteps() == 0u);
+  };
+  for (const auto &c : _contacts)
+  {
+    std::size_t idx1 = this->EntityIndex(c.entity1);
+    std::size_t idx2 = this->EntityIndex(c.entity2);
+    if (idx1 >= this->entities.size() || idx2 >= this->entities.size())
+      continue;
+    if (this->sleeping[idx1] && moved(idx2))
+      this->entities[idx1]->Wake();
+    else if (this->sleeping[idx2] && moved(idx1))
+      this->entities[idx2]->Wake();
+  }
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::CacheContacts(
+    const std::vector<Contact> &_contacts, bool _singleContact)
+{
+  // the cache is only read when entities can fall asleep
+  this->cacheValid = this->sleepSteps > 0u;
+  this->cachedSingleContact = _singleContact;
+  this->cachedContacts.clear();
+  this->cachedPairs.clear();
+  if (!this->cacheValid)
+    return;
+
+  this->cachedContacts = _contacts;
+  for (const auto &c : _contacts)
+  {
+    this->cachedPairs.emplace_back(std::min(c.entity1, c.entity2),
+        std::max(c.entity1, c.entity2));
+  }
+}
+
+//////////////////////////////////////////////////
+void CollisionDetectorPrivate::UpdateContactPairs(
+    const std::vector<Contact> &_contacts)
+{
+  GZ_PROFILE("tpelib::CollisionDetector::UpdateContactPairs");
+  std::swap(this->prevContactPairs, this->contactPairs);
+  this->contactPairs.clear();
+  for (const auto &c : _contacts)
+  {
+    ContactPair p;
+    if (c.entity1 < c.entity2)
+    {
+      p.entity1 = c.entity1;
+      p.entity2 = c.entity2;
+      p.collision1 = c.collision1;
+      p.collision2 = c.collision2;
+    }
+    else
+    {
+      p.entity1 = c.entity2;
+      p.entity2 = c.entity1;
+      p.collision1 = c.collision2;
+      p.collision2 = c.collision1;
+    }
+    // contacts of the same pair are next to each other
+    if (this->contactPairs.empty() || !(this->contactPairs.back() == p))
+      this->contactPairs.push_back(p);
+  }
+  std::sort(this->contactPairs.begin(), this->contactPairs.end());
+  this->contactPairs.erase(
+      std::unique(this->contactPairs.begin(), this->contactPairs.end()),
+      this->contactPairs.end());
+
+  this->addedContactPairs.clear();
+  std::set_difference(this->contactPairs.begin(), this->contactPairs.end(),
+      this->prevContactPairs.begin(), this->prevContactPairs.end(),
+      std::back_inserter(this->addedContactPairs));
+  this->removedContactPairs.clear();
+  std::set_difference(
+      this->prevContactPairs.begin(), this->prevContactPairs.end(),
+      this->contactPairs.begin(), this->contactPairs.end(),
+      std::back_inserter(this->removedContactPairs));
+}
+
+//////////////////////////////////////////////////
+bool ContactPair::operator==(const ContactPair &_other) const
+{
+  return this->entity1 == _other.entity1 &&
+      this->entity2 == _other.entity2 &&
+      this->collision1 == _other.collision1 &&
+      this->collision2 == _other.collision2;
+}
+
+//////////////////////////////////////////////////
+bool ContactPair::operator<(const ContactPair &_other) const
+{
+  return std::tie(this->entity1, this->entity2, this->collision1,
+      this->collision2) < std::tie(_other.entity1, _other.entity2,
+      _other.collision1, _other.collision2);
+}
+
+//////////////////////////////////////////////////
+CollisionDetector::CollisionDetector()
+  : dataPtr(new CollisionDetectorPrivate)
+{
+  this->dataPtr->broadphase =
+      CollisionDetectorPrivate::CreateBroadphase(this->dataPtr->broadphaseType);
+}
+
+//////////////////////////////////////////////////
+CollisionDetector::~CollisionDetector() = default;
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetBroadphaseType(BroadphaseType _type)
+{
+  if (_type == this->dataPtr->broadphaseType)
+    return;
+
+  double margin = this->dataPtr->broadphase->Margin();
+  this->dataPtr->broadphase = CollisionDetectorPrivate::CreateBroadphase(_type);
+  this->dataPtr->broadphase->SetMargin(margin);
+  this->dataPtr->broadphaseType = _type;
+  this->dataPtr->nodeIds.clear();
+
+  // the new broadphase starts empty, so the swept nodes and the cached
+  // contacts of the old one do not apply to it
+  this->dataPtr->sweptNodes.clear();
+  this->dataPtr->cacheValid = false;
+}
+
+//////////////////////////////////////////////////
+BroadphaseType CollisionDetector::GetBroadphaseType() const
+{
+  return this->dataPtr->broadphaseType;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetMargin(double _margin)
+{
+  this->dataPtr->broadphase->SetMargin(_margin);
+}
+
+//////////////////////////////////////////////////
+double CollisionDetector::GetMargin() const
+{
+  return this->dataPtr->broadphase->Margin();
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetPredictionTime(double _time)
+{
+  this->dataPtr->predictionTime = std::max(0.0, _time);
+}
+
+//////////////////////////////////////////////////
+double CollisionDetector::GetPredictionTime() const
+{
+  return this->dataPtr->predictionTime;
+}
+
+//////////////////////////////////////////////////
+std::size_t CollisionDetector::GetBroadphaseReinsertCount() const
+{
+  return this->dataPtr->broadphase->ReinsertCount();
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetWorkerPool(std::shared_ptr<common::WorkerPool> _pool,
+    unsigned int _threadCount)
+{
+  this->dataPtr->workerPool = std::move(_pool);
+  this->dataPtr->threadCount = std::max(1u, _threadCount);
+}
+
+//////////////////////////////////////////////////
+const std::vector<ContactPair> &CollisionDetector::GetContactPairs() const
+{
+  return this->dataPtr->contactPairs;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ContactPair> &
+CollisionDetector::GetAddedContactPairs() const
+{
+  return this->dataPtr->addedContactPairs;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ContactPair> &
+CollisionDetector::GetRemovedContactPairs() const
+{
+  return this->dataPtr->removedContactPairs;
+}
+
+//////////////////////////////////////////////////
+std::size_t CollisionDetector::GetPersistingContactPairCount() const
+{
+  return this->dataPtr->contactPairs.size() -
+      this->dataPtr->addedContactPairs.size();
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetNarrowPhaseEnabled(bool _enabled)
+{
+  // the cached contacts depend on the phase used to compute them
+  if (_enabled != this->dataPtr->narrowPhase)
+    this->dataPtr->cacheValid = false;
+  this->dataPtr->narrowPhase = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetector::GetNarrowPhaseEnabled() const
+{
+  return this->dataPtr->narrowPhase;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetContinuousCollisionEnabled(bool _enabled)
+{
+  // the cached contacts depend on the swept AABBs used to compute them
+  if (_enabled != this->dataPtr->continuous)
+    this->dataPtr->cacheValid = false;
+  this->dataPtr->continuous = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetector::GetContinuousCollisionEnabled() const
+{
+  return this->dataPtr->continuous;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetOrientedBoxesEnabled(bool _enabled)
+{
+  // the cached contacts depend on the boxes used to compute them
+  if (_enabled != this->dataPtr->orientedBoxCheck)
+    this->dataPtr->cacheValid = false;
+  this->dataPtr->orientedBoxCheck = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetector::GetOrientedBoxesEnabled() const
+{
+  return this->dataPtr->orientedBoxCheck;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::SetSleepSteps(unsigned int _steps)
+{
+  this->dataPtr->sleepSteps = _steps;
+}
+
+//////////////////////////////////////////////////
+unsigned int CollisionDetector::GetSleepSteps() const
+{
+  return this->dataPtr->sleepSteps;
+}
+
+//////////////////////////////////////////////////
+std::size_t CollisionDetector::GetSleepingEntityCount() const
+{
+  return this->dataPtr->sleepingCount;
+}
+
+//////////////////////////////////////////////////
+std::vector<Contact> CollisionDetector::CheckCollisions(
+    const std::map<std::size_t, std::shared_ptr<Entity>> &_entities,
+    bool _singleContact)
+{
+  GZ_PROFILE("tpelib::CollisionDetector::CheckCollisions");
+
+  // contacts to be filled and returned
+  std::vector<Contact> contacts;
+
+  // update broadphase
+  this->dataPtr->UpdateBroadphase(_entities);
+
+  // query the broadphase and the static tree for all pairs with
+  // overlapping enlarged AABBs
+  this->dataPtr->CollectPairs();
+
+  // pairs of resting entities, with at least one of them asleep, report
+  // their contacts from the previous call since they did not move
+  this->dataPtr->useCache = this->dataPtr->cacheValid &&
+      this->dataPtr->cachedSingleContact == _singleContact;
+
+  // find the entities of the candidate pairs and compute what their checks
+  // need
+  this->dataPtr->PreparePairs();
+
+  // check the candidate pairs. The broadphase is not modified anymore so
+  // it can be read concurrently. Each task checks a contiguous range of
+  // pairs and the contacts are gathered in task order, so they do not
+  // depend on the number of threads.
+  auto &taskContacts = this->dataPtr->taskContacts;
+  taskContacts.resize(this->dataPtr->threadCount);
+  for (auto &c : taskContacts)
+    c.clear();
+
+  auto checkPairs = [&](unsigned int _task, std::size_t _begin,
+      std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      const auto &[idx1, idx2] = this->dataPtr->pairIndices[i];
+      this->dataPtr->CheckPair(idx1, idx2, _singleContact,
+          taskContacts[_task]);
+    }
+  };
+  parallelFor(this->dataPtr->workerPool.get(), this->dataPtr->threadCount,
+      this->dataPtr->pairs.size(), checkPairs);
+
+  for (const auto &c : taskContacts)
+    contacts.insert(contacts.end(), c.begin(), c.end());
+
+  this->dataPtr->UpdateContactPairs(contacts);
+  this->dataPtr->WakeTouchedEntities(contacts);
+  this->dataPtr->CacheContacts(contacts, _singleContact);
+
+  return contacts;
+}
+
+//////////////////////////////////////////////////
+void CollisionDetector::CastRays(
+    const std::map<std::size_t, std::shared_ptr<Entity>> &_entities,
+    const std::vector<Ray> &_rays, std::vector<RayHit> &_hits) const
+{
+  GZ_PROFILE("tpelib::CollisionDetector::CastRays");
+  _hits.assign(_rays.size(), RayHit());
+  if (_rays.empty())
+    return;
+
+  // the broadphase is only read, and the primitives are computed in local
+  // buffers, so that casting rays does not change the next collision check.
+  // The entities are placed at the poses they had when the broadphase was
+  // last updated, as their nodes are. The primitives of an entity are only
+  // computed once a ray hits its node, by the first task that gets there.
+  using CollisionPrimitive = CollisionDetectorPrivate::CollisionPrimitive;
+  const auto &entityIds = this->dataPtr->entityIds;
+  const auto &poses = this->dataPtr->poses;
+  std::vector<std::vector<CollisionPrimitive>> primitives(entityIds.size());
+  std::unique_ptr<std::once_flag[]> collected(
+      new std::once_flag[entityIds.size()]);
+  auto entityPrimitives = [&](std::size_t _idx)
+      -> const std::vector<CollisionPrimitive> &
+  {
+    std::call_once(collected[_idx], [&]
+    {
+      // entities removed since the broadphase was updated are skipped
+      auto it = _entities.find(entityIds[_idx]);
+      if (it != _entities.end())
       {
-        Contact c;
-        // TPE checks collisions in the model level so contacts are associated
-        // with models and not collisions!
-        c.entity1 = e->GetId();
-        c.entity2 = nId;
-        for (const auto &p : points)
+        CollisionDetectorPrivate::CollectPrimitives(*it->second,
+            poses[_idx], primitives[_idx]);
+      }
+    });
+    return primitives[_idx];
+  };
+
+  // cast the packets of rays. The broadphase and the primitives are only
+  // read, and each ray writes its own hit.
+  const unsigned int packetSize = RayPacket::kMaxSize;
+  std::size_t packetCount = (_rays.size() + packetSize - 1) / packetSize;
+  auto castPackets = [&](unsigned int, std::size_t _begin, std::size_t _end)
+  {
+    RayPacket packet;
+    std::array<math::Vector3d, RayPacket::kMaxSize> directions;
+    std::size_t first = 0u;
+
+    auto visit = [&](std::size_t _id, unsigned int _ray)
+    {
+      std::size_t idx = this->dataPtr->EntityIndex(_id);
+      if (idx == entityIds.size())
+        return;
+
+      const Ray &ray = _rays[first + _ray];
+      RayHit &hit = _hits[first + _ray];
+      for (const auto &p : entityPrimitives(idx))
+      {
+        // rays are only cast against convex shapes
+        if (nullptr != p.heightmap)
+          continue;
+        double distance;
+        math::Vector3d normal;
+        if (!rayIntersectPrimitive(p.primitive, ray.origin,
+            directions[_ray], packet.maxDistances[_ray], distance, normal) ||
+            distance >= hit.distance)
         {
-          c.point = p;
-          contacts.push_back(c);
+          continue;
         }
+        // entities beyond the hit are skipped by the broadphase
+        packet.maxDistances[_ray] = distance;
+        hit.entity = _id;
+        hit.collision = p.id;
+        hit.distance = distance;
+        hit.point = ray.origin + directions[_ray] * distance;
+        hit.normal = normal;
       }
-    }
-  }
+    };
+    std::function<void(std::size_t, unsigned int)> callback = visit;
 
-  this->dataPtr->collisionStateMap.clear();
-  return contacts;
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      first = i * packetSize;
+      packet.size = static_cast<unsigned int>(
+          std::min<std::size_t>(packetSize, _rays.size() - first));
+      for (unsigned int r = 0u; r < packet.size; ++r)
+      {
+        const Ray &ray = _rays[first + r];
+        directions[r] = ray.direction.Normalized();
+        packet.origins[r] = {ray.origin.X(), ray.origin.Y(), ray.origin.Z()};
+        packet.maxDistances[r] = ray.maxDistance;
+        // rays without a direction do not hit anything
+        if (directions[r] == math::Vector3d::Zero)
+        {
+          packet.invDirections[r] = {0.0, 0.0, 0.0};
+          packet.maxDistances[r] = -1.0;
+          continue;
+        }
+        for (unsigned int k = 0u; k < 3u; ++k)
+          packet.invDirections[r][k] = 1.0 / directions[r][k];
+      }
+      this->dataPtr->broadphase->RayQuery(packet, callback);
+      this->dataPtr->staticTree.RayQuery(packet, callback);
+    }
+  };
+  parallelFor(this->dataPtr->workerPool.get(), this->dataPtr->threadCount,
+      packetCount, castPackets);
 }
 
 //////////////////////////////////////////////////
 bool CollisionDetector::GetIntersectionPoints(const math::AxisAlignedBox &_b1,
     const math::AxisAlignedBox &_b2,
     std::vector<math::Vector3d> &_points, bool _singleContact)
+{
+  return CollisionDetectorPrivate::IntersectionPoints(_b1, _b2, _points,
+      _singleContact);
+}
+
+//////////////////////////////////////////////////
+bool CollisionDetectorPrivate::IntersectionPoints(
+    const math::AxisAlignedBox &_b1, const math::AxisAlignedBox &_b2,
+    std::vector<math::Vector3d> &_points, bool _singleContact)
 {
   GZ_PROFILE("CollisionDetector::GetIntersectionPoints");
   // fast intersection check
@@ -241,33 +1701,3 @@ bool CollisionDetector::GetIntersectionPoints(const math::AxisAlignedBox &_b1,
   }
   return false;
 }
-
-//////////////////////////////////////////////////
-bool CollisionDetectorPrivate::CheckDuplicateCollisionPair(
-    std::size_t _a, std::size_t _b)
-{
-  // use a 2d map to keep track of pairs of collisions
-  // mark the corresponding elements in the 2d map to true to indicate
-  // the check is done
-  bool duplicate = true;
-  auto aIt = this->collisionStateMap.find(_a);
-  if (aIt == this->collisionStateMap.end())
-  {
-    duplicate = false;
-  }
-  else
-  {
-    auto bIt = aIt->second.find(_b);
-    if (bIt == aIt->second.end())
-    {
-      duplicate = false;
-    }
-  }
-
-  if (!duplicate)
-  {
-    this->collisionStateMap[_a][_b] = true;
-    this->collisionStateMap[_b][_a] = true;
-  }
-  return duplicate;
-}
@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include <gz/common/WorkerPool.hh>
 #include <gz/math/Pose3.hh>
 #include <gz/utils/SuppressWarning.hh>
 
@@ -30,7 +31,8 @@
 
 #include "Entity.hh"
 
-#include "AABBTree.hh"
+#include "Broadphase.hh"
+#include "RayCast.hh"
 
 namespace gz {
 namespace physics {
@@ -48,10 +50,63 @@ class GZ_PHYSICS_TPELIB_VISIBLE Contact
   /// \brief Id of second collision entity
   public: std::size_t entity2 = kNullEntityId;
 
+  /// \brief Id of the collision of the first entity in contact. Only set
+  /// when the narrow phase is enabled.
+  public: std::size_t collision1 = kNullEntityId;
+
+  /// \brief Id of the collision of the second entity in contact. Only set
+  /// when the narrow phase is enabled.
+  public: std::size_t collision2 = kNullEntityId;
+
   GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
   /// \brief Point of contact in world frame;
   public: math::Vector3d point;
+
+  /// \brief Unit normal in world frame of the force acting on the first
+  /// entity, i.e. pointing from the second entity to the first one. Only
+  /// set when the narrow phase is enabled, or for the contacts of entities
+  /// that passed through each other found by continuous collision
+  /// detection.
+  public: math::Vector3d normal;
   GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Penetration depth in meters. Only set when the narrow phase is
+  /// enabled.
+  public: double depth = 0.0;
+
+  /// \brief Fraction of the last step, between 0 and 1, at which the AABBs
+  /// of the two entities started touching. Only set when continuous
+  /// collision detection is enabled.
+  public: double timeOfImpact = 1.0;
+};
+
+/// \brief A pair of entities in contact. The entity with the smaller id
+/// comes first.
+class GZ_PHYSICS_TPELIB_VISIBLE ContactPair
+{
+  /// \brief Id of the first entity
+  public: std::size_t entity1 = kNullEntityId;
+
+  /// \brief Id of the second entity
+  public: std::size_t entity2 = kNullEntityId;
+
+  /// \brief Id of the collision of the first entity in contact. Only set
+  /// when the narrow phase is enabled.
+  public: std::size_t collision1 = kNullEntityId;
+
+  /// \brief Id of the collision of the second entity in contact. Only set
+  /// when the narrow phase is enabled.
+  public: std::size_t collision2 = kNullEntityId;
+
+  /// \brief Equality operator
+  /// \param[in] _other Pair to compare with
+  /// \return True if both pairs have the same entities and collisions
+  public: bool operator==(const ContactPair &_other) const;
+
+  /// \brief Less than operator, ordering pairs by entity then collision ids
+  /// \param[in] _other Pair to compare with
+  /// \return True if this pair comes before _other
+  public: bool operator<(const ContactPair &_other) const;
 };
 
 /// \brief Collision Detector that checks collisions between a list of entities
@@ -73,6 +128,161 @@ class GZ_PHYSICS_TPELIB_VISIBLE CollisionDetector
       const std::map<std::size_t, std::shared_ptr<Entity>> &_entities,
       bool _singleContact = false);
 
+  /// \brief Cast a batch of rays against the collisions of a list of
+  /// entities and find the closest hit of each ray. The rays are traversed
+  /// through the broadphase in packets of neighboring rays, and the packets
+  /// are cast in parallel when a worker pool is set. Rays starting inside a
+  /// collision do not hit it. The broadphase built by the last call to
+  /// CheckCollisions is only read, so casting rays does not change the
+  /// next collision check. The entities are hit at the poses they had in
+  /// that call, entities added since then are missed and entities removed
+  /// since then are skipped. The collision shapes of an entity are only
+  /// placed in world frame once a ray hits its broadphase node.
+  /// \param[in] _entities List of entities passed to CheckCollisions
+  /// \param[in] _rays Rays in world frame
+  /// \param[out] _hits Closest hit of each ray, in the order of the rays.
+  /// The vector is resized to the number of rays, so its storage is reused
+  /// when the same vector is passed to every call.
+  public: void CastRays(
+      const std::map<std::size_t, std::shared_ptr<Entity>> &_entities,
+      const std::vector<Ray> &_rays, std::vector<RayHit> &_hits) const;
+
+  /// \brief Get the pairs of entities in contact found by the last call to
+  /// CheckCollisions. The pairs are kept across calls so that the changes
+  /// between two calls can be retrieved without comparing the contacts.
+  /// \return Sorted pairs in contact
+  public: const std::vector<ContactPair> &GetContactPairs() const;
+
+  /// \brief Get the pairs of entities that are in contact in the last call
+  /// to CheckCollisions and were not in the call before it.
+  /// \return Sorted pairs that started being in contact
+  public: const std::vector<ContactPair> &GetAddedContactPairs() const;
+
+  /// \brief Get the pairs of entities that were in contact in the call to
+  /// CheckCollisions before the last one and are not anymore.
+  /// \return Sorted pairs that stopped being in contact
+  public: const std::vector<ContactPair> &GetRemovedContactPairs() const;
+
+  /// \brief Get the number of pairs of entities in contact in the last two
+  /// calls to CheckCollisions.
+  /// \return Number of pairs that stayed in contact
+  public: std::size_t GetPersistingContactPairCount() const;
+
+  /// \brief Set the broadphase algorithm used to find candidate pairs of
+  /// colliding entities. Changing the broadphase discards the current one,
+  /// and all entities are added to the new one on the next call to
+  /// CheckCollisions.
+  /// \param[in] _type Broadphase type. Defaults to BroadphaseType::AABB_TREE
+  public: void SetBroadphaseType(BroadphaseType _type);
+
+  /// \brief Get the broadphase algorithm used to find candidate pairs of
+  /// colliding entities.
+  /// \return Broadphase type
+  public: BroadphaseType GetBroadphaseType() const;
+
+  /// \brief Set the margin added to each side of the entity AABBs stored
+  /// in the broadphase. Larger margins reduce the number of broadphase
+  /// updates for moving entities at the cost of more candidate pairs.
+  /// \param[in] _margin Margin in meters. Defaults to 0.
+  public: void SetMargin(double _margin);
+
+  /// \brief Get the margin added to each side of the entity AABBs stored
+  /// in the broadphase.
+  /// \return Margin in meters
+  public: double GetMargin() const;
+
+  /// \brief Set the time used to predict the motion of models from their
+  /// linear velocity. The AABBs stored in the broadphase are extended by
+  /// the distance a model travels during this time, so models moving at a
+  /// constant velocity do not update the broadphase at every step.
+  /// \param[in] _time Prediction time in seconds. Set to 0 to disable
+  /// velocity based enlargement. Defaults to 0.
+  public: void SetPredictionTime(double _time);
+
+  /// \brief Get the time used to predict the motion of models.
+  /// \return Prediction time in seconds
+  public: double GetPredictionTime() const;
+
+  /// \brief Get the number of times an entity was reinserted into the
+  /// broadphase because it moved outside of its enlarged AABB. The count is
+  /// reset when the broadphase type changes.
+  /// \return Total number of reinsertions
+  public: std::size_t GetBroadphaseReinsertCount() const;
+
+  /// \brief Set the worker pool used to compute the entity AABBs and check
+  /// the candidate pairs from the broadphase in parallel. The broadphase
+  /// itself is updated and queried on the calling thread. The contacts do
+  /// not depend on the number of threads.
+  /// \param[in] _pool Worker pool. Set to null to check collisions on the
+  /// calling thread only.
+  /// \param[in] _threadCount Maximum number of tasks run in parallel.
+  public: void SetWorkerPool(std::shared_ptr<common::WorkerPool> _pool,
+      unsigned int _threadCount);
+
+  /// \brief Enable the narrow phase. When enabled, the candidate pairs of
+  /// models found by the broadphase are checked by testing the shapes of
+  /// their collisions against each other, and one contact is reported for
+  /// each pair of collisions in contact, with its normal and depth. When
+  /// disabled, the contacts are the intersection points of the model AABBs,
+  /// see SetOrientedBoxesEnabled.
+  /// \param[in] _enabled True to enable the narrow phase. Defaults to false.
+  public: void SetNarrowPhaseEnabled(bool _enabled);
+
+  /// \brief Get whether the narrow phase is enabled
+  /// \return True if the narrow phase is enabled
+  public: bool GetNarrowPhaseEnabled() const;
+
+  /// \brief Enable continuous collision detection. When enabled, the AABB
+  /// of a dynamic entity that moved with a non-zero linear velocity is
+  /// stored in the broadphase as the union of its AABBs before and after
+  /// the move, so thin entities it passed through during the move are still
+  /// found. Such pairs are reported as a contact at the time of impact of
+  /// the AABBs, with a zero depth and no collision ids, and the time of
+  /// impact is set on all contacts.
+  /// \param[in] _enabled True to enable continuous collision detection.
+  /// Defaults to false.
+  public: void SetContinuousCollisionEnabled(bool _enabled);
+
+  /// \brief Get whether continuous collision detection is enabled
+  /// \return True if continuous collision detection is enabled
+  public: bool GetContinuousCollisionEnabled() const;
+
+  /// \brief Enable the oriented box check. When enabled and the narrow
+  /// phase is disabled, a candidate pair whose AABBs overlap is only
+  /// reported in contact if the bounding boxes of the models in their own
+  /// frame, placed at their world poses, also overlap. This removes the
+  /// false contacts of rotated models, whose AABBs are larger than them.
+  /// The contact points are still the intersection points of the AABBs.
+  /// \param[in] _enabled True to enable the oriented box check. Defaults to
+  /// false.
+  public: void SetOrientedBoxesEnabled(bool _enabled);
+
+  /// \brief Get whether the oriented box check is enabled
+  /// \return True if the oriented box check is enabled
+  public: bool GetOrientedBoxesEnabled() const;
+
+  /// \brief Set the number of steps after which an entity that keeps the
+  /// same pose falls asleep. The candidate pairs between sleeping and
+  /// static entities are not checked again, their contacts from the
+  /// previous call to CheckCollisions are reported instead. Pairs with a
+  /// moving entity, or with a static entity that was added or moved since
+  /// the previous call, are always checked, and a sleeping entity in
+  /// contact with such an entity is woken up. Entities also wake up when
+  /// their pose, velocity or children change, see Entity::Wake.
+  /// \param[in] _steps Number of steps. Set to 0 to disable sleeping.
+  /// Defaults to 0.
+  public: void SetSleepSteps(unsigned int _steps);
+
+  /// \brief Get the number of steps after which an entity that keeps the
+  /// same pose falls asleep.
+  /// \return Number of steps
+  public: unsigned int GetSleepSteps() const;
+
+  /// \brief Get the number of entities that were asleep in the last call
+  /// to CheckCollisions.
+  /// \return Number of sleeping entities
+  public: std::size_t GetSleepingEntityCount() const;
+
   /// \brief Get a vector of intersection points between two axis aligned boxes
   /// \param[in] _b1 Axis aligned box 1
   /// \param[in] _b2 Axis aligned box 2
@@ -16,6 +16,13 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <tuple>
+
 #include <gz/math/AxisAlignedBox.hh>
 
 #include "Collision.hh"
@@ -23,6 +30,7 @@
 #include "Model.hh"
 #include "Link.hh"
 #include "Shape.hh"
+#include "Utils.hh"
 
 using namespace gz;
 using namespace physics;
@@ -403,3 +411,687 @@ TEST(CollisionDetector, CheckStaticCollisionFiltering)
   std::vector<Contact> contacts = cd.CheckCollisions(entities);
   EXPECT_TRUE(contacts.empty());
 }
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, NarrowPhase)
+{
+  // model A with two boxes next to each other
+  std::shared_ptr<Model> modelA(new Model);
+  Entity &linkAEnt = modelA->AddLink();
+  Link *linkA = static_cast<Link *>(&linkAEnt);
+  BoxShape boxShapeA;
+  boxShapeA.SetSize(gz::math::Vector3d(1, 1, 1));
+  Entity &collisionA1Ent = linkA->AddCollision();
+  Collision *collisionA1 = static_cast<Collision *>(&collisionA1Ent);
+  collisionA1->SetShape(boxShapeA);
+  collisionA1->SetPose(math::Pose3d(-1.5, 0, 0, 0, 0, 0));
+  Entity &collisionA2Ent = linkA->AddCollision();
+  Collision *collisionA2 = static_cast<Collision *>(&collisionA2Ent);
+  collisionA2->SetShape(boxShapeA);
+  collisionA2->SetPose(math::Pose3d(1.5, 0, 0, 0, 0, 0));
+
+  // model B
+  std::shared_ptr<Model> modelB(new Model);
+  Entity &linkBEnt = modelB->AddLink();
+  Link *linkB = static_cast<Link *>(&linkBEnt);
+  Entity &collisionBEnt = linkB->AddCollision();
+  Collision *collisionB = static_cast<Collision *>(&collisionBEnt);
+  SphereShape sphereShapeB;
+  sphereShapeB.SetRadius(0.5);
+  collisionB->SetShape(sphereShapeB);
+
+  CollisionDetector cd;
+  EXPECT_FALSE(cd.GetNarrowPhaseEnabled());
+  std::map<std::size_t, std::shared_ptr<Entity>> entities;
+  entities[modelA->GetId()] = modelA;
+  entities[modelB->GetId()] = modelB;
+
+  // the sphere is in the gap between the two boxes. The model AABBs
+  // intersect but the shapes do not.
+  modelA->SetPose(math::Pose3d(0, 0, 0, 0, 0, 0));
+  modelB->SetPose(math::Pose3d(0, 0, 0, 0, 0, 0));
+  std::vector<Contact> contacts = cd.CheckCollisions(entities, true);
+  ASSERT_EQ(1u, contacts.size());
+  EXPECT_EQ(kNullEntityId, contacts[0].collision1);
+  EXPECT_EQ(kNullEntityId, contacts[0].collision2);
+  EXPECT_DOUBLE_EQ(0.0, contacts[0].depth);
+
+  cd.SetNarrowPhaseEnabled(true);
+  EXPECT_TRUE(cd.GetNarrowPhaseEnabled());
+  contacts = cd.CheckCollisions(entities);
+  EXPECT_TRUE(contacts.empty());
+
+  // the sphere touches the second box
+  modelB->SetPose(math::Pose3d(0.7, 0, 0, 0, 0, 0));
+  contacts = cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, contacts.size());
+  Contact c = contacts[0];
+  EXPECT_NEAR(0.2, c.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(1.1, 0, 0), c.point);
+  if (c.entity1 == modelA->GetId())
+  {
+    EXPECT_EQ(modelB->GetId(), c.entity2);
+    EXPECT_EQ(collisionA2->GetId(), c.collision1);
+    EXPECT_EQ(collisionB->GetId(), c.collision2);
+    EXPECT_EQ(math::Vector3d(1, 0, 0), c.normal);
+  }
+  else
+  {
+    EXPECT_EQ(modelB->GetId(), c.entity1);
+    EXPECT_EQ(modelA->GetId(), c.entity2);
+    EXPECT_EQ(collisionB->GetId(), c.collision1);
+    EXPECT_EQ(collisionA2->GetId(), c.collision2);
+    EXPECT_EQ(math::Vector3d(-1, 0, 0), c.normal);
+  }
+
+  // the non-static model comes first
+  modelA->SetStatic(true);
+  contacts = cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, contacts.size());
+  EXPECT_EQ(modelB->GetId(), contacts[0].entity1);
+  EXPECT_EQ(collisionB->GetId(), contacts[0].collision1);
+  EXPECT_EQ(collisionA2->GetId(), contacts[0].collision2);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), contacts[0].normal);
+
+  // collisions are filtered using their own collide bitmask
+  collisionA1->SetCollideBitmask(0x02);
+  collisionA2->SetCollideBitmask(0x01);
+  collisionB->SetCollideBitmask(0x02);
+  contacts = cd.CheckCollisions(entities);
+  EXPECT_TRUE(contacts.empty());
+
+  // move the sphere to the first box
+  modelB->SetPose(math::Pose3d(-0.7, 0, 0, 0, 0, 0));
+  contacts = cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, contacts.size());
+  EXPECT_EQ(collisionA1->GetId(), contacts[0].collision2);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), contacts[0].normal);
+
+  // a larger sphere touches both boxes, and only one contact is reported
+  // when a single contact is requested
+  collisionA1->SetCollideBitmask(0xFF);
+  collisionA2->SetCollideBitmask(0xFF);
+  collisionB->SetCollideBitmask(0xFF);
+  sphereShapeB.SetRadius(1.2);
+  collisionB->SetShape(sphereShapeB);
+  modelB->SetPose(math::Pose3d(0, 0, 0, 0, 0, 0));
+  contacts = cd.CheckCollisions(entities);
+  EXPECT_EQ(2u, contacts.size());
+  contacts = cd.CheckCollisions(entities, true);
+  ASSERT_EQ(1u, contacts.size());
+  EXPECT_EQ(modelB->GetId(), contacts[0].entity1);
+  EXPECT_NEAR(0.2, contacts[0].depth, 1e-9);
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, DefaultContacts)
+{
+  // randomly rotated dynamic and static boxes. With the default settings,
+  // the contacts must be the intersection points of the world AABBs of
+  // every pair of overlapping models with at least one dynamic model, as
+  // they were before the broadphase was added.
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> pos(0.0, 6.0);
+  std::uniform_real_distribution<double> angle(-GZ_PI, GZ_PI);
+  std::uniform_real_distribution<double> size(0.2, 2.0);
+  std::vector<std::shared_ptr<Model>> models;
+  std::map<std::size_t, std::shared_ptr<Entity>> entities;
+  for (int i = 0; i < 40; ++i)
+  {
+    std::shared_ptr<Model> model(new Model);
+    model->SetStatic(i % 4 == 0);
+    model->SetPose(math::Pose3d(pos(gen), pos(gen), pos(gen),
+        angle(gen), angle(gen), angle(gen)));
+    Link *link = static_cast<Link *>(&model->AddLink());
+    Collision *collision = static_cast<Collision *>(&link->AddCollision());
+    BoxShape box;
+    box.SetSize(math::Vector3d(size(gen), size(gen), size(gen)));
+    collision->SetShape(box);
+    models.push_back(model);
+    entities[model->GetId()] = model;
+  }
+
+  using ContactKey = std::tuple<std::size_t, std::size_t, double, double,
+      double>;
+  auto key = [](std::size_t _id1, std::size_t _id2,
+      const math::Vector3d &_point)
+  {
+    // the points are rounded so that the transforms of the AABBs may
+    // differ by a rounding error
+    auto round = [](double _v) { return std::round(_v * 1e6) * 1e-6; };
+    return ContactKey(std::min(_id1, _id2), std::max(_id1, _id2),
+        round(_point.X()), round(_point.Y()), round(_point.Z()));
+  };
+
+  CollisionDetector reference;
+  for (bool singleContact : {true, false})
+  {
+    std::multiset<ContactKey> expected;
+    for (std::size_t i = 0u; i < models.size(); ++i)
+    {
+      for (std::size_t j = i + 1u; j < models.size(); ++j)
+      {
+        if (models[i]->GetStatic() && models[j]->GetStatic())
+          continue;
+        std::vector<math::Vector3d> points;
+        if (!reference.GetIntersectionPoints(
+            transformAxisAlignedBox(models[i]->GetBoundingBox(),
+            models[i]->GetPose()),
+            transformAxisAlignedBox(models[j]->GetBoundingBox(),
+            models[j]->GetPose()), points, singleContact))
+        {
+          continue;
+        }
+        for (const auto &p : points)
+          expected.insert(key(models[i]->GetId(), models[j]->GetId(), p));
+      }
+    }
+    EXPECT_FALSE(expected.empty());
+
+    for (auto type : {BroadphaseType::AABB_TREE,
+        BroadphaseType::SWEEP_AND_PRUNE, BroadphaseType::SPATIAL_HASH})
+    {
+      CollisionDetector cd;
+      cd.SetBroadphaseType(type);
+      std::multiset<ContactKey> result;
+      for (const auto &c : cd.CheckCollisions(entities, singleContact))
+        result.insert(key(c.entity1, c.entity2, c.point));
+      EXPECT_EQ(expected, result);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, ContactPairs)
+{
+  std::vector<std::shared_ptr<Model>> models;
+  std::vector<Collision *> collisions;
+  std::map<std::size_t, std::shared_ptr<Entity>> entities;
+  SphereShape sphereShape;
+  sphereShape.SetRadius(1);
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    std::shared_ptr<Model> model(new Model);
+    Entity &linkEnt = model->AddLink();
+    Link *link = static_cast<Link *>(&linkEnt);
+    Entity &collisionEnt = link->AddCollision();
+    Collision *collision = static_cast<Collision *>(&collisionEnt);
+    collision->SetShape(sphereShape);
+    entities[model->GetId()] = model;
+    models.push_back(model);
+    collisions.push_back(collision);
+  }
+  std::size_t idA = models[0]->GetId();
+  std::size_t idB = models[1]->GetId();
+  std::size_t idC = models[2]->GetId();
+
+  CollisionDetector cd;
+  EXPECT_TRUE(cd.GetContactPairs().empty());
+
+  // A and B in contact
+  models[0]->SetPose(math::Pose3d(0, 0, 0, 0, 0, 0));
+  models[1]->SetPose(math::Pose3d(1.5, 0, 0, 0, 0, 0));
+  models[2]->SetPose(math::Pose3d(100, 0, 0, 0, 0, 0));
+  cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, cd.GetContactPairs().size());
+  EXPECT_EQ(idA, cd.GetContactPairs()[0].entity1);
+  EXPECT_EQ(idB, cd.GetContactPairs()[0].entity2);
+  EXPECT_EQ(kNullEntityId, cd.GetContactPairs()[0].collision1);
+  ASSERT_EQ(1u, cd.GetAddedContactPairs().size());
+  EXPECT_EQ(cd.GetContactPairs()[0], cd.GetAddedContactPairs()[0]);
+  EXPECT_TRUE(cd.GetRemovedContactPairs().empty());
+  EXPECT_EQ(0u, cd.GetPersistingContactPairCount());
+
+  // the pair persists
+  models[1]->SetPose(math::Pose3d(1.4, 0, 0, 0, 0, 0));
+  cd.CheckCollisions(entities);
+  EXPECT_EQ(1u, cd.GetContactPairs().size());
+  EXPECT_TRUE(cd.GetAddedContactPairs().empty());
+  EXPECT_TRUE(cd.GetRemovedContactPairs().empty());
+  EXPECT_EQ(1u, cd.GetPersistingContactPairCount());
+
+  // A moves away and C touches B
+  models[0]->SetPose(math::Pose3d(-100, 0, 0, 0, 0, 0));
+  models[2]->SetPose(math::Pose3d(2.8, 0, 0, 0, 0, 0));
+  cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, cd.GetAddedContactPairs().size());
+  EXPECT_EQ(idB, cd.GetAddedContactPairs()[0].entity1);
+  EXPECT_EQ(idC, cd.GetAddedContactPairs()[0].entity2);
+  ASSERT_EQ(1u, cd.GetRemovedContactPairs().size());
+  EXPECT_EQ(idA, cd.GetRemovedContactPairs()[0].entity1);
+  EXPECT_EQ(idB, cd.GetRemovedContactPairs()[0].entity2);
+  EXPECT_EQ(0u, cd.GetPersistingContactPairCount());
+
+  // pairs are reported on collisions with the narrow phase
+  cd.SetNarrowPhaseEnabled(true);
+  cd.CheckCollisions(entities);
+  ASSERT_EQ(1u, cd.GetContactPairs().size());
+  EXPECT_EQ(collisions[1]->GetId(), cd.GetContactPairs()[0].collision1);
+  EXPECT_EQ(collisions[2]->GetId(), cd.GetContactPairs()[0].collision2);
+  EXPECT_EQ(1u, cd.GetAddedContactPairs().size());
+  EXPECT_EQ(1u, cd.GetRemovedContactPairs().size());
+
+  // removing an entity removes its pairs
+  entities.erase(idC);
+  cd.CheckCollisions(entities);
+  EXPECT_TRUE(cd.GetContactPairs().empty());
+  EXPECT_TRUE(cd.GetAddedContactPairs().empty());
+  ASSERT_EQ(1u, cd.GetRemovedContactPairs().size());
+  EXPECT_EQ(idC, cd.GetRemovedContactPairs()[0].entity2);
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, RemovedCollisions)
+{
+  // a dynamic and a static model overlapping a third model
+  auto makeSphereModel = [](const math::Pose3d &_pose, bool _static)
+  {
+    std::shared_ptr<Model> model(new Model);
+    model->SetStatic(_static);
+    model->SetPose(_pose);
+    Link *link = static_cast<Link *>(&model->AddLink());
+    Collision *collision = static_cast<Collision *>(&link->AddCollision());
+    SphereShape sphere;
+    sphere.SetRadius(1);
+    collision->SetShape(sphere);
+    return model;
+  };
+
+  for (auto type : {BroadphaseType::AABB_TREE,
+      BroadphaseType::SWEEP_AND_PRUNE, BroadphaseType::SPATIAL_HASH,
+      BroadphaseType::AABB_TREE_FLOAT})
+  {
+    auto modelA = makeSphereModel(math::Pose3d(0, 0, 0, 0, 0, 0), false);
+    auto modelB = makeSphereModel(math::Pose3d(1.5, 0, 0, 0, 0, 0), false);
+    auto modelC = makeSphereModel(math::Pose3d(-1.5, 0, 0, 0, 0, 0), true);
+    std::map<std::size_t, std::shared_ptr<Entity>> entities;
+    for (const auto &model : {modelA, modelB, modelC})
+      entities[model->GetId()] = model;
+
+    CollisionDetector cd;
+    cd.SetBroadphaseType(type);
+    EXPECT_EQ(2u, cd.CheckCollisions(entities, true).size());
+
+    std::vector<Ray> rays(2);
+    rays[0].origin = math::Vector3d(10, 0, 0);
+    rays[0].direction = math::Vector3d(-1, 0, 0);
+    rays[1].origin = math::Vector3d(-10, 0, 0);
+    rays[1].direction = math::Vector3d(1, 0, 0);
+    std::vector<RayHit> hits;
+    cd.CastRays(entities, rays, hits);
+    EXPECT_EQ(modelB->GetId(), hits[0].entity);
+    EXPECT_EQ(modelC->GetId(), hits[1].entity);
+
+    // models whose collisions are all removed lose their broadphase node,
+    // even at rest, so they are neither in contact nor hit by rays
+    for (const auto &model : {modelB, modelC})
+    {
+      model->ResetPoseDirty();
+      Entity &link = *model->GetChildren().begin()->second;
+      EXPECT_TRUE(link.RemoveChildById(
+          link.GetChildren().begin()->first));
+    }
+    EXPECT_TRUE(cd.CheckCollisions(entities, true).empty());
+    cd.CastRays(entities, rays, hits);
+    EXPECT_EQ(modelA->GetId(), hits[0].entity);
+    EXPECT_EQ(modelA->GetId(), hits[1].entity);
+
+    // collisions added back to models that did not move get a new node
+    SphereShape sphere;
+    sphere.SetRadius(1);
+    for (const auto &model : {modelB, modelC})
+    {
+      Link *link = static_cast<Link *>(
+          model->GetChildren().begin()->second.get());
+      Collision *collision = static_cast<Collision *>(&link->AddCollision());
+      collision->SetShape(sphere);
+      collision->SetPose(math::Pose3d(0, 0, 5, 0, 0, 0));
+    }
+    EXPECT_TRUE(cd.CheckCollisions(entities, true).empty());
+    rays[0].origin = math::Vector3d(1.5, -10, 5);
+    rays[0].direction = math::Vector3d(0, 1, 0);
+    rays[1].origin = math::Vector3d(-1.5, -10, 5);
+    rays[1].direction = math::Vector3d(0, 1, 0);
+    cd.CastRays(entities, rays, hits);
+    EXPECT_EQ(modelB->GetId(), hits[0].entity);
+    EXPECT_EQ(modelC->GetId(), hits[1].entity);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, CastRays)
+{
+  // model A with two boxes on each side of the origin
+  std::shared_ptr<Model> modelA(new Model);
+  Entity &linkAEnt = modelA->AddLink();
+  Link *linkA = static_cast<Link *>(&linkAEnt);
+  BoxShape boxShapeA;
+  boxShapeA.SetSize(gz::math::Vector3d(1, 1, 1));
+  Entity &collisionA1Ent = linkA->AddCollision();
+  Collision *collisionA1 = static_cast<Collision *>(&collisionA1Ent);
+  collisionA1->SetShape(boxShapeA);
+  collisionA1->SetPose(math::Pose3d(-2, 0, 0, 0, 0, 0));
+  Entity &collisionA2Ent = linkA->AddCollision();
+  Collision *collisionA2 = static_cast<Collision *>(&collisionA2Ent);
+  collisionA2->SetShape(boxShapeA);
+  collisionA2->SetPose(math::Pose3d(2, 0, 0, 0, 0, 0));
+
+  // model B with a sphere in front of the second box
+  std::shared_ptr<Model> modelB(new Model);
+  Entity &linkBEnt = modelB->AddLink();
+  Link *linkB = static_cast<Link *>(&linkBEnt);
+  Entity &collisionBEnt = linkB->AddCollision();
+  Collision *collisionB = static_cast<Collision *>(&collisionBEnt);
+  SphereShape sphereShapeB;
+  sphereShapeB.SetRadius(0.5);
+  collisionB->SetShape(sphereShapeB);
+  modelB->SetPose(math::Pose3d(1, 0, 5, 0, 0, 0));
+
+  std::map<std::size_t, std::shared_ptr<Entity>> entities;
+  entities[modelA->GetId()] = modelA;
+  entities[modelB->GetId()] = modelB;
+
+  std::vector<Ray> rays(3);
+  rays[0].origin = math::Vector3d(0, 0, 0);
+  rays[0].direction = math::Vector3d(2, 0, 0);
+  rays[1].origin = math::Vector3d(0, 0, 0);
+  rays[1].direction = math::Vector3d(-1, 0, 0);
+  rays[1].maxDistance = 1.0;
+  rays[2].origin = math::Vector3d(0, 0, 0);
+  rays[2].direction = math::Vector3d::Zero;
+
+  for (auto type : {BroadphaseType::AABB_TREE,
+      BroadphaseType::SWEEP_AND_PRUNE, BroadphaseType::SPATIAL_HASH,
+      BroadphaseType::AABB_TREE_FLOAT})
+  {
+    CollisionDetector cd;
+    cd.SetBroadphaseType(type);
+    std::vector<RayHit> hits;
+
+    // rays are cast against the broadphase of the last collision check
+    cd.CheckCollisions(entities);
+    cd.CastRays(entities, rays, hits);
+    ASSERT_EQ(3u, hits.size());
+    EXPECT_EQ(modelA->GetId(), hits[0].entity);
+    EXPECT_EQ(collisionA2->GetId(), hits[0].collision);
+    EXPECT_NEAR(1.5, hits[0].distance, 1e-9);
+    EXPECT_EQ(math::Vector3d(1.5, 0, 0), hits[0].point);
+    EXPECT_EQ(math::Vector3d(-1, 0, 0), hits[0].normal);
+
+    // the first box is beyond the maximum distance
+    EXPECT_EQ(kNullEntityId, hits[1].entity);
+    EXPECT_EQ(kNullEntityId, hits[1].collision);
+    EXPECT_EQ(kNullEntityId, hits[2].entity);
+
+    // move the sphere in front of the box and extend the second ray
+    modelB->SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+    rays[1].maxDistance = 10.0;
+    cd.CheckCollisions(entities);
+    cd.CastRays(entities, rays, hits);
+    ASSERT_EQ(3u, hits.size());
+    EXPECT_EQ(modelB->GetId(), hits[0].entity);
+    EXPECT_EQ(collisionB->GetId(), hits[0].collision);
+    EXPECT_NEAR(0.5, hits[0].distance, 1e-9);
+    EXPECT_EQ(modelA->GetId(), hits[1].entity);
+    EXPECT_EQ(collisionA1->GetId(), hits[1].collision);
+    EXPECT_NEAR(1.5, hits[1].distance, 1e-9);
+    EXPECT_EQ(math::Vector3d(1, 0, 0), hits[1].normal);
+
+    // casting rays does not update the broadphase for the moved sphere,
+    // the next collision check does. Until then the sphere is hit where
+    // the last check left it.
+    std::size_t reinsertCount = cd.GetBroadphaseReinsertCount();
+    modelB->SetPose(math::Pose3d(1, 0, 5, 0, 0, 0));
+    rays[1].maxDistance = 1.0;
+    cd.CastRays(entities, rays, hits);
+    EXPECT_EQ(reinsertCount, cd.GetBroadphaseReinsertCount());
+    EXPECT_EQ(collisionB->GetId(), hits[0].collision);
+    EXPECT_NEAR(0.5, hits[0].distance, 1e-9);
+    cd.CheckCollisions(entities);
+    cd.CastRays(entities, rays, hits);
+    EXPECT_EQ(collisionA2->GetId(), hits[0].collision);
+
+    // removed entities are not hit even before the next collision check
+    auto removed = entities;
+    removed.erase(modelA->GetId());
+    cd.CastRays(removed, rays, hits);
+    EXPECT_EQ(kNullEntityId, hits[0].entity);
+  }
+
+  // many rays in parallel
+  auto pool = std::make_shared<common::WorkerPool>(4u);
+  CollisionDetector cd;
+  cd.SetWorkerPool(pool, 4u);
+  std::vector<Ray> fan(100);
+  for (std::size_t i = 0u; i < fan.size(); ++i)
+  {
+    double angle = 2.0 * GZ_PI * static_cast<double>(i) / fan.size();
+    fan[i].direction = math::Vector3d(std::cos(angle), std::sin(angle), 0);
+  }
+  std::vector<RayHit> hits;
+  cd.CheckCollisions(entities);
+  cd.CastRays(entities, fan, hits);
+  ASSERT_EQ(fan.size(), hits.size());
+  EXPECT_EQ(collisionA2->GetId(), hits[0].collision);
+  EXPECT_NEAR(1.5, hits[0].distance, 1e-9);
+  EXPECT_EQ(collisionA1->GetId(), hits[50].collision);
+  EXPECT_NEAR(1.5, hits[50].distance, 1e-9);
+  EXPECT_EQ(kNullEntityId, hits[25].entity);
+  EXPECT_EQ(kNullEntityId, hits[75].entity);
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, StaticEntities)
+{
+  // a row of static walls touching each other
+  auto makeBoxModel = [](const math::Pose3d &_pose, bool _static)
+  {
+    std::shared_ptr<Model> model(new Model);
+    model->SetStatic(_static);
+    model->SetPose(_pose);
+    Link *link = static_cast<Link *>(&model->AddLink());
+    Collision *collision = static_cast<Collision *>(&link->AddCollision());
+    BoxShape box;
+    box.SetSize(math::Vector3d(1, 1, 1));
+    collision->SetShape(box);
+    return model;
+  };
+
+  for (auto type : {BroadphaseType::AABB_TREE,
+      BroadphaseType::SWEEP_AND_PRUNE, BroadphaseType::SPATIAL_HASH,
+      BroadphaseType::AABB_TREE_FLOAT})
+  {
+    std::map<std::size_t, std::shared_ptr<Entity>> entities;
+    std::vector<std::shared_ptr<Model>> walls;
+    for (int i = 0; i < 10; ++i)
+    {
+      walls.push_back(makeBoxModel(math::Pose3d(i * 0.9, 0, 0, 0, 0, 0),
+          true));
+      entities[walls.back()->GetId()] = walls.back();
+    }
+
+    // a dynamic box touching the first wall
+    std::shared_ptr<Model> box =
+        makeBoxModel(math::Pose3d(-0.5, 0.9, 0, 0, 0, 0), false);
+    entities[box->GetId()] = box;
+
+    CollisionDetector cd;
+    cd.SetBroadphaseType(type);
+    cd.SetMargin(0.05);
+
+    // static walls do not collide with each other
+    std::vector<Contact> contacts = cd.CheckCollisions(entities, true);
+    ASSERT_EQ(1u, contacts.size());
+    EXPECT_EQ(box->GetId(), contacts[0].entity1);
+    EXPECT_EQ(walls[0]->GetId(), contacts[0].entity2);
+
+    // move the box along the walls
+    box->SetPose(math::Pose3d(4.05, 0.9, 0, 0, 0, 0));
+    contacts = cd.CheckCollisions(entities, true);
+    ASSERT_EQ(2u, contacts.size());
+    EXPECT_EQ(walls[4]->GetId(), contacts[0].entity2);
+    EXPECT_EQ(walls[5]->GetId(), contacts[1].entity2);
+    for (const auto &c : contacts)
+      EXPECT_EQ(box->GetId(), c.entity1);
+
+    // a wall that becomes dynamic collides with its neighbors
+    walls[7]->SetStatic(false);
+    contacts = cd.CheckCollisions(entities, true);
+    ASSERT_EQ(4u, contacts.size());
+    std::size_t wallContacts = 0u;
+    for (const auto &c : contacts)
+    {
+      if (c.entity1 == walls[7]->GetId())
+      {
+        ++wallContacts;
+        EXPECT_TRUE(c.entity2 == walls[6]->GetId() ||
+            c.entity2 == walls[8]->GetId());
+      }
+    }
+    EXPECT_EQ(2u, wallContacts);
+
+    // a box that becomes static does not collide with the walls anymore
+    box->SetStatic(true);
+    contacts = cd.CheckCollisions(entities, true);
+    EXPECT_EQ(2u, contacts.size());
+
+    // removed static entities are not reported
+    entities.erase(walls[6]->GetId());
+    contacts = cd.CheckCollisions(entities, true);
+    ASSERT_EQ(1u, contacts.size());
+    EXPECT_EQ(walls[8]->GetId(), contacts[0].entity2);
+
+    // rays hit static entities
+    std::vector<Ray> rays(1);
+    rays[0].origin = math::Vector3d(0, -5, 0);
+    rays[0].direction = math::Vector3d(0, 1, 0);
+    std::vector<RayHit> hits;
+    cd.CastRays(entities, rays, hits);
+    ASSERT_EQ(1u, hits.size());
+    EXPECT_EQ(walls[0]->GetId(), hits[0].entity);
+    EXPECT_NEAR(4.5, hits[0].distance, 1e-9);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, CollideBitmask)
+{
+  auto makeBoxModel = [](const math::Pose3d &_pose,
+      const math::Vector3d &_size, uint16_t _mask)
+  {
+    std::shared_ptr<Model> model(new Model);
+    model->SetPose(_pose);
+    Link *link = static_cast<Link *>(&model->AddLink());
+    Collision *collision = static_cast<Collision *>(&link->AddCollision());
+    BoxShape box;
+    box.SetSize(_size);
+    collision->SetShape(box);
+    collision->SetCollideBitmask(_mask);
+    return model;
+  };
+
+  for (auto type : {BroadphaseType::AABB_TREE,
+      BroadphaseType::SWEEP_AND_PRUNE, BroadphaseType::SPATIAL_HASH,
+      BroadphaseType::AABB_TREE_FLOAT})
+  {
+    // a row of overlapping boxes in two alternating groups, on a static
+    // ground that collides with both groups
+    std::map<std::size_t, std::shared_ptr<Entity>> entities;
+    std::vector<std::shared_ptr<Model>> boxes;
+    for (int i = 0; i < 10; ++i)
+    {
+      boxes.push_back(makeBoxModel(math::Pose3d(i * 0.9, 0, 0, 0, 0, 0),
+          math::Vector3d::One, i % 2 == 0 ? 0x01 : 0x02));
+      entities[boxes.back()->GetId()] = boxes.back();
+    }
+    std::shared_ptr<Model> ground = makeBoxModel(
+        math::Pose3d(0, 0, -0.95, 0, 0, 0), math::Vector3d(40, 40, 1), 0x03);
+    ground->SetStatic(true);
+    entities[ground->GetId()] = ground;
+
+    CollisionDetector cd;
+    cd.SetBroadphaseType(type);
+
+    // boxes only collide with the ground
+    std::vector<Contact> contacts = cd.CheckCollisions(entities, true);
+    ASSERT_EQ(10u, contacts.size());
+    for (const auto &c : contacts)
+    {
+      EXPECT_TRUE(c.entity1 == ground->GetId() ||
+          c.entity2 == ground->GetId());
+    }
+
+    // a box that joins both groups collides with its neighbors without
+    // moving
+    auto link = boxes[4]->GetChildren().begin()->second;
+    auto collision = std::static_pointer_cast<Collision>(
+        link->GetChildren().begin()->second);
+    collision->SetCollideBitmask(0x03);
+    contacts = cd.CheckCollisions(entities, true);
+    EXPECT_EQ(12u, contacts.size());
+
+    // the narrow phase reports the same pairs
+    cd.SetNarrowPhaseEnabled(true);
+    contacts = cd.CheckCollisions(entities, true);
+    EXPECT_EQ(12u, contacts.size());
+
+    // a box that leaves all groups does not collide anymore
+    collision->SetCollideBitmask(0x00);
+    contacts = cd.CheckCollisions(entities, true);
+    EXPECT_EQ(9u, contacts.size());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionDetector, OrientedBoxes)
+{
+  auto makeRodModel = [](const math::Pose3d &_pose)
+  {
+    std::shared_ptr<Model> model(new Model);
+    model->SetPose(_pose);
+    Link *link = static_cast<Link *>(&model->AddLink());
+    Collision *collision = static_cast<Collision *>(&link->AddCollision());
+    BoxShape box;
+    box.SetSize(math::Vector3d(4, 0.2, 0.2));
+    collision->SetShape(box);
+    return model;
+  };
+
+  // two parallel diagonal rods side by side. Their AABBs overlap but the
+  // rods do not.
+  std::shared_ptr<Model> rod1 =
+      makeRodModel(math::Pose3d(0, 0, 0, 0, 0, GZ_PI * 0.25));
+  std::shared_ptr<Model> rod2 =
+      makeRodModel(math::Pose3d(1, -1, 0, 0, 0, GZ_PI * 0.25));
+  std::map<std::size_t, std::shared_ptr<Entity>> entities;
+  entities[rod1->GetId()] = rod1;
+  entities[rod2->GetId()] = rod2;
+  auto worldBox = [](const std::shared_ptr<Model> &_model)
+  {
+    return transformAxisAlignedBox(_model->GetBoundingBox(),
+        _model->GetPose());
+  };
+  EXPECT_TRUE(worldBox(rod1).Intersects(worldBox(rod2)));
+
+  // the oriented boxes are only checked when enabled
+  CollisionDetector cd;
+  EXPECT_FALSE(cd.GetOrientedBoxesEnabled());
+  std::vector<Contact> contacts = cd.CheckCollisions(entities, true);
+  EXPECT_EQ(1u, contacts.size());
+
+  cd.SetOrientedBoxesEnabled(true);
+  EXPECT_TRUE(cd.GetOrientedBoxesEnabled());
+  contacts = cd.CheckCollisions(entities, true);
+  EXPECT_TRUE(contacts.empty());
+
+  // the rods cross each other, the contact is still the center of the
+  // intersection of their AABBs
+  rod2->SetPose(math::Pose3d(1, -1, 0, 0, 0, -GZ_PI * 0.25));
+  contacts = cd.CheckCollisions(entities, true);
+  ASSERT_EQ(1u, contacts.size());
+  std::vector<math::Vector3d> points;
+  EXPECT_TRUE(cd.GetIntersectionPoints(worldBox(rod1), worldBox(rod2),
+      points, true));
+  ASSERT_EQ(1u, points.size());
+  EXPECT_EQ(points[0], contacts[0].point);
+}
@@ -15,6 +15,13 @@
  *
 */
 
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "Entity.hh"
 #include "Utils.hh"
 
@@ -24,11 +31,15 @@ class gz::physics::tpelib::EntityPrivate
   /// \brief Name of entity
   public: std::string name;
 
-  /// \brief Entity pose
-  public: math::Pose3d pose;
+  /// \brief Kinematic state of the entity when it is not attached to a
+  /// state store
+  public: EntityState state;
+
+  /// \brief State store holding the kinematic state of the entity
+  public: EntityStateStore *store = nullptr;
 
-  /// \brief Indicate if the object is static
-  public: bool isStatic = false;
+  /// \brief Index of the entity state in the store
+  public: std::size_t stateIndex = 0u;
 
   /// \brief Entity Id
   public: std::size_t id = 0u;
@@ -45,20 +56,97 @@ class gz::physics::tpelib::EntityPrivate
   /// \brief Flag to indicate if bounding box changed
   public: bool bboxDirty = true;
 
-  /// \brief Flag to indicate if pose changed
-  public: bool poseDirty = false;
-
   /// \brief Flag to indicate if collide bitmask changed
   public: bool collideBitmaskDirty = true;
 
+  /// \brief True if the entity has a heightmap collision
+  public: bool hasHeightmap = false;
+
+  /// \brief Flag to indicate if the heightmap collisions changed
+  public: bool hasHeightmapDirty = true;
+
+  /// \brief Cached world pose
+  public: math::Pose3d worldPose;
+
+  /// \brief Flag to indicate if the cached world pose is out of date. When
+  /// set, the flags of all the descendants are set too.
+  public: bool worldPoseDirty = true;
+
   /// \brief Parent of this entity
   public: Entity *parent = nullptr;
+
+  /// \brief Children in the order of their ids, for lookup by index
+  public: std::vector<Entity *> childrenByIndex;
+
+  /// \brief Children by name. Several children can have the same name.
+  public: std::unordered_multimap<std::string, Entity *> childrenByName;
+
+  /// \brief Flag to indicate if the child lookup tables must be rebuilt
+  public: bool childLookupDirty = false;
+
+  /// \brief Rebuild the child lookup tables if they are out of date, i.e.
+  /// after the children are copied, removed in a batch or inserted out of
+  /// id order.
+  public: void UpdateChildLookup();
+
+  /// \brief Remove a child from the lookup tables
+  /// \param[in] _child Child entity
+  public: void RemoveChildLookup(Entity *_child);
+
+  /// \brief Remove a child from the name lookup table
+  /// \param[in] _child Child entity
+  public: void RemoveChildName(Entity *_child);
 };
 
 using namespace gz;
 using namespace physics;
 using namespace tpelib;
 
+//////////////////////////////////////////////////
+void EntityPrivate::UpdateChildLookup()
+{
+  if (!this->childLookupDirty)
+    return;
+
+  this->childrenByIndex.clear();
+  this->childrenByName.clear();
+  this->childrenByName.reserve(this->children.size());
+  for (auto &it : this->children)
+  {
+    this->childrenByIndex.push_back(it.second.get());
+    this->childrenByName.emplace(it.second->GetNameRef(), it.second.get());
+  }
+  this->childLookupDirty = false;
+}
+
+//////////////////////////////////////////////////
+void EntityPrivate::RemoveChildLookup(Entity *_child)
+{
+  if (this->childLookupDirty)
+    return;
+
+  auto it = std::lower_bound(this->childrenByIndex.begin(),
+      this->childrenByIndex.end(), _child->GetId(),
+      [](const Entity *_e, std::size_t _id) { return _e->GetId() < _id; });
+  if (it != this->childrenByIndex.end() && *it == _child)
+    this->childrenByIndex.erase(it);
+  this->RemoveChildName(_child);
+}
+
+//////////////////////////////////////////////////
+void EntityPrivate::RemoveChildName(Entity *_child)
+{
+  auto range = this->childrenByName.equal_range(_child->GetNameRef());
+  for (auto nameIt = range.first; nameIt != range.second; ++nameIt)
+  {
+    if (nameIt->second == _child)
+    {
+      this->childrenByName.erase(nameIt);
+      break;
+    }
+  }
+}
+
 std::size_t Entity::nextId = 0;
 Entity Entity::kNullEntity = Entity(kNullEntityId);
 
@@ -75,8 +163,17 @@ Entity::Entity(const Entity &_other)
 {
   this->dataPtr->id = _other.dataPtr->id;
   this->dataPtr->name = _other.dataPtr->name;
-  this->dataPtr->pose = _other.dataPtr->pose;
+  if (_other.dataPtr->store)
+  {
+    this->dataPtr->state =
+        _other.dataPtr->store->State(_other.dataPtr->stateIndex);
+  }
+  else
+  {
+    this->dataPtr->state = _other.dataPtr->state;
+  }
   this->dataPtr->children = _other.dataPtr->children;
+  this->dataPtr->childLookupDirty = true;
   this->dataPtr->bbox = _other.dataPtr->bbox;
   this->dataPtr->collideBitmask = _other.dataPtr->collideBitmask;
 }
@@ -85,10 +182,32 @@ Entity::Entity(const Entity &_other)
 Entity::Entity(Entity &&_other) noexcept
   : dataPtr(std::exchange(_other.dataPtr, nullptr))
 {
+  if (this->dataPtr && this->dataPtr->store)
+    this->dataPtr->store->entities[this->dataPtr->stateIndex] = this;
 }
 
-/////////////////////////////////////////////////
-Entity &Entity::operator=(Entity &&_entity) noexcept = default;
+//////////////////////////////////////////////////
+Entity &Entity::operator=(Entity &&_other) noexcept
+{
+  if (this == &_other)
+    return *this;
+
+  if (this->dataPtr)
+  {
+    this->DetachState();
+    for (auto &it : this->dataPtr->children)
+    {
+      if (it.second->dataPtr && it.second->dataPtr->parent == this)
+        it.second->dataPtr->parent = nullptr;
+    }
+  }
+  delete this->dataPtr;
+  this->dataPtr = std::exchange(_other.dataPtr, nullptr);
+
+  if (this->dataPtr && this->dataPtr->store)
+    this->dataPtr->store->entities[this->dataPtr->stateIndex] = this;
+  return *this;
+}
 
 //////////////////////////////////////////////////
 Entity::Entity(std::size_t _id)
@@ -100,6 +219,17 @@ Entity::Entity(std::size_t _id)
 //////////////////////////////////////////////////
 Entity::~Entity()
 {
+  if (this->dataPtr)
+  {
+    this->DetachState();
+
+    // children can outlive their parent
+    for (auto &it : this->dataPtr->children)
+    {
+      if (it.second->dataPtr && it.second->dataPtr->parent == this)
+        it.second->dataPtr->parent = nullptr;
+    }
+  }
   delete this->dataPtr;
   this->dataPtr = nullptr;
 }
@@ -108,12 +238,28 @@ Entity::~Entity()
 Entity &Entity::operator=(const Entity &_other)
 {
   this->dataPtr->children = _other.dataPtr->children;
+  this->dataPtr->childLookupDirty = true;
   return *this;
 }
 
 //////////////////////////////////////////////////
 void Entity::SetName(const std::string &_name)
 {
+  // update the name lookup table of the parent if this entity is one of its
+  // children
+  Entity *parent = this->dataPtr->parent;
+  if (parent && !parent->dataPtr->childLookupDirty)
+  {
+    auto it = parent->dataPtr->children.find(this->dataPtr->id);
+    if (it != parent->dataPtr->children.end() && it->second.get() == this)
+    {
+      parent->dataPtr->RemoveChildName(this);
+      this->dataPtr->name = _name;
+      parent->dataPtr->childrenByName.emplace(_name, this);
+      return;
+    }
+  }
+
   this->dataPtr->name = _name;
 }
 
@@ -132,35 +278,157 @@ const std::string &Entity::GetNameRef() const
 //////////////////////////////////////////////////
 void Entity::SetPose(const math::Pose3d &_pose)
 {
-  this->dataPtr->pose = _pose;
-  this->dataPtr->poseDirty = true;
+  if (this->dataPtr->store)
+  {
+    std::size_t i = this->dataPtr->stateIndex;
+    this->dataPtr->store->position[i] = _pose.Pos();
+    this->dataPtr->store->rotation[i] = _pose.Rot();
+    this->dataPtr->store->SetPoseDirty(i);
+    this->dataPtr->store->idleSteps[i] = 0u;
+    this->WorldPoseChanged();
+    return;
+  }
+
+  this->dataPtr->state.pose = _pose;
+  this->dataPtr->state.poseDirty = true;
+  this->WorldPoseChanged();
+
+  // entities of nested models are not in the store. Mark the pose of the
+  // nearest ancestor in the store dirty so that the move is reported with
+  // the poses changed by the step.
+  for (Entity *e = this->dataPtr->parent; e; e = e->dataPtr->parent)
+  {
+    if (e->dataPtr->store)
+    {
+      std::size_t i = e->dataPtr->stateIndex;
+      e->dataPtr->store->SetPoseDirty(i);
+      e->dataPtr->store->idleSteps[i] = 0u;
+      break;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
 math::Pose3d Entity::GetPose() const
 {
-  return this->dataPtr->pose;
+  if (this->dataPtr->store)
+  {
+    std::size_t i = this->dataPtr->stateIndex;
+    return math::Pose3d(this->dataPtr->store->position[i],
+        this->dataPtr->store->rotation[i]);
+  }
+
+  return this->dataPtr->state.pose;
 }
 
 //////////////////////////////////////////////////
 math::Pose3d Entity::GetWorldPose() const
 {
-  if (this->dataPtr->parent)
-    return this->dataPtr->parent->GetWorldPose() * this->dataPtr->pose;
+  if (this->dataPtr->worldPoseDirty)
+  {
+    // the cache is written without synchronization
+    assert(!inParallelFor());
+    if (this->dataPtr->parent)
+    {
+      this->dataPtr->worldPose =
+          this->dataPtr->parent->GetWorldPose() * this->GetPose();
+    }
+    else
+    {
+      this->dataPtr->worldPose = this->GetPose();
+    }
+    this->dataPtr->worldPoseDirty = false;
+  }
 
-  return this->dataPtr->pose;
+  return this->dataPtr->worldPose;
+}
+
+//////////////////////////////////////////////////
+void Entity::SetLinearVelocity(const math::Vector3d &_velocity)
+{
+  if (this->dataPtr->store)
+  {
+    this->dataPtr->store->linearVelocity[this->dataPtr->stateIndex] =
+        _velocity;
+    return;
+  }
+
+  this->dataPtr->state.linearVelocity = _velocity;
+}
+
+//////////////////////////////////////////////////
+math::Vector3d Entity::GetLinearVelocity() const
+{
+  if (this->dataPtr->store)
+    return this->dataPtr->store->linearVelocity[this->dataPtr->stateIndex];
+
+  return this->dataPtr->state.linearVelocity;
+}
+
+//////////////////////////////////////////////////
+void Entity::SetAngularVelocity(const math::Vector3d &_velocity)
+{
+  if (this->dataPtr->store)
+  {
+    this->dataPtr->store->angularVelocity[this->dataPtr->stateIndex] =
+        _velocity;
+    return;
+  }
+
+  this->dataPtr->state.angularVelocity = _velocity;
+}
+
+//////////////////////////////////////////////////
+math::Vector3d Entity::GetAngularVelocity() const
+{
+  if (this->dataPtr->store)
+    return this->dataPtr->store->angularVelocity[this->dataPtr->stateIndex];
+
+  return this->dataPtr->state.angularVelocity;
+}
+
+//////////////////////////////////////////////////
+void Entity::UpdatePose(double _timeStep)
+{
+  if (this->dataPtr->store)
+  {
+    this->dataPtr->store->Integrate(_timeStep, this->dataPtr->stateIndex,
+        this->dataPtr->stateIndex + 1u);
+    if (this->PoseDirty())
+      this->WorldPoseChanged();
+    return;
+  }
+
+  EntityState &state = this->dataPtr->state;
+  if (state.linearVelocity == math::Vector3d::Zero &&
+      state.angularVelocity == math::Vector3d::Zero)
+    return;
+
+  math::Pose3d nextPose(
+    state.pose.Pos() + state.linearVelocity * _timeStep,
+    state.pose.Rot().Integrate(state.angularVelocity, _timeStep));
+  this->SetPose(nextPose);
 }
 
 //////////////////////////////////////////////////
 void Entity::SetStatic(bool _static)
 {
-  this->dataPtr->isStatic = _static;
+  if (this->dataPtr->store)
+  {
+    this->dataPtr->store->isStatic[this->dataPtr->stateIndex] = _static;
+    return;
+  }
+
+  this->dataPtr->state.isStatic = _static;
 }
 
 //////////////////////////////////////////////////
 bool Entity::GetStatic() const
 {
-  return this->dataPtr->isStatic;
+  if (this->dataPtr->store)
+    return this->dataPtr->store->isStatic[this->dataPtr->stateIndex];
+
+  return this->dataPtr->state.isStatic;
 }
 
 //////////////////////////////////////////////////
@@ -190,32 +458,31 @@ Entity &Entity::GetChildById(std::size_t _id) const
 //////////////////////////////////////////////////
 Entity &Entity::GetChildByName(const std::string &_name) const
 {
-  for (auto it = this->dataPtr->children.begin();
-      it != this->dataPtr->children.end(); ++it)
+  this->dataPtr->UpdateChildLookup();
+
+  // return the child with the smallest id if several have the same name
+  Entity *child = nullptr;
+  auto range = this->dataPtr->childrenByName.equal_range(_name);
+  for (auto it = range.first; it != range.second; ++it)
   {
-    if (it->second->GetName() == _name)
-    {
-      return *it->second.get();
-    }
+    if (!child || it->second->GetId() < child->GetId())
+      child = it->second;
   }
 
+  if (child)
+    return *child;
+
   return kNullEntity;
 }
 
 //////////////////////////////////////////////////
 Entity &Entity::GetChildByIndex(unsigned int _index) const
 {
-  if (_index >= this->dataPtr->children.size())
+  this->dataPtr->UpdateChildLookup();
+  if (_index >= this->dataPtr->childrenByIndex.size())
     return kNullEntity;
 
-  auto it = this->dataPtr->children.begin();
-  std::advance(it, _index);
-  if (it != this->dataPtr->children.end())
-  {
-    return *it->second.get();
-  }
-
-  return kNullEntity;
+  return *this->dataPtr->childrenByIndex[_index];
 }
 
 //////////////////////////////////////////////////
@@ -224,6 +491,8 @@ bool Entity::RemoveChildById(std::size_t _id)
   auto it = this->dataPtr->children.find(_id);
   if (it != this->dataPtr->children.end())
   {
+    this->dataPtr->RemoveChildLookup(it->second.get());
+    it->second->DetachState();
     this->dataPtr->children.erase(it);
     this->ChildrenChanged();
     return true;
@@ -235,17 +504,70 @@ bool Entity::RemoveChildById(std::size_t _id)
 //////////////////////////////////////////////////
 bool Entity::RemoveChildByName(const std::string &_name)
 {
-  for (auto it = this->dataPtr->children.begin();
-      it != this->dataPtr->children.end(); ++it)
+  Entity &child = this->GetChildByName(_name);
+  if (child.GetId() == kNullEntityId)
+    return false;
+
+  return Entity::RemoveChildById(child.GetId());
+}
+
+//////////////////////////////////////////////////
+std::size_t Entity::RemoveChildrenById(const std::vector<std::size_t> &_ids)
+{
+  std::size_t removed = 0u;
+  for (std::size_t id : _ids)
   {
-    if (it->second->GetName() == _name)
-    {
-      this->dataPtr->children.erase(it);
-      this->ChildrenChanged();
-      return true;
-    }
+    auto it = this->dataPtr->children.find(id);
+    if (it == this->dataPtr->children.end())
+      continue;
+
+    it->second->DetachState();
+    this->dataPtr->children.erase(it);
+    ++removed;
   }
-  return false;
+
+  if (removed > 0u)
+  {
+    // removing the children one by one from the lookup tables takes time
+    // linear in the number of children, so the tables are rebuilt on the
+    // next lookup instead
+    this->dataPtr->childLookupDirty = true;
+    this->ChildrenChanged();
+  }
+  return removed;
+}
+
+//////////////////////////////////////////////////
+Entity &Entity::AddChild(std::shared_ptr<Entity> _child)
+{
+  Entity *child = _child.get();
+  const auto[it, success] = this->dataPtr->children.insert(
+      {child->GetId(), std::move(_child)});
+  if (!success)
+    return *it->second.get();
+
+  child->SetParent(this);
+
+  // children usually have increasing ids so they are appended to the
+  // lookup tables. Otherwise the tables are rebuilt on the next lookup.
+  auto &byIndex = this->dataPtr->childrenByIndex;
+  if (this->dataPtr->childLookupDirty ||
+      byIndex.size() + 1u != this->dataPtr->children.size() ||
+      (!byIndex.empty() && byIndex.back()->GetId() > child->GetId()))
+  {
+    this->dataPtr->childLookupDirty = true;
+    return *child;
+  }
+  byIndex.push_back(child);
+  this->dataPtr->childrenByName.emplace(child->GetNameRef(), child);
+  return *child;
+}
+
+//////////////////////////////////////////////////
+void Entity::ReserveChildren(std::size_t _count)
+{
+  this->dataPtr->childrenByIndex.reserve(_count);
+  this->dataPtr->childrenByName.reserve(_count);
 }
 
 //////////////////////////////////////////////////
@@ -298,7 +620,29 @@ uint16_t Entity::GetCollideBitmask() const
 }
 
 //////////////////////////////////////////////////
-std::map<std::size_t, std::shared_ptr<Entity>> &Entity::GetChildren() const
+bool Entity::HasHeightmap() const
+{
+  if (this->dataPtr->hasHeightmapDirty)
+  {
+    bool hasHeightmap = false;
+    for (auto &it : this->dataPtr->children)
+    {
+      if (it.second->HasHeightmap())
+      {
+        hasHeightmap = true;
+        break;
+      }
+    }
+    this->dataPtr->hasHeightmap = hasHeightmap;
+    this->dataPtr->hasHeightmapDirty = false;
+  }
+
+  return this->dataPtr->hasHeightmap;
+}
+
+//////////////////////////////////////////////////
+const std::map<std::size_t, std::shared_ptr<Entity>> &Entity::GetChildren()
+    const
 {
   return this->dataPtr->children;
 }
@@ -314,15 +658,33 @@ void Entity::ChildrenChanged()
 {
   this->dataPtr->bboxDirty = true;
   this->dataPtr->collideBitmaskDirty = true;
+  this->dataPtr->hasHeightmapDirty = true;
+
+  // the contacts of a sleeping entity are cached, so it wakes up to have
+  // them computed again from its new collisions
+  this->Wake();
 
   if (this->dataPtr->parent)
     this->dataPtr->parent->ChildrenChanged();
 }
 
+//////////////////////////////////////////////////
+void Entity::WorldPoseChanged()
+{
+  // the descendants of a dirty entity are already dirty
+  if (this->dataPtr->worldPoseDirty)
+    return;
+
+  this->dataPtr->worldPoseDirty = true;
+  for (auto &it : this->dataPtr->children)
+    it.second->WorldPoseChanged();
+}
+
 //////////////////////////////////////////////////
 void Entity::SetParent(Entity *_parent)
 {
   this->dataPtr->parent = _parent;
+  this->WorldPoseChanged();
 }
 
 //////////////////////////////////////////////////
@@ -334,11 +696,89 @@ Entity *Entity::GetParent() const
 //////////////////////////////////////////////////
 bool Entity::PoseDirty() const
 {
-  return this->dataPtr->poseDirty;
+  if (this->dataPtr->store)
+    return this->dataPtr->store->poseDirty[this->dataPtr->stateIndex];
+
+  return this->dataPtr->state.poseDirty;
 }
 
 //////////////////////////////////////////////////
 void Entity::ResetPoseDirty()
 {
-  this->dataPtr->poseDirty = false;
+  if (this->dataPtr->store)
+  {
+    this->dataPtr->store->ResetPoseDirty(this->dataPtr->stateIndex);
+    return;
+  }
+
+  this->dataPtr->state.poseDirty = false;
+}
+
+//////////////////////////////////////////////////
+unsigned int Entity::GetIdleSteps() const
+{
+  EntityStateStore *store = this->dataPtr->store;
+  if (!store)
+    return 0u;
+
+  unsigned int idle = store->idleSteps[this->dataPtr->stateIndex];
+  for (auto &it : this->dataPtr->children)
+  {
+    if (idle == 0u)
+      break;
+    if (it.second->dataPtr->store == store)
+      idle = std::min(idle, it.second->GetIdleSteps());
+  }
+  return idle;
+}
+
+//////////////////////////////////////////////////
+void Entity::Wake()
+{
+  if (this->dataPtr->store)
+    this->dataPtr->store->idleSteps[this->dataPtr->stateIndex] = 0u;
+}
+
+//////////////////////////////////////////////////
+void Entity::AttachState(EntityStateStore *_store)
+{
+  if (this->dataPtr->store == _store)
+    return;
+
+  this->DetachState();
+  if (!_store)
+    return;
+
+  this->dataPtr->stateIndex = _store->Add(this, this->dataPtr->state);
+  this->dataPtr->store = _store;
+}
+
+//////////////////////////////////////////////////
+void Entity::DetachState()
+{
+  EntityStateStore *store = this->dataPtr->store;
+  if (!store)
+    return;
+
+  for (auto &it : this->dataPtr->children)
+  {
+    if (it.second->dataPtr->store == store)
+      it.second->DetachState();
+  }
+
+  this->dataPtr->state = store->State(this->dataPtr->stateIndex);
+  store->Remove(this->dataPtr->stateIndex);
+  this->dataPtr->store = nullptr;
+}
+
+//////////////////////////////////////////////////
+EntityStateStore *Entity::GetStateStore() const
+{
+  return this->dataPtr->store;
+}
+
+//////////////////////////////////////////////////
+void Entity::SetStateIndex(std::size_t _index)
+{
+  this->dataPtr->stateIndex = _index;
 }
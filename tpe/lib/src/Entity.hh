@@ -22,11 +22,14 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gz/math/AxisAlignedBox.hh>
 #include <gz/math/Pose3.hh>
 #include "gz/physics/tpelib/Export.hh"
 
+#include "EntityStateStore.hh"
+
 namespace gz {
 namespace physics {
 namespace tpelib {
@@ -102,21 +105,49 @@ class GZ_PHYSICS_TPELIB_VISIBLE Entity
   /// \return Pose of entity
   public: virtual math::Pose3d GetPose() const;
 
-  /// \brief Get the world pose of the entity
+  /// \brief Get the world pose of the entity. The world pose is cached
+  /// and only recomputed after the pose of the entity or of one of its
+  /// ancestors changes, so repeated calls are cheap. Since it updates the
+  /// cache without synchronization, this function must only be called from
+  /// the thread stepping the world and never from within parallelFor,
+  /// which is asserted in debug builds.
   /// \return World pose of entity
   public: virtual math::Pose3d GetWorldPose() const;
 
+  /// \brief Set the linear velocity of the entity relative to parent
+  /// \param[in] _velocity linear velocity in meters per second
+  public: void SetLinearVelocity(const math::Vector3d &_velocity);
+
+  /// \brief Get the linear velocity of the entity relative to parent
+  /// \return linear velocity of entity in meters per second
+  public: math::Vector3d GetLinearVelocity() const;
+
+  /// \brief Set the angular velocity of the entity relative to parent
+  /// \param[in] _velocity angular velocity in radians per second
+  public: void SetAngularVelocity(const math::Vector3d &_velocity);
+
+  /// \brief Get the angular velocity of the entity relative to parent
+  /// \return angular velocity in radians per second
+  public: math::Vector3d GetAngularVelocity() const;
+
+  /// \brief Update the pose of the entity from its velocities
+  /// \param[in] _timeStep current world timestep in seconds
+  public: virtual void UpdatePose(double _timeStep);
+
   /// \brief Get a child entity by id
   /// \param[in] _id Id of child entity
   /// \return Child entity
   public: virtual Entity &GetChildById(std::size_t _id) const;
 
-  /// \brief Get a child entity by name
+  /// \brief Get a child entity by name. If several children have the
+  /// name, the one with the smallest id is returned. Names are looked up
+  /// in a hash table so this takes constant time.
   /// \param[in] _name Name of child entity
   /// \return Child entity
   public: virtual Entity &GetChildByName(const std::string &_name) const;
 
-  /// \brief Get a child entity by index
+  /// \brief Get a child entity by index. Children are indexed in the
+  /// order of their ids.
   /// \param[in] _index Index of child entity
   /// \return Child entity
   public: virtual Entity &GetChildByIndex(unsigned int _index) const;
@@ -130,6 +161,15 @@ class GZ_PHYSICS_TPELIB_VISIBLE Entity
   /// \return True if child entity was removed, false otherwise
   public: virtual bool RemoveChildByName(const std::string &_name);
 
+  /// \brief Remove many child entities at once. The lookup tables are
+  /// rebuilt once and the parents are notified once, instead of once per
+  /// child.
+  /// \param[in] _ids Ids of child entities to remove. Ids that are not
+  /// children of this entity are ignored.
+  /// \return Number of child entities removed
+  public: virtual std::size_t RemoveChildrenById(
+      const std::vector<std::size_t> &_ids);
+
   /// \brief Remove a child entity by index
   /// \param[in] _index Index of child entity to remove
   // public: virtual void RemoveChildByIndex(size_t _index);
@@ -147,6 +187,11 @@ class GZ_PHYSICS_TPELIB_VISIBLE Entity
   /// \return Collision's collide bitmask
   public: virtual uint16_t GetCollideBitmask() const;
 
+  /// \brief Get whether the entity or one of its descendants is a
+  /// collision with a heightmap shape
+  /// \return True if the entity has a heightmap collision
+  public: virtual bool HasHeightmap() const;
+
   /// \internal
   /// \brief Set the parent of this entity.
   /// \param[in] _parent Parent to set to
@@ -166,14 +211,58 @@ class GZ_PHYSICS_TPELIB_VISIBLE Entity
   /// \brief Reset the pose dirty flag
   public: void ResetPoseDirty();
 
+  /// \internal
+  /// \brief Get the number of consecutive steps during which this entity
+  /// and its children attached to the same state store kept the same pose.
+  /// \return Smallest idle step count of the entity and of its attached
+  /// children, or 0 if the entity is not attached to a state store
+  public: unsigned int GetIdleSteps() const;
+
+  /// \internal
+  /// \brief Reset the idle step count of this entity so that it is
+  /// considered to be moving again
+  public: void Wake();
+
+  /// \internal
+  /// \brief Move the kinematic state of this entity, i.e. its pose,
+  /// velocities, static flag and pose dirty flag, to a state store. The
+  /// entity then reads and writes its state from the store until it is
+  /// detached.
+  /// \param[in] _store Store to attach to
+  public: void AttachState(EntityStateStore *_store);
+
+  /// \internal
+  /// \brief Move the kinematic state of this entity, and of its children
+  /// attached to the same store, out of the state store.
+  public: void DetachState();
+
+  /// \internal
+  /// \brief Get the state store this entity is attached to
+  /// \return State store or nullptr if the entity is not attached
+  public: EntityStateStore *GetStateStore() const;
+
+  /// \internal
+  /// \brief Set the index of the state of this entity in its state store.
+  /// Called by the store when it moves the state.
+  /// \param[in] _index New index
+  public: void SetStateIndex(std::size_t _index);
+
+  /// \internal
+  /// \brief Mark that the world pose of the entity has changed, e.g. its
+  /// pose or its parent changed, and invalidate the cached world poses of
+  /// the entity and of its descendants.
+  public: void WorldPoseChanged();
+
   /// \internal
   /// \brief Mark that the children of the entity has changed, e.g. a child
   /// entity is added or removed, or child entity properties changed.
   public: void ChildrenChanged();
 
-  /// \brief Get number of children
+  /// \brief Get the children of this entity. Children are added and
+  /// removed through the entity API, which keeps the name and index lookups
+  /// up to date.
   /// \return Map of child id's to child entities
-  public: std::map<std::size_t, std::shared_ptr<Entity>> &GetChildren()
+  public: const std::map<std::size_t, std::shared_ptr<Entity>> &GetChildren()
       const;
 
   /// \brief Update the entity bounding box
@@ -183,6 +272,18 @@ class GZ_PHYSICS_TPELIB_VISIBLE Entity
   /// \brief An invalid vertex.
   public: static Entity kNullEntity;
 
+  /// \brief Add a child entity, set its parent and add it to the name and
+  /// index lookups.
+  /// \param[in] _child Child entity
+  /// \return The child, or the existing child with the same id
+  protected: Entity &AddChild(std::shared_ptr<Entity> _child);
+
+  /// \brief Reserve storage in the name and index lookups for children
+  /// about to be added
+  /// \param[in] _count Total number of children the lookups can hold
+  /// without reallocating
+  protected: void ReserveChildren(std::size_t _count);
+
   /// \brief Get the id of next entity
   /// \return size_t id of next entity
   protected: static std::size_t GetNextId();
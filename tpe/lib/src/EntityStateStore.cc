@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include <gz/common/Profiler.hh>
+
+#include "Entity.hh"
+#include "EntityStateStore.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+//////////////////////////////////////////////////
+EntityStateStore::~EntityStateStore()
+{
+  // detaching an entity removes its state, and those of its attached
+  // children, from the store
+  while (!this->entities.empty())
+    this->entities.back()->DetachState();
+}
+
+//////////////////////////////////////////////////
+std::size_t EntityStateStore::Add(Entity *_entity, const EntityState &_state)
+{
+  this->position.push_back(_state.pose.Pos());
+  this->rotation.push_back(_state.pose.Rot());
+  this->linearVelocity.push_back(_state.linearVelocity);
+  this->angularVelocity.push_back(_state.angularVelocity);
+  this->isStatic.push_back(_state.isStatic);
+  // the pose of a new entity is reported as changed in its first step
+  this->poseDirty.push_back(true);
+  this->idleSteps.push_back(0u);
+  this->entities.push_back(_entity);
+  this->dirtySlots.push_back(this->dirtyIndices.size());
+  this->dirtyIndices.push_back(this->entities.size() - 1u);
+  return this->entities.size() - 1u;
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::Reserve(std::size_t _count)
+{
+  this->position.reserve(_count);
+  this->rotation.reserve(_count);
+  this->linearVelocity.reserve(_count);
+  this->angularVelocity.reserve(_count);
+  this->isStatic.reserve(_count);
+  this->poseDirty.reserve(_count);
+  this->dirtySlots.reserve(_count);
+  this->idleSteps.reserve(_count);
+  this->entities.reserve(_count);
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::Remove(std::size_t _index)
+{
+  std::size_t last = this->entities.size() - 1u;
+
+  // keep the list of dirty states in sync
+  if (this->poseDirty[_index])
+    this->EraseDirtyIndex(_index);
+  if (_index != last && this->poseDirty[last])
+  {
+    // the last state moves into the place of the removed one
+    this->dirtyIndices[this->dirtySlots[last]] = _index;
+  }
+
+  if (_index != last)
+  {
+    this->position[_index] = this->position[last];
+    this->rotation[_index] = this->rotation[last];
+    this->linearVelocity[_index] = this->linearVelocity[last];
+    this->angularVelocity[_index] = this->angularVelocity[last];
+    this->isStatic[_index] = this->isStatic[last];
+    this->poseDirty[_index] = this->poseDirty[last];
+    this->dirtySlots[_index] = this->dirtySlots[last];
+    this->idleSteps[_index] = this->idleSteps[last];
+    this->entities[_index] = this->entities[last];
+    this->entities[_index]->SetStateIndex(_index);
+  }
+
+  this->position.pop_back();
+  this->rotation.pop_back();
+  this->linearVelocity.pop_back();
+  this->angularVelocity.pop_back();
+  this->isStatic.pop_back();
+  this->poseDirty.pop_back();
+  this->dirtySlots.pop_back();
+  this->idleSteps.pop_back();
+  this->entities.pop_back();
+}
+
+//////////////////////////////////////////////////
+EntityState EntityStateStore::State(std::size_t _index) const
+{
+  EntityState state;
+  state.pose = math::Pose3d(this->position[_index], this->rotation[_index]);
+  state.linearVelocity = this->linearVelocity[_index];
+  state.angularVelocity = this->angularVelocity[_index];
+  state.isStatic = this->isStatic[_index];
+  state.poseDirty = this->poseDirty[_index];
+  return state;
+}
+
+//////////////////////////////////////////////////
+std::size_t EntityStateStore::Size() const
+{
+  return this->entities.size();
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::Integrate(double _timeStep, std::size_t _begin,
+    std::size_t _end)
+{
+  std::size_t slot = this->dirtyIndices.size();
+  this->Integrate(_timeStep, _begin, _end, this->dirtyIndices);
+  for (; slot < this->dirtyIndices.size(); ++slot)
+    this->dirtySlots[this->dirtyIndices[slot]] = slot;
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::Integrate(double _timeStep, std::size_t _begin,
+    std::size_t _end, std::vector<std::size_t> &_dirtied)
+{
+  GZ_PROFILE("tpelib::EntityStateStore::Integrate");
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    const math::Vector3d &linear = this->linearVelocity[i];
+    const math::Vector3d &angular = this->angularVelocity[i];
+    if (linear == math::Vector3d::Zero && angular == math::Vector3d::Zero)
+    {
+      // the pose may still have been set since the last step
+      unsigned int &idle = this->idleSteps[i];
+      if (this->poseDirty[i])
+        idle = 0u;
+      else if (idle < std::numeric_limits<unsigned int>::max())
+        ++idle;
+      continue;
+    }
+
+    this->position[i] += linear * _timeStep;
+    this->rotation[i] = this->rotation[i].Integrate(angular, _timeStep);
+    if (!this->poseDirty[i])
+    {
+      this->poseDirty[i] = true;
+      _dirtied.push_back(i);
+    }
+    this->idleSteps[i] = 0u;
+  }
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::AddDirtyIndices(
+    const std::vector<std::size_t> &_indices)
+{
+  for (std::size_t i : _indices)
+  {
+    this->dirtySlots[i] = this->dirtyIndices.size();
+    this->dirtyIndices.push_back(i);
+  }
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::SetPoseDirty(std::size_t _index)
+{
+  if (this->poseDirty[_index])
+    return;
+
+  this->poseDirty[_index] = true;
+  this->dirtySlots[_index] = this->dirtyIndices.size();
+  this->dirtyIndices.push_back(_index);
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::InvalidateWorldPoses()
+{
+  GZ_PROFILE("tpelib::EntityStateStore::InvalidateWorldPoses");
+  for (std::size_t i : this->dirtyIndices)
+    this->entities[i]->WorldPoseChanged();
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::DirtyEntityIds(std::vector<std::size_t> &_ids) const
+{
+  GZ_PROFILE("tpelib::EntityStateStore::DirtyEntityIds");
+  _ids.clear();
+  _ids.reserve(this->dirtyIndices.size());
+  for (std::size_t i : this->dirtyIndices)
+    _ids.push_back(this->entities[i]->GetId());
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::ResetPoseDirty()
+{
+  for (std::size_t i : this->dirtyIndices)
+    this->poseDirty[i] = false;
+  this->dirtyIndices.clear();
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::ResetPoseDirty(std::size_t _index)
+{
+  if (!this->poseDirty[_index])
+    return;
+
+  this->poseDirty[_index] = false;
+  this->EraseDirtyIndex(_index);
+}
+
+//////////////////////////////////////////////////
+void EntityStateStore::EraseDirtyIndex(std::size_t _index)
+{
+  // the last index of the list moves into the slot of the erased one
+  std::size_t slot = this->dirtySlots[_index];
+  std::size_t moved = this->dirtyIndices.back();
+  this->dirtyIndices[slot] = moved;
+  this->dirtySlots[moved] = slot;
+  this->dirtyIndices.pop_back();
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_ENTITYSTATESTORE_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_ENTITYSTATESTORE_HH_
+
+#include <cstddef>
+#include <vector>
+
+#include <gz/math/Pose3.hh>
+#include <gz/math/Quaternion.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/utils/SuppressWarning.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+// forward declaration
+class Entity;
+
+/// \brief Kinematic state of an entity
+struct GZ_PHYSICS_TPELIB_VISIBLE EntityState
+{
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Pose relative to the parent entity
+  math::Pose3d pose;
+
+  /// \brief Linear velocity relative to the parent entity
+  math::Vector3d linearVelocity;
+
+  /// \brief Angular velocity relative to the parent entity
+  math::Vector3d angularVelocity;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief True if the entity is static
+  bool isStatic = false;
+
+  /// \brief True if the pose changed since the dirty flag was last reset
+  bool poseDirty = false;
+};
+
+/// \brief Contiguous storage for the kinematic state of many entities.
+/// Each state property is stored in its own array so that stepping the
+/// entities is a linear sweep over the arrays. Entities attached to a store
+/// read and write their state from it, see Entity::AttachState.
+class GZ_PHYSICS_TPELIB_VISIBLE EntityStateStore
+{
+  /// \brief Constructor
+  public: EntityStateStore() = default;
+
+  /// \brief Destructor. Attached entities keep a copy of their state.
+  public: ~EntityStateStore();
+
+  /// \brief Copy constructor is deleted since entities hold indices into
+  /// the store
+  public: EntityStateStore(const EntityStateStore &) = delete;
+
+  /// \brief Assignment operator is deleted since entities hold indices
+  /// into the store
+  public: EntityStateStore &operator=(const EntityStateStore &) = delete;
+
+  /// \brief Add the state of an entity to the store
+  /// \param[in] _entity Entity that owns the state
+  /// \param[in] _state Initial state
+  /// \return Index of the state in the store
+  public: std::size_t Add(Entity *_entity, const EntityState &_state);
+
+  /// \brief Reserve storage for states about to be added, so that adding
+  /// many entities does not reallocate the arrays.
+  /// \param[in] _count Total number of states the store can hold without
+  /// reallocating
+  public: void Reserve(std::size_t _count);
+
+  /// \brief Remove a state from the store. The last state is moved into its
+  /// place and its entity is given the new index.
+  /// \param[in] _index Index of the state to remove
+  public: void Remove(std::size_t _index);
+
+  /// \brief Get a copy of a state
+  /// \param[in] _index Index of the state
+  /// \return State at the index
+  public: EntityState State(std::size_t _index) const;
+
+  /// \brief Get the number of states in the store
+  /// \return Number of states
+  public: std::size_t Size() const;
+
+  /// \brief Integrate the poses of a range of states at their constant
+  /// velocities. States that do not move keep their pose dirty flag. The
+  /// idle step count of states that neither move nor have a dirty pose is
+  /// incremented, and reset otherwise.
+  /// \param[in] _timeStep Time step in seconds
+  /// \param[in] _begin Index of the first state to integrate
+  /// \param[in] _end Index after the last state to integrate
+  public: void Integrate(double _timeStep, std::size_t _begin,
+      std::size_t _end);
+
+  /// \brief Integrate the poses of a range of states without touching the
+  /// list of dirty states, so that disjoint ranges can be integrated
+  /// concurrently. The indices of the states whose pose became dirty are
+  /// appended to _dirtied, to be passed to AddDirtyIndices afterwards.
+  /// \param[in] _timeStep Time step in seconds
+  /// \param[in] _begin Index of the first state to integrate
+  /// \param[in] _end Index after the last state to integrate
+  /// \param[in,out] _dirtied Indices of the states whose pose became dirty
+  public: void Integrate(double _timeStep, std::size_t _begin,
+      std::size_t _end, std::vector<std::size_t> &_dirtied);
+
+  /// \brief Add states whose pose became dirty during a concurrent
+  /// integration to the list of dirty states
+  /// \param[in] _indices Indices returned by Integrate
+  public: void AddDirtyIndices(const std::vector<std::size_t> &_indices);
+
+  /// \brief Mark the pose of a state as dirty
+  /// \param[in] _index Index of the state
+  public: void SetPoseDirty(std::size_t _index);
+
+  /// \brief Invalidate the cached world poses of the entities whose pose
+  /// is dirty and of their descendants. Called after the states are
+  /// integrated, on a single thread since descendants may belong to other
+  /// ranges of states. Only the dirty states are visited.
+  public: void InvalidateWorldPoses();
+
+  /// \brief Get the ids of the entities whose pose is dirty
+  /// \param[out] _ids Ids of the entities, in no particular order. The
+  /// vector is cleared first so that its memory can be reused.
+  public: void DirtyEntityIds(std::vector<std::size_t> &_ids) const;
+
+  /// \brief Reset the pose dirty flag of all the states
+  public: void ResetPoseDirty();
+
+  /// \brief Reset the pose dirty flag of a state
+  /// \param[in] _index Index of the state
+  public: void ResetPoseDirty(std::size_t _index);
+
+  /// \brief Erase a state from the list of dirty states by moving the last
+  /// index of the list into its slot
+  /// \param[in] _index Index of the state, whose pose must be dirty
+  private: void EraseDirtyIndex(std::size_t _index);
+
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Positions relative to the parent entities
+  public: std::vector<math::Vector3d> position;
+
+  /// \brief Orientations relative to the parent entities
+  public: std::vector<math::Quaterniond> rotation;
+
+  /// \brief Linear velocities relative to the parent entities
+  public: std::vector<math::Vector3d> linearVelocity;
+
+  /// \brief Angular velocities relative to the parent entities
+  public: std::vector<math::Vector3d> angularVelocity;
+
+  /// \brief Static flags
+  public: std::vector<unsigned char> isStatic;
+
+  /// \brief Pose dirty flags. They are set and reset with SetPoseDirty
+  /// and ResetPoseDirty, which keep the list of dirty states in sync.
+  public: std::vector<unsigned char> poseDirty;
+
+  /// \brief Number of consecutive steps during which each state kept the
+  /// same pose
+  public: std::vector<unsigned int> idleSteps;
+
+  /// \brief Entities owning the states
+  public: std::vector<Entity *> entities;
+
+  /// \brief Indices of the states whose pose is dirty, so that the dirty
+  /// states are visited without sweeping over all the flags. An index is
+  /// in the list if and only if its pose dirty flag is set.
+  private: std::vector<std::size_t> dirtyIndices;
+
+  /// \brief Position of each dirty state in dirtyIndices, so that a state
+  /// is erased from the list in constant time. Only valid for the states
+  /// whose pose dirty flag is set.
+  private: std::vector<std::size_t> dirtySlots;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+};
+
+}
+}
+}
+
+#endif
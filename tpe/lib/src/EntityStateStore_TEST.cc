@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "EntityStateStore.hh"
+#include "Link.hh"
+#include "Model.hh"
+#include "World.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, AttachDetach)
+{
+  EntityStateStore store;
+  EXPECT_EQ(0u, store.Size());
+
+  Model model;
+  math::Pose3d pose(1, 2, 3, 0, 0, 0.5);
+  model.SetPose(pose);
+  model.SetLinearVelocity(math::Vector3d(1, 0, 0));
+  model.SetAngularVelocity(math::Vector3d(0, 0, 1));
+  model.SetStatic(true);
+  model.ResetPoseDirty();
+  EXPECT_EQ(nullptr, model.GetStateStore());
+
+  // the state is moved to the store
+  model.AttachState(&store);
+  EXPECT_EQ(&store, model.GetStateStore());
+  ASSERT_EQ(1u, store.Size());
+  EXPECT_EQ(pose.Pos(), store.position[0]);
+  EXPECT_EQ(pose.Rot(), store.rotation[0]);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), store.linearVelocity[0]);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), store.angularVelocity[0]);
+  EXPECT_TRUE(store.isStatic[0]);
+
+  // the pose of an entity new to the store is dirty
+  EXPECT_TRUE(store.poseDirty[0]);
+  store.ResetPoseDirty();
+
+  // the entity reads and writes the store
+  store.position[0] = math::Vector3d(4, 5, 6);
+  EXPECT_EQ(math::Vector3d(4, 5, 6), model.GetPose().Pos());
+  model.SetStatic(false);
+  EXPECT_FALSE(store.isStatic[0]);
+  model.SetPose(pose);
+  EXPECT_EQ(pose.Pos(), store.position[0]);
+  EXPECT_TRUE(model.PoseDirty());
+  EXPECT_TRUE(store.poseDirty[0]);
+  store.ResetPoseDirty();
+  EXPECT_FALSE(model.PoseDirty());
+
+  // links added to the model share its store, nested models do not
+  Entity &link = model.AddLink();
+  EXPECT_EQ(&store, link.GetStateStore());
+  Entity &nested = model.AddModel();
+  EXPECT_EQ(nullptr, nested.GetStateStore());
+  EXPECT_EQ(2u, store.Size());
+
+  // the state is moved back out of the store
+  model.SetLinearVelocity(math::Vector3d(2, 0, 0));
+  link.SetAngularVelocity(math::Vector3d(0, 1, 0));
+  model.DetachState();
+  EXPECT_EQ(nullptr, model.GetStateStore());
+  EXPECT_EQ(nullptr, link.GetStateStore());
+  EXPECT_EQ(0u, store.Size());
+  EXPECT_EQ(pose, model.GetPose());
+  EXPECT_EQ(math::Vector3d(2, 0, 0), model.GetLinearVelocity());
+  EXPECT_EQ(math::Vector3d(0, 0, 1), model.GetAngularVelocity());
+  EXPECT_EQ(math::Vector3d(0, 1, 0), link.GetAngularVelocity());
+  EXPECT_FALSE(model.GetStatic());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, Remove)
+{
+  EntityStateStore store;
+  Model model1;
+  Model model2;
+  Model model3;
+  model1.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  model2.SetPose(math::Pose3d(2, 0, 0, 0, 0, 0));
+  model3.SetPose(math::Pose3d(3, 0, 0, 0, 0, 0));
+  model1.AttachState(&store);
+  model2.AttachState(&store);
+  model3.AttachState(&store);
+  EXPECT_EQ(3u, store.Size());
+
+  // the last state is moved into the hole
+  model1.DetachState();
+  EXPECT_EQ(2u, store.Size());
+  EXPECT_EQ(&model3, store.entities[0]);
+  EXPECT_EQ(math::Pose3d(3, 0, 0, 0, 0, 0), model3.GetPose());
+  model3.SetPose(math::Pose3d(4, 0, 0, 0, 0, 0));
+  EXPECT_EQ(math::Vector3d(4, 0, 0), store.position[0]);
+  EXPECT_EQ(math::Pose3d(2, 0, 0, 0, 0, 0), model2.GetPose());
+
+  // destroying an attached entity removes its state
+  {
+    Model model4;
+    model4.AttachState(&store);
+    EXPECT_EQ(3u, store.Size());
+  }
+  EXPECT_EQ(2u, store.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, Move)
+{
+  EntityStateStore store;
+  Entity entity1;
+  Entity entity2;
+  entity1.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  entity2.SetPose(math::Pose3d(2, 0, 0, 0, 0, 0));
+  entity1.AttachState(&store);
+  entity2.AttachState(&store);
+  std::size_t id1 = entity1.GetId();
+
+  // the moved-to entity takes over the slot of the moved-from entity
+  Entity moved(std::move(entity1));
+  EXPECT_EQ(2u, store.Size());
+  EXPECT_EQ(&moved, store.entities[0]);
+  EXPECT_EQ(id1, moved.GetId());
+
+  // the state of the assigned-to entity is released
+  entity2 = std::move(moved);
+  EXPECT_EQ(1u, store.Size());
+  EXPECT_EQ(&entity2, store.entities[0]);
+  EXPECT_EQ(id1, entity2.GetId());
+  EXPECT_EQ(math::Pose3d(1, 0, 0, 0, 0, 0), entity2.GetPose());
+  entity2.SetPose(math::Pose3d(3, 0, 0, 0, 0, 0));
+  EXPECT_EQ(math::Vector3d(3, 0, 0), store.position[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, Integrate)
+{
+  EntityStateStore store;
+  Model model;
+  Model modelStill;
+  Model modelRef;
+  for (Model *m : {&model, &modelStill, &modelRef})
+    m->SetPose(math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+  model.SetLinearVelocity(math::Vector3d(1, 2, 3));
+  model.SetAngularVelocity(math::Vector3d(0.1, 0, 0.5));
+  modelRef.SetLinearVelocity(math::Vector3d(1, 2, 3));
+  modelRef.SetAngularVelocity(math::Vector3d(0.1, 0, 0.5));
+  model.AttachState(&store);
+  modelStill.AttachState(&store);
+  store.ResetPoseDirty();
+
+  // integrating in the store matches integrating a standalone entity
+  for (int i = 0; i < 10; ++i)
+  {
+    store.Integrate(0.1, 0u, store.Size());
+    modelRef.UpdatePose(0.1);
+  }
+  EXPECT_EQ(modelRef.GetPose(), model.GetPose());
+  EXPECT_TRUE(model.PoseDirty());
+
+  // entities that do not move are not marked dirty
+  EXPECT_EQ(math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3), modelStill.GetPose());
+  EXPECT_FALSE(modelStill.PoseDirty());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, World)
+{
+  std::shared_ptr<Entity> modelPtr;
+  {
+    World world;
+    world.SetTimeStep(0.1);
+    Model &model = static_cast<Model &>(world.AddModel());
+    Entity &link = model.AddLink();
+    model.SetLinearVelocity(math::Vector3d(1, 0, 0));
+    link.SetLinearVelocity(math::Vector3d(0, 1, 0));
+    world.Step();
+    EXPECT_EQ(math::Vector3d(0.1, 0, 0), model.GetPose().Pos());
+    EXPECT_EQ(math::Vector3d(0, 0.1, 0), link.GetPose().Pos());
+    modelPtr = world.GetChildren().begin()->second;
+
+    // removed models are not stepped anymore
+    Entity &removed = world.AddModel();
+    removed.SetLinearVelocity(math::Vector3d(1, 0, 0));
+    std::shared_ptr<Entity> removedPtr =
+        world.GetChildren().rbegin()->second;
+    EXPECT_TRUE(world.RemoveChildById(removed.GetId()));
+    EXPECT_EQ(nullptr, removedPtr->GetStateStore());
+    world.Step();
+    EXPECT_EQ(math::Vector3d::Zero, removedPtr->GetPose().Pos());
+  }
+
+  // models keep their state when the world is destroyed
+  EXPECT_EQ(nullptr, modelPtr->GetStateStore());
+  EXPECT_EQ(math::Vector3d(0.2, 0, 0), modelPtr->GetPose().Pos());
+  EXPECT_EQ(math::Vector3d(1, 0, 0), modelPtr->GetLinearVelocity());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, WorldPose)
+{
+  World world;
+  world.SetTimeStep(0.1);
+  Model &model = static_cast<Model &>(world.AddModel());
+  Link &link = static_cast<Link &>(model.AddLink());
+  Entity &collision = link.AddCollision();
+  link.SetPose(math::Pose3d(0, 0, 1, 0, 0, 0));
+  EXPECT_EQ(math::Pose3d(0, 0, 1, 0, 0, 0), collision.GetWorldPose());
+
+  // the cached world poses are updated when the states are integrated
+  model.SetLinearVelocity(math::Vector3d(1, 0, 0));
+  world.Step();
+  EXPECT_EQ(math::Pose3d(0.1, 0, 1, 0, 0, 0), collision.GetWorldPose());
+  link.SetLinearVelocity(math::Vector3d(0, 1, 0));
+  world.Step();
+  EXPECT_EQ(math::Pose3d(0.2, 0.1, 1, 0, 0, 0), collision.GetWorldPose());
+
+  // and when a single entity is updated
+  model.SetLinearVelocity(math::Vector3d::Zero);
+  link.UpdatePose(0.1);
+  EXPECT_EQ(math::Pose3d(0.2, 0.2, 1, 0, 0, 0), collision.GetWorldPose());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, DirtyEntityIds)
+{
+  EntityStateStore store;
+  Model model1;
+  Model model2;
+  Model model3;
+  Model model4;
+  for (Model *m : {&model1, &model2, &model3, &model4})
+    m->AttachState(&store);
+
+  // new entities are dirty
+  std::vector<std::size_t> ids;
+  store.DirtyEntityIds(ids);
+  EXPECT_EQ(4u, ids.size());
+  store.ResetPoseDirty();
+  store.DirtyEntityIds(ids);
+  EXPECT_TRUE(ids.empty());
+
+  // only the entities that moved or had their pose set are listed, once
+  model2.SetLinearVelocity(math::Vector3d(1, 0, 0));
+  store.Integrate(0.1, 0u, store.Size());
+  store.Integrate(0.1, 0u, store.Size());
+  model4.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  model4.SetPose(math::Pose3d(2, 0, 0, 0, 0, 0));
+  store.DirtyEntityIds(ids);
+  EXPECT_EQ((std::vector<std::size_t>{model2.GetId(), model4.GetId()}), ids);
+
+  // resetting a single entity removes it from the list
+  model2.ResetPoseDirty();
+  store.DirtyEntityIds(ids);
+  EXPECT_EQ(std::vector<std::size_t>{model4.GetId()}, ids);
+
+  // the list follows the states moved by a removal
+  model1.SetPose(math::Pose3d(3, 0, 0, 0, 0, 0));
+  model1.DetachState();
+  EXPECT_EQ(&model4, store.entities[0]);
+  store.DirtyEntityIds(ids);
+  EXPECT_EQ(std::vector<std::size_t>{model4.GetId()}, ids);
+  store.ResetPoseDirty();
+  EXPECT_FALSE(model4.PoseDirty());
+  store.DirtyEntityIds(ids);
+  EXPECT_TRUE(ids.empty());
+
+  // setting the pose of a nested model, which is not in the store, marks
+  // its top level model dirty
+  Entity &nested = model2.AddModel();
+  Entity &nestedLink = static_cast<Model &>(nested).AddLink();
+  EXPECT_EQ(nullptr, nestedLink.GetStateStore());
+  store.ResetPoseDirty();
+  nestedLink.SetPose(math::Pose3d(0, 1, 0, 0, 0, 0));
+  store.DirtyEntityIds(ids);
+  EXPECT_EQ(std::vector<std::size_t>{model2.GetId()}, ids);
+  EXPECT_EQ(0u, model2.GetIdleSteps());
+}
+
+/////////////////////////////////////////////////
+TEST(EntityStateStore, IdleSteps)
+{
+  EntityStateStore store;
+  Model model;
+  EXPECT_EQ(0u, model.GetIdleSteps());
+  model.AttachState(&store);
+  Entity &link = model.AddLink();
+  store.ResetPoseDirty();
+
+  // entities that do not move count the steps they stay idle
+  for (unsigned int i = 1u; i <= 3u; ++i)
+  {
+    store.Integrate(0.1, 0u, store.Size());
+    store.ResetPoseDirty();
+    EXPECT_EQ(i, model.GetIdleSteps());
+    EXPECT_EQ(i, link.GetIdleSteps());
+  }
+
+  // a moving link keeps its model awake
+  link.SetLinearVelocity(math::Vector3d(1, 0, 0));
+  store.Integrate(0.1, 0u, store.Size());
+  store.ResetPoseDirty();
+  EXPECT_EQ(0u, link.GetIdleSteps());
+  EXPECT_EQ(0u, model.GetIdleSteps());
+  link.SetLinearVelocity(math::Vector3d::Zero);
+  store.Integrate(0.1, 0u, store.Size());
+  store.ResetPoseDirty();
+  EXPECT_EQ(1u, model.GetIdleSteps());
+
+  // setting the pose or waking up resets the count
+  model.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  EXPECT_EQ(0u, model.GetIdleSteps());
+  store.Integrate(0.1, 0u, store.Size());
+  store.ResetPoseDirty();
+  store.Integrate(0.1, 0u, store.Size());
+  EXPECT_EQ(1u, model.GetIdleSteps());
+  model.Wake();
+  EXPECT_EQ(0u, model.GetIdleSteps());
+}
@@ -44,34 +44,6 @@ class GZ_PHYSICS_TPELIB_VISIBLE Link : public Entity
   /// \brief Add a collision
   /// \return Newly created Collision
   public: Entity &AddCollision();
-
-  /// \brief Set the linear velocity of link relative to parent
-  /// \param[in] _velocity linear velocity in meters per second
-  public: void SetLinearVelocity(const math::Vector3d &_velocity);
-
-  /// \brief Get the linear velocity of link relative to parent
-  /// \return linear velocity of link in meters per second
-  public: math::Vector3d GetLinearVelocity() const;
-
-  /// \brief Set the angular velocity of link relative to parent
-  /// \param[in] _velocity angular velocity in radians per second
-  public: void SetAngularVelocity(const math::Vector3d &_velocity);
-
-  /// \brief Get the angular velocity of link relative to parent
-  /// \return angular velocity in radians per second
-  public: math::Vector3d GetAngularVelocity() const;
-
-  /// \brief Update the pose of the entity
-  /// \param[in] _timeStep current world timestep in seconds
-  public: virtual void UpdatePose(double _timeStep);
-
-  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
-  /// \brief linear velocity of link
-  protected: math::Vector3d linearVelocity;
-
-  /// \brief angular velocity of link
-  protected: math::Vector3d angularVelocity;
-  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
 };
 
 }
@@ -15,11 +15,10 @@
  *
 */
 
+#include <algorithm>
 #include <set>
 #include <string>
 
-#include <gz/common/Profiler.hh>
-
 #include <gz/math/Pose3.hh>
 #include <gz/math/Vector3.hh>
 
@@ -76,13 +75,13 @@ Entity &Model::AddLink()
     this->dataPtr->canonicalLinkId = linkId;
   }
 
-  const auto[it, success]  = this->GetChildren().insert(
-      {linkId, std::make_shared<Link>(linkId)});
+  Entity &link = this->AddChild(std::make_shared<Link>(linkId));
   this->dataPtr->linkIds.push_back(linkId);
 
-  it->second->SetParent(this);
+  // links are stepped with the model they belong to
+  link.AttachState(this->GetStateStore());
   this->ChildrenChanged();
-  return *it->second.get();
+  return link;
 }
 
 //////////////////////////////////////////////////
@@ -95,13 +94,11 @@ std::size_t Model::GetLinkCount() const
 Entity &Model::AddModel()
 {
   std::size_t modelId = Entity::GetNextId();
-  const auto[it, success]  = this->GetChildren().insert(
-      {modelId, std::make_shared<Model>(modelId)});
+  Entity &model = this->AddChild(std::make_shared<Model>(modelId));
   this->dataPtr->nestedModelIds.push_back(modelId);
 
-  it->second->SetParent(this);
   this->ChildrenChanged();
-  return *it->second.get();
+  return model;
 }
 
 //////////////////////////////////////////////////
@@ -149,47 +146,6 @@ Entity &Model::GetCanonicalLink()
   return kNullEntity;
 }
 
-//////////////////////////////////////////////////
-void Model::SetLinearVelocity(const math::Vector3d &_velocity)
-{
-  this->linearVelocity = _velocity;
-}
-
-//////////////////////////////////////////////////
-math::Vector3d Model::GetLinearVelocity() const
-{
-  GZ_PROFILE("tpelib::Model::GetLinearVelocity");
-  return this->linearVelocity;
-}
-
-//////////////////////////////////////////////////
-void Model::SetAngularVelocity(const math::Vector3d &_velocity)
-{
-  this->angularVelocity = _velocity;
-}
-
-//////////////////////////////////////////////////
-math::Vector3d Model::GetAngularVelocity() const
-{
-  GZ_PROFILE("tpelib::Model::GetAngularVelocity");
-  return this->angularVelocity;
-}
-
-//////////////////////////////////////////////////
-void Model::UpdatePose(double _timeStep)
-{
-  GZ_PROFILE("tpelib::Model::UpdatePose");
-
-  if (this->linearVelocity == math::Vector3d::Zero &&
-      this->angularVelocity == math::Vector3d::Zero)
-    return;
-
-  math::Pose3d currentPose = this->GetPose();
-  math::Pose3d nextPose(
-    currentPose.Pos() + this->linearVelocity * _timeStep,
-    currentPose.Rot().Integrate(this->angularVelocity, _timeStep));
-  this->SetPose(nextPose);
-}
 
 //////////////////////////////////////////////////
 bool Model::RemoveModelById(std::size_t _id)
@@ -231,6 +187,28 @@ bool Model::RemoveChildByName(const std::string &_name)
   return this->RemoveChildEntityBasedOnType(&ent);
 }
 
+//////////////////////////////////////////////////
+std::size_t Model::RemoveChildrenById(const std::vector<std::size_t> &_ids)
+{
+  std::size_t removed = Entity::RemoveChildrenById(_ids);
+  if (removed == 0u)
+    return removed;
+
+  // drop the ids of the removed children in one pass
+  const auto &children = this->GetChildren();
+  auto isRemoved = [&children](std::size_t _id)
+  {
+    return children.find(_id) == children.end();
+  };
+  auto &linkIds = this->dataPtr->linkIds;
+  linkIds.erase(std::remove_if(linkIds.begin(), linkIds.end(), isRemoved),
+      linkIds.end());
+  auto &modelIds = this->dataPtr->nestedModelIds;
+  modelIds.erase(std::remove_if(modelIds.begin(), modelIds.end(), isRemoved),
+      modelIds.end());
+  return removed;
+}
+
 //////////////////////////////////////////////////
 bool Model::RemoveChildEntityBasedOnType(const Entity *_ent)
 {
@@ -68,26 +68,6 @@ class GZ_PHYSICS_TPELIB_VISIBLE Model : public Entity
   /// \return Entity the canonical (first) link
   public: Entity &GetCanonicalLink();
 
-  /// \brief Set the linear velocity of model relative to parent
-  /// \param[in] _velocity linear velocity in meters per second
-  public: void SetLinearVelocity(const math::Vector3d &_velocity);
-
-  /// \brief Get the linear velocity of model relative to parent
-  /// \return linear velocity of model in meters per second
-  public: math::Vector3d GetLinearVelocity() const;
-
-  /// \brief Set the angular velocity of model relative to parent
-  /// \param[in] _velocity angular velocity from world in radians per second
-  public: void SetAngularVelocity(const math::Vector3d &_velocity);
-
-  /// \brief Get the angular velocity of model relative to parent
-  /// \return angular velocity in radians per second
-  public: math::Vector3d GetAngularVelocity() const;
-
-  /// \brief Update the pose of the entity
-  /// \param[in] _timeStep current world timestep in seconds
-  public: virtual void UpdatePose(double _timeStep);
-
   /// \brief Removes a child entity (either a link or model) from the
   /// appropriate child entity containers
   /// \param[in] _ent Pointer to entity
@@ -103,13 +83,11 @@ class GZ_PHYSICS_TPELIB_VISIBLE Model : public Entity
   /// \return True if child entity was removed, false otherwise
   public: bool RemoveChildByName(const std::string &_name) override;
 
-  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
-  /// \brief linear velocity of model
-  protected: math::Vector3d linearVelocity;
-
-  /// \brief angular velocity of model
-  protected: math::Vector3d angularVelocity;
-  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+  /// \brief Remove many child entities (links or models) at once
+  /// \param[in] _ids Ids of child entities to remove
+  /// \return Number of child entities removed
+  public: std::size_t RemoveChildrenById(
+      const std::vector<std::size_t> &_ids) override;
 
   /// \brief Remove a model entity by id
   /// \param[in] _id Id of model entity to remove
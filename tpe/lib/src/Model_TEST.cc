@@ -17,6 +17,10 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "Collision.hh"
 #include "Link.hh"
 #include "Model.hh"
@@ -26,6 +30,12 @@ using namespace gz;
 using namespace physics;
 using namespace tpelib;
 
+/// \brief Model that can add existing entities as children
+class ChildModel : public Model
+{
+  public: using Model::AddChild;
+};
+
 /////////////////////////////////////////////////
 TEST(Model, BasicAPI)
 {
@@ -344,3 +354,108 @@ TEST(Model, NestedModel)
   m2->SetCanonicalLink();
   EXPECT_EQ(linkEnt2.GetId(), m2->GetCanonicalLink().GetId());
 }
+
+/////////////////////////////////////////////////
+TEST(Model, WorldPose)
+{
+  // chain of nested models with a link and a collision at the end
+  Model m0;
+  Model *m1 = static_cast<Model *>(&m0.AddModel());
+  Model *m2 = static_cast<Model *>(&m1->AddModel());
+  Link *link = static_cast<Link *>(&m2->AddLink());
+  Entity &collision = link->AddCollision();
+  m0.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  m1->SetPose(math::Pose3d(0, 1, 0, 0, 0, GZ_PI * 0.5));
+  m2->SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  collision.SetPose(math::Pose3d(0, 0, 1, 0, 0, 0));
+
+  math::Pose3d expected = m0.GetPose() * m1->GetPose() * m2->GetPose() *
+      link->GetPose() * collision.GetPose();
+  EXPECT_EQ(expected, collision.GetWorldPose());
+  EXPECT_EQ(expected, collision.GetWorldPose());
+  EXPECT_EQ(math::Pose3d(1, 2, 1, 0, 0, GZ_PI * 0.5),
+      collision.GetWorldPose());
+
+  // the cached world poses of the descendants are updated when the pose
+  // of an ancestor changes
+  m1->SetPose(math::Pose3d(0, 1, 0, 0, 0, 0));
+  EXPECT_EQ(math::Pose3d(2, 1, 1, 0, 0, 0), collision.GetWorldPose());
+  EXPECT_EQ(math::Pose3d(2, 1, 0, 0, 0, 0), link->GetWorldPose());
+  m0.SetPose(math::Pose3d(0, 0, 2, 0, 0, 0));
+  EXPECT_EQ(math::Pose3d(1, 1, 2, 0, 0, 0), m2->GetWorldPose());
+  EXPECT_EQ(math::Pose3d(1, 1, 3, 0, 0, 0), collision.GetWorldPose());
+
+  // and when the entity itself moves
+  link->SetPose(math::Pose3d(0, 0, 1, 0, 0, 0));
+  EXPECT_EQ(math::Pose3d(1, 1, 4, 0, 0, 0), collision.GetWorldPose());
+  EXPECT_EQ(math::Pose3d(0, 1, 2, 0, 0, 0), m1->GetWorldPose());
+}
+
+/////////////////////////////////////////////////
+TEST(Model, ChildLookup)
+{
+  ChildModel model;
+  std::vector<Entity *> links;
+  for (int i = 0; i < 10; ++i)
+  {
+    Entity &link = model.AddLink();
+    link.SetName("link_" + std::to_string(i));
+    links.push_back(&link);
+  }
+  ASSERT_EQ(10u, model.GetChildCount());
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ(links[i], &model.GetChildByIndex(i));
+    EXPECT_EQ(links[i], &model.GetChildByName("link_" + std::to_string(i)));
+  }
+  EXPECT_EQ(kNullEntityId, model.GetChildByIndex(10).GetId());
+  EXPECT_EQ(kNullEntityId, model.GetChildByName("link_10").GetId());
+
+  // renamed children are found by their new name only
+  links[3]->SetName("renamed");
+  EXPECT_EQ(links[3], &model.GetChildByName("renamed"));
+  EXPECT_EQ(kNullEntityId, model.GetChildByName("link_3").GetId());
+
+  // the child with the smallest id is returned for duplicate names
+  links[7]->SetName("renamed");
+  EXPECT_EQ(links[3], &model.GetChildByName("renamed"));
+  links[3]->SetName("link_3");
+  EXPECT_EQ(links[7], &model.GetChildByName("renamed"));
+
+  // removed children are not found anymore and the indices are shifted
+  EXPECT_TRUE(model.RemoveChildByName("link_5"));
+  EXPECT_EQ(kNullEntityId, model.GetChildByName("link_5").GetId());
+  EXPECT_EQ(links[6], &model.GetChildByIndex(5));
+  EXPECT_TRUE(model.RemoveChildById(links[0]->GetId()));
+  EXPECT_EQ(links[1], &model.GetChildByIndex(0));
+  EXPECT_EQ(8u, model.GetChildCount());
+  EXPECT_FALSE(model.RemoveChildByName("link_5"));
+
+  // children inserted out of id order are found
+  auto link = std::make_shared<Link>(0u);
+  link->SetName("first");
+  EXPECT_EQ(link.get(), &model.AddChild(link));
+  EXPECT_EQ(link.get(), &model.GetChildByIndex(0));
+  EXPECT_EQ(link.get(), &model.GetChildByName("first"));
+  EXPECT_EQ(links[9], &model.GetChildByName("link_9"));
+}
+
+/////////////////////////////////////////////////
+TEST(Model, RemoveChildren)
+{
+  Model model;
+  std::vector<std::size_t> linkIds;
+  for (int i = 0; i < 4; ++i)
+    linkIds.push_back(model.AddLink().GetId());
+  Entity &nested = model.AddModel();
+  ASSERT_EQ(4u, model.GetLinkCount());
+  ASSERT_EQ(1u, model.GetModelCount());
+
+  EXPECT_EQ(3u, model.RemoveChildrenById(
+      {linkIds[0], linkIds[2], nested.GetId()}));
+  EXPECT_EQ(2u, model.GetChildCount());
+  EXPECT_EQ(2u, model.GetLinkCount());
+  EXPECT_EQ(0u, model.GetModelCount());
+  EXPECT_EQ(linkIds[1], model.GetChildByIndex(0).GetId());
+  EXPECT_EQ(linkIds[3], model.GetChildByIndex(1).GetId());
+}
@@ -0,0 +1,702 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "NarrowPhase.hh"
+#include "Utils.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+namespace {
+
+/// \brief Length below which vectors are considered zero
+const double kEpsilon = 1e-9;
+
+/// \brief Maximum number of GJK iterations
+const int kMaxGjkIterations = 64;
+
+/// \brief Number of ternary search iterations used to find the point of a
+/// segment closest to a box
+const int kSegmentSearchIterations = 48;
+
+/// \brief Simplex used by GJK. The newest point is first.
+using Simplex = std::array<math::Vector3d, 4>;
+
+//////////////////////////////////////////////////
+/// \brief Whether a primitive is a segment (or point) inflated by a radius
+bool isCore(const ConvexPrimitive &_p)
+{
+  return _p.type == ShapeType::SPHERE || _p.type == ShapeType::CAPSULE;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the world end points of the core segment of a sphere or
+/// capsule
+void coreSegment(const ConvexPrimitive &_p, math::Vector3d &_a,
+    math::Vector3d &_b)
+{
+  math::Vector3d axis;
+  if (_p.type == ShapeType::CAPSULE)
+    axis = _p.pose.Rot().RotateVector(math::Vector3d(0, 0, _p.size.Z()));
+  _a = _p.pose.Pos() - axis;
+  _b = _p.pose.Pos() + axis;
+}
+
+//////////////////////////////////////////////////
+/// \brief Support point of a primitive in its own frame
+math::Vector3d localSupport(const ConvexPrimitive &_p,
+    const math::Vector3d &_d)
+{
+  const math::Vector3d &s = _p.size;
+  switch (_p.type)
+  {
+    case ShapeType::BOX:
+      return math::Vector3d(
+          _d.X() >= 0 ? s.X() : -s.X(),
+          _d.Y() >= 0 ? s.Y() : -s.Y(),
+          _d.Z() >= 0 ? s.Z() : -s.Z());
+    case ShapeType::SPHERE:
+    case ShapeType::CAPSULE:
+    {
+      math::Vector3d p;
+      if (_p.type == ShapeType::CAPSULE)
+        p.Z(_d.Z() >= 0 ? s.Z() : -s.Z());
+      double len = _d.Length();
+      if (len > kEpsilon)
+        p += _d * (s.X() / len);
+      return p;
+    }
+    case ShapeType::CYLINDER:
+    {
+      math::Vector3d p(0, 0, _d.Z() >= 0 ? s.Z() : -s.Z());
+      double len = std::hypot(_d.X(), _d.Y());
+      if (len > kEpsilon)
+      {
+        p.X(_d.X() * s.X() / len);
+        p.Y(_d.Y() * s.X() / len);
+      }
+      return p;
+    }
+    case ShapeType::ELLIPSOID:
+    {
+      math::Vector3d scaled(_d.X() * s.X(), _d.Y() * s.Y(), _d.Z() * s.Z());
+      double len = scaled.Length();
+      if (len <= kEpsilon)
+        return math::Vector3d(s.X(), 0, 0);
+      return math::Vector3d(s.X() * scaled.X(), s.Y() * scaled.Y(),
+          s.Z() * scaled.Z()) / len;
+    }
+    case ShapeType::MESH:
+    {
+      math::Vector3d p;
+      double best = -std::numeric_limits<double>::max();
+      for (const math::Vector3d &v : *_p.hull)
+      {
+        double dist = v.Dot(_d);
+        if (dist > best)
+        {
+          best = dist;
+          p = v;
+        }
+      }
+      return p;
+    }
+    default:
+      return math::Vector3d::Zero;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Support point of a primitive in world frame
+math::Vector3d support(const ConvexPrimitive &_p, const math::Vector3d &_d)
+{
+  math::Vector3d local =
+      localSupport(_p, _p.pose.Rot().RotateVectorReverse(_d));
+  return _p.pose.Pos() + _p.pose.Rot().RotateVector(local);
+}
+
+//////////////////////////////////////////////////
+/// \brief Support point of the Minkowski difference _p1 - _p2
+math::Vector3d minkowskiSupport(const ConvexPrimitive &_p1,
+    const ConvexPrimitive &_p2, const math::Vector3d &_d)
+{
+  return support(_p1, _d) - support(_p2, -_d);
+}
+
+//////////////////////////////////////////////////
+/// \brief Reduce a line simplex and update the search direction
+void updateLine(Simplex &_s, int &_n, math::Vector3d &_d)
+{
+  math::Vector3d ab = _s[1] - _s[0];
+  math::Vector3d ao = -_s[0];
+  if (ab.Dot(ao) > 0)
+  {
+    _n = 2;
+    _d = ab.Cross(ao).Cross(ab);
+  }
+  else
+  {
+    _n = 1;
+    _d = ao;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Reduce a triangle simplex and update the search direction
+void updateTriangle(Simplex &_s, int &_n, math::Vector3d &_d)
+{
+  math::Vector3d a = _s[0];
+  math::Vector3d b = _s[1];
+  math::Vector3d c = _s[2];
+  math::Vector3d ab = b - a;
+  math::Vector3d ac = c - a;
+  math::Vector3d ao = -a;
+  math::Vector3d abc = ab.Cross(ac);
+
+  if (abc.SquaredLength() <= kEpsilon * kEpsilon)
+  {
+    // Degenerate triangle
+    _n = 2;
+    updateLine(_s, _n, _d);
+    return;
+  }
+
+  if (abc.Cross(ac).Dot(ao) > 0)
+  {
+    if (ac.Dot(ao) > 0)
+    {
+      _s[1] = c;
+      _n = 2;
+      _d = ac.Cross(ao).Cross(ac);
+      return;
+    }
+    _n = 2;
+    updateLine(_s, _n, _d);
+    return;
+  }
+
+  if (ab.Cross(abc).Dot(ao) > 0)
+  {
+    _n = 2;
+    updateLine(_s, _n, _d);
+    return;
+  }
+
+  _n = 3;
+  if (abc.Dot(ao) > 0)
+  {
+    _d = abc;
+  }
+  else
+  {
+    _s[1] = c;
+    _s[2] = b;
+    _d = -abc;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Reduce the simplex to its feature closest to the origin and
+/// update the search direction
+/// \return True if the simplex contains the origin
+bool updateSimplex(Simplex &_s, int &_n, math::Vector3d &_d)
+{
+  if (_n == 2)
+  {
+    updateLine(_s, _n, _d);
+  }
+  else if (_n == 3)
+  {
+    updateTriangle(_s, _n, _d);
+  }
+  else
+  {
+    const math::Vector3d a = _s[0];
+    const math::Vector3d ao = -a;
+    const std::array<std::array<int, 3>, 3> faces =
+        {{{1, 2, 3}, {2, 3, 1}, {3, 1, 2}}};
+    bool outside = false;
+    for (const auto &f : faces)
+    {
+      const math::Vector3d x = _s[f[0]];
+      const math::Vector3d y = _s[f[1]];
+      math::Vector3d normal = (x - a).Cross(y - a);
+      if (normal.Dot(_s[f[2]] - a) > 0)
+        normal = -normal;
+      if (normal.Dot(ao) > 0)
+      {
+        _s[1] = x;
+        _s[2] = y;
+        _n = 3;
+        updateTriangle(_s, _n, _d);
+        outside = true;
+        break;
+      }
+    }
+    if (!outside)
+      return true;
+  }
+  return _d.SquaredLength() <= kEpsilon * kEpsilon;
+}
+
+//////////////////////////////////////////////////
+/// \brief GJK overlap test
+bool gjkIntersect(const ConvexPrimitive &_p1, const ConvexPrimitive &_p2)
+{
+  math::Vector3d d = _p2.pose.Pos() - _p1.pose.Pos();
+  if (d.SquaredLength() <= kEpsilon * kEpsilon)
+    d = math::Vector3d::UnitX;
+
+  Simplex s;
+  int n = 1;
+  s[0] = minkowskiSupport(_p1, _p2, d);
+  d = -s[0];
+
+  for (int i = 0; i < kMaxGjkIterations; ++i)
+  {
+    if (d.SquaredLength() <= kEpsilon * kEpsilon)
+      return true;
+
+    math::Vector3d a = minkowskiSupport(_p1, _p2, d);
+    if (a.Dot(d) < 0)
+      return false;
+
+    for (int k = n; k > 0; --k)
+      s[k] = s[k - 1];
+    s[0] = a;
+    ++n;
+
+    if (updateSimplex(s, n, d))
+      return true;
+  }
+  // Not converged, the primitives are touching
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Closest points between segments [_p1, _q1] and [_p2, _q2]
+void closestSegmentPoints(const math::Vector3d &_p1, const math::Vector3d &_q1,
+    const math::Vector3d &_p2, const math::Vector3d &_q2,
+    math::Vector3d &_c1, math::Vector3d &_c2)
+{
+  math::Vector3d d1 = _q1 - _p1;
+  math::Vector3d d2 = _q2 - _p2;
+  math::Vector3d r = _p1 - _p2;
+  double a = d1.SquaredLength();
+  double e = d2.SquaredLength();
+  double f = d2.Dot(r);
+  double s = 0.0;
+  double t = 0.0;
+
+  if (a <= kEpsilon && e <= kEpsilon)
+  {
+    // Both segments are points
+  }
+  else if (a <= kEpsilon)
+  {
+    t = std::clamp(f / e, 0.0, 1.0);
+  }
+  else
+  {
+    double c = d1.Dot(r);
+    if (e <= kEpsilon)
+    {
+      s = std::clamp(-c / a, 0.0, 1.0);
+    }
+    else
+    {
+      double b = d1.Dot(d2);
+      double denom = a * e - b * b;
+      if (denom > kEpsilon)
+        s = std::clamp((b * f - c * e) / denom, 0.0, 1.0);
+      t = (b * s + f) / e;
+      if (t < 0.0)
+      {
+        t = 0.0;
+        s = std::clamp(-c / a, 0.0, 1.0);
+      }
+      else if (t > 1.0)
+      {
+        t = 1.0;
+        s = std::clamp((b - c) / a, 0.0, 1.0);
+      }
+    }
+  }
+  _c1 = _p1 + d1 * s;
+  _c2 = _p2 + d2 * t;
+}
+
+//////////////////////////////////////////////////
+/// \brief Closest point of a box to a point, in world frame
+math::Vector3d closestBoxPoint(const ConvexPrimitive &_box,
+    const math::Vector3d &_point)
+{
+  math::Vector3d local =
+      _box.pose.Rot().RotateVectorReverse(_point - _box.pose.Pos());
+  local.X(std::clamp(local.X(), -_box.size.X(), _box.size.X()));
+  local.Y(std::clamp(local.Y(), -_box.size.Y(), _box.size.Y()));
+  local.Z(std::clamp(local.Z(), -_box.size.Z(), _box.size.Z()));
+  return _box.pose.Pos() + _box.pose.Rot().RotateVector(local);
+}
+
+//////////////////////////////////////////////////
+/// \brief Contact between two spheres or capsules
+bool collideCores(const ConvexPrimitive &_p1, const ConvexPrimitive &_p2,
+    PrimitiveContact &_contact)
+{
+  math::Vector3d a1, b1, a2, b2, c1, c2;
+  coreSegment(_p1, a1, b1);
+  coreSegment(_p2, a2, b2);
+  closestSegmentPoints(a1, b1, a2, b2, c1, c2);
+
+  double r1 = _p1.size.X();
+  double r2 = _p2.size.X();
+  math::Vector3d diff = c1 - c2;
+  double dist = diff.Length();
+  if (dist > r1 + r2)
+    return false;
+
+  math::Vector3d normal;
+  if (dist > kEpsilon)
+    normal = diff / dist;
+  else
+  {
+    // Cores intersect, pick a direction that separates the centers
+    normal = _p1.pose.Pos() - _p2.pose.Pos();
+    if (normal.Length() > kEpsilon)
+      normal.Normalize();
+    else
+      normal = math::Vector3d::UnitZ;
+  }
+
+  _contact.normal = normal;
+  _contact.depth = r1 + r2 - dist;
+  _contact.point = ((c1 - normal * r1) + (c2 + normal * r2)) * 0.5;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Contact between a sphere or capsule and a box, computed from
+/// the closest points of the core segment and the box. The normal points
+/// from the box to the core.
+/// \param[out] _resolved False if the core reaches inside the box, in
+/// which case the closest points do not define the contact
+bool collideCoreBox(const ConvexPrimitive &_core, const ConvexPrimitive &_box,
+    PrimitiveContact &_contact, bool &_resolved)
+{
+  math::Vector3d a, b;
+  coreSegment(_core, a, b);
+  math::Vector3d ab = b - a;
+
+  // The distance from a point moving along the segment to the box is convex
+  double lo = 0.0;
+  double hi = 1.0;
+  if (ab.SquaredLength() > kEpsilon * kEpsilon)
+  {
+    auto distSq = [&](double _t)
+    {
+      math::Vector3d p = a + ab * _t;
+      return (p - closestBoxPoint(_box, p)).SquaredLength();
+    };
+    for (int i = 0; i < kSegmentSearchIterations; ++i)
+    {
+      double m1 = lo + (hi - lo) / 3.0;
+      double m2 = hi - (hi - lo) / 3.0;
+      if (distSq(m1) < distSq(m2))
+        hi = m2;
+      else
+        lo = m1;
+    }
+  }
+  math::Vector3d p = a + ab * ((lo + hi) * 0.5);
+  math::Vector3d q = closestBoxPoint(_box, p);
+  math::Vector3d diff = p - q;
+  double dist = diff.Length();
+
+  _resolved = dist > kEpsilon;
+  if (!_resolved)
+    return false;
+
+  double r = _core.size.X();
+  if (dist > r)
+    return false;
+
+  _contact.normal = diff / dist;
+  _contact.depth = r - dist;
+  _contact.point = (q + (p - _contact.normal * r)) * 0.5;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the edge and face directions of a primitive in world frame
+/// \return Number of directions
+std::size_t primitiveAxes(const ConvexPrimitive &_p,
+    std::array<math::Vector3d, 3> &_axes)
+{
+  const math::Quaterniond &rot = _p.pose.Rot();
+  switch (_p.type)
+  {
+    case ShapeType::BOX:
+      _axes[0] = rot.RotateVector(math::Vector3d::UnitX);
+      _axes[1] = rot.RotateVector(math::Vector3d::UnitY);
+      _axes[2] = rot.RotateVector(math::Vector3d::UnitZ);
+      return 3;
+    case ShapeType::CAPSULE:
+    case ShapeType::CYLINDER:
+      _axes[0] = rot.RotateVector(math::Vector3d::UnitZ);
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Surface normal of a curved primitive where it faces a point, in
+/// world frame and not normalized. Zero for boxes.
+math::Vector3d facingNormal(const ConvexPrimitive &_p,
+    const math::Vector3d &_target)
+{
+  math::Vector3d u =
+      _p.pose.Rot().RotateVectorReverse(_target - _p.pose.Pos());
+  math::Vector3d n;
+  switch (_p.type)
+  {
+    case ShapeType::SPHERE:
+      n = u;
+      break;
+    case ShapeType::CAPSULE:
+      n.Set(u.X(), u.Y(),
+          u.Z() - std::clamp(u.Z(), -_p.size.Z(), _p.size.Z()));
+      break;
+    case ShapeType::CYLINDER:
+      n.Set(u.X(), u.Y(), 0);
+      break;
+    case ShapeType::ELLIPSOID:
+      n.Set(u.X() / (_p.size.X() * _p.size.X()),
+            u.Y() / (_p.size.Y() * _p.size.Y()),
+            u.Z() / (_p.size.Z() * _p.size.Z()));
+      break;
+    default:
+      return n;
+  }
+  return _p.pose.Rot().RotateVector(n);
+}
+
+//////////////////////////////////////////////////
+/// \brief Contact between any two primitives. Overlap is tested with GJK
+/// and the contact is the one of least penetration over a set of
+/// candidate separating axes.
+bool collideGeneric(const ConvexPrimitive &_p1, const ConvexPrimitive &_p2,
+    PrimitiveContact &_contact)
+{
+  if (!gjkIntersect(_p1, _p2))
+    return false;
+
+  std::array<math::Vector3d, 24> axes;
+  std::size_t count = 0;
+  auto addAxis = [&](const math::Vector3d &_v)
+  {
+    double len = _v.Length();
+    if (len > kEpsilon && count < axes.size())
+      axes[count++] = _v / len;
+  };
+
+  std::array<math::Vector3d, 3> axes1;
+  std::array<math::Vector3d, 3> axes2;
+  std::size_t count1 = primitiveAxes(_p1, axes1);
+  std::size_t count2 = primitiveAxes(_p2, axes2);
+  for (std::size_t i = 0; i < count1; ++i)
+    addAxis(axes1[i]);
+  for (std::size_t i = 0; i < count2; ++i)
+    addAxis(axes2[i]);
+  for (std::size_t i = 0; i < count1; ++i)
+  {
+    for (std::size_t j = 0; j < count2; ++j)
+      addAxis(axes1[i].Cross(axes2[j]));
+  }
+  addAxis(_p2.pose.Pos() - _p1.pose.Pos());
+  addAxis(facingNormal(_p1, _p2.pose.Pos()));
+  addAxis(facingNormal(_p2, _p1.pose.Pos()));
+  addAxis(math::Vector3d::UnitX);
+  addAxis(math::Vector3d::UnitY);
+  addAxis(math::Vector3d::UnitZ);
+
+  double depth = std::numeric_limits<double>::max();
+  math::Vector3d normal12;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const math::Vector3d &n = axes[i];
+    double max1 = support(_p1, n).Dot(n);
+    double min1 = support(_p1, -n).Dot(n);
+    double max2 = support(_p2, n).Dot(n);
+    double min2 = support(_p2, -n).Dot(n);
+
+    // Overlap when pushing the second primitive along n, and along -n
+    double overlapPos = max1 - min2;
+    double overlapNeg = max2 - min1;
+    if (overlapPos < 0 || overlapNeg < 0)
+      return false;
+    if (overlapPos < depth)
+    {
+      depth = overlapPos;
+      normal12 = n;
+    }
+    if (overlapNeg < depth)
+    {
+      depth = overlapNeg;
+      normal12 = -n;
+    }
+  }
+
+  _contact.normal = -normal12;
+  _contact.depth = depth;
+  _contact.point =
+      (support(_p1, normal12) + support(_p2, -normal12)) * 0.5;
+  return true;
+}
+
+}
+
+//////////////////////////////////////////////////
+bool convexPrimitive(Shape &_shape, const math::Pose3d &_pose,
+    ConvexPrimitive &_primitive)
+{
+  _primitive.type = _shape.GetType();
+  _primitive.pose = _pose;
+  _primitive.hull = nullptr;
+  math::Vector3d halfExtents;
+  switch (_primitive.type)
+  {
+    case ShapeType::BOX:
+      _primitive.size = static_cast<BoxShape &>(_shape).GetSize() * 0.5;
+      halfExtents = _primitive.size;
+      break;
+    case ShapeType::CAPSULE:
+    {
+      const CapsuleShape &capsule = static_cast<const CapsuleShape &>(_shape);
+      double r = capsule.GetRadius();
+      _primitive.size.Set(r, r, capsule.GetLength() * 0.5);
+      halfExtents.Set(r, r, _primitive.size.Z() + r);
+      break;
+    }
+    case ShapeType::CYLINDER:
+    {
+      const CylinderShape &cylinder =
+          static_cast<const CylinderShape &>(_shape);
+      double r = cylinder.GetRadius();
+      _primitive.size.Set(r, r, cylinder.GetLength() * 0.5);
+      halfExtents = _primitive.size;
+      break;
+    }
+    case ShapeType::ELLIPSOID:
+      _primitive.size =
+          static_cast<const EllipsoidShape &>(_shape).GetRadii();
+      halfExtents = _primitive.size;
+      break;
+    case ShapeType::SPHERE:
+    {
+      double r = static_cast<const SphereShape &>(_shape).GetRadius();
+      _primitive.size.Set(r, r, r);
+      halfExtents = _primitive.size;
+      break;
+    }
+    case ShapeType::MESH:
+    {
+      // Meshes are tested with their convex hull, whose bounding box need
+      // not be centered on the origin of the shape
+      MeshShape &mesh = static_cast<MeshShape &>(_shape);
+      if (mesh.GetHullVertices().empty())
+        return false;
+      _primitive.hull = &mesh.GetHullVertices();
+      _primitive.aabb =
+          transformAxisAlignedBox(mesh.GetBoundingBox(), _primitive.pose);
+      return true;
+    }
+    default:
+      return false;
+  }
+  _primitive.aabb = transformAxisAlignedBox(
+      math::AxisAlignedBox(-halfExtents, halfExtents), _primitive.pose);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool collidePrimitives(const ConvexPrimitive &_p1,
+    const ConvexPrimitive &_p2, PrimitiveContact &_contact)
+{
+  if (!_p1.aabb.Intersects(_p2.aabb))
+    return false;
+
+  bool core1 = isCore(_p1);
+  bool core2 = isCore(_p2);
+  if (core1 && core2)
+    return collideCores(_p1, _p2, _contact);
+
+  bool resolved = false;
+  if (core1 && _p2.type == ShapeType::BOX)
+  {
+    bool hit = collideCoreBox(_p1, _p2, _contact, resolved);
+    if (resolved)
+      return hit;
+  }
+  else if (core2 && _p1.type == ShapeType::BOX)
+  {
+    bool hit = collideCoreBox(_p2, _p1, _contact, resolved);
+    if (resolved)
+    {
+      _contact.normal = -_contact.normal;
+      return hit;
+    }
+  }
+
+  return collideGeneric(_p1, _p2, _contact);
+}
+
+//////////////////////////////////////////////////
+bool collideHeightmap(const HeightmapShape &_heightmap,
+    const math::Pose3d &_pose, const math::AxisAlignedBox &_box,
+    PrimitiveContact &_contact)
+{
+  // test the box in the frame of the heightmap
+  math::AxisAlignedBox box = transformAxisAlignedBox(_box, _pose.Inverse());
+  math::Vector3d point;
+  math::Vector3d normal;
+  if (!_heightmap.GetMaxHeight(box.Min(), box.Max(), point, normal) ||
+      point.Z() < box.Min().Z())
+  {
+    return false;
+  }
+
+  // the contact point is halfway between the heightmap and the bottom of
+  // the box
+  double depth = point.Z() - box.Min().Z();
+  point.Z(point.Z() - depth * 0.5);
+  _contact.point = _pose.CoordPositionAdd(point);
+  _contact.normal = _pose.Rot().RotateVector(normal);
+  _contact.depth = depth * normal.Z();
+  return true;
+}
+
+}
+}
+}
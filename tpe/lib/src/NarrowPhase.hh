@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_NARROWPHASE_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_NARROWPHASE_HH_
+
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Pose3.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/utils/SuppressWarning.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+#include "Shape.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+/// \brief Convex primitive tested by the narrow phase. Meshes are
+/// approximated by the convex hull of their mesh shape.
+struct GZ_PHYSICS_TPELIB_VISIBLE ConvexPrimitive
+{
+  /// \brief Type of primitive. One of BOX, CAPSULE, CYLINDER, ELLIPSOID,
+  /// MESH or SPHERE.
+  ShapeType type = ShapeType::EMPTY;
+
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief World pose of the center of the primitive
+  math::Pose3d pose;
+
+  /// \brief Half extents for boxes, radii for ellipsoids and spheres,
+  /// and (radius, radius, half length) for capsules and cylinders. The
+  /// half length of a capsule excludes its caps.
+  math::Vector3d size;
+
+  /// \brief World axis aligned box of the primitive
+  math::AxisAlignedBox aabb;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Hull vertices of meshes, in the frame of the primitive. Owned
+  /// by the mesh shape.
+  const std::vector<math::Vector3d> *hull = nullptr;
+};
+
+/// \brief Contact between two convex primitives
+struct GZ_PHYSICS_TPELIB_VISIBLE PrimitiveContact
+{
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Contact point in world frame, halfway between the deepest
+  /// points of the two primitives
+  math::Vector3d point;
+
+  /// \brief Unit contact normal in world frame, pointing from the second
+  /// primitive to the first one
+  math::Vector3d normal;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Penetration depth in meters
+  double depth = 0.0;
+};
+
+/// \brief Create the convex primitive of a shape
+/// \param[in] _shape Shape
+/// \param[in] _pose World pose of the shape
+/// \param[out] _primitive Primitive to fill
+/// \return True if the shape has a primitive, false for empty shapes
+GZ_PHYSICS_TPELIB_VISIBLE
+bool convexPrimitive(Shape &_shape, const math::Pose3d &_pose,
+    ConvexPrimitive &_primitive);
+
+/// \brief Test two convex primitives for contact. Pairs of spheres and
+/// capsules, and spheres and capsules that do not reach the inside of a
+/// box, are tested in closed form. Other pairs are tested for overlap with
+/// GJK, and their normal and depth are those of the axis of least
+/// penetration among the face normals, edge cross products and center
+/// directions of the primitives.
+/// \param[in] _p1 First primitive
+/// \param[in] _p2 Second primitive
+/// \param[out] _contact Contact between the primitives
+/// \return True if the primitives are in contact
+GZ_PHYSICS_TPELIB_VISIBLE
+bool collidePrimitives(const ConvexPrimitive &_p1,
+    const ConvexPrimitive &_p2, PrimitiveContact &_contact);
+
+/// \brief Test a box for contact with a heightmap. The bottom of the box
+/// is tested against the highest point of the heightmap under it, which is
+/// found from the grid cells the box overlaps, so the cost does not depend
+/// on the size of the heightmap.
+/// \param[in] _heightmap Heightmap
+/// \param[in] _pose World pose of the heightmap
+/// \param[in] _box World axis aligned box, e.g. the AABB of a primitive
+/// \param[out] _contact Contact between the box and the heightmap, with a
+/// normal pointing from the heightmap to the box
+/// \return True if the box is in contact with the heightmap
+GZ_PHYSICS_TPELIB_VISIBLE
+bool collideHeightmap(const HeightmapShape &_heightmap,
+    const math::Pose3d &_pose, const math::AxisAlignedBox &_box,
+    PrimitiveContact &_contact);
+
+}
+}
+}
+
+#endif
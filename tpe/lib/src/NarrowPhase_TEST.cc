@@ -0,0 +1,398 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <gz/common/Mesh.hh>
+#include <gz/common/SubMesh.hh>
+
+#include "NarrowPhase.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/////////////////////////////////////////////////
+ConvexPrimitive makeBox(const math::Vector3d &_size,
+    const math::Pose3d &_pose)
+{
+  BoxShape shape;
+  shape.SetSize(_size);
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+ConvexPrimitive makeSphere(double _radius, const math::Pose3d &_pose)
+{
+  SphereShape shape;
+  shape.SetRadius(_radius);
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+ConvexPrimitive makeCapsule(double _radius, double _length,
+    const math::Pose3d &_pose)
+{
+  CapsuleShape shape;
+  shape.SetRadius(_radius);
+  shape.SetLength(_length);
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+ConvexPrimitive makeCylinder(double _radius, double _length,
+    const math::Pose3d &_pose)
+{
+  CylinderShape shape;
+  shape.SetRadius(_radius);
+  shape.SetLength(_length);
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+ConvexPrimitive makeEllipsoid(const math::Vector3d &_radii,
+    const math::Pose3d &_pose)
+{
+  EllipsoidShape shape;
+  shape.SetRadii(_radii);
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, ConvexPrimitive)
+{
+  Shape empty;
+  ConvexPrimitive p;
+  EXPECT_FALSE(convexPrimitive(empty, math::Pose3d::Zero, p));
+
+  p = makeBox(math::Vector3d(2, 4, 6), math::Pose3d(1, 0, 0, 0, 0, 0));
+  EXPECT_EQ(ShapeType::BOX, p.type);
+  EXPECT_EQ(math::Vector3d(1, 2, 3), p.size);
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(0, -2, -3),
+      math::Vector3d(2, 2, 3)), p.aabb);
+
+  p = makeCapsule(0.5, 2, math::Pose3d::Zero);
+  EXPECT_EQ(ShapeType::CAPSULE, p.type);
+  EXPECT_EQ(math::Vector3d(0.5, 0.5, 1), p.size);
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-0.5, -0.5, -1.5),
+      math::Vector3d(0.5, 0.5, 1.5)), p.aabb);
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, SphereSphere)
+{
+  ConvexPrimitive s1 = makeSphere(1, math::Pose3d::Zero);
+  ConvexPrimitive s2 = makeSphere(1, math::Pose3d(1.5, 0, 0, 0, 0, 0));
+
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(s1, s2, contact));
+  EXPECT_NEAR(0.5, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), contact.normal);
+  EXPECT_EQ(math::Vector3d(0.75, 0, 0), contact.point);
+
+  // swapping the primitives flips the normal
+  ASSERT_TRUE(collidePrimitives(s2, s1, contact));
+  EXPECT_NEAR(0.5, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), contact.normal);
+
+  s2 = makeSphere(1, math::Pose3d(2.5, 0, 0, 0, 0, 0));
+  EXPECT_FALSE(collidePrimitives(s1, s2, contact));
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, CapsuleCapsule)
+{
+  // capsule along z and capsule along x crossing above it
+  ConvexPrimitive c1 = makeCapsule(0.5, 2, math::Pose3d::Zero);
+  ConvexPrimitive c2 = makeCapsule(0.5, 2,
+      math::Pose3d(0, 0.8, 0.5, 0, GZ_PI * 0.5, 0));
+
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(c1, c2, contact));
+  EXPECT_NEAR(0.2, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, -1, 0), contact.normal);
+  EXPECT_EQ(math::Vector3d(0, 0.4, 0.5), contact.point);
+
+  // the rounded end of the first capsule is reached
+  c2 = makeCapsule(0.5, 2, math::Pose3d(0, 0, 1.9, 0, GZ_PI * 0.5, 0));
+  ASSERT_TRUE(collidePrimitives(c1, c2, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, -1), contact.normal);
+
+  c2 = makeCapsule(0.5, 2, math::Pose3d(0, 1.1, 0, 0, GZ_PI * 0.5, 0));
+  EXPECT_FALSE(collidePrimitives(c1, c2, contact));
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, SphereBox)
+{
+  ConvexPrimitive box = makeBox(math::Vector3d(2, 2, 2), math::Pose3d::Zero);
+
+  // sphere outside the box
+  ConvexPrimitive sphere = makeSphere(0.5, math::Pose3d(1.3, 0, 0, 0, 0, 0));
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(box, sphere, contact));
+  EXPECT_NEAR(0.2, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), contact.normal);
+  EXPECT_EQ(math::Vector3d(0.9, 0, 0), contact.point);
+
+  ASSERT_TRUE(collidePrimitives(sphere, box, contact));
+  EXPECT_NEAR(0.2, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), contact.normal);
+
+  // sphere near a corner of the box. The aabbs overlap but the shapes do
+  // not.
+  sphere = makeSphere(0.5, math::Pose3d(1.4, 1.4, 0, 0, 0, 0));
+  EXPECT_FALSE(collidePrimitives(box, sphere, contact));
+
+  // sphere center inside the box
+  sphere = makeSphere(0.5, math::Pose3d(0.8, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(box, sphere, contact));
+  EXPECT_NEAR(0.7, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), contact.normal);
+
+  // rotated box
+  box = makeBox(math::Vector3d(2, 2, 2),
+      math::Pose3d(0, 0, 0, 0, 0, GZ_PI * 0.25));
+  sphere = makeSphere(0.5, math::Pose3d(1.6, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(sphere, box, contact));
+  EXPECT_NEAR(0.5 - (1.6 - std::sqrt(2)), contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), contact.normal);
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, BoxBox)
+{
+  ConvexPrimitive b1 = makeBox(math::Vector3d(2, 2, 2), math::Pose3d::Zero);
+
+  // box resting on top of b1
+  ConvexPrimitive b2 = makeBox(math::Vector3d(1, 1, 1),
+      math::Pose3d(0.2, 0.1, 1.45, 0, 0, 0.3));
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(b1, b2, contact));
+  EXPECT_NEAR(0.05, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, -1), contact.normal);
+  EXPECT_NEAR(1.0 - 0.025, contact.point.Z(), 1e-9);
+
+  // corner of a box rotated about z pushed into the side of b1
+  b2 = makeBox(math::Vector3d(2, 2, 2),
+      math::Pose3d(1.8, 0, 0, 0, 0, GZ_PI * 0.25));
+  ASSERT_TRUE(collidePrimitives(b1, b2, contact));
+  EXPECT_NEAR(1.0 - (1.8 - std::sqrt(2)), contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), contact.normal);
+
+  // edge to edge, separated along a cross product axis
+  b2 = makeBox(math::Vector3d(2, 2, 2),
+      math::Pose3d(2.3, 2.3, 0, 0, 0, GZ_PI * 0.25));
+  EXPECT_TRUE(b1.aabb.Intersects(b2.aabb));
+  EXPECT_FALSE(collidePrimitives(b1, b2, contact));
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, CapsuleBox)
+{
+  ConvexPrimitive box = makeBox(math::Vector3d(2, 2, 2), math::Pose3d::Zero);
+
+  // capsule lying on top of the box
+  ConvexPrimitive capsule = makeCapsule(0.5, 2,
+      math::Pose3d(0.5, 0, 1.4, 0, GZ_PI * 0.5, 0));
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(capsule, box, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), contact.normal);
+
+  // capsule core pushed into the box
+  capsule = makeCapsule(0.5, 2, math::Pose3d(0, 0, 1.8, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(capsule, box, contact));
+  EXPECT_NEAR(0.7, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), contact.normal);
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, CylinderBox)
+{
+  ConvexPrimitive box = makeBox(math::Vector3d(2, 2, 2), math::Pose3d::Zero);
+
+  // cylinder standing on top of the box
+  ConvexPrimitive cylinder = makeCylinder(0.5, 2,
+      math::Pose3d(0.3, 0, 1.9, 0, 0, 0));
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(cylinder, box, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), contact.normal);
+  EXPECT_NEAR(0.95, contact.point.Z(), 1e-9);
+
+  // cylinder next to a vertical edge of the box
+  cylinder = makeCylinder(0.5, 2, math::Pose3d(1.4, 1.4, 0, 0, 0, 0));
+  EXPECT_TRUE(cylinder.aabb.Intersects(box.aabb));
+  EXPECT_FALSE(collidePrimitives(cylinder, box, contact));
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, CylinderCylinder)
+{
+  ConvexPrimitive c1 = makeCylinder(1, 2, math::Pose3d::Zero);
+
+  // side by side, overlapping aabbs but separated shapes
+  ConvexPrimitive c2 = makeCylinder(1, 2, math::Pose3d(1.6, 1.6, 0, 0, 0, 0));
+  EXPECT_TRUE(c1.aabb.Intersects(c2.aabb));
+  PrimitiveContact contact;
+  EXPECT_FALSE(collidePrimitives(c1, c2, contact));
+
+  // side by side, touching
+  c2 = makeCylinder(1, 2, math::Pose3d(1.2, 1.2, 0, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(c1, c2, contact));
+  EXPECT_NEAR(2.0 - 1.2 * std::sqrt(2), contact.depth, 1e-9);
+  math::Vector3d expected(-1, -1, 0);
+  expected.Normalize();
+  EXPECT_EQ(expected, contact.normal);
+
+  // stacked
+  c2 = makeCylinder(0.5, 1, math::Pose3d(0.2, 0, 1.4, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(c1, c2, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, -1), contact.normal);
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, Ellipsoid)
+{
+  ConvexPrimitive box = makeBox(math::Vector3d(2, 2, 2), math::Pose3d::Zero);
+  ConvexPrimitive ellipsoid = makeEllipsoid(math::Vector3d(1, 2, 0.5),
+      math::Pose3d(0, 0, 1.4, 0, 0, 0));
+
+  PrimitiveContact contact;
+  ASSERT_TRUE(collidePrimitives(ellipsoid, box, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), contact.normal);
+  EXPECT_NEAR(0.95, contact.point.Z(), 1e-9);
+
+  // ellipsoid and sphere
+  ConvexPrimitive sphere = makeSphere(0.5, math::Pose3d(0, 0, 2.3, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(ellipsoid, sphere, contact));
+  EXPECT_NEAR(0.1, contact.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, -1), contact.normal);
+
+  // along the long axis the aabbs overlap near the tip but the shapes do
+  // not
+  sphere = makeSphere(0.5, math::Pose3d(1, 2, 1.4, 0, 0, 0));
+  EXPECT_TRUE(ellipsoid.aabb.Intersects(sphere.aabb));
+  EXPECT_FALSE(collidePrimitives(ellipsoid, sphere, contact));
+}
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, Heightmap)
+{
+  // a 20x20 m heightmap with a 1 m bump in the middle
+  HeightmapShape heightmap;
+  ASSERT_TRUE(heightmap.SetHeights({0, 0, 0, 0, 1, 0, 0, 0, 0}, 3u,
+      math::Vector3d(20, 20, 0)));
+  math::Pose3d pose(10, 0, 0, 0, 0, 0);
+
+  // a box over the bump
+  PrimitiveContact contact;
+  math::AxisAlignedBox box(math::Vector3d(9.5, -0.5, 0.5),
+      math::Vector3d(10.5, 0.5, 1.5));
+  ASSERT_TRUE(collideHeightmap(heightmap, pose, box, contact));
+  EXPECT_TRUE(contact.point.Equal(math::Vector3d(10, 0, 0.75), 1e-9));
+  EXPECT_LT(0.0, contact.normal.Z());
+  EXPECT_NEAR(1.0, contact.normal.Length(), 1e-9);
+  EXPECT_NEAR(0.5 * contact.normal.Z(), contact.depth, 1e-9);
+
+  // the aabb of the heightmap covers the box, but the box is above the
+  // heightmap under it
+  box = math::AxisAlignedBox(math::Vector3d(1, 8, 0.5),
+      math::Vector3d(2, 9, 1.5));
+  EXPECT_FALSE(collideHeightmap(heightmap, pose, box, contact));
+
+  // boxes above the bump and outside of the heightmap
+  box = math::AxisAlignedBox(math::Vector3d(9.5, -0.5, 1.1),
+      math::Vector3d(10.5, 0.5, 2));
+  EXPECT_FALSE(collideHeightmap(heightmap, pose, box, contact));
+  box = math::AxisAlignedBox(math::Vector3d(30, 0, -1),
+      math::Vector3d(31, 1, 1));
+  EXPECT_FALSE(collideHeightmap(heightmap, pose, box, contact));
+
+  // a rotated heightmap
+  pose = math::Pose3d(0, 0, 0, GZ_PI, 0, 0);
+  box = math::AxisAlignedBox(math::Vector3d(-0.5, -0.5, -1.5),
+      math::Vector3d(0.5, 0.5, -0.5));
+  ASSERT_TRUE(collideHeightmap(heightmap, pose, box, contact));
+  EXPECT_GT(0.0, contact.normal.Z());
+}
+
+
+/////////////////////////////////////////////////
+TEST(NarrowPhase, Mesh)
+{
+  // an octahedron mesh, whose hull is much smaller than its bounding box
+  common::Mesh mesh;
+  common::SubMesh submesh;
+  for (const math::Vector3d &axis : {math::Vector3d::UnitX,
+      math::Vector3d::UnitY, math::Vector3d::UnitZ})
+  {
+    submesh.AddVertex(axis);
+    submesh.AddVertex(-axis);
+  }
+  mesh.AddSubMesh(submesh);
+  MeshShape shape;
+  shape.SetMesh(mesh);
+  EXPECT_EQ(6u, shape.GetHullVertices().size());
+
+  ConvexPrimitive octahedron;
+  ASSERT_TRUE(convexPrimitive(shape, math::Pose3d(0, 0, 1, 0, 0, 0),
+      octahedron));
+  EXPECT_EQ(ShapeType::MESH, octahedron.type);
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-1, -1, 0),
+      math::Vector3d(1, 1, 2)), octahedron.aabb);
+
+  // a sphere next to an edge of the octahedron is inside its bounding box
+  // but does not touch it
+  PrimitiveContact c;
+  ConvexPrimitive sphere = makeSphere(0.5, math::Pose3d(1, 1, 1, 0, 0, 0));
+  EXPECT_FALSE(collidePrimitives(sphere, octahedron, c));
+
+  // the sphere touches the edge, pushed away from the octahedron
+  sphere = makeSphere(0.5, math::Pose3d(0.6, 0.6, 1, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(sphere, octahedron, c));
+  EXPECT_GT(c.depth, 0.0);
+  EXPECT_GT(c.normal.X(), 0.0);
+  EXPECT_GT(c.normal.Y(), 0.0);
+
+  // a mesh resting on a box
+  ConvexPrimitive ground = makeBox(math::Vector3d(10, 10, 1),
+      math::Pose3d(0, 0, -0.45, 0, 0, 0));
+  ASSERT_TRUE(collidePrimitives(octahedron, ground, c));
+  EXPECT_NEAR(0.05, c.depth, 1e-9);
+  EXPECT_EQ(math::Vector3d::UnitZ, c.normal);
+
+  // meshes without vertices have no primitive
+  common::Mesh emptyMesh;
+  MeshShape emptyShape;
+  emptyShape.SetMesh(emptyMesh);
+  EXPECT_FALSE(convexPrimitive(emptyShape, math::Pose3d::Zero, octahedron));
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "RayCast.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+namespace {
+
+/// \brief Direction components below which a ray is considered parallel
+/// to an axis
+const double kEpsilon = 1e-12;
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with a sphere centered at the origin
+bool raySphere(const math::Vector3d &_o, const math::Vector3d &_d,
+    double _radius, double &_t, math::Vector3d &_n)
+{
+  double b = _o.Dot(_d);
+  double c = _o.SquaredLength() - _radius * _radius;
+  if (c < 0.0)
+    return false;
+  double disc = b * b - c;
+  if (disc < 0.0)
+    return false;
+  double t = -b - std::sqrt(disc);
+  if (t < 0.0)
+    return false;
+  _t = t;
+  _n = (_o + _d * t) / _radius;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with the side of a cylinder along the z axis
+/// centered at the origin, ignoring the caps
+bool rayCylinderSide(const math::Vector3d &_o, const math::Vector3d &_d,
+    double _radius, double _halfLength, double &_t, math::Vector3d &_n)
+{
+  double a = _d.X() * _d.X() + _d.Y() * _d.Y();
+  double c = _o.X() * _o.X() + _o.Y() * _o.Y() - _radius * _radius;
+  if (a < kEpsilon || c < 0.0)
+    return false;
+  double b = _o.X() * _d.X() + _o.Y() * _d.Y();
+  double disc = b * b - a * c;
+  if (disc < 0.0)
+    return false;
+  double t = (-b - std::sqrt(disc)) / a;
+  if (t < 0.0)
+    return false;
+  math::Vector3d p = _o + _d * t;
+  if (std::abs(p.Z()) > _halfLength)
+    return false;
+  _t = t;
+  _n.Set(p.X() / _radius, p.Y() / _radius, 0);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with a box centered at the origin
+bool rayBox(const math::Vector3d &_o, const math::Vector3d &_d,
+    const math::Vector3d &_half, double &_t, math::Vector3d &_n)
+{
+  double tNear = -std::numeric_limits<double>::infinity();
+  double tFar = std::numeric_limits<double>::infinity();
+  unsigned int axis = 0u;
+  double sign = 1.0;
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    if (std::abs(_d[i]) < kEpsilon)
+    {
+      if (_o[i] < -_half[i] || _o[i] > _half[i])
+        return false;
+      continue;
+    }
+    double t1 = (-_half[i] - _o[i]) / _d[i];
+    double t2 = (_half[i] - _o[i]) / _d[i];
+    double near = std::min(t1, t2);
+    double far = std::max(t1, t2);
+    if (near > tNear)
+    {
+      tNear = near;
+      axis = i;
+      sign = _d[i] > 0.0 ? -1.0 : 1.0;
+    }
+    tFar = std::min(tFar, far);
+  }
+  // the origin is inside the box when the ray enters it behind the origin
+  if (tNear > tFar || tNear < 0.0)
+    return false;
+  _t = tNear;
+  _n = math::Vector3d::Zero;
+  _n[axis] = sign;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with a cylinder along the z axis centered at the
+/// origin
+bool rayCylinder(const math::Vector3d &_o, const math::Vector3d &_d,
+    double _radius, double _halfLength, double &_t, math::Vector3d &_n)
+{
+  bool hit = rayCylinderSide(_o, _d, _radius, _halfLength, _t, _n);
+  if (hit || std::abs(_d.Z()) < kEpsilon)
+    return hit;
+
+  // cap facing the ray origin
+  double s = _o.Z() > 0.0 ? 1.0 : -1.0;
+  if (s * _o.Z() <= _halfLength || s * _d.Z() >= 0.0)
+    return false;
+  double t = (s * _halfLength - _o.Z()) / _d.Z();
+  math::Vector3d p = _o + _d * t;
+  if (p.X() * p.X() + p.Y() * p.Y() > _radius * _radius)
+    return false;
+  _t = t;
+  _n.Set(0, 0, s);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with a capsule along the z axis centered at the
+/// origin
+bool rayCapsule(const math::Vector3d &_o, const math::Vector3d &_d,
+    double _radius, double _halfLength, double &_t, math::Vector3d &_n)
+{
+  // rays starting inside the capsule do not hit it
+  math::Vector3d core(0, 0, std::clamp(_o.Z(), -_halfLength, _halfLength));
+  if ((_o - core).SquaredLength() < _radius * _radius)
+    return false;
+
+  bool hit = rayCylinderSide(_o, _d, _radius, _halfLength, _t, _n);
+  for (double s : {-1.0, 1.0})
+  {
+    math::Vector3d center(0, 0, s * _halfLength);
+    double t;
+    math::Vector3d n;
+    if (raySphere(_o - center, _d, _radius, t, n) && (!hit || t < _t))
+    {
+      hit = true;
+      _t = t;
+      _n = n;
+    }
+  }
+  return hit;
+}
+
+//////////////////////////////////////////////////
+/// \brief Intersect a ray with an ellipsoid centered at the origin
+bool rayEllipsoid(const math::Vector3d &_o, const math::Vector3d &_d,
+    const math::Vector3d &_radii, double &_t, math::Vector3d &_n)
+{
+  // scale the ellipsoid to a unit sphere
+  math::Vector3d o(_o.X() / _radii.X(), _o.Y() / _radii.Y(),
+      _o.Z() / _radii.Z());
+  math::Vector3d d(_d.X() / _radii.X(), _d.Y() / _radii.Y(),
+      _d.Z() / _radii.Z());
+  double a = d.SquaredLength();
+  double b = o.Dot(d);
+  double c = o.SquaredLength() - 1.0;
+  if (c < 0.0)
+    return false;
+  double disc = b * b - a * c;
+  if (disc < 0.0)
+    return false;
+  double t = (-b - std::sqrt(disc)) / a;
+  if (t < 0.0)
+    return false;
+  math::Vector3d p = _o + _d * t;
+  _t = t;
+  _n.Set(p.X() / (_radii.X() * _radii.X()),
+         p.Y() / (_radii.Y() * _radii.Y()),
+         p.Z() / (_radii.Z() * _radii.Z()));
+  _n.Normalize();
+  return true;
+}
+}
+
+//////////////////////////////////////////////////
+bool rayIntersectPrimitive(const ConvexPrimitive &_primitive,
+    const math::Vector3d &_origin, const math::Vector3d &_direction,
+    double _maxDistance, double &_distance, math::Vector3d &_normal)
+{
+  const math::Quaterniond &rot = _primitive.pose.Rot();
+  math::Vector3d o = rot.RotateVectorReverse(_origin - _primitive.pose.Pos());
+  math::Vector3d d = rot.RotateVectorReverse(_direction);
+  const math::Vector3d &s = _primitive.size;
+
+  double t = 0.0;
+  math::Vector3d n;
+  bool hit = false;
+  switch (_primitive.type)
+  {
+    case ShapeType::BOX:
+      hit = rayBox(o, d, s, t, n);
+      break;
+    case ShapeType::CAPSULE:
+      hit = rayCapsule(o, d, s.X(), s.Z(), t, n);
+      break;
+    case ShapeType::CYLINDER:
+      hit = rayCylinder(o, d, s.X(), s.Z(), t, n);
+      break;
+    case ShapeType::ELLIPSOID:
+      hit = rayEllipsoid(o, d, s, t, n);
+      break;
+    case ShapeType::SPHERE:
+      hit = raySphere(o, d, s.X(), t, n);
+      break;
+    default:
+      break;
+  }
+  if (!hit || t > _maxDistance)
+    return false;
+
+  _distance = t;
+  _normal = rot.RotateVector(n);
+  return true;
+}
+
+}
+}
+}
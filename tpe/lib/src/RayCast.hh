@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_RAYCAST_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_RAYCAST_HH_
+
+#include <limits>
+
+#include <gz/math/Vector3.hh>
+#include <gz/utils/SuppressWarning.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+#include "Entity.hh"
+#include "NarrowPhase.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+/// \brief A ray cast against the collisions of a world
+struct GZ_PHYSICS_TPELIB_VISIBLE Ray
+{
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Origin of the ray in world frame
+  math::Vector3d origin;
+
+  /// \brief Direction of the ray in world frame. Does not need to be
+  /// normalized. Rays with a zero direction do not hit anything.
+  math::Vector3d direction;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Maximum distance of the hits along the ray in meters
+  double maxDistance = std::numeric_limits<double>::infinity();
+};
+
+/// \brief Closest hit of a ray
+struct GZ_PHYSICS_TPELIB_VISIBLE RayHit
+{
+  /// \brief Id of the model hit, kNullEntityId if the ray did not hit
+  /// anything
+  std::size_t entity = kNullEntityId;
+
+  /// \brief Id of the collision hit, kNullEntityId if the ray did not hit
+  /// anything
+  std::size_t collision = kNullEntityId;
+
+  /// \brief Distance of the hit from the ray origin in meters, infinite if
+  /// the ray did not hit anything
+  double distance = std::numeric_limits<double>::infinity();
+
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Hit point in world frame
+  math::Vector3d point;
+
+  /// \brief Unit surface normal at the hit point in world frame
+  math::Vector3d normal;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+};
+
+/// \brief Intersect a ray with a convex primitive. Only hits entering the
+/// primitive are reported, so rays starting inside a primitive do not hit
+/// it.
+/// \param[in] _primitive Primitive
+/// \param[in] _origin Ray origin in world frame
+/// \param[in] _direction Unit ray direction in world frame
+/// \param[in] _maxDistance Maximum distance of the hit
+/// \param[out] _distance Distance of the hit along the ray
+/// \param[out] _normal Unit surface normal at the hit in world frame
+/// \return True if the ray hits the primitive within the maximum distance
+GZ_PHYSICS_TPELIB_VISIBLE
+bool rayIntersectPrimitive(const ConvexPrimitive &_primitive,
+    const math::Vector3d &_origin, const math::Vector3d &_direction,
+    double _maxDistance, double &_distance, math::Vector3d &_normal);
+
+}
+}
+}
+
+#endif
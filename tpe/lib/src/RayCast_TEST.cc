@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "RayCast.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/////////////////////////////////////////////////
+ConvexPrimitive makePrimitive(Shape &_shape, const math::Pose3d &_pose)
+{
+  ConvexPrimitive p;
+  EXPECT_TRUE(convexPrimitive(_shape, _pose, p));
+  return p;
+}
+
+/////////////////////////////////////////////////
+TEST(RayCast, Sphere)
+{
+  SphereShape shape;
+  shape.SetRadius(1.0);
+  ConvexPrimitive p = makePrimitive(shape, math::Pose3d(5, 0, 0, 0, 0, 0));
+
+  double distance = 0.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d::Zero,
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(4.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  // hit beyond the maximum distance
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d::Zero,
+      math::Vector3d::UnitX, 3.0, distance, normal));
+
+  // ray pointing away, passing by and starting inside
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d::Zero,
+      -math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(0, 1.1, 0),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(5, 0, 0),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+}
+
+/////////////////////////////////////////////////
+TEST(RayCast, Box)
+{
+  // box rotated so that its y axis is along the world x axis
+  BoxShape shape;
+  shape.SetSize(math::Vector3d(1, 2, 4));
+  ConvexPrimitive p = makePrimitive(shape,
+      math::Pose3d(5, 0, 0, 0, 0, GZ_PI * 0.5));
+
+  double distance = 0.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0, 0.4, 1.9),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(4.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(5, 0, 10),
+      -math::Vector3d::UnitZ, 10.0, distance, normal));
+  EXPECT_NEAR(8.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), normal);
+
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(0, 0.6, 0),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(5, 0, 0),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+}
+
+/////////////////////////////////////////////////
+TEST(RayCast, Cylinder)
+{
+  CylinderShape shape;
+  shape.SetRadius(1.0);
+  shape.SetLength(2.0);
+  ConvexPrimitive p = makePrimitive(shape, math::Pose3d::Zero);
+
+  double distance = 0.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(-5, 0, 0.5),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(4.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  // caps
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0.5, 0, 5),
+      -math::Vector3d::UnitZ, 10.0, distance, normal));
+  EXPECT_NEAR(4.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), normal);
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0, 0.5, -5),
+      math::Vector3d::UnitZ, 10.0, distance, normal));
+  EXPECT_NEAR(4.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, -1), normal);
+
+  // above the cylinder and inside it
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(-5, 0, 1.5),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d::Zero,
+      math::Vector3d::UnitX, 10.0, distance, normal));
+}
+
+/////////////////////////////////////////////////
+TEST(RayCast, Capsule)
+{
+  CapsuleShape shape;
+  shape.SetRadius(0.5);
+  shape.SetLength(2.0);
+  ConvexPrimitive p = makePrimitive(shape, math::Pose3d::Zero);
+
+  double distance = 0.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(-5, 0, 0),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(4.5, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0, 0, 5),
+      -math::Vector3d::UnitZ, 10.0, distance, normal));
+  EXPECT_NEAR(3.5, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), normal);
+
+  // hemispherical end
+  double x = std::sqrt(0.25 - 0.04);
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(-5, 0, 1.2),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(5.0 - x, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-x, 0, 0.2) / 0.5, normal);
+
+  EXPECT_FALSE(rayIntersectPrimitive(p, math::Vector3d(0, 0, 0.9),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+}
+
+/////////////////////////////////////////////////
+TEST(RayCast, Ellipsoid)
+{
+  EllipsoidShape shape;
+  shape.SetRadii(math::Vector3d(1, 2, 3));
+  ConvexPrimitive p = makePrimitive(shape, math::Pose3d(0, 0, 1, 0, 0, 0));
+
+  double distance = 0.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0, -5, 1),
+      math::Vector3d::UnitY, 10.0, distance, normal));
+  EXPECT_NEAR(3.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, -1, 0), normal);
+
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(0, 0, 10),
+      -math::Vector3d::UnitZ, 10.0, distance, normal));
+  EXPECT_NEAR(6.0, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(0, 0, 1), normal);
+
+  // the normal is not along the ray
+  double x = std::sqrt(0.75);
+  EXPECT_TRUE(rayIntersectPrimitive(p, math::Vector3d(-5, 1, 1),
+      math::Vector3d::UnitX, 10.0, distance, normal));
+  EXPECT_NEAR(5.0 - x, distance, 1e-9);
+  EXPECT_EQ(math::Vector3d(-x, 0.25, 0).Normalized(), normal);
+}
@@ -15,12 +15,151 @@
  *
 */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <gz/common/Console.hh>
+#include <gz/common/SubMesh.hh>
+#include <gz/math/Helpers.hh>
+
 #include "Shape.hh"
 
 using namespace gz;
 using namespace physics;
 using namespace tpelib;
 
+namespace {
+
+//////////////////////////////////////////////////
+/// \brief Interpolate the heights of a heightmap at a point of its grid
+/// \param[in] _heights Heights of the vertices, row by row
+/// \param[in] _count Number of vertices along each side of the grid
+/// \param[in] _u Column coordinate of the point, in number of cells
+/// \param[in] _v Row coordinate of the point, in number of cells
+/// \param[out] _du Derivative of the height along the columns
+/// \param[out] _dv Derivative of the height along the rows
+/// \return Height at the point
+double interpolateHeight(const std::vector<float> &_heights,
+    unsigned int _count, double _u, double _v, double &_du, double &_dv)
+{
+  // points on the last row or column belong to the cells before them
+  double maxCell = static_cast<double>(_count - 2u);
+  double col = std::min(std::floor(_u), maxCell);
+  double row = std::min(std::floor(_v), maxCell);
+  double fu = _u - col;
+  double fv = _v - row;
+  std::size_t i = static_cast<std::size_t>(row) * _count +
+      static_cast<std::size_t>(col);
+  double h00 = _heights[i];
+  double h01 = _heights[i + 1u];
+  double h10 = _heights[i + _count];
+  double h11 = _heights[i + _count + 1u];
+
+  _du = (1.0 - fv) * (h01 - h00) + fv * (h11 - h10);
+  _dv = (1.0 - fu) * (h10 - h00) + fu * (h11 - h01);
+  return (1.0 - fv) * ((1.0 - fu) * h00 + fu * h01) +
+      fv * ((1.0 - fu) * h10 + fu * h11);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the directions along which the hull vertices of meshes are
+/// found. The axes come first so that the hulls keep the bounding boxes of
+/// the meshes, and the other directions are spread evenly on a sphere.
+/// \return kMaxMeshHullVertices unit directions
+const std::vector<math::Vector3d> &hullDirections()
+{
+  static const std::vector<math::Vector3d> directions = []()
+  {
+    std::vector<math::Vector3d> dirs = {
+        math::Vector3d::UnitX, -math::Vector3d::UnitX,
+        math::Vector3d::UnitY, -math::Vector3d::UnitY,
+        math::Vector3d::UnitZ, -math::Vector3d::UnitZ};
+    const std::size_t count = kMaxMeshHullVertices - dirs.size();
+    const double goldenAngle = GZ_PI * (3.0 - std::sqrt(5.0));
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      double z = 1.0 - (2.0 * i + 1.0) / count;
+      double r = std::sqrt(1.0 - z * z);
+      double angle = goldenAngle * i;
+      dirs.push_back(math::Vector3d(r * std::cos(angle),
+          r * std::sin(angle), z));
+    }
+    return dirs;
+  }();
+  return directions;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compute the simplified convex hull of a scaled mesh, made of
+/// the vertices furthest along each hull direction
+/// \param[in] _mesh Mesh
+/// \param[in] _scale Scale applied to the mesh vertices
+/// \return Distinct hull vertices, empty if the mesh has no vertices
+std::shared_ptr<const std::vector<math::Vector3d>> simplifiedHull(
+    const common::Mesh &_mesh, const math::Vector3d &_scale)
+{
+  const std::vector<math::Vector3d> &dirs = hullDirections();
+  std::vector<double> best(dirs.size(), -std::numeric_limits<double>::max());
+  std::vector<math::Vector3d> points(dirs.size());
+  bool empty = true;
+  for (unsigned int i = 0u; i < _mesh.SubMeshCount(); ++i)
+  {
+    auto subMesh = _mesh.SubMeshByIndex(i).lock();
+    if (!subMesh)
+      continue;
+    for (unsigned int v = 0u; v < subMesh->VertexCount(); ++v)
+    {
+      math::Vector3d p = _scale * subMesh->Vertex(v);
+      for (std::size_t d = 0u; d < dirs.size(); ++d)
+      {
+        double dist = p.Dot(dirs[d]);
+        if (dist > best[d])
+        {
+          best[d] = dist;
+          points[d] = p;
+        }
+      }
+      empty = false;
+    }
+  }
+
+  auto hull = std::make_shared<std::vector<math::Vector3d>>();
+  if (empty)
+    return hull;
+  for (const math::Vector3d &p : points)
+  {
+    if (std::find(hull->begin(), hull->end(), p) == hull->end())
+      hull->push_back(p);
+  }
+  return hull;
+}
+
+/// \brief Hulls of the meshes shared by all mesh shapes, by mesh address
+/// and scale
+struct HullCache
+{
+  /// \brief Mutex protecting the hulls
+  std::mutex mutex;
+
+  /// \brief Hull of each mesh and scale
+  std::map<std::tuple<const common::Mesh *, double, double, double>,
+      std::shared_ptr<const std::vector<math::Vector3d>>> hulls;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the hull cache
+HullCache &hullCache()
+{
+  static HullCache cache;
+  return cache;
+}
+
+}
+
 //////////////////////////////////////////////////
 Shape::Shape()
 {
@@ -222,23 +361,212 @@ math::Vector3d MeshShape::GetScale() const
 void MeshShape::SetScale(math::Vector3d _scale)
 {
   this->scale = _scale;
+  this->UpdateHull();
   this->dirty = true;
 }
 
 //////////////////////////////////////////////////
 void MeshShape::SetMesh(const common::Mesh &_mesh)
 {
-  math::Vector3d center;
-  math::Vector3d min;
-  math::Vector3d max;
-  _mesh.AABB(center, min, max);
-  this->meshAABB = math::AxisAlignedBox(min, max);
+  this->mesh = &_mesh;
+  this->UpdateHull();
   this->dirty = true;
 }
 
+//////////////////////////////////////////////////
+const std::vector<math::Vector3d> &MeshShape::GetHullVertices() const
+{
+  static const std::vector<math::Vector3d> empty;
+  return this->hull ? *this->hull : empty;
+}
+
+//////////////////////////////////////////////////
+void MeshShape::UpdateHull()
+{
+  if (nullptr == this->mesh)
+    return;
+
+  HullCache &cache = hullCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto &hullRef = cache.hulls[std::make_tuple(this->mesh, this->scale.X(),
+      this->scale.Y(), this->scale.Z())];
+  if (!hullRef)
+    hullRef = simplifiedHull(*this->mesh, this->scale);
+  this->hull = hullRef;
+}
+
 //////////////////////////////////////////////////
 void MeshShape::UpdateBoundingBox()
 {
+  const std::vector<math::Vector3d> &vertices = this->GetHullVertices();
+  if (vertices.empty())
+  {
+    this->bbox = math::AxisAlignedBox();
+    return;
+  }
+  math::Vector3d min = vertices.front();
+  math::Vector3d max = vertices.front();
+  for (const math::Vector3d &v : vertices)
+  {
+    min.Min(v);
+    max.Max(v);
+  }
+  this->bbox = math::AxisAlignedBox(min, max);
+}
+
+//////////////////////////////////////////////////
+HeightmapShape::HeightmapShape() : Shape()
+{
+  this->type = ShapeType::HEIGHTMAP;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapShape::SetHeights(const std::vector<float> &_heights,
+    unsigned int _vertexCount, const math::Vector3d &_size)
+{
+  if (_vertexCount < 2u ||
+      _heights.size() != static_cast<std::size_t>(_vertexCount) * _vertexCount)
+  {
+    gzerr << "Heightmap with " << _vertexCount << " vertices per side "
+          << "expects " << _vertexCount << "x" << _vertexCount
+          << " heights, got " << _heights.size() << "." << std::endl;
+    return false;
+  }
+  if (_size.X() <= 0.0 || _size.Y() <= 0.0)
+  {
+    gzerr << "Invalid heightmap size [" << _size << "]." << std::endl;
+    return false;
+  }
+
+  this->heights = std::make_shared<const std::vector<float>>(_heights);
+  this->vertexCount = _vertexCount;
+  auto [minIt, maxIt] = std::minmax_element(_heights.begin(), _heights.end());
+  this->minHeight = *minIt;
+  this->maxHeight = *maxIt;
+  this->size = math::Vector3d(_size.X(), _size.Y(),
+      this->maxHeight - this->minHeight);
+  this->dirty = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int HeightmapShape::GetVertexCount() const
+{
+  return this->vertexCount;
+}
+
+//////////////////////////////////////////////////
+math::Vector3d HeightmapShape::GetSize() const
+{
+  return this->size;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapShape::GetHeight(double _x, double _y, double &_height,
+    math::Vector3d &_normal) const
+{
+  if (!this->heights)
+    return false;
+
+  // coordinates of the point in number of cells from the first vertex
+  double cells = static_cast<double>(this->vertexCount - 1u);
+  double dx = this->size.X() / cells;
+  double dy = this->size.Y() / cells;
+  double u = (_x + this->size.X() * 0.5) / dx;
+  double v = (this->size.Y() * 0.5 - _y) / dy;
+  if (u < 0.0 || u > cells || v < 0.0 || v > cells)
+    return false;
+
+  double du;
+  double dv;
+  _height = interpolateHeight(*this->heights, this->vertexCount, u, v, du,
+      dv);
+  // rows go towards negative y
+  _normal = math::Vector3d(-du / dx, dv / dy, 1.0).Normalized();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapShape::GetMaxHeight(const math::Vector3d &_min,
+    const math::Vector3d &_max, math::Vector3d &_point,
+    math::Vector3d &_normal) const
+{
+  if (!this->heights)
+    return false;
+
+  double halfX = this->size.X() * 0.5;
+  double halfY = this->size.Y() * 0.5;
+  double minX = std::max(_min.X(), -halfX);
+  double maxX = std::min(_max.X(), halfX);
+  double minY = std::max(_min.Y(), -halfY);
+  double maxY = std::min(_max.Y(), halfY);
+  if (minX > maxX || minY > maxY)
+    return false;
+
+  double cells = static_cast<double>(this->vertexCount - 1u);
+  double dx = this->size.X() / cells;
+  double dy = this->size.Y() / cells;
+  double u0 = (minX + halfX) / dx;
+  double u1 = std::min((maxX + halfX) / dx, cells);
+  double v0 = (halfY - maxY) / dy;
+  double v1 = std::min((halfY - minY) / dy, cells);
+
+  // the interpolated heights are linear along the edges of the rectangle
+  // and the grid lines crossing it, so the highest point is at a vertex
+  // inside the rectangle or where a grid line crosses its sides. Points
+  // with the same height are averaged so that a flat heightmap gives the
+  // center of the rectangle.
+  auto next = [](double _t, double _end)
+  {
+    return std::min(std::floor(_t) + 1.0, _end);
+  };
+  double best = -std::numeric_limits<double>::infinity();
+  math::Vector3d sum;
+  math::Vector3d normalSum;
+  int count = 0;
+  for (double v = v0;; v = next(v, v1))
+  {
+    for (double u = u0;; u = next(u, u1))
+    {
+      double du;
+      double dv;
+      double h = interpolateHeight(*this->heights, this->vertexCount, u, v,
+          du, dv);
+      if (h > best + 1e-9)
+      {
+        best = h;
+        sum = math::Vector3d::Zero;
+        normalSum = math::Vector3d::Zero;
+        count = 0;
+      }
+      if (h >= best - 1e-9)
+      {
+        sum += math::Vector3d(u * dx - halfX, halfY - v * dy, 0.0);
+        normalSum += math::Vector3d(-du / dx, dv / dy, 1.0).Normalized();
+        ++count;
+      }
+      if (u >= u1)
+        break;
+    }
+    if (v >= v1)
+      break;
+  }
+
+  _point = sum / count;
+  _point.Z(best);
+  _normal = normalSum.Normalized();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void HeightmapShape::UpdateBoundingBox()
+{
+  if (!this->heights)
+    return;
+
   this->bbox = math::AxisAlignedBox(
-      this->scale * this->meshAABB.Min(), this->scale * this->meshAABB.Max());
+      math::Vector3d(-this->size.X() * 0.5, -this->size.Y() * 0.5,
+      this->minHeight),
+      math::Vector3d(this->size.X() * 0.5, this->size.Y() * 0.5,
+      this->maxHeight));
 }
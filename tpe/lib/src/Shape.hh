@@ -20,6 +20,8 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <gz/common/Mesh.hh>
 #include <gz/math/Vector3.hh>
@@ -59,6 +61,9 @@ enum class GZ_PHYSICS_TPELIB_VISIBLE ShapeType
 
   /// \brief A ellipsoid shape.
   ELLIPSOID = 7,
+
+  /// \brief A heightmap shape.
+  HEIGHTMAP = 8,
 };
 
 
@@ -238,7 +243,12 @@ class GZ_PHYSICS_TPELIB_VISIBLE SphereShape : public Shape
   private: double radius = 0.0;
 };
 
-/// \brief Mesh geometry
+/// \brief Maximum number of vertices of the convex hull of a mesh shape
+constexpr std::size_t kMaxMeshHullVertices = 64u;
+
+/// \brief Mesh geometry. The mesh is reduced to a simplified convex hull,
+/// which gives the bounding box of the shape and its shape in the narrow
+/// phase.
 class GZ_PHYSICS_TPELIB_VISIBLE MeshShape : public Shape
 {
   /// \brief Constructor
@@ -247,8 +257,14 @@ class GZ_PHYSICS_TPELIB_VISIBLE MeshShape : public Shape
   /// \brief Destructor
   public: virtual ~MeshShape() = default;
 
-  /// \brief Set mesh
-  /// \param[in] _mesh Mesh object
+  /// \brief Set mesh. The hull is made of the mesh vertices furthest along
+  /// a fixed set of directions, so it has at most kMaxMeshHullVertices
+  /// vertices and the same bounding box as the mesh. Hulls are cached by
+  /// mesh address and scale, so all shapes of a mesh with the same scale
+  /// share one hull, and it is only computed for the first of them. Set
+  /// the scale before the mesh to avoid computing the hull twice.
+  /// \param[in] _mesh Mesh object. The mesh must not be destroyed before
+  /// the last call to SetScale.
   public: void SetMesh(const gz::common::Mesh &_mesh);
 
   /// \brief Get mesh scale
@@ -259,16 +275,106 @@ class GZ_PHYSICS_TPELIB_VISIBLE MeshShape : public Shape
   /// \param[in] _scale Mesh scale
   public: void SetScale(math::Vector3d _scale);
 
+  /// \brief Get the vertices of the convex hull of the scaled mesh
+  /// \return Hull vertices in the shape frame, empty if no mesh is set
+  public: const std::vector<math::Vector3d> &GetHullVertices() const;
+
   // Documentation inherited
   protected: virtual void UpdateBoundingBox() override;
 
+  /// \brief Get the hull of the mesh at the current scale from the cache
+  private: void UpdateHull();
+
   GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
   /// \brief Mesh scale
   private: math::Vector3d scale{1.0, 1.0, 1.0};
+
+  /// \brief Hull vertices of the scaled mesh, shared with the cache
+  private: std::shared_ptr<const std::vector<math::Vector3d>> hull;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Mesh object, only used as the key of the hull cache
+  private: const common::Mesh *mesh = nullptr;
+};
+
+/// \brief Heightmap geometry, e.g. a terrain. The heights are sampled on a
+/// square grid of vertices spanning the x and y size of the heightmap and
+/// centered on the origin of the shape. The first row of the grid is at the
+/// largest y and the first vertex of each row at the smallest x, as in an
+/// image. Heights between the vertices are interpolated bilinearly.
+class GZ_PHYSICS_TPELIB_VISIBLE HeightmapShape : public Shape
+{
+  /// \brief Constructor
+  public: HeightmapShape();
+
+  /// \brief Destructor
+  public: virtual ~HeightmapShape() = default;
+
+  /// \brief Set the heights of the heightmap. Copies of the shape share
+  /// the heights.
+  /// \param[in] _heights Height of each vertex in meters, row by row
+  /// \param[in] _vertexCount Number of vertices along each side of the
+  /// grid. Must be at least 2 and its square must be the number of heights.
+  /// \param[in] _size Size of the heightmap in meters. Only x and y are
+  /// used, the heights give the z extent.
+  /// \return True if the heights were set
+  public: bool SetHeights(const std::vector<float> &_heights,
+      unsigned int _vertexCount, const math::Vector3d &_size);
+
+  /// \brief Get the number of vertices along each side of the grid
+  /// \return Vertex count, 0 if no heights are set
+  public: unsigned int GetVertexCount() const;
+
+  /// \brief Get the size of the heightmap, with the z extent of its
+  /// heights
+  /// \return Size in meters
+  public: math::Vector3d GetSize() const;
+
+  /// \brief Get the height of the heightmap at a point. The grid cell
+  /// containing the point is found from its coordinates, so the lookup
+  /// takes constant time.
+  /// \param[in] _x X coordinate in the shape frame
+  /// \param[in] _y Y coordinate in the shape frame
+  /// \param[out] _height Height in the shape frame
+  /// \param[out] _normal Unit normal of the heightmap at the point, in the
+  /// shape frame
+  /// \return False if the point is outside of the heightmap
+  public: bool GetHeight(double _x, double _y, double &_height,
+      math::Vector3d &_normal) const;
+
+  /// \brief Get the highest point of the heightmap over a rectangle. Only
+  /// the grid cells overlapping the rectangle are visited.
+  /// \param[in] _min Corner of the rectangle with the smallest x and y, in
+  /// the shape frame. The z coordinate is ignored.
+  /// \param[in] _max Corner of the rectangle with the largest x and y, in
+  /// the shape frame. The z coordinate is ignored.
+  /// \param[out] _point Highest point in the shape frame
+  /// \param[out] _normal Unit normal of the heightmap at the highest point,
+  /// in the shape frame
+  /// \return False if the rectangle does not overlap the heightmap
+  public: bool GetMaxHeight(const math::Vector3d &_min,
+      const math::Vector3d &_max, math::Vector3d &_point,
+      math::Vector3d &_normal) const;
+
+  // Documentation inherited
+  protected: virtual void UpdateBoundingBox() override;
+
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  /// \brief Heights of the vertices, row by row
+  private: std::shared_ptr<const std::vector<float>> heights;
+
+  /// \brief Size of the heightmap
+  private: math::Vector3d size;
   GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
 
-  /// \brief Mesh object
-  private: math::AxisAlignedBox meshAABB;
+  /// \brief Number of vertices along each side of the grid
+  private: unsigned int vertexCount = 0u;
+
+  /// \brief Smallest height
+  private: double minHeight = 0.0;
+
+  /// \brief Largest height
+  private: double maxHeight = 0.0;
 };
 
 }
@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include <gz/common/Mesh.hh>
 #include <gz/common/SubMesh.hh>
 
@@ -154,3 +156,128 @@ TEST(Shape, MeshShape)
   EXPECT_EQ(v0, bbox.Min());
   EXPECT_EQ(v2, bbox.Max());
 }
+
+/////////////////////////////////////////////////
+TEST(Shape, MeshShapeHull)
+{
+  // a dense sphere of radius 2 around a point inside it
+  common::Mesh mesh;
+  common::SubMesh submesh;
+  submesh.AddVertex(math::Vector3d::Zero);
+  for (int i = 0; i <= 40; ++i)
+  {
+    double polar = GZ_PI * i / 40;
+    for (int j = 0; j < 80; ++j)
+    {
+      double azimuth = 2 * GZ_PI * j / 80;
+      submesh.AddVertex(math::Vector3d(
+          2 * std::sin(polar) * std::cos(azimuth),
+          2 * std::sin(polar) * std::sin(azimuth), 2 * std::cos(polar)));
+    }
+  }
+  mesh.AddSubMesh(submesh);
+
+  // the hull is simplified but keeps the bounding box of the mesh
+  MeshShape shape;
+  EXPECT_TRUE(shape.GetHullVertices().empty());
+  shape.SetMesh(mesh);
+  const std::vector<math::Vector3d> &hull = shape.GetHullVertices();
+  EXPECT_LE(hull.size(), kMaxMeshHullVertices);
+  EXPECT_GT(hull.size(), 6u);
+  for (const math::Vector3d &v : hull)
+    EXPECT_NEAR(2.0, v.Length(), 1e-9);
+  math::AxisAlignedBox bbox = shape.GetBoundingBox();
+  EXPECT_TRUE(math::Vector3d(-2, -2, -2).Equal(bbox.Min(), 1e-9));
+  EXPECT_TRUE(math::Vector3d(2, 2, 2).Equal(bbox.Max(), 1e-9));
+
+  // shapes of the same mesh and scale share their hull, including copies
+  MeshShape shape2;
+  shape2.SetMesh(mesh);
+  EXPECT_EQ(&hull, &shape2.GetHullVertices());
+  MeshShape copy(shape);
+  EXPECT_EQ(&hull, &copy.GetHullVertices());
+
+  // a different scale has its own hull
+  shape2.SetScale(math::Vector3d(1, 1, 0.5));
+  EXPECT_NE(&hull, &shape2.GetHullVertices());
+  bbox = shape2.GetBoundingBox();
+  EXPECT_TRUE(math::Vector3d(-2, -2, -1).Equal(bbox.Min(), 1e-9));
+  EXPECT_TRUE(math::Vector3d(2, 2, 1).Equal(bbox.Max(), 1e-9));
+  MeshShape shape3;
+  shape3.SetScale(math::Vector3d(1, 1, 0.5));
+  shape3.SetMesh(mesh);
+  EXPECT_EQ(&shape2.GetHullVertices(), &shape3.GetHullVertices());
+
+  // a mesh without vertices has no hull
+  common::Mesh emptyMesh;
+  MeshShape emptyShape;
+  emptyShape.SetMesh(emptyMesh);
+  EXPECT_TRUE(emptyShape.GetHullVertices().empty());
+  EXPECT_EQ(math::AxisAlignedBox(), emptyShape.GetBoundingBox());
+}
+
+/////////////////////////////////////////////////
+TEST(Shape, HeightmapShape)
+{
+  HeightmapShape shape;
+  EXPECT_EQ(ShapeType::HEIGHTMAP, shape.GetType());
+  EXPECT_EQ(0u, shape.GetVertexCount());
+  double height;
+  math::Vector3d normal;
+  EXPECT_FALSE(shape.GetHeight(0, 0, height, normal));
+
+  // the number of heights must match the grid
+  math::Vector3d size(4, 4, 0);
+  EXPECT_FALSE(shape.SetHeights({0, 0, 0}, 3u, size));
+  EXPECT_FALSE(shape.SetHeights({0}, 1u, size));
+
+  // a 3x3 grid with 2 m cells, a bump in the middle and a peak at the
+  // corner with the largest x and smallest y
+  std::vector<float> heights = {
+    0, 0, 0,
+    0, 1, 0,
+    0, 0, 2};
+  EXPECT_TRUE(shape.SetHeights(heights, 3u, size));
+  EXPECT_EQ(3u, shape.GetVertexCount());
+  EXPECT_EQ(math::Vector3d(4, 4, 2), shape.GetSize());
+  math::AxisAlignedBox bbox = shape.GetBoundingBox();
+  EXPECT_EQ(math::Vector3d(-2, -2, 0), bbox.Min());
+  EXPECT_EQ(math::Vector3d(2, 2, 2), bbox.Max());
+
+  // heights are interpolated between the vertices
+  EXPECT_TRUE(shape.GetHeight(0, 0, height, normal));
+  EXPECT_DOUBLE_EQ(1.0, height);
+  EXPECT_TRUE(normal.Equal(math::Vector3d(0.5, -0.5, 1).Normalized(), 1e-9));
+  EXPECT_TRUE(shape.GetHeight(1, -1, height, normal));
+  EXPECT_DOUBLE_EQ(0.75, height);
+  EXPECT_TRUE(shape.GetHeight(-1, 1, height, normal));
+  EXPECT_DOUBLE_EQ(0.25, height);
+  EXPECT_TRUE(shape.GetHeight(2, -2, height, normal));
+  EXPECT_DOUBLE_EQ(2.0, height);
+  EXPECT_FALSE(shape.GetHeight(3, 0, height, normal));
+
+  // highest point over a rectangle
+  math::Vector3d point;
+  EXPECT_TRUE(shape.GetMaxHeight(math::Vector3d(-1.5, -1.5, 0),
+      math::Vector3d(-0.5, -0.5, 0), point, normal));
+  EXPECT_TRUE(point.Equal(math::Vector3d(-0.5, -0.5, 0.5625), 1e-9));
+  EXPECT_TRUE(shape.GetMaxHeight(math::Vector3d(-10, -10, 0),
+      math::Vector3d(10, 10, 0), point, normal));
+  EXPECT_TRUE(point.Equal(math::Vector3d(2, -2, 2), 1e-9));
+  EXPECT_FALSE(shape.GetMaxHeight(math::Vector3d(3, 3, 0),
+      math::Vector3d(4, 4, 0), point, normal));
+
+  // on a flat heightmap the highest point is the center of the rectangle
+  HeightmapShape flat;
+  EXPECT_TRUE(flat.SetHeights(std::vector<float>(9, 0.5f), 3u, size));
+  EXPECT_TRUE(flat.GetMaxHeight(math::Vector3d(-1, -1, 0),
+      math::Vector3d(1, 1, 0), point, normal));
+  EXPECT_TRUE(point.Equal(math::Vector3d(0, 0, 0.5), 1e-9));
+  EXPECT_EQ(math::Vector3d(0, 0, 1), normal);
+
+  // copies share the heights
+  HeightmapShape copy(shape);
+  EXPECT_TRUE(copy.GetHeight(0, 0, height, normal));
+  EXPECT_DOUBLE_EQ(1.0, height);
+}
+
@@ -0,0 +1,754 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gz/common/Console.hh>
+#include <gz/common/Profiler.hh>
+
+#include "SpatialHashGrid.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+/// \brief Integer coordinates of a grid cell
+using SpatialHashGridCellKey = std::array<std::int64_t, 3>;
+
+/// \brief Hash function for grid cell coordinates
+struct SpatialHashGridCellHash
+{
+  /// \brief Hash cell coordinates
+  /// \param[in] _key Cell coordinates
+  /// \return Hash value
+  std::size_t operator()(const SpatialHashGridCellKey &_key) const
+  {
+    // large primes from "Optimized Spatial Hashing for Collision Detection
+    // of Deformable Objects", Teschner et al. 2003
+    return static_cast<std::size_t>(
+        (static_cast<std::uint64_t>(_key[0]) * 73856093u) ^
+        (static_cast<std::uint64_t>(_key[1]) * 19349663u) ^
+        (static_cast<std::uint64_t>(_key[2]) * 83492791u));
+  }
+};
+
+/// \brief A node of the spatial hash grid
+struct SpatialHashGridNode
+{
+  /// \brief Node id
+  std::size_t id;
+
+  /// \brief Lower bound of the enlarged AABB
+  std::array<double, 3> min;
+
+  /// \brief Upper bound of the enlarged AABB
+  std::array<double, 3> max;
+
+  /// \brief Lower bound of the actual AABB
+  std::array<double, 3> aabbMin;
+
+  /// \brief Upper bound of the actual AABB
+  std::array<double, 3> aabbMax;
+
+  /// \brief Coordinates of the cell containing the lower bound of the
+  /// enlarged AABB
+  SpatialHashGridCellKey cellMin;
+
+  /// \brief Coordinates of the cell containing the upper bound of the
+  /// enlarged AABB
+  SpatialHashGridCellKey cellMax;
+
+  /// \brief True if the node spans too many cells to be stored in the grid
+  bool oversized{false};
+
+  /// \brief Collide bitmask
+  uint16_t collideBitmask{kDefaultCollideBitmask};
+};
+
+/// \brief Private data class for SpatialHashGrid
+class SpatialHashGridPrivate
+{
+  /// \brief Compute the cell range of a node and add it to the grid
+  /// \param[in] _index Index of the node
+  public: void Insert(std::size_t _index);
+
+  /// \brief Remove a node from the grid
+  /// \param[in] _index Index of the node
+  public: void Erase(std::size_t _index);
+
+  /// \brief Update the grid after a node moved to a new index
+  /// \param[in] _from Previous index of the node
+  /// \param[in] _to New index of the node
+  public: void Reindex(std::size_t _from, std::size_t _to);
+
+  /// \brief Recompute the cell size if needed and add all nodes to the grid
+  public: void Rebuild();
+
+  /// \brief Compute the cell size from the median of the largest side of
+  /// the node AABBs
+  /// \return Cell size
+  public: double ComputeCellSize();
+
+  /// \brief All nodes
+  public: std::vector<SpatialHashGridNode> nodes;
+
+  /// \brief Map of node id to index in nodes
+  public: std::unordered_map<std::size_t, std::size_t> indices;
+
+  /// \brief Map of cell coordinates to the indices of the nodes in the cell
+  public: std::unordered_map<SpatialHashGridCellKey, std::vector<std::size_t>,
+      SpatialHashGridCellHash> cells;
+
+  /// \brief Indices of the nodes that are not stored in the grid
+  public: std::vector<std::size_t> oversized;
+
+  /// \brief Lowest coordinates of the cells that nodes were added to since
+  /// the last rebuild
+  public: SpatialHashGridCellKey boundsMin;
+
+  /// \brief Highest coordinates of the cells that nodes were added to since
+  /// the last rebuild
+  public: SpatialHashGridCellKey boundsMax;
+
+  /// \brief Buffer used to compute the median node size
+  public: std::vector<double> sizes;
+
+  /// \brief Length of the cell sides
+  public: double cellSize{0.0};
+
+  /// \brief True if the cell size is computed from the node AABBs
+  public: bool autoCellSize{true};
+
+  /// \brief Number of nodes when the cell size was last computed
+  public: std::size_t cellSizeNodeCount{0u};
+
+  /// \brief True if the grid needs to be rebuilt before the next query.
+  /// Nodes are not added to the cells while this is true.
+  public: bool dirty{true};
+};
+}
+}
+}
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+namespace
+{
+/// \brief Nodes spanning more cells than this are kept out of the grid
+const double kMaxNodeCellCount = 64.0;
+
+/// \brief Copy an axis aligned box to a node
+/// \param[in] _aabb Actual AABB
+/// \param[in] _fat Enlarged AABB
+/// \param[out] _node Node to fill
+void SetBounds(const math::AxisAlignedBox &_aabb,
+    const math::AxisAlignedBox &_fat, SpatialHashGridNode &_node)
+{
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    _node.aabbMin[i] = _aabb.Min()[i];
+    _node.aabbMax[i] = _aabb.Max()[i];
+    _node.min[i] = _fat.Min()[i];
+    _node.max[i] = _fat.Max()[i];
+  }
+}
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGridPrivate::Insert(std::size_t _index)
+{
+  SpatialHashGridNode &node = this->nodes[_index];
+
+  double cellCount = 1.0;
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    double lower = std::floor(node.min[i] / this->cellSize);
+    double upper = std::floor(node.max[i] / this->cellSize);
+    if (!std::isfinite(lower) || !std::isfinite(upper))
+    {
+      cellCount = kMaxNodeCellCount + 1.0;
+      break;
+    }
+    cellCount *= upper - lower + 1.0;
+    node.cellMin[i] = static_cast<std::int64_t>(lower);
+    node.cellMax[i] = static_cast<std::int64_t>(upper);
+  }
+
+  node.oversized = cellCount > kMaxNodeCellCount;
+  if (node.oversized)
+  {
+    this->oversized.push_back(_index);
+    return;
+  }
+
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    this->boundsMin[i] = std::min(this->boundsMin[i], node.cellMin[i]);
+    this->boundsMax[i] = std::max(this->boundsMax[i], node.cellMax[i]);
+  }
+
+  SpatialHashGridCellKey key;
+  for (key[0] = node.cellMin[0]; key[0] <= node.cellMax[0]; ++key[0])
+  {
+    for (key[1] = node.cellMin[1]; key[1] <= node.cellMax[1]; ++key[1])
+    {
+      for (key[2] = node.cellMin[2]; key[2] <= node.cellMax[2]; ++key[2])
+        this->cells[key].push_back(_index);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGridPrivate::Erase(std::size_t _index)
+{
+  const SpatialHashGridNode &node = this->nodes[_index];
+  if (node.oversized)
+  {
+    this->oversized.erase(std::find(
+        this->oversized.begin(), this->oversized.end(), _index));
+    return;
+  }
+
+  SpatialHashGridCellKey key;
+  for (key[0] = node.cellMin[0]; key[0] <= node.cellMax[0]; ++key[0])
+  {
+    for (key[1] = node.cellMin[1]; key[1] <= node.cellMax[1]; ++key[1])
+    {
+      for (key[2] = node.cellMin[2]; key[2] <= node.cellMax[2]; ++key[2])
+      {
+        auto it = this->cells.find(key);
+        if (it == this->cells.end())
+          continue;
+        auto &cell = it->second;
+        auto nodeIt = std::find(cell.begin(), cell.end(), _index);
+        if (nodeIt != cell.end())
+        {
+          *nodeIt = cell.back();
+          cell.pop_back();
+        }
+        if (cell.empty())
+          this->cells.erase(it);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGridPrivate::Reindex(std::size_t _from, std::size_t _to)
+{
+  const SpatialHashGridNode &node = this->nodes[_to];
+  if (node.oversized)
+  {
+    std::replace(this->oversized.begin(), this->oversized.end(), _from, _to);
+    return;
+  }
+
+  SpatialHashGridCellKey key;
+  for (key[0] = node.cellMin[0]; key[0] <= node.cellMax[0]; ++key[0])
+  {
+    for (key[1] = node.cellMin[1]; key[1] <= node.cellMax[1]; ++key[1])
+    {
+      for (key[2] = node.cellMin[2]; key[2] <= node.cellMax[2]; ++key[2])
+      {
+        auto &cell = this->cells[key];
+        std::replace(cell.begin(), cell.end(), _from, _to);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+double SpatialHashGridPrivate::ComputeCellSize()
+{
+  this->sizes.clear();
+  for (const auto &node : this->nodes)
+  {
+    double size = std::max({node.max[0] - node.min[0],
+        node.max[1] - node.min[1], node.max[2] - node.min[2]});
+    if (std::isfinite(size))
+      this->sizes.push_back(size);
+  }
+
+  if (this->sizes.empty())
+    return 0.0;
+
+  auto median = this->sizes.begin() + this->sizes.size() / 2u;
+  std::nth_element(this->sizes.begin(), median, this->sizes.end());
+  return *median;
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGridPrivate::Rebuild()
+{
+  GZ_PROFILE("tpelib::SpatialHashGrid::Rebuild");
+  this->cells.clear();
+  this->oversized.clear();
+  this->boundsMin.fill(std::numeric_limits<std::int64_t>::max());
+  this->boundsMax.fill(std::numeric_limits<std::int64_t>::min());
+
+  if (this->autoCellSize)
+  {
+    this->cellSize = this->ComputeCellSize();
+    this->cellSizeNodeCount = this->nodes.size();
+
+    // all nodes are points
+    if (this->cellSize <= 0.0)
+      this->cellSize = 1.0;
+  }
+
+  for (std::size_t i = 0u; i < this->nodes.size(); ++i)
+    this->Insert(i);
+  this->dirty = false;
+}
+
+//////////////////////////////////////////////////
+SpatialHashGrid::SpatialHashGrid()
+  : dataPtr(new SpatialHashGridPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+SpatialHashGrid::~SpatialHashGrid() = default;
+
+//////////////////////////////////////////////////
+void SpatialHashGrid::SetCellSize(double _size)
+{
+  if (_size < 0.0 || !std::isfinite(_size))
+  {
+    gzerr << "Invalid cell size '" << _size << "'. "
+          << "Cell size must be positive, or 0 to compute it automatically."
+          << std::endl;
+    return;
+  }
+
+  this->dataPtr->autoCellSize = _size == 0.0;
+  this->dataPtr->cellSize = _size;
+  this->dataPtr->dirty = true;
+}
+
+//////////////////////////////////////////////////
+double SpatialHashGrid::CellSize() const
+{
+  return this->dataPtr->cellSize;
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGrid::AddNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
+{
+  if (this->HasNode(_id))
+  {
+    gzerr << "Unable to add node '" << _id << "'. "
+           << "Node already exists." << std::endl;
+    return;
+  }
+
+  SpatialHashGridNode node;
+  node.id = _id;
+  SetBounds(_aabb, this->Fatten(_aabb, _displacement), node);
+
+  std::size_t index = this->dataPtr->nodes.size();
+  this->dataPtr->indices[_id] = index;
+  this->dataPtr->nodes.push_back(node);
+
+  if (this->dataPtr->autoCellSize &&
+      this->dataPtr->nodes.size() >= 2u * this->dataPtr->cellSizeNodeCount)
+  {
+    this->dataPtr->dirty = true;
+  }
+
+  if (!this->dataPtr->dirty)
+    this->dataPtr->Insert(index);
+}
+
+//////////////////////////////////////////////////
+bool SpatialHashGrid::RemoveNode(std::size_t _id)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to remove node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  std::size_t index = it->second;
+  std::size_t last = this->dataPtr->nodes.size() - 1u;
+  this->dataPtr->indices.erase(it);
+  if (!this->dataPtr->dirty)
+    this->dataPtr->Erase(index);
+
+  // move the last node into the hole
+  if (index != last)
+  {
+    this->dataPtr->nodes[index] = this->dataPtr->nodes[last];
+    this->dataPtr->indices[this->dataPtr->nodes[index].id] = index;
+    if (!this->dataPtr->dirty)
+      this->dataPtr->Reindex(last, index);
+  }
+  this->dataPtr->nodes.pop_back();
+
+  if (this->dataPtr->autoCellSize &&
+      2u * this->dataPtr->nodes.size() < this->dataPtr->cellSizeNodeCount)
+  {
+    this->dataPtr->dirty = true;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SpatialHashGrid::UpdateNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to update node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  std::size_t index = it->second;
+  SpatialHashGridNode &node = this->dataPtr->nodes[index];
+  bool contained = true;
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    contained &= (_aabb.Min()[i] >= node.min[i]) &
+                 (_aabb.Max()[i] <= node.max[i]);
+  }
+
+  if (contained)
+  {
+    for (unsigned int i = 0; i < 3u; ++i)
+    {
+      node.aabbMin[i] = _aabb.Min()[i];
+      node.aabbMax[i] = _aabb.Max()[i];
+    }
+    return true;
+  }
+
+  ++this->reinsertCount;
+  if (this->dataPtr->dirty)
+  {
+    SetBounds(_aabb, this->Fatten(_aabb, _displacement), node);
+    return true;
+  }
+
+  // only touch the grid if the node moved to different cells
+  SpatialHashGridNode previous = node;
+  SetBounds(_aabb, this->Fatten(_aabb, _displacement), node);
+  if (!previous.oversized)
+  {
+    bool sameCells = true;
+    for (unsigned int i = 0; i < 3u; ++i)
+    {
+      sameCells &=
+          (std::floor(node.min[i] / this->dataPtr->cellSize) ==
+           static_cast<double>(previous.cellMin[i])) &
+          (std::floor(node.max[i] / this->dataPtr->cellSize) ==
+           static_cast<double>(previous.cellMax[i]));
+    }
+    if (sameCells)
+      return true;
+  }
+
+  std::swap(node, previous);
+  this->dataPtr->Erase(index);
+  this->dataPtr->nodes[index] = previous;
+  this->dataPtr->Insert(index);
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int SpatialHashGrid::NodeCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->nodes.size());
+}
+
+//////////////////////////////////////////////////
+bool SpatialHashGrid::HasNode(std::size_t _id) const
+{
+  return this->dataPtr->indices.find(_id) != this->dataPtr->indices.end();
+}
+
+//////////////////////////////////////////////////
+bool SpatialHashGrid::SetCollideBitmask(std::size_t _id, uint16_t _bitmask)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to set collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  this->dataPtr->nodes[it->second].collideBitmask = _bitmask;
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint16_t SpatialHashGrid::CollideBitmask(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return 0u;
+  }
+
+  return this->dataPtr->nodes[it->second].collideBitmask;
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGrid::CollisionPairs(
+    std::vector<std::pair<std::size_t, std::size_t>> &_pairs) const
+{
+  GZ_PROFILE("tpelib::SpatialHashGrid::CollisionPairs");
+  _pairs.clear();
+
+  if (this->dataPtr->dirty)
+    this->dataPtr->Rebuild();
+
+  const auto &nodes = this->dataPtr->nodes;
+  auto overlap = [](const SpatialHashGridNode &_n1,
+      const SpatialHashGridNode &_n2)
+  {
+    return static_cast<bool>(
+        (_n2.min[0] <= _n1.max[0]) & (_n1.min[0] <= _n2.max[0]) &
+        (_n2.min[1] <= _n1.max[1]) & (_n1.min[1] <= _n2.max[1]) &
+        (_n2.min[2] <= _n1.max[2]) & (_n1.min[2] <= _n2.max[2]) &
+        ((_n1.collideBitmask & _n2.collideBitmask) != 0));
+  };
+
+  for (const auto &[key, cell] : this->dataPtr->cells)
+  {
+    for (std::size_t i = 0u; i < cell.size(); ++i)
+    {
+      const SpatialHashGridNode &n1 = nodes[cell[i]];
+      for (std::size_t j = i + 1u; j < cell.size(); ++j)
+      {
+        const SpatialHashGridNode &n2 = nodes[cell[j]];
+        if (!overlap(n1, n2))
+          continue;
+
+        // Two nodes may share several cells. Only report the pair in the
+        // cell containing the lower corner of their overlap.
+        if (std::max(n1.cellMin[0], n2.cellMin[0]) != key[0] ||
+            std::max(n1.cellMin[1], n2.cellMin[1]) != key[1] ||
+            std::max(n1.cellMin[2], n2.cellMin[2]) != key[2])
+        {
+          continue;
+        }
+
+        _pairs.emplace_back(std::min(n1.id, n2.id), std::max(n1.id, n2.id));
+      }
+    }
+  }
+
+  // test nodes that are not in the grid against all other nodes
+  for (std::size_t o : this->dataPtr->oversized)
+  {
+    const SpatialHashGridNode &n1 = nodes[o];
+    for (std::size_t i = 0u; i < nodes.size(); ++i)
+    {
+      const SpatialHashGridNode &n2 = nodes[i];
+      // pairs of oversized nodes are reported once
+      if (i == o || (n2.oversized && i < o))
+        continue;
+
+      if (overlap(n1, n2))
+        _pairs.emplace_back(std::min(n1.id, n2.id), std::max(n1.id, n2.id));
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void SpatialHashGrid::RayQuery(RayPacket &_packet,
+    const std::function<void(std::size_t, unsigned int)> &_callback) const
+{
+  const auto &nodes = this->dataPtr->nodes;
+
+  // the cells are only filled when the grid is rebuilt by CollisionPairs.
+  // Until then rays are tested against every node.
+  if (this->dataPtr->dirty)
+  {
+    for (const auto &node : nodes)
+    {
+      for (unsigned int i = 0; i < _packet.size; ++i)
+      {
+        if (_packet.Hits(i, node.aabbMin, node.aabbMax))
+          _callback(node.id, i);
+      }
+    }
+    return;
+  }
+
+  // nodes that are not in the grid are tested against every ray
+  for (std::size_t o : this->dataPtr->oversized)
+  {
+    for (unsigned int i = 0; i < _packet.size; ++i)
+    {
+      if (_packet.Hits(i, nodes[o].aabbMin, nodes[o].aabbMax))
+        _callback(nodes[o].id, i);
+    }
+  }
+  if (this->dataPtr->cells.empty())
+    return;
+
+  // Nodes spanning several cells are only tested once per ray. Each ray
+  // gets a new stamp and the nodes it tested are marked with it.
+  thread_local std::vector<std::uint32_t> stamps;
+  thread_local std::uint32_t stamp = 0u;
+  if (stamps.size() < nodes.size())
+    stamps.resize(nodes.size(), 0u);
+
+  const double cellSize = this->dataPtr->cellSize;
+  const auto &boundsMin = this->dataPtr->boundsMin;
+  const auto &boundsMax = this->dataPtr->boundsMax;
+  for (unsigned int i = 0; i < _packet.size; ++i)
+  {
+    if (++stamp == 0u)
+    {
+      std::fill(stamps.begin(), stamps.end(), 0u);
+      stamp = 1u;
+    }
+
+    // clip the ray to the cells that hold nodes. Rays without a direction
+    // have a negative maximum distance.
+    const auto &origin = _packet.origins[i];
+    const auto &invDirection = _packet.invDirections[i];
+    std::array<double, 3> direction;
+    double tMin = 0.0;
+    double tMax = _packet.maxDistances[i];
+    for (unsigned int k = 0; k < 3u; ++k)
+    {
+      direction[k] = 1.0 / invDirection[k];
+      double lower = static_cast<double>(boundsMin[k]) * cellSize;
+      double upper = static_cast<double>(boundsMax[k] + 1) * cellSize;
+      if (direction[k] == 0.0)
+      {
+        if (origin[k] < lower || origin[k] > upper)
+          tMax = -1.0;
+        continue;
+      }
+      double t1 = (lower - origin[k]) * invDirection[k];
+      double t2 = (upper - origin[k]) * invDirection[k];
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+    }
+    if (!(tMin <= tMax))
+      continue;
+
+    // find the cell where the clipped ray starts, and the distance along
+    // the ray to the next cell on each axis
+    SpatialHashGridCellKey key;
+    std::array<std::int64_t, 3> step;
+    std::array<double, 3> next;
+    std::array<double, 3> delta;
+    for (unsigned int k = 0; k < 3u; ++k)
+    {
+      double start = std::floor(
+          (origin[k] + direction[k] * tMin) / cellSize);
+      key[k] = std::clamp(static_cast<std::int64_t>(start), boundsMin[k],
+          boundsMax[k]);
+      if (direction[k] == 0.0)
+      {
+        step[k] = 0;
+        next[k] = std::numeric_limits<double>::infinity();
+        delta[k] = next[k];
+        continue;
+      }
+      step[k] = direction[k] > 0.0 ? 1 : -1;
+      double boundary = static_cast<double>(key[k] + (step[k] > 0 ? 1 : 0)) *
+          cellSize;
+      next[k] = (boundary - origin[k]) * invDirection[k];
+      delta[k] = cellSize * std::abs(invDirection[k]);
+    }
+
+    // march through the cells from the origin of the ray. The callback
+    // shortens the ray when it finds a hit, so the cells beyond the hit are
+    // not visited.
+    while (true)
+    {
+      auto it = this->dataPtr->cells.find(key);
+      if (it != this->dataPtr->cells.end())
+      {
+        for (std::size_t index : it->second)
+        {
+          if (stamps[index] == stamp)
+            continue;
+          stamps[index] = stamp;
+          if (_packet.Hits(i, nodes[index].aabbMin, nodes[index].aabbMax))
+            _callback(nodes[index].id, i);
+        }
+      }
+
+      unsigned int axis = next[0] < next[1] ?
+          (next[0] < next[2] ? 0u : 2u) : (next[1] < next[2] ? 1u : 2u);
+      if (next[axis] > std::min(tMax, _packet.maxDistances[i]))
+        break;
+      key[axis] += step[axis];
+      if (key[axis] < boundsMin[axis] || key[axis] > boundsMax[axis])
+        break;
+      next[axis] += delta[axis];
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox SpatialHashGrid::AABB(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get AABB for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return math::AxisAlignedBox();
+  }
+
+  const SpatialHashGridNode &node = this->dataPtr->nodes[it->second];
+  return math::AxisAlignedBox(
+      math::Vector3d(node.aabbMin[0], node.aabbMin[1], node.aabbMin[2]),
+      math::Vector3d(node.aabbMax[0], node.aabbMax[1], node.aabbMax[2]));
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox SpatialHashGrid::FatAABB(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get AABB for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return math::AxisAlignedBox();
+  }
+
+  const SpatialHashGridNode &node = this->dataPtr->nodes[it->second];
+  return math::AxisAlignedBox(
+      math::Vector3d(node.min[0], node.min[1], node.min[2]),
+      math::Vector3d(node.max[0], node.max[1], node.max[2]));
+}
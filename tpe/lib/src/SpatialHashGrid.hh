@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_SPATIALHASHGRID_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_SPATIALHASHGRID_HH_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/utils/SuppressWarning.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+#include "Broadphase.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+// forward declaration
+class SpatialHashGridPrivate;
+
+/// \brief Broadphase based on a uniform grid of cubic cells stored in a hash
+/// map. Each node is added to the cells overlapped by its enlarged AABB, so
+/// adding and updating nodes of about the cell size is done in constant
+/// time. Only the nodes that share a cell are tested against each other.
+///
+/// Unless set explicitly, the cell size is the median of the largest side of
+/// the node AABBs, and is recomputed when the number of nodes doubles or
+/// halves. Nodes that span too many cells, e.g. the ground, are kept out of
+/// the grid and tested against all the other nodes.
+///
+/// Rays march through the cells they cross, from their origin to their
+/// maximum distance, and are only tested against the nodes of those cells
+/// and the nodes kept out of the grid. Until the grid is rebuilt by the
+/// next call to CollisionPairs, rays are tested against every node.
+class GZ_PHYSICS_TPELIB_VISIBLE SpatialHashGrid : public Broadphase
+{
+  /// \brief Constructor
+  public: SpatialHashGrid();
+
+  /// \brief Destructor
+  public: ~SpatialHashGrid() override;
+
+  /// \brief Set the size of the grid cells
+  /// \param[in] _size Length of the cell sides in meters. Set to 0 to
+  /// compute it from the node AABBs. Defaults to 0.
+  public: void SetCellSize(double _size);
+
+  /// \brief Get the size of the grid cells
+  /// \return Length of the cell sides in meters. This is 0 if the cell size
+  /// is computed from the node AABBs and there has not been any query yet.
+  public: double CellSize() const;
+
+  // Documentation inherited
+  public: void AddNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  // Documentation inherited
+  public: bool RemoveNode(std::size_t _id) override;
+
+  // Documentation inherited
+  public: bool UpdateNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  // Documentation inherited
+  public: unsigned int NodeCount() const override;
+
+  // Documentation inherited
+  public: bool HasNode(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: bool SetCollideBitmask(std::size_t _id, uint16_t _bitmask)
+      override;
+
+  // Documentation inherited
+  public: uint16_t CollideBitmask(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: void CollisionPairs(
+      std::vector<std::pair<std::size_t, std::size_t>> &_pairs)
+      const override;
+
+  // Documentation inherited
+  public: void RayQuery(RayPacket &_packet,
+      const std::function<void(std::size_t, unsigned int)> &_callback)
+      const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox AABB(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox FatAABB(std::size_t _id) const override;
+
+  /// \brief Pointer to the private data
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  private: std::unique_ptr<SpatialHashGridPrivate> dataPtr;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gz/common/Console.hh>
+#include <gz/common/Profiler.hh>
+
+#include "SweepAndPrune.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+/// \brief A node of the sort and sweep broadphase
+struct SweepAndPruneEntry
+{
+  /// \brief Node id
+  std::size_t id;
+
+  /// \brief Lower bound of the enlarged AABB
+  std::array<double, 3> min;
+
+  /// \brief Upper bound of the enlarged AABB
+  std::array<double, 3> max;
+
+  /// \brief Lower bound of the actual AABB
+  std::array<double, 3> aabbMin;
+
+  /// \brief Upper bound of the actual AABB
+  std::array<double, 3> aabbMax;
+
+  /// \brief Collide bitmask
+  uint16_t collideBitmask{kDefaultCollideBitmask};
+};
+
+/// \brief Private data class for SweepAndPrune
+class SweepAndPrunePrivate
+{
+  /// \brief Sort the entries along the sweep axis and update the map of
+  /// entry indices.
+  public: void Sort();
+
+  /// \brief Nodes sorted by the lower bound of their enlarged AABB along
+  /// the sweep axis.
+  public: std::vector<SweepAndPruneEntry> entries;
+
+  /// \brief Map of node id to index in entries
+  public: std::unordered_map<std::size_t, std::size_t> indices;
+
+  /// \brief Axis the entries are sorted along
+  public: unsigned int axis{0u};
+
+  /// \brief Number of entries added, moved or removed out of order since
+  /// the last sort.
+  public: std::size_t unsorted{0u};
+
+  /// \brief True if no entry was added, removed or enlarged since the last
+  /// sort, so that the entries are in order
+  public: bool sorted{true};
+};
+}
+}
+}
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+namespace
+{
+/// \brief Above this number of out of order entries the entries are sorted
+/// from scratch instead of with an insertion sort.
+const std::size_t kMaxInsertionSortCount = 16u;
+
+/// \brief Copy an axis aligned box to an entry
+/// \param[in] _aabb Actual AABB
+/// \param[in] _fat Enlarged AABB
+/// \param[out] _entry Entry to fill
+void SetBounds(const math::AxisAlignedBox &_aabb,
+    const math::AxisAlignedBox &_fat, SweepAndPruneEntry &_entry)
+{
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    _entry.aabbMin[i] = _aabb.Min()[i];
+    _entry.aabbMax[i] = _aabb.Max()[i];
+    _entry.min[i] = _fat.Min()[i];
+    _entry.max[i] = _fat.Max()[i];
+  }
+}
+}
+
+//////////////////////////////////////////////////
+void SweepAndPrunePrivate::Sort()
+{
+  const unsigned int a = this->axis;
+  if (this->unsorted > kMaxInsertionSortCount)
+  {
+    std::sort(this->entries.begin(), this->entries.end(),
+        [a](const SweepAndPruneEntry &_e1, const SweepAndPruneEntry &_e2)
+        {
+          return _e1.min[a] < _e2.min[a];
+        });
+    for (std::size_t i = 0u; i < this->entries.size(); ++i)
+      this->indices[this->entries[i].id] = i;
+  }
+  else
+  {
+    // The entries are nearly sorted when nodes move little between calls so
+    // an insertion sort only shifts a few entries.
+    for (std::size_t i = 1u; i < this->entries.size(); ++i)
+    {
+      if (this->entries[i - 1u].min[a] <= this->entries[i].min[a])
+        continue;
+
+      SweepAndPruneEntry entry = this->entries[i];
+      std::size_t j = i;
+      while (j > 0u && this->entries[j - 1u].min[a] > entry.min[a])
+      {
+        this->entries[j] = this->entries[j - 1u];
+        this->indices[this->entries[j].id] = j;
+        --j;
+      }
+      this->entries[j] = entry;
+      this->indices[entry.id] = j;
+    }
+  }
+  this->unsorted = 0u;
+  this->sorted = true;
+}
+
+//////////////////////////////////////////////////
+SweepAndPrune::SweepAndPrune()
+  : dataPtr(new SweepAndPrunePrivate)
+{
+}
+
+//////////////////////////////////////////////////
+SweepAndPrune::~SweepAndPrune() = default;
+
+//////////////////////////////////////////////////
+void SweepAndPrune::AddNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
+{
+  if (this->HasNode(_id))
+  {
+    gzerr << "Unable to add node '" << _id << "'. "
+           << "Node already exists." << std::endl;
+    return;
+  }
+
+  SweepAndPruneEntry entry;
+  entry.id = _id;
+  SetBounds(_aabb, this->Fatten(_aabb, _displacement), entry);
+
+  this->dataPtr->indices[_id] = this->dataPtr->entries.size();
+  this->dataPtr->entries.push_back(entry);
+  ++this->dataPtr->unsorted;
+  this->dataPtr->sorted = false;
+}
+
+//////////////////////////////////////////////////
+bool SweepAndPrune::RemoveNode(std::size_t _id)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to remove node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  // move the last entry into the hole. It will be put back in order on the
+  // next sort.
+  std::size_t index = it->second;
+  this->dataPtr->indices.erase(it);
+  if (index + 1u != this->dataPtr->entries.size())
+  {
+    this->dataPtr->entries[index] = this->dataPtr->entries.back();
+    this->dataPtr->indices[this->dataPtr->entries[index].id] = index;
+    ++this->dataPtr->unsorted;
+    this->dataPtr->sorted = false;
+  }
+  this->dataPtr->entries.pop_back();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SweepAndPrune::UpdateNode(std::size_t _id,
+    const math::AxisAlignedBox &_aabb, const math::Vector3d &_displacement)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to update node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  SweepAndPruneEntry &entry = this->dataPtr->entries[it->second];
+  bool contained = true;
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    contained &= (_aabb.Min()[i] >= entry.min[i]) &
+                 (_aabb.Max()[i] <= entry.max[i]);
+  }
+
+  if (contained)
+  {
+    for (unsigned int i = 0; i < 3u; ++i)
+    {
+      entry.aabbMin[i] = _aabb.Min()[i];
+      entry.aabbMax[i] = _aabb.Max()[i];
+    }
+    return true;
+  }
+
+  // the entry is put back in order on the next sort
+  SetBounds(_aabb, this->Fatten(_aabb, _displacement), entry);
+  ++this->reinsertCount;
+  this->dataPtr->sorted = false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int SweepAndPrune::NodeCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->entries.size());
+}
+
+//////////////////////////////////////////////////
+bool SweepAndPrune::HasNode(std::size_t _id) const
+{
+  return this->dataPtr->indices.find(_id) != this->dataPtr->indices.end();
+}
+
+//////////////////////////////////////////////////
+bool SweepAndPrune::SetCollideBitmask(std::size_t _id, uint16_t _bitmask)
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to set collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return false;
+  }
+
+  this->dataPtr->entries[it->second].collideBitmask = _bitmask;
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint16_t SweepAndPrune::CollideBitmask(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get collide bitmask for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return 0u;
+  }
+
+  return this->dataPtr->entries[it->second].collideBitmask;
+}
+
+//////////////////////////////////////////////////
+void SweepAndPrune::CollisionPairs(
+    std::vector<std::pair<std::size_t, std::size_t>> &_pairs) const
+{
+  GZ_PROFILE("tpelib::SweepAndPrune::CollisionPairs");
+  _pairs.clear();
+
+  this->dataPtr->Sort();
+
+  const auto &entries = this->dataPtr->entries;
+  const unsigned int a = this->dataPtr->axis;
+  const unsigned int b = (a + 1u) % 3u;
+  const unsigned int c = (a + 2u) % 3u;
+
+  // sums used to compute the variance of the node centers along each axis
+  std::array<double, 3> sum = {0.0, 0.0, 0.0};
+  std::array<double, 3> sumSq = {0.0, 0.0, 0.0};
+
+  for (std::size_t i = 0u; i < entries.size(); ++i)
+  {
+    const SweepAndPruneEntry &e1 = entries[i];
+    for (unsigned int k = 0; k < 3u; ++k)
+    {
+      double center = 0.5 * (e1.min[k] + e1.max[k]);
+      sum[k] += center;
+      sumSq[k] += center * center;
+    }
+
+    // entries are sorted along the sweep axis so stop at the first entry
+    // that starts after this one ends
+    for (std::size_t j = i + 1u;
+         j < entries.size() && entries[j].min[a] <= e1.max[a]; ++j)
+    {
+      const SweepAndPruneEntry &e2 = entries[j];
+      if ((e2.min[b] <= e1.max[b]) & (e1.min[b] <= e2.max[b]) &
+          (e2.min[c] <= e1.max[c]) & (e1.min[c] <= e2.max[c]) &
+          ((e1.collideBitmask & e2.collideBitmask) != 0))
+      {
+        _pairs.emplace_back(std::min(e1.id, e2.id), std::max(e1.id, e2.id));
+      }
+    }
+  }
+
+  // sweep along the axis with the largest variance on the next call
+  unsigned int bestAxis = a;
+  double bestVariance = -1.0;
+  double n = static_cast<double>(entries.size());
+  for (unsigned int k = 0; k < 3u && n > 0.0; ++k)
+  {
+    double variance = sumSq[k] - sum[k] * sum[k] / n;
+    if (variance > bestVariance)
+    {
+      bestVariance = variance;
+      bestAxis = k;
+    }
+  }
+  if (bestAxis != a)
+  {
+    this->dataPtr->axis = bestAxis;
+    this->dataPtr->unsorted = entries.size();
+    this->dataPtr->sorted = false;
+  }
+}
+
+//////////////////////////////////////////////////
+void SweepAndPrune::RayQuery(RayPacket &_packet,
+    const std::function<void(std::size_t, unsigned int)> &_callback) const
+{
+  const auto &entries = this->dataPtr->entries;
+  const unsigned int a = this->dataPtr->axis;
+
+  // extent of the rays along the sweep axis. Rays without a direction have
+  // a negative maximum distance.
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -lower;
+  for (unsigned int i = 0; i < _packet.size; ++i)
+  {
+    if (_packet.maxDistances[i] < 0.0)
+      continue;
+    double origin = _packet.origins[i][a];
+    double end = origin;
+    double direction = 1.0 / _packet.invDirections[i][a];
+    if (direction != 0.0)
+      end += direction * _packet.maxDistances[i];
+    lower = std::min({lower, origin, end});
+    upper = std::max({upper, origin, end});
+  }
+
+  // the entries are sorted by their lower bound along the sweep axis, so
+  // the entries past the end of the rays are skipped. Entries moved since
+  // the last sort are all tested.
+  auto last = entries.end();
+  if (this->dataPtr->sorted)
+  {
+    last = std::upper_bound(entries.begin(), entries.end(), upper,
+        [a](double _value, const SweepAndPruneEntry &_entry)
+        {
+          return _value < _entry.min[a];
+        });
+  }
+  for (auto it = entries.begin(); it != last; ++it)
+  {
+    if (it->aabbMax[a] < lower || it->aabbMin[a] > upper)
+      continue;
+    for (unsigned int i = 0; i < _packet.size; ++i)
+    {
+      if (_packet.Hits(i, it->aabbMin, it->aabbMax))
+        _callback(it->id, i);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox SweepAndPrune::AABB(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get AABB for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return math::AxisAlignedBox();
+  }
+
+  const SweepAndPruneEntry &entry = this->dataPtr->entries[it->second];
+  return math::AxisAlignedBox(
+      math::Vector3d(entry.aabbMin[0], entry.aabbMin[1], entry.aabbMin[2]),
+      math::Vector3d(entry.aabbMax[0], entry.aabbMax[1], entry.aabbMax[2]));
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox SweepAndPrune::FatAABB(std::size_t _id) const
+{
+  auto it = this->dataPtr->indices.find(_id);
+  if (it == this->dataPtr->indices.end())
+  {
+    gzerr << "Unable to get AABB for node '" << _id << "'. "
+           << "Node not found." << std::endl;
+    return math::AxisAlignedBox();
+  }
+
+  const SweepAndPruneEntry &entry = this->dataPtr->entries[it->second];
+  return math::AxisAlignedBox(
+      math::Vector3d(entry.min[0], entry.min[1], entry.min[2]),
+      math::Vector3d(entry.max[0], entry.max[1], entry.max[2]));
+}
+
+//////////////////////////////////////////////////
+unsigned int SweepAndPrune::SweepAxis() const
+{
+  return this->dataPtr->axis;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_LIB_SRC_SWEEPANDPRUNE_HH_
+#define GZ_PHYSICS_TPE_LIB_SRC_SWEEPANDPRUNE_HH_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gz/math/AxisAlignedBox.hh>
+#include <gz/math/Vector3.hh>
+#include <gz/utils/SuppressWarning.hh>
+
+#include "gz/physics/tpelib/Export.hh"
+
+#include "Broadphase.hh"
+
+namespace gz {
+namespace physics {
+namespace tpelib {
+
+// forward declaration
+class SweepAndPrunePrivate;
+
+/// \brief Broadphase based on incremental sort and sweep. The nodes are kept
+/// sorted along one axis and the sort is updated with an insertion sort, which
+/// is close to linear when the nodes move little between calls. The sweep axis
+/// is the one along which the node centers are the most spread out.
+///
+/// Rays are only tested against the nodes whose extent along the sweep axis
+/// overlaps the extent of the rays. The nodes that start past the end of the
+/// rays are skipped with a binary search in the sorted nodes, except until
+/// the nodes are sorted again by the next call to CollisionPairs.
+class GZ_PHYSICS_TPELIB_VISIBLE SweepAndPrune : public Broadphase
+{
+  /// \brief Constructor
+  public: SweepAndPrune();
+
+  /// \brief Destructor
+  public: ~SweepAndPrune() override;
+
+  // Documentation inherited
+  public: void AddNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  // Documentation inherited
+  public: bool RemoveNode(std::size_t _id) override;
+
+  // Documentation inherited
+  public: bool UpdateNode(std::size_t _id, const math::AxisAlignedBox &_aabb,
+      const math::Vector3d &_displacement = math::Vector3d::Zero) override;
+
+  // Documentation inherited
+  public: unsigned int NodeCount() const override;
+
+  // Documentation inherited
+  public: bool HasNode(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: bool SetCollideBitmask(std::size_t _id, uint16_t _bitmask)
+      override;
+
+  // Documentation inherited
+  public: uint16_t CollideBitmask(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: void CollisionPairs(
+      std::vector<std::pair<std::size_t, std::size_t>> &_pairs)
+      const override;
+
+  // Documentation inherited
+  public: void RayQuery(RayPacket &_packet,
+      const std::function<void(std::size_t, unsigned int)> &_callback)
+      const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox AABB(std::size_t _id) const override;
+
+  // Documentation inherited
+  public: math::AxisAlignedBox FatAABB(std::size_t _id) const override;
+
+  /// \brief Get the axis the nodes are currently sorted along
+  /// \return 0, 1 or 2 for the x, y or z axis
+  public: unsigned int SweepAxis() const;
+
+  /// \brief Pointer to the private data
+  GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
+  private: std::unique_ptr<SweepAndPrunePrivate> dataPtr;
+  GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+};
+}
+}
+}
+
+#endif
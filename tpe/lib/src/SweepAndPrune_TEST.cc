@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "AABBTree.hh"
+#include "SweepAndPrune.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpelib;
+
+/// \brief Get the collision pairs of a broadphase as a set
+/// \param[in] _broadphase Broadphase to query
+/// \return Set of colliding node id pairs
+std::set<std::pair<std::size_t, std::size_t>> PairSet(
+    const Broadphase &_broadphase)
+{
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  _broadphase.CollisionPairs(pairs);
+  std::set<std::pair<std::size_t, std::size_t>> result(
+      pairs.begin(), pairs.end());
+  EXPECT_EQ(pairs.size(), result.size());
+  return result;
+}
+
+/// \brief Get the nodes hit by each ray of a packet as a set
+/// \param[in] _broadphase Broadphase to query
+/// \param[in] _packet Rays
+/// \return Set of node id and ray index pairs
+std::set<std::pair<std::size_t, unsigned int>> RayHitSet(
+    const Broadphase &_broadphase, RayPacket _packet)
+{
+  std::set<std::pair<std::size_t, unsigned int>> result;
+  _broadphase.RayQuery(_packet, [&](std::size_t _id, unsigned int _ray)
+  {
+    EXPECT_TRUE(result.emplace(_id, _ray).second);
+  });
+  return result;
+}
+
+/////////////////////////////////////////////////
+TEST(SweepAndPrune, SweepAndPrune)
+{
+  SweepAndPrune sap;
+  EXPECT_EQ(0u, sap.NodeCount());
+  EXPECT_TRUE(PairSet(sap).empty());
+
+  // add node
+  math::AxisAlignedBox a(-math::Vector3d::One, math::Vector3d::One);
+  std::size_t aId = 1u;
+  sap.AddNode(aId, a);
+  EXPECT_EQ(1u, sap.NodeCount());
+  EXPECT_TRUE(sap.HasNode(aId));
+  EXPECT_EQ(a, sap.AABB(aId));
+  EXPECT_TRUE(PairSet(sap).empty());
+
+  math::AxisAlignedBox b(math::Vector3d(-3, -3, -3),
+     math::Vector3d(-2, -2, -2));
+  std::size_t bId = 2u;
+  sap.AddNode(bId, b);
+  EXPECT_EQ(2u, sap.NodeCount());
+  EXPECT_TRUE(sap.HasNode(bId));
+
+  // c overlaps with a and b
+  math::AxisAlignedBox c(math::Vector3d(-2.5, -2.5, -2.5),
+      math::Vector3d(0.5, 0.5, 0.5));
+  std::size_t cId = 3u;
+  sap.AddNode(cId, c);
+
+  // d overlaps with a only
+  math::AxisAlignedBox d(math::Vector3d(0.55, 0.55, 0.55),
+      math::Vector3d(0.75, 0.75, 0.75));
+  std::size_t dId = 4u;
+  sap.AddNode(dId, d);
+
+  // e does not overlap with any node
+  math::AxisAlignedBox e(math::Vector3d(2.55, 2.55, 2.55),
+      math::Vector3d(3.75, 3.75, 3.75));
+  std::size_t eId = 5u;
+  sap.AddNode(eId, e);
+  EXPECT_EQ(5u, sap.NodeCount());
+
+  // adding an existing node fails
+  sap.AddNode(eId, a);
+  EXPECT_EQ(5u, sap.NodeCount());
+  EXPECT_EQ(e, sap.AABB(eId));
+
+  // check collisions
+  auto result = PairSet(sap);
+  EXPECT_EQ(3u, result.size());
+  EXPECT_EQ(1u, result.count({aId, cId}));
+  EXPECT_EQ(1u, result.count({aId, dId}));
+  EXPECT_EQ(1u, result.count({bId, cId}));
+
+  // remove non-existent node - this should fail
+  EXPECT_FALSE(sap.RemoveNode(555u));
+  EXPECT_FALSE(sap.UpdateNode(555u, a));
+
+  // remove node b
+  EXPECT_TRUE(sap.RemoveNode(bId));
+  EXPECT_EQ(4u, sap.NodeCount());
+  EXPECT_FALSE(sap.HasNode(bId));
+  EXPECT_EQ(c, sap.AABB(cId));
+  EXPECT_EQ(e, sap.AABB(eId));
+
+  result = PairSet(sap);
+  EXPECT_EQ(2u, result.size());
+  EXPECT_EQ(1u, result.count({aId, cId}));
+  EXPECT_EQ(1u, result.count({aId, dId}));
+
+  // update node c so it no longer overlaps with any other nodes
+  EXPECT_TRUE(sap.UpdateNode(cId, math::AxisAlignedBox(
+    math::Vector3d(-40, -40, -40),
+    math::Vector3d(-10, -10, -10))));
+  EXPECT_EQ(4u, sap.NodeCount());
+  EXPECT_TRUE(sap.HasNode(cId));
+
+  result = PairSet(sap);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(1u, result.count({aId, dId}));
+
+  // move node e onto d
+  EXPECT_TRUE(sap.UpdateNode(eId, d));
+  result = PairSet(sap);
+  EXPECT_EQ(3u, result.size());
+  EXPECT_EQ(1u, result.count({aId, dId}));
+  EXPECT_EQ(1u, result.count({aId, eId}));
+  EXPECT_EQ(1u, result.count({dId, eId}));
+}
+
+/////////////////////////////////////////////////
+TEST(SweepAndPrune, Margin)
+{
+  SweepAndPrune sap;
+  sap.SetMargin(0.5);
+
+  math::AxisAlignedBox a(math::Vector3d(-1, -1, -1),
+      math::Vector3d(1, 1, 1));
+  std::size_t aId = 1u;
+  sap.AddNode(aId, a);
+  EXPECT_EQ(a, sap.AABB(aId));
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-1.5, -1.5, -1.5),
+      math::Vector3d(1.5, 1.5, 1.5)), sap.FatAABB(aId));
+
+  // moving within the enlarged AABB keeps it
+  math::AxisAlignedBox a2(math::Vector3d(-0.7, -1, -1),
+      math::Vector3d(1.3, 1, 1));
+  EXPECT_TRUE(sap.UpdateNode(aId, a2));
+  EXPECT_EQ(0u, sap.ReinsertCount());
+  EXPECT_EQ(a2, sap.AABB(aId));
+
+  // moving outside of it recomputes it along the displacement
+  math::AxisAlignedBox a3(math::Vector3d(0, -1, -1),
+      math::Vector3d(2, 1, 1));
+  EXPECT_TRUE(sap.UpdateNode(aId, a3, math::Vector3d(2, 0, -1)));
+  EXPECT_EQ(1u, sap.ReinsertCount());
+  EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-0.5, -1.5, -2.5),
+      math::Vector3d(4.5, 1.5, 1.5)), sap.FatAABB(aId));
+}
+
+/////////////////////////////////////////////////
+TEST(SweepAndPrune, MatchAABBTree)
+{
+  // random boxes spread along the y axis, moved randomly between queries.
+  // Both broadphases must report the same pairs.
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> pos(0.0, 20.0);
+  std::uniform_real_distribution<double> size(0.1, 1.5);
+  std::uniform_real_distribution<double> step(-0.3, 0.3);
+
+  auto randomBox = [&](const math::Vector3d &_center)
+  {
+    math::Vector3d half(size(gen), size(gen), size(gen));
+    return math::AxisAlignedBox(_center - half * 0.5, _center + half * 0.5);
+  };
+
+  SweepAndPrune sap;
+  AABBTree tree;
+  const std::size_t n = 300u;
+  std::vector<math::Vector3d> centers;
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    centers.emplace_back(pos(gen) * 0.2, pos(gen) * 5, pos(gen) * 0.1);
+    auto box = randomBox(centers.back());
+    sap.AddNode(i, box);
+    tree.AddNode(i, box);
+  }
+
+  auto expected = PairSet(tree);
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, PairSet(sap));
+
+  // the nodes are the most spread out along the y axis
+  EXPECT_EQ(1u, sap.SweepAxis());
+
+  for (int iter = 0; iter < 20; ++iter)
+  {
+    for (std::size_t i = 0u; i < n; ++i)
+    {
+      centers[i] += math::Vector3d(step(gen), step(gen), step(gen));
+      auto box = randomBox(centers[i]);
+      EXPECT_TRUE(sap.UpdateNode(i, box));
+      EXPECT_TRUE(tree.UpdateNode(i, box));
+    }
+
+    // remove and add back a few nodes
+    for (std::size_t i = iter; i < n; i += 37u)
+    {
+      EXPECT_TRUE(sap.RemoveNode(i));
+      EXPECT_TRUE(tree.RemoveNode(i));
+    }
+    for (std::size_t i = iter; i < n; i += 37u)
+    {
+      auto box = randomBox(centers[i]);
+      sap.AddNode(i, box);
+      tree.AddNode(i, box);
+    }
+    EXPECT_EQ(tree.NodeCount(), sap.NodeCount());
+    EXPECT_EQ(PairSet(tree), PairSet(sap));
+    for (std::size_t i = iter; i < n; i += 37u)
+      EXPECT_EQ(tree.AABB(i), sap.AABB(i));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(SweepAndPrune, CollideBitmask)
+{
+  // random boxes in random groups. Both broadphases must report the same
+  // pairs, and no pair of nodes that do not share a bit.
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> pos(0.0, 10.0);
+  std::uniform_int_distribution<int> group(0, 3);
+
+  SweepAndPrune sap;
+  AABBTree tree;
+  const std::size_t n = 200u;
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    math::Vector3d center(pos(gen), pos(gen), pos(gen) * 0.1);
+    math::AxisAlignedBox box(center - math::Vector3d::One * 0.5,
+        center + math::Vector3d::One * 0.5);
+    sap.AddNode(i, box);
+    tree.AddNode(i, box);
+    EXPECT_EQ(kDefaultCollideBitmask, sap.CollideBitmask(i));
+  }
+  auto all = PairSet(tree);
+  EXPECT_EQ(all, PairSet(sap));
+
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    auto mask = static_cast<uint16_t>(1u << group(gen));
+    EXPECT_TRUE(sap.SetCollideBitmask(i, mask));
+    EXPECT_TRUE(tree.SetCollideBitmask(i, mask));
+    EXPECT_EQ(mask, sap.CollideBitmask(i));
+  }
+  EXPECT_FALSE(sap.SetCollideBitmask(n, 0x01));
+  EXPECT_EQ(0u, sap.CollideBitmask(n));
+
+  auto expected = PairSet(tree);
+  EXPECT_FALSE(expected.empty());
+  EXPECT_LT(expected.size(), all.size());
+  EXPECT_EQ(expected, PairSet(sap));
+  for (const auto &pair : expected)
+  {
+    EXPECT_NE(0, sap.CollideBitmask(pair.first) &
+        sap.CollideBitmask(pair.second));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(SweepAndPrune, RayQuery)
+{
+  // random boxes. Rays must hit the same nodes as in
+  // the AABB tree, whether they are short, long or along an axis.
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> pos(0.0, 50.0);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  std::uniform_real_distribution<double> dist(0.0, 30.0);
+
+  SweepAndPrune sap;
+  AABBTree tree;
+  for (std::size_t i = 0u; i < 300u; ++i)
+  {
+    math::Vector3d center(pos(gen), pos(gen), pos(gen) * 0.1);
+    math::AxisAlignedBox box(center - math::Vector3d::One * 0.5,
+        center + math::Vector3d::One * 0.5);
+    sap.AddNode(i, box);
+    tree.AddNode(i, box);
+  }
+
+  auto randomPacket = [&]()
+  {
+    RayPacket packet;
+    packet.size = RayPacket::kMaxSize;
+    for (unsigned int r = 0u; r < packet.size; ++r)
+    {
+      math::Vector3d origin(pos(gen), pos(gen), pos(gen) * 0.1);
+      math::Vector3d direction(dir(gen), dir(gen), dir(gen) * 0.1);
+      if (r == 0u)
+        direction = math::Vector3d(0, 1, 0);
+      direction.Normalize();
+      packet.origins[r] = {origin.X(), origin.Y(), origin.Z()};
+      for (unsigned int k = 0u; k < 3u; ++k)
+        packet.invDirections[r][k] = 1.0 / direction[k];
+      packet.maxDistances[r] = r == 1u ? math::INF_D : dist(gen);
+    }
+    return packet;
+  };
+
+  // rays are tested against every node until the nodes are sorted, and then
+  // only against the nodes along the rays
+  for (int i = 0; i < 20; ++i)
+  {
+    RayPacket packet = randomPacket();
+    EXPECT_EQ(RayHitSet(tree, packet), RayHitSet(sap, packet));
+  }
+
+  std::size_t hitCount = 0u;
+  PairSet(sap);
+  for (int i = 0; i < 50; ++i)
+  {
+    RayPacket packet = randomPacket();
+    auto expected = RayHitSet(tree, packet);
+    hitCount += expected.size();
+    EXPECT_EQ(expected, RayHitSet(sap, packet));
+  }
+  EXPECT_LT(0u, hitCount);
+
+  // rays shortened by the callback skip the nodes beyond the hit
+  RayPacket packet;
+  packet.size = 1u;
+  packet.origins[0] = {-10.0, 0.0, 0.0};
+  packet.invDirections[0] = {1.0, math::INF_D, math::INF_D};
+  packet.maxDistances[0] = math::INF_D;
+  SweepAndPrune row;
+  for (std::size_t i = 0u; i < 10u; ++i)
+  {
+    math::Vector3d center(static_cast<double>(i) * 2.0, 0, 0);
+    row.AddNode(i, math::AxisAlignedBox(center - math::Vector3d::One * 0.5,
+        center + math::Vector3d::One * 0.5));
+  }
+  PairSet(row);
+  std::vector<std::size_t> hits;
+  row.RayQuery(packet, [&](std::size_t _id, unsigned int)
+  {
+    hits.push_back(_id);
+    packet.maxDistances[0] = 9.5 + static_cast<double>(_id) * 2.0;
+  });
+  ASSERT_FALSE(hits.empty());
+  EXPECT_EQ(0u, hits[0]);
+  EXPECT_EQ(0u, *std::max_element(hits.begin(), hits.end()));
+}
@@ -15,12 +15,43 @@
  *
 */
 
+#include <algorithm>
+#include <cmath>
+
 #include "Utils.hh"
 
 namespace gz {
 namespace physics {
 namespace tpelib {
 
+namespace {
+/// \brief True while the thread runs a function passed to parallelFor
+thread_local bool parallelRegion = false;
+
+/// \brief Flag the calling thread as running in a parallel region for the
+/// lifetime of the guard
+class ParallelRegionGuard
+{
+  public: ParallelRegionGuard()
+    : previous(parallelRegion)
+  {
+    parallelRegion = true;
+  }
+
+  public: ~ParallelRegionGuard()
+  {
+    parallelRegion = this->previous;
+  }
+
+  private: bool previous;
+};
+
+/// \brief Number of boxes transformed together by
+/// transformAxisAlignedBoxes. Eight doubles fill one AVX-512 register or
+/// two AVX registers.
+constexpr std::size_t kBoxLanes = 8u;
+}
+
 //////////////////////////////////////////////////
 math::AxisAlignedBox transformAxisAlignedBox(
     const math::AxisAlignedBox &_box, const math::Pose3d &_pose)
@@ -97,6 +128,272 @@ math::AxisAlignedBox transformAxisAlignedBox(
   return math::AxisAlignedBox(newMin, newMax);
 }
 
+//////////////////////////////////////////////////
+void transformAxisAlignedBoxes(
+    const std::vector<math::AxisAlignedBox> &_boxes,
+    const std::vector<math::Pose3d> &_poses,
+    std::vector<math::AxisAlignedBox> &_result)
+{
+  const std::size_t count = std::min(_boxes.size(), _poses.size());
+  _result.resize(count);
+
+  // The boxes are gathered into blocks with one array per component, so
+  // that the arithmetic is a loop over the lanes of the block with no
+  // dependency between lanes, which the compiler turns into SIMD
+  // instructions. Lanes past the end of the input are left at zero.
+  for (std::size_t begin = 0u; begin < count; begin += kBoxLanes)
+  {
+    const std::size_t lanes = std::min(kBoxLanes, count - begin);
+
+    // center and half extents of the boxes, rotation and translation of
+    // the poses
+    double cx[kBoxLanes] = {}, cy[kBoxLanes] = {}, cz[kBoxLanes] = {};
+    double ex[kBoxLanes] = {}, ey[kBoxLanes] = {}, ez[kBoxLanes] = {};
+    double qw[kBoxLanes] = {}, qx[kBoxLanes] = {};
+    double qy[kBoxLanes] = {}, qz[kBoxLanes] = {};
+    double px[kBoxLanes] = {}, py[kBoxLanes] = {}, pz[kBoxLanes] = {};
+    for (std::size_t l = 0u; l < lanes; ++l)
+    {
+      const math::Vector3d &min = _boxes[begin + l].Min();
+      const math::Vector3d &max = _boxes[begin + l].Max();
+      cx[l] = 0.5 * (min.X() + max.X());
+      cy[l] = 0.5 * (min.Y() + max.Y());
+      cz[l] = 0.5 * (min.Z() + max.Z());
+      ex[l] = 0.5 * (max.X() - min.X());
+      ey[l] = 0.5 * (max.Y() - min.Y());
+      ez[l] = 0.5 * (max.Z() - min.Z());
+
+      const math::Pose3d &pose = _poses[begin + l];
+      qw[l] = pose.Rot().W();
+      qx[l] = pose.Rot().X();
+      qy[l] = pose.Rot().Y();
+      qz[l] = pose.Rot().Z();
+      px[l] = pose.Pos().X();
+      py[l] = pose.Pos().Y();
+      pz[l] = pose.Pos().Z();
+    }
+
+    // the new center is the transformed center, and the new half extents
+    // are the half extents transformed by the absolute rotation matrix
+    double nx[kBoxLanes], ny[kBoxLanes], nz[kBoxLanes];
+    double mx[kBoxLanes], my[kBoxLanes], mz[kBoxLanes];
+    for (std::size_t l = 0u; l < kBoxLanes; ++l)
+    {
+      // rotation matrix of the quaternion, as applied by
+      // math::Quaternion::operator*(Vector3)
+      const double xx = qx[l] * qx[l], yy = qy[l] * qy[l];
+      const double zz = qz[l] * qz[l], xy = qx[l] * qy[l];
+      const double xz = qx[l] * qz[l], yz = qy[l] * qz[l];
+      const double wx = qw[l] * qx[l], wy = qw[l] * qy[l];
+      const double wz = qw[l] * qz[l];
+      const double r00 = 1.0 - 2.0 * (yy + zz);
+      const double r01 = 2.0 * (xy - wz);
+      const double r02 = 2.0 * (xz + wy);
+      const double r10 = 2.0 * (xy + wz);
+      const double r11 = 1.0 - 2.0 * (xx + zz);
+      const double r12 = 2.0 * (yz - wx);
+      const double r20 = 2.0 * (xz - wy);
+      const double r21 = 2.0 * (yz + wx);
+      const double r22 = 1.0 - 2.0 * (xx + yy);
+
+      nx[l] = r00 * cx[l] + r01 * cy[l] + r02 * cz[l] + px[l];
+      ny[l] = r10 * cx[l] + r11 * cy[l] + r12 * cz[l] + py[l];
+      nz[l] = r20 * cx[l] + r21 * cy[l] + r22 * cz[l] + pz[l];
+      mx[l] = std::abs(r00) * ex[l] + std::abs(r01) * ey[l] +
+          std::abs(r02) * ez[l];
+      my[l] = std::abs(r10) * ex[l] + std::abs(r11) * ey[l] +
+          std::abs(r12) * ez[l];
+      mz[l] = std::abs(r20) * ex[l] + std::abs(r21) * ey[l] +
+          std::abs(r22) * ez[l];
+    }
+
+    for (std::size_t l = 0u; l < lanes; ++l)
+    {
+      math::AxisAlignedBox &result = _result[begin + l];
+      if (ex[l] < 0.0 || ey[l] < 0.0 || ez[l] < 0.0)
+      {
+        result = _boxes[begin + l];
+        continue;
+      }
+      result.Min().Set(nx[l] - mx[l], ny[l] - my[l], nz[l] - mz[l]);
+      result.Max().Set(nx[l] + mx[l], ny[l] + my[l], nz[l] + mz[l]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool timeOfImpact(
+    const math::AxisAlignedBox &_start1, const math::AxisAlignedBox &_end1,
+    const math::AxisAlignedBox &_start2, const math::AxisAlignedBox &_end2,
+    double &_time, math::Vector3d &_normal)
+{
+  // the boxes touch while, along every axis, the min of each box is below
+  // the max of the other. Each of these six conditions is linear in time,
+  // so it holds on an interval of the motion, and the boxes touch on the
+  // intersection of the intervals.
+  double t0 = 0.0;
+  double t1 = 1.0;
+  int axis = -1;
+  double sign = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    // min of the first box below the max of the second one, then min of
+    // the second box below the max of the first one
+    const double gaps[2][2] = {
+      {_start2.Max()[i] - _start1.Min()[i], _end2.Max()[i] - _end1.Min()[i]},
+      {_start1.Max()[i] - _start2.Min()[i], _end1.Max()[i] - _end2.Min()[i]}};
+    for (int j = 0; j < 2; ++j)
+    {
+      const double g0 = gaps[j][0];
+      const double g1 = gaps[j][1];
+      if (g0 >= 0.0 && g1 >= 0.0)
+        continue;
+      if (g0 < 0.0 && g1 < 0.0)
+        return false;
+
+      const double t = g0 / (g0 - g1);
+      if (g0 < 0.0)
+      {
+        // the condition starts holding at t
+        if (t > t0)
+        {
+          t0 = t;
+          axis = i;
+          sign = j == 0 ? 1.0 : -1.0;
+        }
+      }
+      else
+      {
+        // the condition stops holding at t
+        t1 = std::min(t1, t);
+      }
+    }
+  }
+
+  if (t0 > t1)
+    return false;
+
+  _time = t0;
+  _normal = math::Vector3d::Zero;
+  if (axis >= 0)
+    _normal[axis] = sign;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool intersectOrientedBoxes(
+    const math::Pose3d &_pose1, const math::Vector3d &_halfSize1,
+    const math::Pose3d &_pose2, const math::Vector3d &_halfSize2)
+{
+  // axes of both boxes in world frame
+  const math::Vector3d unit[3] = {
+      math::Vector3d::UnitX, math::Vector3d::UnitY, math::Vector3d::UnitZ};
+  math::Vector3d axes1[3];
+  math::Vector3d axes2[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    axes1[i] = _pose1.Rot().RotateVector(unit[i]);
+    axes2[i] = _pose2.Rot().RotateVector(unit[i]);
+  }
+
+  // rotation of the second box and offset between the centers in the frame
+  // of the first box. The epsilon keeps the edge cross products of nearly
+  // parallel edges from separating boxes through rounding.
+  double r[3][3];
+  double absR[3][3];
+  double t[3];
+  math::Vector3d offset = _pose2.Pos() - _pose1.Pos();
+  for (int i = 0; i < 3; ++i)
+  {
+    t[i] = offset.Dot(axes1[i]);
+    for (int j = 0; j < 3; ++j)
+    {
+      r[i][j] = axes1[i].Dot(axes2[j]);
+      absR[i][j] = std::abs(r[i][j]) + 1e-9;
+    }
+  }
+
+  // face normals of the first box
+  for (int i = 0; i < 3; ++i)
+  {
+    double rb = _halfSize2[0] * absR[i][0] + _halfSize2[1] * absR[i][1] +
+        _halfSize2[2] * absR[i][2];
+    if (std::abs(t[i]) > _halfSize1[i] + rb)
+      return false;
+  }
+
+  // face normals of the second box
+  for (int j = 0; j < 3; ++j)
+  {
+    double ra = _halfSize1[0] * absR[0][j] + _halfSize1[1] * absR[1][j] +
+        _halfSize1[2] * absR[2][j];
+    double dist = t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j];
+    if (std::abs(dist) > ra + _halfSize2[j])
+      return false;
+  }
+
+  // cross products of the edges
+  for (int i = 0; i < 3; ++i)
+  {
+    const int i1 = (i + 1) % 3;
+    const int i2 = (i + 2) % 3;
+    for (int j = 0; j < 3; ++j)
+    {
+      const int j1 = (j + 1) % 3;
+      const int j2 = (j + 2) % 3;
+      double ra = _halfSize1[i1] * absR[i2][j] + _halfSize1[i2] * absR[i1][j];
+      double rb = _halfSize2[j1] * absR[i][j2] + _halfSize2[j2] * absR[i][j1];
+      double dist = t[i2] * r[i1][j] - t[i1] * r[i2][j];
+      if (std::abs(dist) > ra + rb)
+        return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void parallelFor(common::WorkerPool *_pool, unsigned int _chunkCount,
+    std::size_t _count, const std::function<
+    void(unsigned int, std::size_t, std::size_t)> &_func)
+{
+  // Minimum number of items per chunk. Smaller ranges are not worth the
+  // cost of dispatching work to the pool.
+  const std::size_t minChunkSize = 64u;
+
+  std::size_t chunkCount = std::min<std::size_t>(
+      _chunkCount, _count / minChunkSize);
+  if (!_pool || chunkCount <= 1u)
+  {
+    if (_count > 0u)
+    {
+      ParallelRegionGuard guard;
+      _func(0u, 0u, _count);
+    }
+    return;
+  }
+
+  std::size_t chunkSize = (_count + chunkCount - 1u) / chunkCount;
+  for (std::size_t c = 0u; c < chunkCount; ++c)
+  {
+    std::size_t begin = c * chunkSize;
+    std::size_t end = std::min(_count, begin + chunkSize);
+    if (begin >= end)
+      break;
+    _pool->AddWork([&_func, c, begin, end]()
+    {
+      ParallelRegionGuard guard;
+      _func(static_cast<unsigned int>(c), begin, end);
+    });
+  }
+  _pool->WaitForResults();
+}
+
+//////////////////////////////////////////////////
+bool inParallelFor()
+{
+  return parallelRegion;
+}
+
 }
 }
 }
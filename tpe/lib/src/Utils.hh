@@ -15,6 +15,10 @@
  *
 */
 
+#include <functional>
+#include <vector>
+
+#include <gz/common/WorkerPool.hh>
 #include <gz/math/AxisAlignedBox.hh>
 #include <gz/math/Pose3.hh>
 
@@ -32,6 +36,79 @@ namespace tpelib {
   GZ_PHYSICS_TPELIB_VISIBLE
   math::AxisAlignedBox transformAxisAlignedBox(
       const math::AxisAlignedBox &_box, const math::Pose3d &_pose);
+
+  /// \brief Transform many axis aligned boxes by their poses at once. Each
+  /// box is transformed as its center and half extents, with the absolute
+  /// rotation matrix giving the half extents of the new box, and the boxes
+  /// are processed in blocks that the compiler vectorizes across boxes.
+  /// The result matches transformAxisAlignedBox up to rounding.
+  /// \param[in] _boxes Axis aligned boxes to be transformed. Boxes with a
+  /// min greater than their max, such as the default empty box, are copied
+  /// unchanged.
+  /// \param[in] _poses Transform to be applied to each box
+  /// \param[out] _result New axis aligned boxes, one for each of the first
+  /// min(_boxes.size(), _poses.size()) boxes. The vector is resized, so its
+  /// storage is reused when the same vector is passed to every call.
+  GZ_PHYSICS_TPELIB_VISIBLE
+  void transformAxisAlignedBoxes(
+      const std::vector<math::AxisAlignedBox> &_boxes,
+      const std::vector<math::Pose3d> &_poses,
+      std::vector<math::AxisAlignedBox> &_result);
+
+  /// \brief Find the first time at which two moving axis aligned boxes
+  /// touch. The bounds of each box move linearly from its start box to its
+  /// end box during the motion.
+  /// \param[in] _start1 First box at the start of the motion
+  /// \param[in] _end1 First box at the end of the motion
+  /// \param[in] _start2 Second box at the start of the motion
+  /// \param[in] _end2 Second box at the end of the motion
+  /// \param[out] _time Fraction of the motion, between 0 and 1, at which
+  /// the boxes start touching
+  /// \param[out] _normal Unit normal of the face of the second box first
+  /// touched by the first box, pointing towards the first box. Zero if the
+  /// boxes already touch at the start of the motion.
+  /// \return True if the boxes touch during the motion
+  GZ_PHYSICS_TPELIB_VISIBLE
+  bool timeOfImpact(
+      const math::AxisAlignedBox &_start1, const math::AxisAlignedBox &_end1,
+      const math::AxisAlignedBox &_start2, const math::AxisAlignedBox &_end2,
+      double &_time, math::Vector3d &_normal);
+
+  /// \brief Check whether two oriented boxes overlap, using the separating
+  /// axis test on the face normals of both boxes and the cross products of
+  /// their edges.
+  /// \param[in] _pose1 Pose of the center of the first box
+  /// \param[in] _halfSize1 Half extents of the first box
+  /// \param[in] _pose2 Pose of the center of the second box
+  /// \param[in] _halfSize2 Half extents of the second box
+  /// \return True if the boxes overlap or touch
+  GZ_PHYSICS_TPELIB_VISIBLE
+  bool intersectOrientedBoxes(
+      const math::Pose3d &_pose1, const math::Vector3d &_halfSize1,
+      const math::Pose3d &_pose2, const math::Vector3d &_halfSize2);
+
+  /// \brief Split the range [0, _count) into contiguous chunks and call a
+  /// function on each chunk. The chunks are run on the worker pool when one
+  /// is given and the range is large enough, otherwise the function is
+  /// called once with the full range on the calling thread. Returns after
+  /// all the chunks are processed.
+  /// \param[in] _pool Worker pool. Can be null.
+  /// \param[in] _chunkCount Maximum number of chunks
+  /// \param[in] _count Size of the range
+  /// \param[in] _func Function called with the index of the chunk, and the
+  /// begin and end of its range. Chunk indices are less than _chunkCount
+  /// and follow the order of the range.
+  GZ_PHYSICS_TPELIB_VISIBLE
+  void parallelFor(common::WorkerPool *_pool, unsigned int _chunkCount,
+      std::size_t _count, const std::function<
+      void(unsigned int, std::size_t, std::size_t)> &_func);
+
+  /// \brief Check if the calling thread is running a function passed to
+  /// parallelFor, including the serial fallback. Used to assert that code
+  /// which is not thread safe stays out of the parallel regions.
+  /// \return True if called from within parallelFor
+  GZ_PHYSICS_TPELIB_VISIBLE
+  bool inParallelFor();
 }
 }
 }
@@ -17,6 +17,10 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <random>
+#include <vector>
+
 #include "Utils.hh"
 
 using namespace gz;
@@ -53,3 +57,153 @@ TEST(Utils, TransformAxisAlignedBox)
   EXPECT_EQ(math::AxisAlignedBox(math::Vector3d(-1, 0, 1),
       math::Vector3d(5, 4, 3)), box2TransformedRot);
 }
+
+/////////////////////////////////////////////////
+TEST(Utils, InParallelFor)
+{
+  EXPECT_FALSE(inParallelFor());
+
+  // serial fallback
+  bool serial = false;
+  parallelFor(nullptr, 4u, 10u,
+      [&serial](unsigned int, std::size_t, std::size_t)
+  {
+    serial = inParallelFor();
+  });
+  EXPECT_TRUE(serial);
+  EXPECT_FALSE(inParallelFor());
+
+  // worker threads
+  common::WorkerPool pool(4u);
+  std::atomic<std::size_t> count{0u};
+  std::atomic<bool> parallel{true};
+  parallelFor(&pool, 4u, 1000u,
+      [&count, &parallel](unsigned int, std::size_t _begin, std::size_t _end)
+  {
+    if (!inParallelFor())
+      parallel = false;
+    count += _end - _begin;
+  });
+  EXPECT_EQ(1000u, count.load());
+  EXPECT_TRUE(parallel.load());
+  EXPECT_FALSE(inParallelFor());
+}
+
+/////////////////////////////////////////////////
+TEST(Utils, TransformAxisAlignedBoxes)
+{
+  // a number of boxes that is not a multiple of the block size, with an
+  // empty box in the middle
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> coord(-10.0, 10.0);
+  std::uniform_real_distribution<double> size(0.0, 5.0);
+  std::uniform_real_distribution<double> angle(-GZ_PI, GZ_PI);
+  std::vector<math::AxisAlignedBox> boxes;
+  std::vector<math::Pose3d> poses;
+  for (int i = 0; i < 21; ++i)
+  {
+    math::Vector3d min(coord(gen), coord(gen), coord(gen));
+    boxes.push_back(math::AxisAlignedBox(min,
+        min + math::Vector3d(size(gen), size(gen), size(gen))));
+    poses.push_back(math::Pose3d(coord(gen), coord(gen), coord(gen),
+        angle(gen), angle(gen), angle(gen)));
+  }
+  boxes[10] = math::AxisAlignedBox();
+
+  std::vector<math::AxisAlignedBox> result;
+  transformAxisAlignedBoxes(boxes, poses, result);
+  ASSERT_EQ(boxes.size(), result.size());
+  for (std::size_t i = 0; i < boxes.size(); ++i)
+  {
+    math::AxisAlignedBox expected =
+        transformAxisAlignedBox(boxes[i], poses[i]);
+    EXPECT_TRUE(expected.Min().Equal(result[i].Min(), 1e-9)) << i;
+    EXPECT_TRUE(expected.Max().Equal(result[i].Max(), 1e-9)) << i;
+  }
+
+  // the output is resized to the number of boxes with a pose
+  poses.resize(5);
+  transformAxisAlignedBoxes(boxes, poses, result);
+  EXPECT_EQ(5u, result.size());
+  transformAxisAlignedBoxes({}, {}, result);
+  EXPECT_TRUE(result.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Utils, TimeOfImpact)
+{
+  // a box moving through a thin static box touches it at 40% of the move
+  math::AxisAlignedBox start(math::Vector3d(0, 0, 0), math::Vector3d(1, 1, 1));
+  math::AxisAlignedBox end(math::Vector3d(10, 0, 0), math::Vector3d(11, 1, 1));
+  math::AxisAlignedBox wall(math::Vector3d(5, -5, -5),
+      math::Vector3d(5.1, 5, 5));
+  double time = -1.0;
+  math::Vector3d normal;
+  EXPECT_TRUE(timeOfImpact(start, end, wall, wall, time, normal));
+  EXPECT_DOUBLE_EQ(0.4, time);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  // the other way round, the normal points towards the first box
+  EXPECT_TRUE(timeOfImpact(wall, wall, start, end, time, normal));
+  EXPECT_DOUBLE_EQ(0.4, time);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), normal);
+
+  // two boxes moving towards each other
+  math::AxisAlignedBox start2(math::Vector3d(9, 0, 0),
+      math::Vector3d(10, 1, 1));
+  math::AxisAlignedBox end2(math::Vector3d(3, 0, 0), math::Vector3d(4, 1, 1));
+  math::AxisAlignedBox end1(math::Vector3d(4, 0, 0), math::Vector3d(5, 1, 1));
+  EXPECT_TRUE(timeOfImpact(start, end1, start2, end2, time, normal));
+  EXPECT_DOUBLE_EQ(0.8, time);
+  EXPECT_EQ(math::Vector3d(-1, 0, 0), normal);
+
+  // boxes touching at the start
+  EXPECT_TRUE(timeOfImpact(start, end, start, start, time, normal));
+  EXPECT_DOUBLE_EQ(0.0, time);
+  EXPECT_EQ(math::Vector3d::Zero, normal);
+
+  // a box passing next to the wall, and a box moving away from it
+  math::AxisAlignedBox besideWall = wall + math::Vector3d(0, 20, 0);
+  EXPECT_FALSE(timeOfImpact(start, end, besideWall, besideWall, time,
+      normal));
+  EXPECT_FALSE(timeOfImpact(end, end + math::Vector3d(1, 0, 0), wall, wall,
+      time, normal));
+}
+
+/////////////////////////////////////////////////
+TEST(Utils, IntersectOrientedBoxes)
+{
+  math::Vector3d half(1, 1, 1);
+  math::Pose3d origin;
+
+  // overlapping and touching boxes
+  EXPECT_TRUE(intersectOrientedBoxes(origin, half,
+      math::Pose3d(1.5, 0.5, 0, 0, 0, GZ_PI * 0.25), half));
+  EXPECT_TRUE(intersectOrientedBoxes(origin, half,
+      math::Pose3d(2, 0, 0, 0, 0, 0), half));
+
+  // separated along a face normal of the first box, and along a face
+  // normal of the rotated box only
+  EXPECT_FALSE(intersectOrientedBoxes(origin, half,
+      math::Pose3d(0, 0, 2.1, 0, 0, 0), half));
+  EXPECT_FALSE(intersectOrientedBoxes(origin, half,
+      math::Pose3d(2.1, 2.1, 0, 0, 0, GZ_PI * 0.25), half));
+
+  // two parallel diagonal rods side by side, whose AABBs overlap while the
+  // rods themselves do not
+  math::Vector3d rod(2, 0.1, 0.1);
+  math::Pose3d rod1(0, 0, 0, 0, 0, GZ_PI * 0.25);
+  math::Pose3d rod2(1, -1, 0, 0, 0, GZ_PI * 0.25);
+  EXPECT_TRUE(transformAxisAlignedBox(
+      math::AxisAlignedBox(-rod, rod), rod1).Intersects(
+      transformAxisAlignedBox(math::AxisAlignedBox(-rod, rod), rod2)));
+  EXPECT_FALSE(intersectOrientedBoxes(rod1, rod, rod2, rod));
+
+  // a box with a top edge along x below a box with a bottom edge along y.
+  // Only the cross product of the edges separates them.
+  math::Pose3d edge1(0, 0, 0, GZ_PI * 0.25, 0, 0);
+  math::Pose3d edge2(0, 0, 2.9, 0, GZ_PI * 0.25, 0);
+  EXPECT_FALSE(intersectOrientedBoxes(edge1, half, edge2, half));
+  edge2.Pos().Z() = 2.7;
+  EXPECT_TRUE(intersectOrientedBoxes(edge1, half, edge2, half));
+}
@@ -15,8 +15,10 @@
  *
 */
 
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <thread>
 
 #include <gz/common/Profiler.hh>
 
@@ -24,6 +26,7 @@
 #include "World.hh"
 #include "Model.hh"
 #include "Link.hh"
+#include "Utils.hh"
 
 using namespace gz;
 using namespace physics;
@@ -58,36 +61,158 @@ double World::GetTimeStep() const
   return this->timeStep;
 }
 
+/////////////////////////////////////////////////
+void World::SetBroadphaseType(BroadphaseType _type)
+{
+  this->collisionDetector.SetBroadphaseType(_type);
+}
+
+/////////////////////////////////////////////////
+BroadphaseType World::GetBroadphaseType() const
+{
+  return this->collisionDetector.GetBroadphaseType();
+}
+
+/////////////////////////////////////////////////
+void World::SetCollisionMargin(double _margin)
+{
+  this->collisionDetector.SetMargin(_margin);
+}
+
+/////////////////////////////////////////////////
+double World::GetCollisionMargin() const
+{
+  return this->collisionDetector.GetMargin();
+}
+
+/////////////////////////////////////////////////
+void World::SetCollisionPredictionSteps(unsigned int _steps)
+{
+  this->collisionPredictionSteps = _steps;
+}
+
+/////////////////////////////////////////////////
+unsigned int World::GetCollisionPredictionSteps() const
+{
+  return this->collisionPredictionSteps;
+}
+
+/////////////////////////////////////////////////
+std::size_t World::GetBroadphaseReinsertCount() const
+{
+  return this->collisionDetector.GetBroadphaseReinsertCount();
+}
+
+/////////////////////////////////////////////////
+void World::SetNarrowPhaseEnabled(bool _enabled)
+{
+  this->collisionDetector.SetNarrowPhaseEnabled(_enabled);
+}
+
+/////////////////////////////////////////////////
+bool World::GetNarrowPhaseEnabled() const
+{
+  return this->collisionDetector.GetNarrowPhaseEnabled();
+}
+
+/////////////////////////////////////////////////
+void World::SetContinuousCollisionEnabled(bool _enabled)
+{
+  this->collisionDetector.SetContinuousCollisionEnabled(_enabled);
+}
+
+/////////////////////////////////////////////////
+bool World::GetContinuousCollisionEnabled() const
+{
+  return this->collisionDetector.GetContinuousCollisionEnabled();
+}
+
+/////////////////////////////////////////////////
+void World::SetOrientedBoxesEnabled(bool _enabled)
+{
+  this->collisionDetector.SetOrientedBoxesEnabled(_enabled);
+}
+
+/////////////////////////////////////////////////
+bool World::GetOrientedBoxesEnabled() const
+{
+  return this->collisionDetector.GetOrientedBoxesEnabled();
+}
+
+/////////////////////////////////////////////////
+void World::SetSleepSteps(unsigned int _steps)
+{
+  this->collisionDetector.SetSleepSteps(_steps);
+}
+
+/////////////////////////////////////////////////
+unsigned int World::GetSleepSteps() const
+{
+  return this->collisionDetector.GetSleepSteps();
+}
+
+/////////////////////////////////////////////////
+std::size_t World::GetSleepingModelCount() const
+{
+  return this->collisionDetector.GetSleepingEntityCount();
+}
+
+/////////////////////////////////////////////////
+void World::SetThreadCount(unsigned int _count)
+{
+  if (_count == 0u)
+    _count = std::max(1u, std::thread::hardware_concurrency());
+
+  if (_count == this->threadCount)
+    return;
+
+  this->threadCount = _count;
+  if (_count > 1u)
+    this->workerPool = std::make_shared<common::WorkerPool>(_count);
+  else
+    this->workerPool.reset();
+  this->collisionDetector.SetWorkerPool(this->workerPool, _count);
+}
+
+/////////////////////////////////////////////////
+unsigned int World::GetThreadCount() const
+{
+  return this->threadCount;
+}
+
 /////////////////////////////////////////////////
 void World::Step()
 {
   GZ_PROFILE("tpelib::World::Step");
-  // apply updates to each model
   auto &children = this->GetChildren();
-  for (auto it = children.begin(); it != children.end(); ++it)
+
+  // apply updates to each model and link. Their states are independent so
+  // they can be updated in parallel. Each chunk collects the states it
+  // moved, which are merged into the store's dirty list afterwards.
+  this->dirtiedByChunk.resize(this->threadCount);
+  for (auto &dirtied : this->dirtiedByChunk)
+    dirtied.clear();
+  parallelFor(this->workerPool.get(), this->threadCount,
+      this->stateStore.Size(),
+      [&](unsigned int _chunk, std::size_t _begin, std::size_t _end)
   {
-    auto model = std::dynamic_pointer_cast<Model>(it->second);
-    model->UpdatePose(this->timeStep);
-    auto &ents = model->GetChildren();
-    for (auto linkIt = ents.begin(); linkIt != ents.end(); ++linkIt)
-    {
-      // if child of model is link
-      auto link = std::dynamic_pointer_cast<Link>(linkIt->second);
-      if (link)
-      {
-        link->UpdatePose(this->timeStep);
-      }
-    }
-  }
+    this->stateStore.Integrate(this->timeStep, _begin, _end,
+        this->dirtiedByChunk[_chunk]);
+  });
+  for (const auto &dirtied : this->dirtiedByChunk)
+    this->stateStore.AddDirtyIndices(dirtied);
+  this->stateStore.InvalidateWorldPoses();
 
   // check colliisions
+  this->collisionDetector.SetPredictionTime(
+      this->collisionPredictionSteps * this->timeStep);
   // the last bool arg tells the collision checker to return one single contact
   // point for each pair of collisions
   this->contacts = std::move(
       this->collisionDetector.CheckCollisions(children, true));
 
-  for (auto it = children.begin(); it != children.end(); ++it)
-    it->second->ResetPoseDirty();
+  this->stateStore.DirtyEntityIds(this->movedEntities);
+  this->stateStore.ResetPoseDirty();
 
   // increment world time by step size
   this->time += this->timeStep;
@@ -97,13 +222,60 @@ void World::Step()
 Entity &World::AddModel()
 {
   std::size_t modelId = Entity::GetNextId();
-  const auto[it, success] = this->GetChildren().insert(
-    {modelId, std::make_shared<Model>(modelId)});
-  return *it->second.get();
+  Entity &model = this->AddChild(std::make_shared<Model>(modelId));
+  model.AttachState(&this->stateStore);
+  return model;
 }
 
 /////////////////////////////////////////////////
-std::vector<Contact> World::GetContacts() const
+void World::ReserveModels(std::size_t _modelCount, std::size_t _linkCount)
+{
+  this->ReserveChildren(this->GetChildCount() + _modelCount);
+  // the models and their links keep their state in the world store
+  this->stateStore.Reserve(
+      this->stateStore.Size() + _modelCount + _linkCount);
+}
+
+/////////////////////////////////////////////////
+const std::vector<std::size_t> &World::GetMovedEntities() const
+{
+  return this->movedEntities;
+}
+
+/////////////////////////////////////////////////
+const std::vector<Contact> &World::GetContacts() const
 {
   return this->contacts;
 }
+
+/////////////////////////////////////////////////
+const std::vector<ContactPair> &World::GetContactPairs() const
+{
+  return this->collisionDetector.GetContactPairs();
+}
+
+/////////////////////////////////////////////////
+const std::vector<ContactPair> &World::GetAddedContactPairs() const
+{
+  return this->collisionDetector.GetAddedContactPairs();
+}
+
+/////////////////////////////////////////////////
+const std::vector<ContactPair> &World::GetRemovedContactPairs() const
+{
+  return this->collisionDetector.GetRemovedContactPairs();
+}
+
+/////////////////////////////////////////////////
+std::size_t World::GetPersistingContactPairCount() const
+{
+  return this->collisionDetector.GetPersistingContactPairCount();
+}
+
+/////////////////////////////////////////////////
+void World::CastRays(const std::vector<Ray> &_rays,
+    std::vector<RayHit> &_hits) const
+{
+  GZ_PROFILE("tpelib::World::CastRays");
+  this->collisionDetector.CastRays(this->GetChildren(), _rays, _hits);
+}
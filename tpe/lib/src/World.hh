@@ -18,13 +18,16 @@
 #ifndef GZ_PHYSICS_TPE_LIB_SRC_WORLD_HH_
 #define GZ_PHYSICS_TPE_LIB_SRC_WORLD_HH_
 
+#include <memory>
 #include <vector>
+#include <gz/common/WorkerPool.hh>
 #include <gz/utils/SuppressWarning.hh>
 
 #include "gz/physics/tpelib/Export.hh"
 
 #include "CollisionDetector.hh"
 #include "Entity.hh"
+#include "EntityStateStore.hh"
 
 namespace gz {
 namespace physics {
@@ -57,6 +60,113 @@ class GZ_PHYSICS_TPELIB_VISIBLE World : public Entity
   /// \return double current timestep of the world
   public: double GetTimeStep() const;
 
+  /// \brief Set the broadphase algorithm used by the collision detector.
+  /// \param[in] _type Broadphase type. Defaults to BroadphaseType::AABB_TREE
+  public: void SetBroadphaseType(BroadphaseType _type);
+
+  /// \brief Get the broadphase algorithm used by the collision detector.
+  /// \return Broadphase type
+  public: BroadphaseType GetBroadphaseType() const;
+
+  /// \brief Set the margin added to each side of the model AABBs stored in
+  /// the collision detector's broadphase. A model is only updated in the
+  /// broadphase when it moves outside of its enlarged AABB.
+  /// \param[in] _margin Margin in meters. Defaults to 0.
+  public: void SetCollisionMargin(double _margin);
+
+  /// \brief Get the margin added to each side of the model AABBs stored in
+  /// the collision detector's broadphase.
+  /// \return Margin in meters
+  public: double GetCollisionMargin() const;
+
+  /// \brief Set the number of steps of motion covered by the model AABBs
+  /// stored in the collision detector's broadphase. The AABBs are
+  /// extended along the model's linear velocity by the distance it travels
+  /// over this number of steps.
+  /// \param[in] _steps Number of steps. Set to 0 to disable velocity based
+  /// enlargement. Defaults to 0.
+  public: void SetCollisionPredictionSteps(unsigned int _steps);
+
+  /// \brief Get the number of steps of motion covered by the model AABBs
+  /// stored in the collision detector's broadphase.
+  /// \return Number of steps
+  public: unsigned int GetCollisionPredictionSteps() const;
+
+  /// \brief Get the number of times a model was reinserted into the
+  /// collision detector's broadphase since the broadphase was created.
+  /// \return Total number of reinsertions
+  public: std::size_t GetBroadphaseReinsertCount() const;
+
+  /// \brief Enable the narrow phase of the collision detector. When
+  /// enabled, contacts are reported for each pair of collisions whose
+  /// shapes are in contact, with their normal and depth. When disabled,
+  /// contacts are the intersection points of the model AABBs. The TPE
+  /// plugin enables it with the "narrow_phase" solver.
+  /// \param[in] _enabled True to enable the narrow phase. Defaults to false.
+  public: void SetNarrowPhaseEnabled(bool _enabled);
+
+  /// \brief Get whether the narrow phase of the collision detector is
+  /// enabled.
+  /// \return True if the narrow phase is enabled
+  public: bool GetNarrowPhaseEnabled() const;
+
+  /// \brief Enable continuous collision detection. The AABB of a model
+  /// moving with a linear velocity is swept over the step, so a fast model
+  /// that passes through a thin model within one step is still reported in
+  /// contact with it, at the time of impact of their AABBs. This allows
+  /// larger time steps without missing contacts.
+  /// \param[in] _enabled True to enable continuous collision detection.
+  /// Defaults to false.
+  public: void SetContinuousCollisionEnabled(bool _enabled);
+
+  /// \brief Get whether continuous collision detection is enabled.
+  /// \return True if continuous collision detection is enabled
+  public: bool GetContinuousCollisionEnabled() const;
+
+  /// \brief Enable the oriented box check of the collision detector. When
+  /// enabled and the narrow phase is disabled, models whose AABBs overlap
+  /// are only reported in contact if their rotated bounding boxes also
+  /// overlap, so long models driving diagonally next to each other are not.
+  /// \param[in] _enabled True to enable the oriented box check. Defaults to
+  /// false.
+  public: void SetOrientedBoxesEnabled(bool _enabled);
+
+  /// \brief Get whether the oriented box check of the collision detector
+  /// is enabled.
+  /// \return True if the oriented box check is enabled
+  public: bool GetOrientedBoxesEnabled() const;
+
+  /// \brief Set the number of steps after which a model that keeps the
+  /// same pose, e.g. a parked robot, falls asleep. The contacts between
+  /// sleeping and static models are not checked again but reported from
+  /// the previous step. A sleeping model wakes up when its pose or
+  /// velocity, or those of its links, are set, when its links or
+  /// collisions change, or when a moving model, or a static model that was
+  /// added or moved, touches it.
+  /// \param[in] _steps Number of steps. Set to 0 to disable sleeping.
+  /// Defaults to 0.
+  public: void SetSleepSteps(unsigned int _steps);
+
+  /// \brief Get the number of steps after which a model that keeps the
+  /// same pose falls asleep.
+  /// \return Number of steps
+  public: unsigned int GetSleepSteps() const;
+
+  /// \brief Get the number of models that were asleep in the last step
+  /// \return Number of sleeping models
+  public: std::size_t GetSleepingModelCount() const;
+
+  /// \brief Set the number of threads used to step the world. Model poses
+  /// are integrated and collisions are checked in parallel when this is
+  /// greater than 1. The results do not depend on the number of threads.
+  /// \param[in] _count Number of threads. Set to 0 to use all the hardware
+  /// threads. Defaults to 1.
+  public: void SetThreadCount(unsigned int _count);
+
+  /// \brief Get the number of threads used to step the world.
+  /// \return Number of threads
+  public: unsigned int GetThreadCount() const;
+
   /// \brief Step forward at a constant timestep
   public: void Step();
 
@@ -64,9 +174,55 @@ class GZ_PHYSICS_TPELIB_VISIBLE World : public Entity
   /// \return Model added to the world
   public: Entity &AddModel();
 
+  /// \brief Reserve storage for models about to be added to this world,
+  /// so that spawning many models does not grow the child lookups and the
+  /// state arrays one model at a time.
+  /// \param[in] _modelCount Number of models about to be added
+  /// \param[in] _linkCount Number of links of these models
+  public: void ReserveModels(std::size_t _modelCount,
+      std::size_t _linkCount = 0u);
+
   /// \brief Get contacts from last step
   /// \return Contacts from last step
-  public: std::vector<Contact> GetContacts() const;
+  public: const std::vector<Contact> &GetContacts() const;
+
+  /// \brief Get the pairs of entities in contact in the last step
+  /// \return Sorted pairs in contact
+  public: const std::vector<ContactPair> &GetContactPairs() const;
+
+  /// \brief Get the pairs of entities that started being in contact in the
+  /// last step
+  /// \return Sorted pairs that started being in contact
+  public: const std::vector<ContactPair> &GetAddedContactPairs() const;
+
+  /// \brief Get the pairs of entities that stopped being in contact in the
+  /// last step
+  /// \return Sorted pairs that stopped being in contact
+  public: const std::vector<ContactPair> &GetRemovedContactPairs() const;
+
+  /// \brief Get the number of pairs of entities that were in contact in the
+  /// step before the last one and still are in the last step
+  /// \return Number of pairs that stayed in contact
+  public: std::size_t GetPersistingContactPairCount() const;
+
+  /// \brief Get the ids of the models and links whose pose changed in the
+  /// last step, either because they were added or integrated, or because
+  /// their pose was set since the step before. Only the models of the world
+  /// and their links are tracked. Setting the pose of an entity of a nested
+  /// model reports the model of the world it belongs to.
+  /// \return Ids of the entities that moved
+  public: const std::vector<std::size_t> &GetMovedEntities() const;
+
+  /// \brief Cast a batch of rays against the collisions of the models and
+  /// find the closest hit of each ray, e.g. to simulate a lidar. The rays
+  /// are cast in parallel on the worker pool of the world, against the
+  /// models as they were at the end of the last step. Models added since
+  /// the last step are missed by the rays, and models moved since then are
+  /// hit where the last step left them.
+  /// \param[in] _rays Rays in world frame
+  /// \param[out] _hits Closest hit of each ray, in the order of the rays
+  public: void CastRays(const std::vector<Ray> &_rays,
+      std::vector<RayHit> &_hits) const;
 
   /// \brief World time
   protected: double time{0.0};
@@ -74,13 +230,33 @@ class GZ_PHYSICS_TPELIB_VISIBLE World : public Entity
   /// \brief Time step size
   protected: double timeStep{0.1};
 
+  /// \brief Number of steps of motion covered by the broadphase AABBs
+  protected: unsigned int collisionPredictionSteps{0u};
+
+  /// \brief Number of threads used to step the world
+  protected: unsigned int threadCount{1u};
+
   /// \brief Collision detector
   protected: CollisionDetector collisionDetector;
 
   GZ_UTILS_WARN_IGNORE__DLL_INTERFACE_MISSING
   /// \brief list of contacts
   protected: std::vector<Contact> contacts;
+
+  /// \brief Ids of the entities that moved in the last step
+  protected: std::vector<std::size_t> movedEntities;
+
+  /// \brief Indices of the states moved by each chunk of the parallel
+  /// integration, reused across steps
+  protected: std::vector<std::vector<std::size_t>> dirtiedByChunk;
+
+  /// \brief Worker pool used when stepping with more than one thread
+  protected: std::shared_ptr<common::WorkerPool> workerPool;
+
   GZ_UTILS_WARN_RESUME__DLL_INTERFACE_MISSING
+
+  /// \brief Kinematic state of the models of the world and of their links
+  protected: EntityStateStore stateStore;
 };
 
 }  // namespace tpelib
@@ -17,8 +17,15 @@
 
 #include <gtest/gtest.h>
 
-#include "World.hh"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Collision.hh"
+#include "Link.hh"
 #include "Model.hh"
+#include "Shape.hh"
+#include "World.hh"
 
 using namespace gz;
 using namespace physics;
@@ -43,6 +50,10 @@ TEST(World, BasicAPI)
   world.Step();
   EXPECT_NEAR(world.GetTime()-1.1, 0.0, 1e-6);
 
+  EXPECT_FALSE(world.GetNarrowPhaseEnabled());
+  world.SetNarrowPhaseEnabled(true);
+  EXPECT_TRUE(world.GetNarrowPhaseEnabled());
+
   World world2;
   EXPECT_NE(world.GetId(), world2.GetId());
 }
@@ -91,3 +102,654 @@ TEST(World, Model)
   Entity nullEnt = world.GetChildById(modelId);
   EXPECT_EQ(Entity::kNullEntity.GetId(), nullEnt.GetId());
 }
+
+/////////////////////////////////////////////////
+TEST(World, CollisionMargin)
+{
+  // create two worlds with the same models moving at a constant velocity.
+  // One world uses enlarged AABBs in its broadphase tree
+  World world;
+  World worldMargin;
+  EXPECT_DOUBLE_EQ(0.0, worldMargin.GetCollisionMargin());
+  EXPECT_EQ(0u, worldMargin.GetCollisionPredictionSteps());
+  worldMargin.SetCollisionMargin(0.05);
+  worldMargin.SetCollisionPredictionSteps(10u);
+  EXPECT_DOUBLE_EQ(0.05, worldMargin.GetCollisionMargin());
+  EXPECT_EQ(10u, worldMargin.GetCollisionPredictionSteps());
+
+  const int modelCount = 10;
+  for (World *w : {&world, &worldMargin})
+  {
+    w->SetTimeStep(0.01);
+    for (int i = 0; i < modelCount; ++i)
+    {
+      Model &model = static_cast<Model &>(w->AddModel());
+      model.SetPose(math::Pose3d(0, i * 3.0, 0, 0, 0, 0));
+      Entity &linkEnt = model.AddLink();
+      Link &link = static_cast<Link &>(linkEnt);
+      Collision &collision = static_cast<Collision &>(link.AddCollision());
+      BoxShape box;
+      box.SetSize(math::Vector3d(1, 1, 1));
+      collision.SetShape(box);
+      // odd models move towards the even models in front of them
+      if (i % 2 == 1)
+        model.SetLinearVelocity(math::Vector3d(0, -1, 0));
+    }
+  }
+
+  const int steps = 200;
+  for (int i = 0; i < steps; ++i)
+  {
+    world.Step();
+    worldMargin.Step();
+
+    // contacts are computed from the actual AABBs so they must match
+    auto contacts = world.GetContacts();
+    auto contactsMargin = worldMargin.GetContacts();
+    ASSERT_EQ(contacts.size(), contactsMargin.size()) << i;
+    for (std::size_t c = 0u; c < contacts.size(); ++c)
+    {
+      EXPECT_EQ(contacts[c].point, contactsMargin[c].point);
+      EXPECT_EQ(world.GetChildById(contacts[c].entity1).GetName(),
+          worldMargin.GetChildById(contactsMargin[c].entity1).GetName());
+    }
+  }
+
+  // models collide during the simulation
+  EXPECT_FALSE(world.GetContacts().empty());
+
+  // without margins the moving models are reinserted in the tree at every
+  // step after the first one, where they are added to the tree
+  EXPECT_EQ(static_cast<std::size_t>((steps - 1) * modelCount / 2),
+      world.GetBroadphaseReinsertCount());
+  EXPECT_GT(world.GetBroadphaseReinsertCount(),
+      10u * worldMargin.GetBroadphaseReinsertCount());
+}
+
+/////////////////////////////////////////////////
+TEST(World, BroadphaseType)
+{
+  // the same models moving in worlds with different broadphases must
+  // produce the same contacts
+  World world;
+  World worldSap;
+  World worldHash;
+  World worldFloat;
+  EXPECT_EQ(BroadphaseType::AABB_TREE, world.GetBroadphaseType());
+  worldSap.SetCollisionMargin(0.1);
+  worldSap.SetBroadphaseType(BroadphaseType::SWEEP_AND_PRUNE);
+  EXPECT_EQ(BroadphaseType::SWEEP_AND_PRUNE, worldSap.GetBroadphaseType());
+  EXPECT_DOUBLE_EQ(0.1, worldSap.GetCollisionMargin());
+  worldHash.SetBroadphaseType(BroadphaseType::SPATIAL_HASH);
+  EXPECT_EQ(BroadphaseType::SPATIAL_HASH, worldHash.GetBroadphaseType());
+  worldFloat.SetBroadphaseType(BroadphaseType::AABB_TREE_FLOAT);
+  EXPECT_EQ(BroadphaseType::AABB_TREE_FLOAT, worldFloat.GetBroadphaseType());
+
+  const int modelCount = 20;
+  for (World *w : {&world, &worldSap, &worldHash, &worldFloat})
+  {
+    w->SetTimeStep(0.01);
+    for (int i = 0; i < modelCount; ++i)
+    {
+      Model &model = static_cast<Model &>(w->AddModel());
+      model.SetPose(math::Pose3d((i % 5) * 1.5, (i / 5) * 1.5, 0, 0, 0, 0));
+      Entity &linkEnt = model.AddLink();
+      Link &link = static_cast<Link &>(linkEnt);
+      Collision &collision = static_cast<Collision &>(link.AddCollision());
+      BoxShape box;
+      box.SetSize(math::Vector3d(1, 1, 1));
+      collision.SetShape(box);
+      model.SetLinearVelocity(
+          math::Vector3d((i % 3) - 1.0, ((i / 3) % 3) - 1.0, 0) * 0.5);
+    }
+  }
+
+  std::size_t contactCount = 0u;
+  for (int i = 0; i < 300; ++i)
+  {
+    world.Step();
+    worldSap.Step();
+    worldHash.Step();
+    worldFloat.Step();
+
+    // switch broadphase halfway through the simulation
+    if (i == 150)
+      world.SetBroadphaseType(BroadphaseType::SWEEP_AND_PRUNE);
+
+    auto contacts = world.GetContacts();
+    auto contactsSap = worldSap.GetContacts();
+    auto contactsHash = worldHash.GetContacts();
+    auto contactsFloat = worldFloat.GetContacts();
+    ASSERT_EQ(contacts.size(), contactsSap.size()) << i;
+    ASSERT_EQ(contacts.size(), contactsHash.size()) << i;
+
+    // the single precision tree rounds the AABBs outward, so it also
+    // reports the entities that touch up to a float rounding error
+    EXPECT_LE(contacts.size(), contactsFloat.size()) << i;
+    for (std::size_t c = 0u; c < contacts.size(); ++c)
+    {
+      EXPECT_EQ(contacts[c].point, contactsSap[c].point);
+      EXPECT_EQ(world.GetChildById(contacts[c].entity1).GetName(),
+          worldSap.GetChildById(contactsSap[c].entity1).GetName());
+      EXPECT_EQ(contacts[c].point, contactsHash[c].point);
+      EXPECT_EQ(world.GetChildById(contacts[c].entity1).GetName(),
+          worldHash.GetChildById(contactsHash[c].entity1).GetName());
+    }
+    contactCount += contacts.size();
+  }
+  EXPECT_LT(0u, contactCount);
+}
+
+/////////////////////////////////////////////////
+TEST(World, ThreadCount)
+{
+  // the same models stepped with different numbers of threads must end up
+  // at the same poses with the same contacts
+  World world;
+  World world2;
+  World worldAll;
+  EXPECT_EQ(1u, world.GetThreadCount());
+  world2.SetThreadCount(2u);
+  EXPECT_EQ(2u, world2.GetThreadCount());
+  worldAll.SetThreadCount(0u);
+  EXPECT_LE(1u, worldAll.GetThreadCount());
+
+  const int side = 30;
+  for (World *w : {&world, &world2, &worldAll})
+  {
+    w->SetTimeStep(0.01);
+    w->SetCollisionMargin(0.05);
+    for (int i = 0; i < side * side; ++i)
+    {
+      Model &model = static_cast<Model &>(w->AddModel());
+      model.SetName("model_" + std::to_string(i));
+      model.SetPose(math::Pose3d((i % side) * 1.5, (i / side) * 1.5, 0,
+          0, 0, 0));
+      Entity &linkEnt = model.AddLink();
+      Link &link = static_cast<Link &>(linkEnt);
+      Collision &collision = static_cast<Collision &>(link.AddCollision());
+      BoxShape box;
+      box.SetSize(math::Vector3d(1, 1, 1));
+      collision.SetShape(box);
+      model.SetLinearVelocity(
+          math::Vector3d((i % 3) - 1.0, ((i / 3) % 3) - 1.0, 0) * 0.5);
+      model.SetAngularVelocity(math::Vector3d(0, 0, (i % 5) * 0.1));
+    }
+  }
+
+  // switch the number of threads in the middle of the simulation
+  std::size_t contactCount = 0u;
+  for (int i = 0; i < 100; ++i)
+  {
+    if (i == 50)
+      world.SetThreadCount(3u);
+
+    world.Step();
+    world2.Step();
+    worldAll.Step();
+
+    auto contacts = world.GetContacts();
+    for (World *w : {&world2, &worldAll})
+    {
+      auto contactsOther = w->GetContacts();
+      ASSERT_EQ(contacts.size(), contactsOther.size()) << i;
+      for (std::size_t c = 0u; c < contacts.size(); ++c)
+      {
+        EXPECT_EQ(contacts[c].point, contactsOther[c].point);
+        EXPECT_EQ(world.GetChildById(contacts[c].entity1).GetName(),
+            w->GetChildById(contactsOther[c].entity1).GetName());
+        EXPECT_EQ(world.GetChildById(contacts[c].entity2).GetName(),
+            w->GetChildById(contactsOther[c].entity2).GetName());
+      }
+    }
+    contactCount += contacts.size();
+  }
+  EXPECT_LT(0u, contactCount);
+
+  for (int i = 0; i < side * side; ++i)
+  {
+    std::string name = "model_" + std::to_string(i);
+    EXPECT_EQ(world.GetChildByName(name).GetPose(),
+        world2.GetChildByName(name).GetPose());
+    EXPECT_EQ(world.GetChildByName(name).GetPose(),
+        worldAll.GetChildByName(name).GetPose());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(World, MovedEntities)
+{
+  World world;
+  world.SetTimeStep(0.1);
+  EXPECT_TRUE(world.GetMovedEntities().empty());
+
+  Model &moving = static_cast<Model &>(world.AddModel());
+  Entity &movingLink = moving.AddLink();
+  Model &still = static_cast<Model &>(world.AddModel());
+  Entity &stillLink = still.AddLink();
+  Model &linkMoving = static_cast<Model &>(world.AddModel());
+  Entity &spinningLink = linkMoving.AddLink();
+
+  // new entities are reported in their first step, whether their pose
+  // was set or not
+  still.SetPose(math::Pose3d(1, 0, 0, 0, 0, 0));
+  world.Step();
+  {
+    auto moved = world.GetMovedEntities();
+    std::sort(moved.begin(), moved.end());
+    std::vector<std::size_t> expected{moving.GetId(), movingLink.GetId(),
+        still.GetId(), stillLink.GetId(), linkMoving.GetId(),
+        spinningLink.GetId()};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, moved);
+  }
+
+  // nothing moves
+  world.Step();
+  EXPECT_TRUE(world.GetMovedEntities().empty());
+
+  // only the entities with a velocity are reported
+  moving.SetLinearVelocity(math::Vector3d(1, 0, 0));
+  spinningLink.SetAngularVelocity(math::Vector3d(0, 0, 1));
+  for (int i = 0; i < 3; ++i)
+  {
+    world.Step();
+    auto moved = world.GetMovedEntities();
+    std::sort(moved.begin(), moved.end());
+    std::vector<std::size_t> expected{moving.GetId(), spinningLink.GetId()};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, moved);
+  }
+
+  // a pose set between steps is reported once
+  moving.SetLinearVelocity(math::Vector3d::Zero);
+  spinningLink.SetAngularVelocity(math::Vector3d::Zero);
+  stillLink.SetPose(math::Pose3d(0, 1, 0, 0, 0, 0));
+  world.Step();
+  ASSERT_EQ(1u, world.GetMovedEntities().size());
+  EXPECT_EQ(stillLink.GetId(), world.GetMovedEntities()[0]);
+  world.Step();
+  EXPECT_TRUE(world.GetMovedEntities().empty());
+  EXPECT_EQ(math::Pose3d::Zero, movingLink.GetPose());
+}
+
+/////////////////////////////////////////////////
+TEST(World, Sleep)
+{
+  // a world with sleeping models reports the same contacts as a world
+  // without sleeping
+  for (bool narrowPhase : {false, true})
+  {
+    World world;
+    World worldRef;
+    EXPECT_EQ(0u, world.GetSleepSteps());
+    world.SetSleepSteps(5u);
+    EXPECT_EQ(5u, world.GetSleepSteps());
+
+    const int count = 10;
+    for (World *w : {&world, &worldRef})
+    {
+      w->SetTimeStep(0.1);
+      w->SetNarrowPhaseEnabled(narrowPhase);
+
+      // static ground
+      Model &ground = static_cast<Model &>(w->AddModel());
+      ground.SetName("ground");
+      ground.SetStatic(true);
+      ground.SetPose(math::Pose3d(0, 0, -0.5, 0, 0, 0));
+      Link &groundLink = static_cast<Link &>(ground.AddLink());
+      Collision &groundCollision =
+          static_cast<Collision &>(groundLink.AddCollision());
+      BoxShape groundBox;
+      groundBox.SetSize(math::Vector3d(100, 100, 1));
+      groundCollision.SetShape(groundBox);
+
+      // parked boxes touching the ground and their neighbors
+      for (int i = 0; i < count; ++i)
+      {
+        Model &model = static_cast<Model &>(w->AddModel());
+        model.SetName("model_" + std::to_string(i));
+        model.SetPose(math::Pose3d(i * 0.9, 0, 0.45, 0, 0, 0));
+        Link &link = static_cast<Link &>(model.AddLink());
+        Collision &collision = static_cast<Collision &>(link.AddCollision());
+        BoxShape box;
+        box.SetSize(math::Vector3d(1, 1, 1));
+        collision.SetShape(box);
+      }
+    }
+
+    auto compareContacts = [&](int _step)
+    {
+      const auto &contacts = world.GetContacts();
+      const auto &contactsRef = worldRef.GetContacts();
+      ASSERT_EQ(contactsRef.size(), contacts.size()) << _step;
+      for (std::size_t c = 0u; c < contacts.size(); ++c)
+      {
+        EXPECT_EQ(contactsRef[c].point, contacts[c].point) << _step;
+        EXPECT_EQ(contactsRef[c].depth, contacts[c].depth) << _step;
+        EXPECT_EQ(worldRef.GetChildById(contactsRef[c].entity1).GetName(),
+            world.GetChildById(contacts[c].entity1).GetName()) << _step;
+        EXPECT_EQ(worldRef.GetChildById(contactsRef[c].entity2).GetName(),
+            world.GetChildById(contacts[c].entity2).GetName()) << _step;
+      }
+    };
+
+    // the parked models fall asleep after the given number of steps
+    for (int i = 0; i < 10; ++i)
+    {
+      world.Step();
+      worldRef.Step();
+      compareContacts(i);
+      if (i < 5)
+      {
+        EXPECT_EQ(0u, world.GetSleepingModelCount()) << i;
+      }
+    }
+    EXPECT_EQ(static_cast<std::size_t>(count),
+        world.GetSleepingModelCount());
+    EXPECT_EQ(0u, worldRef.GetSleepingModelCount());
+    EXPECT_LT(0u, world.GetContacts().size());
+
+    // setting a velocity wakes a model up, and the moving model wakes up
+    // the models it touches
+    for (World *w : {&world, &worldRef})
+      w->GetChildByName("model_0").SetLinearVelocity(math::Vector3d(1, 0, 0));
+    world.Step();
+    worldRef.Step();
+    compareContacts(10);
+    EXPECT_EQ(static_cast<std::size_t>(count - 1),
+        world.GetSleepingModelCount());
+    world.Step();
+    worldRef.Step();
+    compareContacts(11);
+    EXPECT_EQ(static_cast<std::size_t>(count - 2),
+        world.GetSleepingModelCount());
+
+    // setting a pose wakes a model up
+    for (World *w : {&world, &worldRef})
+    {
+      Entity &model = w->GetChildByName("model_9");
+      model.SetPose(math::Pose3d(20, 0, 0.45, 0, 0, 0));
+    }
+    EXPECT_EQ(0u, world.GetChildByName("model_9").GetIdleSteps());
+    for (int i = 12; i < 30; ++i)
+    {
+      world.Step();
+      worldRef.Step();
+      compareContacts(i);
+    }
+
+    // a static box added onto a sleeping model touches it and wakes it up
+    auto touchesModel9 = [&]()
+    {
+      std::size_t model9 = world.GetChildByName("model_9").GetId();
+      std::size_t lid = world.GetChildByName("lid").GetId();
+      for (const auto &c : world.GetContacts())
+      {
+        if ((c.entity1 == model9 && c.entity2 == lid) ||
+            (c.entity1 == lid && c.entity2 == model9))
+        {
+          return true;
+        }
+      }
+      return false;
+    };
+    ASSERT_LT(0u, world.GetSleepingModelCount());
+    for (World *w : {&world, &worldRef})
+    {
+      Model &lid = static_cast<Model &>(w->AddModel());
+      lid.SetName("lid");
+      lid.SetStatic(true);
+      lid.SetPose(math::Pose3d(20, 0, 1.4, 0, 0, 0));
+      Link &lidLink = static_cast<Link &>(lid.AddLink());
+      Collision &lidCollision =
+          static_cast<Collision &>(lidLink.AddCollision());
+      BoxShape lidBox;
+      lidBox.SetSize(math::Vector3d(1, 1, 1));
+      lidCollision.SetShape(lidBox);
+    }
+    world.Step();
+    worldRef.Step();
+    compareContacts(30);
+    EXPECT_TRUE(touchesModel9());
+    EXPECT_EQ(0u, world.GetChildByName("model_9").GetIdleSteps());
+
+    // moving the static box away and back onto the model, once it fell
+    // asleep again, also wakes it up
+    for (int i = 31; i < 40; ++i)
+    {
+      if (i == 31 || i == 35)
+      {
+        double z = i == 31 ? 3.0 : 1.4;
+        for (World *w : {&world, &worldRef})
+          w->GetChildByName("lid").SetPose(math::Pose3d(20, 0, z, 0, 0, 0));
+      }
+      world.Step();
+      worldRef.Step();
+      compareContacts(i);
+    }
+    EXPECT_TRUE(touchesModel9());
+    EXPECT_EQ(4u, world.GetChildByName("model_9").GetIdleSteps());
+
+    // changing the collisions of a sleeping model wakes it up
+    for (int i = 40; i < 50; ++i)
+    {
+      world.Step();
+      worldRef.Step();
+      compareContacts(i);
+    }
+    EXPECT_LE(5u, world.GetChildByName("model_9").GetIdleSteps());
+    for (World *w : {&world, &worldRef})
+    {
+      Entity &model = w->GetChildByName("model_9");
+      Entity &collision = model.GetChildByIndex(0u).GetChildByIndex(0u);
+      BoxShape box;
+      box.SetSize(math::Vector3d(0.5, 0.5, 0.5));
+      static_cast<Collision &>(collision).SetShape(box);
+    }
+    EXPECT_EQ(0u, world.GetChildByName("model_9").GetIdleSteps());
+    for (int i = 50; i < 55; ++i)
+    {
+      world.Step();
+      worldRef.Step();
+      compareContacts(i);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(World, ContinuousCollision)
+{
+  // a fast model passes through a thin wall within one step
+  for (bool narrowPhase : {false, true})
+  {
+    for (bool continuous : {false, true})
+    {
+      World world;
+      EXPECT_FALSE(world.GetContinuousCollisionEnabled());
+      world.SetContinuousCollisionEnabled(continuous);
+      EXPECT_EQ(continuous, world.GetContinuousCollisionEnabled());
+      world.SetNarrowPhaseEnabled(narrowPhase);
+      world.SetTimeStep(1.0);
+
+      Model &wall = static_cast<Model &>(world.AddModel());
+      wall.SetStatic(true);
+      wall.SetPose(math::Pose3d(5, 0, 0, 0, 0, 0));
+      Link &wallLink = static_cast<Link &>(wall.AddLink());
+      Collision &wallCollision =
+          static_cast<Collision &>(wallLink.AddCollision());
+      BoxShape wallBox;
+      wallBox.SetSize(math::Vector3d(0.1, 10, 10));
+      wallCollision.SetShape(wallBox);
+
+      Model &model = static_cast<Model &>(world.AddModel());
+      Link &link = static_cast<Link &>(model.AddLink());
+      Collision &collision = static_cast<Collision &>(link.AddCollision());
+      BoxShape box;
+      box.SetSize(math::Vector3d(1, 1, 1));
+      collision.SetShape(box);
+
+      world.Step();
+      EXPECT_TRUE(world.GetContacts().empty());
+
+      // the model moves from x = 0 to x = 10 and its AABB touches the wall
+      // after moving 4.45 m
+      model.SetLinearVelocity(math::Vector3d(10, 0, 0));
+      world.Step();
+      EXPECT_EQ(math::Vector3d(10, 0, 0), model.GetPose().Pos());
+      const auto &contacts = world.GetContacts();
+      if (!continuous)
+      {
+        EXPECT_TRUE(contacts.empty());
+        continue;
+      }
+      ASSERT_EQ(1u, contacts.size());
+      EXPECT_EQ(model.GetId(), contacts[0].entity1);
+      EXPECT_EQ(wall.GetId(), contacts[0].entity2);
+      EXPECT_EQ(kNullEntityId, contacts[0].collision1);
+      EXPECT_NEAR(0.445, contacts[0].timeOfImpact, 1e-9);
+      EXPECT_EQ(math::Vector3d(-1, 0, 0), contacts[0].normal);
+      EXPECT_TRUE(math::Vector3d(4.95, 0, 0).Equal(contacts[0].point, 1e-9));
+      EXPECT_DOUBLE_EQ(0.0, contacts[0].depth);
+
+      // the next move starts past the wall
+      world.Step();
+      EXPECT_TRUE(world.GetContacts().empty());
+
+      // a teleported model is not swept
+      model.SetLinearVelocity(math::Vector3d::Zero);
+      model.SetPose(math::Pose3d(-10, 0, 0, 0, 0, 0));
+      world.Step();
+      EXPECT_TRUE(world.GetContacts().empty());
+
+      // a model that ends the move inside the wall gets the time at which
+      // it started touching it
+      model.SetLinearVelocity(math::Vector3d(14.5, 0, 0));
+      world.Step();
+      ASSERT_FALSE(world.GetContacts().empty());
+      for (const auto &c : world.GetContacts())
+        EXPECT_NEAR(14.45 / 14.5, c.timeOfImpact, 1e-9);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(World, Heightmap)
+{
+  // models are tested against the heights of the terrain under them and
+  // not against its aabb
+  for (bool narrowPhase : {false, true})
+  {
+    World world;
+    world.SetNarrowPhaseEnabled(narrowPhase);
+
+    // a 20x20 m terrain with a 5 m hill in the middle
+    Model &terrain = static_cast<Model &>(world.AddModel());
+    terrain.SetStatic(true);
+    Link &terrainLink = static_cast<Link &>(terrain.AddLink());
+    Collision &terrainCollision =
+        static_cast<Collision &>(terrainLink.AddCollision());
+    HeightmapShape heightmap;
+    ASSERT_TRUE(heightmap.SetHeights({0, 0, 0, 0, 5, 0, 0, 0, 0}, 3u,
+        math::Vector3d(20, 20, 0)));
+    terrainCollision.SetShape(heightmap);
+    EXPECT_TRUE(terrain.HasHeightmap());
+    EXPECT_TRUE(world.HasHeightmap());
+
+    BoxShape box;
+    box.SetSize(math::Vector3d(1, 1, 1));
+    Model &low = static_cast<Model &>(world.AddModel());
+    low.SetPose(math::Pose3d(-8, 8, 1, 0, 0, 0));
+    Link &lowLink = static_cast<Link &>(low.AddLink());
+    static_cast<Collision &>(lowLink.AddCollision()).SetShape(box);
+    EXPECT_FALSE(low.HasHeightmap());
+
+    Model &top = static_cast<Model &>(world.AddModel());
+    top.SetPose(math::Pose3d(0, 0, 4.8, 0, 0, 0));
+    Link &topLink = static_cast<Link &>(top.AddLink());
+    static_cast<Collision &>(topLink.AddCollision()).SetShape(box);
+
+    world.Step();
+    const auto &contacts = world.GetContacts();
+    ASSERT_EQ(1u, contacts.size());
+    EXPECT_EQ(top.GetId(), contacts[0].entity1);
+    EXPECT_EQ(terrain.GetId(), contacts[0].entity2);
+    EXPECT_NEAR(0.0, contacts[0].point.X(), 1e-9);
+    EXPECT_NEAR(0.0, contacts[0].point.Y(), 1e-9);
+    if (narrowPhase)
+    {
+      EXPECT_EQ(terrainCollision.GetId(), contacts[0].collision2);
+      EXPECT_LT(0.0, contacts[0].normal.Z());
+      EXPECT_LT(0.0, contacts[0].depth);
+    }
+
+    // the low model lands on the terrain
+    low.SetPose(math::Pose3d(-8, 8, 0.6, 0, 0, 0));
+    world.Step();
+    EXPECT_EQ(2u, world.GetContacts().size());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(World, BatchModels)
+{
+  World world;
+  world.SetTimeStep(0.1);
+
+  // spawn a row of overlapping boxes with reserved storage
+  const std::size_t count = 100u;
+  world.ReserveModels(count, count);
+  std::vector<std::size_t> ids;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    Model &model = static_cast<Model &>(world.AddModel());
+    model.SetName("model_" + std::to_string(i));
+    model.SetPose(math::Pose3d(0.6 * i, 0, 0, 0, 0, 0));
+    Link &link = static_cast<Link &>(model.AddLink());
+    Collision &collision = static_cast<Collision &>(link.AddCollision());
+    BoxShape box;
+    box.SetSize(math::Vector3d(1, 1, 1));
+    collision.SetShape(box);
+    ids.push_back(model.GetId());
+  }
+  ASSERT_EQ(count, world.GetChildCount());
+  EntityStateStore *store = world.GetChildById(ids[0]).GetStateStore();
+  ASSERT_NE(nullptr, store);
+  EXPECT_EQ(2u * count, store->Size());
+
+  world.Step();
+  EXPECT_EQ(count - 1u, world.GetContactPairs().size());
+
+  // remove every other model in one batch, ignoring unknown and repeated
+  // ids
+  std::vector<std::size_t> removed;
+  for (std::size_t i = 0; i < count; i += 2u)
+    removed.push_back(ids[i]);
+  removed.push_back(ids[0]);
+  removed.push_back(kNullEntityId);
+  EXPECT_EQ(count / 2u, world.RemoveChildrenById(removed));
+  EXPECT_EQ(count / 2u, world.GetChildCount());
+  EXPECT_EQ(count, store->Size());
+  EXPECT_EQ(0u, world.RemoveChildrenById(removed));
+
+  // the lookups only find the remaining models
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const std::string name = "model_" + std::to_string(i);
+    if (i % 2u == 0u)
+    {
+      EXPECT_EQ(kNullEntityId, world.GetChildById(ids[i]).GetId());
+      EXPECT_EQ(kNullEntityId, world.GetChildByName(name).GetId());
+    }
+    else
+    {
+      EXPECT_EQ(ids[i], world.GetChildByIndex(i / 2u).GetId());
+      EXPECT_EQ(ids[i], world.GetChildByName(name).GetId());
+    }
+  }
+
+  // the remaining models are 1.2 m apart and do not touch
+  world.Step();
+  EXPECT_TRUE(world.GetContactPairs().empty());
+  EXPECT_EQ(count - 1u, world.GetRemovedContactPairs().size());
+}
@@ -0,0 +1,1834 @@
+/*
+  Copyright (c) 2009 Erin Catto http://www.box2d.org
+  Copyright (c) 2016-2018 Lester Hedges <lester.hedges+aabbcc@gmail.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source distribution.
+
+  This code was adapted from parts of the Box2D Physics Engine,
+  http://www.box2d.org
+
+  This file is an altered version of AABB.h from the aabbcc library
+  (https://github.com/lohedges/aabbcc): the dimension and scalar type
+  are template parameters, bounds are stored inline and periodic boxes are
+  not supported.
+*/
+
+#ifndef _FIXED_AABB_H
+#define _FIXED_AABB_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Null node flag.
+const unsigned int NULL_NODE = 0xffffffff;
+
+/// Bitmask of the particles inserted without one. It has all bits set, like
+/// the default collide bitmask of the broadphase.
+const std::uint16_t DEFAULT_MASK = 0xffff;
+
+namespace aabb
+{
+    /*! \brief Fixed-dimension axis-aligned bounding box.
+
+        The box stores its lower and upper bounds and caches its surface
+        area. The bounds are stored inline in std::arrays, so creating,
+        copying and merging boxes never allocates. The loops over
+        the dimension have a compile-time trip count so the compiler can
+        unroll and vectorize them, and the overlap and containment tests
+        are evaluated without early exits.
+     */
+    template <unsigned int Dimension, typename Scalar = double>
+    class FixedAABB
+    {
+    public:
+        static_assert(Dimension >= 2, "Invalid dimensionality!");
+
+        /// Array type used to store the bounds.
+        using Bounds = std::array<Scalar, Dimension>;
+
+        /// Constructor.
+        FixedAABB()
+        {
+            lowerBound.fill(0);
+            upperBound.fill(0);
+        }
+
+        //! Constructor.
+        /*! \param lowerBound_
+                The lower bound in each dimension.
+
+            \param upperBound_
+                The upper bound in each dimension.
+         */
+        FixedAABB(const Bounds& lowerBound_, const Bounds& upperBound_) :
+            lowerBound(lowerBound_), upperBound(upperBound_)
+        {
+            // Validate that the upper bounds exceed the lower bounds.
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                if (lowerBound[i] > upperBound[i])
+                {
+                    throw std::invalid_argument("[ERROR]: AABB lower bound is greater than the upper bound!");
+                }
+            }
+
+            surfaceArea = computeSurfaceArea();
+        }
+
+        /// Compute the surface area of the box.
+        Scalar computeSurfaceArea() const
+        {
+            Bounds size;
+            for (unsigned int i=0;i<Dimension;i++)
+                size[i] = upperBound[i] - lowerBound[i];
+
+            if constexpr (Dimension == 3)
+            {
+                return 2 * (size[0] * size[1] + size[1] * size[2] +
+                            size[2] * size[0]);
+            }
+            else
+            {
+                // General formula for one side: hold one dimension constant
+                // and multiply by all the other ones.
+                Scalar sum = 0;
+                for (unsigned int d1 = 0; d1 < Dimension; d1++)
+                {
+                    Scalar product = 1;
+                    for (unsigned int d2 = 0; d2 < Dimension; d2++)
+                    {
+                        if (d1 != d2)
+                            product *= size[d2];
+                    }
+                    sum += product;
+                }
+                return 2 * sum;
+            }
+        }
+
+        /// Get the surface area of the box.
+        Scalar getSurfaceArea() const
+        {
+            return surfaceArea;
+        }
+
+        //! Merge two AABBs into this one.
+        /*! \param aabb1
+                A reference to the first AABB.
+
+            \param aabb2
+                A reference to the second AABB.
+         */
+        void merge(const FixedAABB& aabb1, const FixedAABB& aabb2)
+        {
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                lowerBound[i] = std::min(aabb1.lowerBound[i], aabb2.lowerBound[i]);
+                upperBound[i] = std::max(aabb1.upperBound[i], aabb2.upperBound[i]);
+            }
+
+            surfaceArea = computeSurfaceArea();
+        }
+
+        //! Test whether the AABB is contained within this one.
+        /*! \param aabb
+                A reference to the AABB.
+
+            \return
+                Whether the AABB is fully contained.
+         */
+        bool contains(const FixedAABB& aabb) const
+        {
+            bool rv = true;
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                rv &= (aabb.lowerBound[i] >= lowerBound[i]) &
+                      (aabb.upperBound[i] <= upperBound[i]);
+            }
+            return rv;
+        }
+
+        //! Test whether the AABB overlaps this one.
+        /*! \param aabb
+                A reference to the AABB.
+
+            \param touchIsOverlap
+                Does touching constitute an overlap?
+
+            \return
+                Whether the AABB overlaps.
+         */
+        bool overlaps(const FixedAABB& aabb, bool touchIsOverlap) const
+        {
+            bool rv = true;
+            if (touchIsOverlap)
+            {
+                for (unsigned int i=0;i<Dimension;i++)
+                {
+                    rv &= (aabb.upperBound[i] >= lowerBound[i]) &
+                          (aabb.lowerBound[i] <= upperBound[i]);
+                }
+            }
+            else
+            {
+                for (unsigned int i=0;i<Dimension;i++)
+                {
+                    rv &= (aabb.upperBound[i] > lowerBound[i]) &
+                          (aabb.lowerBound[i] < upperBound[i]);
+                }
+            }
+            return rv;
+        }
+
+        //! Test whether a ray segment hits the AABB.
+        /*! \param origin
+                The origin of the ray.
+
+            \param invDirection
+                The component-wise inverse of the direction of the ray. It
+                is infinite along the axes the ray is parallel to.
+
+            \param maxT
+                The length of the segment, in units of the direction.
+
+            \return
+                Whether the segment hits the AABB. Segments that start
+                inside the AABB hit it.
+
+            The ray may have a different scalar type than the AABB, in
+            which case the test is computed in the scalar type of the ray.
+         */
+        template <typename RayScalar>
+        bool rayHits(const std::array<RayScalar, Dimension>& origin,
+            const std::array<RayScalar, Dimension>& invDirection,
+            RayScalar maxT) const
+        {
+            RayScalar tMin = 0;
+            RayScalar tMax = maxT;
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                // A ray parallel to the slab of an axis only hits the AABB
+                // if it starts within the slab. This also avoids 0 * inf
+                // when it starts on a face.
+                if (std::isinf(invDirection[i]))
+                {
+                    if (origin[i] < lowerBound[i] || origin[i] > upperBound[i])
+                        return false;
+                    continue;
+                }
+                RayScalar t1 = (lowerBound[i] - origin[i]) * invDirection[i];
+                RayScalar t2 = (upperBound[i] - origin[i]) * invDirection[i];
+                tMin = std::max(tMin, std::min(t1, t2));
+                tMax = std::min(tMax, std::max(t1, t2));
+            }
+            return tMin <= tMax;
+        }
+
+        //! Compute the centre of the AABB.
+        /*! \returns
+                The position vector of the AABB centre.
+         */
+        Bounds computeCentre() const
+        {
+            Bounds position;
+            for (unsigned int i=0;i<Dimension;i++)
+                position[i] = static_cast<Scalar>(0.5) * (lowerBound[i] + upperBound[i]);
+            return position;
+        }
+
+        /// Lower bound of AABB in each dimension.
+        Bounds lowerBound;
+
+        /// Upper bound of AABB in each dimension.
+        Bounds upperBound;
+
+        /// The AABB's surface area.
+        Scalar surfaceArea = 0;
+    };
+
+    /*! \brief A node of the fixed-dimension AABB tree.
+
+        Plain data, so the node pool is a single contiguous allocation.
+     */
+    template <unsigned int Dimension, typename Scalar = double>
+    struct FixedNode
+    {
+        /// The fattened axis-aligned bounding box.
+        FixedAABB<Dimension, Scalar> aabb;
+
+        /// The actual bounding box of the particle (leaf nodes only).
+        FixedAABB<Dimension, Scalar> particleAABB;
+
+        /// Index of the parent node.
+        unsigned int parent = NULL_NODE;
+
+        /// Index of the next node.
+        unsigned int next = NULL_NODE;
+
+        /// Index of the left-hand child.
+        unsigned int left = NULL_NODE;
+
+        /// Index of the right-hand child.
+        unsigned int right = NULL_NODE;
+
+        /// Height of the node. This is 0 for a leaf and -1 for a free node.
+        int height = -1;
+
+        /// The index of the particle that the node contains (leaf nodes only).
+        std::size_t particle = 0;
+
+        /// Bitmask of the particle for leaf nodes, bitwise OR of the masks of
+        /// the children for internal nodes. Two sub-trees whose masks do not
+        /// share a bit contain no pair of interacting particles.
+        std::uint16_t mask = DEFAULT_MASK;
+
+        //! Test whether the node is a leaf.
+        /*! \return
+                Whether the node is a leaf node.
+         */
+        bool isLeaf() const
+        {
+            return (left == NULL_NODE);
+        }
+    };
+
+    /*! \brief The fixed-dimension dynamic AABB tree.
+
+        Each particle is stored as a leaf holding its AABB, and each internal
+        node holds the union of the AABBs of its children. A particle is
+        inserted next to the leaf that increases the surface area of the
+        tree the least, and the tree is kept balanced by rotations. Queries
+        descend only into the nodes whose AABBs overlap the query.
+
+        All boxes have a compile-time dimension and are stored inline in a
+        contiguous node pool. Inserting, updating and querying particles
+        does not allocate once the pool and the caller's result buffers are
+        large enough. Particle indices are std::size_t so that 64 bit ids
+        are not truncated.
+     */
+    template <unsigned int Dimension, typename Scalar = double>
+    class FixedTree
+    {
+    public:
+        /// Box type stored in the tree.
+        using AABBType = FixedAABB<Dimension, Scalar>;
+
+        /// Node type stored in the tree.
+        using NodeType = FixedNode<Dimension, Scalar>;
+
+        //! Constructor.
+        /*! \param skinThickness_
+                The skin thickness for fattened AABBs, as a fraction
+                of the AABB base length.
+
+            \param nParticles
+                The number of particles (for fixed particle number systems).
+
+            \param touchIsOverlap
+                Does touching count as overlapping in query operations?
+         */
+        explicit FixedTree(Scalar skinThickness_ = 0.05,
+            unsigned int nParticles = 16, bool touchIsOverlap_ = true) :
+            skinThickness(skinThickness_), touchIsOverlap(touchIsOverlap_)
+        {
+            root = NULL_NODE;
+            nodeCount = 0;
+            nodeCapacity = std::max(nParticles, 1u);
+            nodes.resize(nodeCapacity);
+
+            // Build a linked list for the list of free nodes.
+            for (unsigned int i=0;i<nodeCapacity-1;i++)
+            {
+                nodes[i].next = i + 1;
+                nodes[i].height = -1;
+            }
+            nodes[nodeCapacity-1].next = NULL_NODE;
+            nodes[nodeCapacity-1].height = -1;
+
+            // Assign the index of the first free node.
+            freeList = 0;
+        }
+
+        //! Insert a particle into the tree.
+        /*! \param particle
+                The index of the particle.
+
+            \param aabb
+                The bounding box of the particle.
+         */
+        void insertParticle(std::size_t particle, const AABBType& aabb)
+        {
+            validateBounds(aabb);
+            insertParticle(particle, aabb, fatten(aabb));
+        }
+
+        //! Insert a particle into the tree with a caller-provided fat AABB.
+        /*! \param particle
+                The index of the particle.
+
+            \param aabb
+                The bounding box of the particle.
+
+            \param fatAABB
+                The fattened bounding box stored in the tree. It must
+                contain aabb.
+         */
+        void insertParticle(std::size_t particle, const AABBType& aabb,
+            const AABBType& fatAABB)
+        {
+            insertParticle(particle, aabb, fatAABB, DEFAULT_MASK);
+        }
+
+        //! Insert a particle into the tree with a caller-provided fat AABB
+        //! and bitmask.
+        /*! \param particle
+                The index of the particle.
+
+            \param aabb
+                The bounding box of the particle.
+
+            \param fatAABB
+                The fattened bounding box stored in the tree. It must
+                contain aabb.
+
+            \param mask
+                The bitmask of the particle. Pairs of particles whose masks
+                do not share a bit are not reported by queryPairs.
+         */
+        void insertParticle(std::size_t particle, const AABBType& aabb,
+            const AABBType& fatAABB, std::uint16_t mask)
+        {
+            // Make sure the particle doesn't already exist.
+            if (particleMap.count(particle) != 0)
+            {
+                throw std::invalid_argument("[ERROR]: Particle already exists in tree!");
+            }
+
+            validateBounds(aabb);
+            validateFatBounds(aabb, fatAABB);
+
+            // Allocate a new node for the particle.
+            unsigned int node = allocateNode();
+
+            nodes[node].aabb = fatAABB;
+            nodes[node].aabb.surfaceArea = fatAABB.computeSurfaceArea();
+            nodes[node].particleAABB = aabb;
+            nodes[node].height = 0;
+            nodes[node].particle = particle;
+            nodes[node].mask = mask;
+
+            // Insert a new leaf into the tree.
+            insertLeaf(node);
+
+            // Add the new particle to the map.
+            particleMap.emplace(particle, node);
+        }
+
+        /// Return the number of particles in the tree.
+        unsigned int nParticles() const
+        {
+            return static_cast<unsigned int>(particleMap.size());
+        }
+
+        //! Whether the tree contains a particle.
+        /*! \param particle
+                The particle index.
+         */
+        bool hasParticle(std::size_t particle) const
+        {
+            return particleMap.find(particle) != particleMap.end();
+        }
+
+        //! Set the bitmask of a particle.
+        /*! \param particle
+                The particle index.
+
+            \param mask
+                The new bitmask. The masks of the ancestors of the particle
+                are updated.
+         */
+        void setParticleMask(std::size_t particle, std::uint16_t mask)
+        {
+            auto it = particleMap.find(particle);
+
+            // The particle doesn't exist.
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+
+            unsigned int node = it->second;
+            if (nodes[node].mask == mask) return;
+
+            nodes[node].mask = mask;
+            for (unsigned int index = nodes[node].parent; index != NULL_NODE;
+                 index = nodes[index].parent)
+            {
+                nodes[index].mask =
+                    nodes[nodes[index].left].mask | nodes[nodes[index].right].mask;
+            }
+        }
+
+        //! Get the bitmask of a particle.
+        /*! \param particle
+                The particle index.
+         */
+        std::uint16_t getParticleMask(std::size_t particle) const
+        {
+            auto it = particleMap.find(particle);
+
+            // The particle doesn't exist.
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+
+            return nodes[it->second].mask;
+        }
+
+        //! Remove a particle from the tree.
+        /*! \param particle
+                The particle index (particleMap will be used to map the node).
+         */
+        void removeParticle(std::size_t particle)
+        {
+            auto it = particleMap.find(particle);
+
+            // The particle doesn't exist.
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+
+            // Extract the node index.
+            unsigned int node = it->second;
+
+            // Erase the particle from the map.
+            particleMap.erase(it);
+
+            assert(node < nodeCapacity);
+            assert(nodes[node].isLeaf());
+
+            removeLeaf(node);
+            freeNode(node);
+        }
+
+        /// Remove all particles from the tree.
+        void removeAll()
+        {
+            for (const auto& it : particleMap)
+            {
+                unsigned int node = it.second;
+
+                assert(node < nodeCapacity);
+                assert(nodes[node].isLeaf());
+
+                removeLeaf(node);
+                freeNode(node);
+            }
+
+            particleMap.clear();
+        }
+
+        //! Update the tree if a particle moves outside its fattened AABB.
+        /*! \param particle
+                The particle index (particleMap will be used to map the node).
+
+            \param aabb
+                The new bounding box of the particle.
+
+            \param alwaysReinsert
+                Always reinsert the particle, even if it's within its old AABB (default: false)
+
+            \return
+                Whether the particle was reinserted.
+         */
+        bool updateParticle(std::size_t particle, const AABBType& aabb,
+            bool alwaysReinsert=false)
+        {
+            validateBounds(aabb);
+            return updateParticle(particle, aabb, fatten(aabb), alwaysReinsert);
+        }
+
+        //! Update the tree if a particle moves outside its fattened AABB.
+        /*! \param particle
+                The particle index (particleMap will be used to map the node).
+
+            \param aabb
+                The new bounding box of the particle.
+
+            \param fatAABB
+                The fattened bounding box stored in the tree if the particle
+                is reinserted. It must contain aabb.
+
+            \param alwaysReinsert
+                Always reinsert the particle, even if it's within its old AABB (default: false)
+
+            \return
+                Whether the particle was reinserted.
+         */
+        bool updateParticle(std::size_t particle, const AABBType& aabb,
+            const AABBType& fatAABB, bool alwaysReinsert=false)
+        {
+            auto it = particleMap.find(particle);
+
+            // The particle doesn't exist.
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+
+            validateBounds(aabb);
+            validateFatBounds(aabb, fatAABB);
+
+            // Extract the node index.
+            unsigned int node = it->second;
+
+            assert(node < nodeCapacity);
+            assert(nodes[node].isLeaf());
+
+            nodes[node].particleAABB = aabb;
+
+            // No need to update if the particle is still within its fattened AABB.
+            if (!alwaysReinsert && nodes[node].aabb.contains(aabb)) return false;
+
+            // Remove the current leaf.
+            removeLeaf(node);
+
+            // Assign the new fattened AABB.
+            nodes[node].aabb = fatAABB;
+            nodes[node].aabb.surfaceArea = fatAABB.computeSurfaceArea();
+
+            // Insert a new leaf node.
+            insertLeaf(node);
+
+            return true;
+        }
+
+        //! Query the tree to find candidate interactions for a particle.
+        /*! \param particle
+                The particle index.
+
+            \param particles
+                A vector that is cleared and filled with particle indices.
+         */
+        void query(std::size_t particle, std::vector<std::size_t>& particles) const
+        {
+            auto it = particleMap.find(particle);
+
+            // Make sure that this is a valid particle.
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+
+            // Test overlap of particle AABB against all other particles.
+            query(particle, nodes[it->second].aabb, particles);
+        }
+
+        //! Query the tree to find candidate interactions for an AABB.
+        /*! \param particle
+                The particle index, which is excluded from the result.
+
+            \param aabb
+                The AABB.
+
+            \param particles
+                A vector that is cleared and filled with particle indices.
+         */
+        void query(std::size_t particle, const AABBType& aabb,
+            std::vector<std::size_t>& particles) const
+        {
+            query(particle, aabb, DEFAULT_MASK, particles);
+        }
+
+        //! Query the tree to find candidate interactions for an AABB whose
+        //! bitmask shares a bit with the particles.
+        /*! \param particle
+                The particle index, which is excluded from the result.
+
+            \param aabb
+                The AABB.
+
+            \param mask
+                The bitmask. Sub-trees whose masks do not share a bit with it
+                are skipped.
+
+            \param particles
+                A vector that is cleared and filled with particle indices.
+         */
+        void query(std::size_t particle, const AABBType& aabb,
+            std::uint16_t mask, std::vector<std::size_t>& particles) const
+        {
+            particles.clear();
+
+            if (root == NULL_NODE) return;
+
+            // Each thread traverses the tree with its own stack, so const
+            // queries can run concurrently.
+            thread_local std::vector<unsigned int> stack;
+            stack.clear();
+            stack.push_back(root);
+
+            while (stack.size() > 0)
+            {
+                unsigned int node = stack.back();
+                stack.pop_back();
+
+                const NodeType& n = nodes[node];
+
+                // Test for a common bit and for overlap between the AABBs.
+                if ((n.mask & mask) == 0) continue;
+                if (!aabb.overlaps(n.aabb, touchIsOverlap)) continue;
+
+                // Check that we're at a leaf node.
+                if (n.isLeaf())
+                {
+                    // Can't interact with itself.
+                    if (n.particle != particle)
+                        particles.push_back(n.particle);
+                }
+                else
+                {
+                    stack.push_back(n.left);
+                    stack.push_back(n.right);
+                }
+            }
+        }
+
+        //! Query the tree to find candidate interactions for an AABB.
+        /*! \param aabb
+                The AABB.
+
+            \param particles
+                A vector that is cleared and filled with particle indices.
+         */
+        void query(const AABBType& aabb, std::vector<std::size_t>& particles) const
+        {
+            query(std::numeric_limits<std::size_t>::max(), aabb, particles);
+        }
+
+        //! Query the tree to find candidate interactions for an AABB whose
+        //! bitmask shares a bit with the particles.
+        /*! \param aabb
+                The AABB.
+
+            \param mask
+                The bitmask.
+
+            \param particles
+                A vector that is cleared and filled with particle indices.
+         */
+        void query(const AABBType& aabb, std::uint16_t mask,
+            std::vector<std::size_t>& particles) const
+        {
+            query(std::numeric_limits<std::size_t>::max(), aabb, mask,
+                particles);
+        }
+
+        //! Query the tree for the particles hit by a packet of rays.
+        /*! Internal nodes are visited if any ray of the packet hits their
+            fattened AABB, and children are visited front to back along the
+            first ray. The tree is not modified so it can be queried
+            concurrently with separate stacks.
+
+            \param count
+                The number of rays.
+
+            \param origins
+                The origin of each ray.
+
+            \param invDirections
+                The component-wise inverse of the direction of each ray.
+
+            \param maxT
+                The length of each ray. The visitor can shorten it to skip
+                the particles beyond a hit.
+
+            \param stack
+                A node stack used for the traversal.
+
+            \param visitor
+                Called with the particle index and the index of the ray for
+                each ray that hits the actual AABB of a particle.
+         */
+        template <typename RayScalar, typename Visitor>
+        void queryRays(unsigned int count,
+            const std::array<RayScalar, Dimension>* origins,
+            const std::array<RayScalar, Dimension>* invDirections,
+            const RayScalar* maxT,
+            std::vector<unsigned int>& stack, Visitor&& visitor) const
+        {
+            if (root == NULL_NODE || count == 0) return;
+
+            stack.clear();
+            stack.push_back(root);
+
+            while (stack.size() > 0)
+            {
+                unsigned int node = stack.back();
+                stack.pop_back();
+
+                const NodeType& n = nodes[node];
+
+                if (n.isLeaf())
+                {
+                    for (unsigned int i=0;i<count;i++)
+                    {
+                        if (n.particleAABB.rayHits(origins[i],
+                            invDirections[i], maxT[i]))
+                        {
+                            visitor(n.particle, i);
+                        }
+                    }
+                    continue;
+                }
+
+                bool hit = false;
+                for (unsigned int i=0;i<count && !hit;i++)
+                    hit = n.aabb.rayHits(origins[i], invDirections[i], maxT[i]);
+                if (!hit) continue;
+
+                // Push the far child first so that the near child is
+                // visited first, using the axis that best separates them.
+                const AABBType& left = nodes[n.left].aabb;
+                const AABBType& right = nodes[n.right].aabb;
+                unsigned int axis = 0;
+                Scalar separation = 0;
+                for (unsigned int i=0;i<Dimension;i++)
+                {
+                    Scalar d = (right.lowerBound[i] + right.upperBound[i])
+                        - (left.lowerBound[i] + left.upperBound[i]);
+                    if (std::abs(d) > std::abs(separation))
+                    {
+                        separation = d;
+                        axis = i;
+                    }
+                }
+                bool leftFirst = (separation >= 0) == (invDirections[0][axis] >= 0);
+                if (leftFirst)
+                {
+                    stack.push_back(n.right);
+                    stack.push_back(n.left);
+                }
+                else
+                {
+                    stack.push_back(n.left);
+                    stack.push_back(n.right);
+                }
+            }
+        }
+
+        //! Query the tree to find all pairs of overlapping particles.
+        /*! The tree is traversed once against itself, so each pair is
+            reported exactly once and no per-particle queries are needed.
+
+            \param pairs
+                A vector that is cleared and then filled with the pairs of
+                particle indices. The lower index of each pair comes first.
+                The vector's capacity is kept so it can be reused.
+         */
+        void queryPairs(std::vector<std::pair<std::size_t, std::size_t>>& pairs) const
+        {
+            pairs.clear();
+
+            if (root == NULL_NODE) return;
+
+            // Each thread traverses the tree with its own stack, so const
+            // queries can run concurrently.
+            thread_local std::vector<std::pair<unsigned int, unsigned int>> stack;
+            stack.clear();
+            stack.emplace_back(root, root);
+
+            while (stack.size() > 0)
+            {
+                unsigned int nodeA = stack.back().first;
+                unsigned int nodeB = stack.back().second;
+                stack.pop_back();
+
+                const NodeType& a = nodes[nodeA];
+
+                // Self test of a sub-tree: test both children against
+                // themselves and against each other.
+                if (nodeA == nodeB)
+                {
+                    if (a.isLeaf()) continue;
+
+                    stack.emplace_back(a.left, a.left);
+                    stack.emplace_back(a.right, a.right);
+                    stack.emplace_back(a.left, a.right);
+                    continue;
+                }
+
+                const NodeType& b = nodes[nodeB];
+
+                // No particle of one sub-tree interacts with the other.
+                if ((a.mask & b.mask) == 0) continue;
+                if (!a.aabb.overlaps(b.aabb, touchIsOverlap)) continue;
+
+                if (a.isLeaf() && b.isLeaf())
+                {
+                    pairs.emplace_back(std::min(a.particle, b.particle),
+                                       std::max(a.particle, b.particle));
+                }
+                // Descend into the larger of the two nodes.
+                else if (b.isLeaf() || (!a.isLeaf() &&
+                         a.aabb.getSurfaceArea() >= b.aabb.getSurfaceArea()))
+                {
+                    stack.emplace_back(a.left, nodeB);
+                    stack.emplace_back(a.right, nodeB);
+                }
+                else
+                {
+                    stack.emplace_back(nodeA, b.left);
+                    stack.emplace_back(nodeA, b.right);
+                }
+            }
+        }
+
+        //! Get the fattened AABB of a particle.
+        /*! \param particle
+                The particle index.
+         */
+        const AABBType& getAABB(std::size_t particle) const
+        {
+            auto it = particleMap.find(particle);
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+            return nodes[it->second].aabb;
+        }
+
+        //! Get the actual (not fattened) AABB of a particle.
+        /*! \param particle
+                The particle index.
+         */
+        const AABBType& getParticleAABB(std::size_t particle) const
+        {
+            auto it = particleMap.find(particle);
+            if (it == particleMap.end())
+            {
+                throw std::invalid_argument("[ERROR]: Invalid particle index!");
+            }
+            return nodes[it->second].particleAABB;
+        }
+
+        //! Get the height of the tree.
+        /*! \return
+                The height of the binary tree.
+         */
+        unsigned int getHeight() const
+        {
+            if (root == NULL_NODE) return 0;
+            return nodes[root].height;
+        }
+
+        //! Get the number of nodes in the tree.
+        /*! \return
+                The number of nodes in the tree.
+         */
+        unsigned int getNodeCount() const
+        {
+            return nodeCount;
+        }
+
+        //! Compute the maximum balancance of the tree.
+        /*! \return
+                The maximum difference between the height of two
+                children of a node.
+         */
+        unsigned int computeMaximumBalance() const
+        {
+            unsigned int maxBalance = 0;
+            for (unsigned int i=0; i<nodeCapacity; i++)
+            {
+                if (nodes[i].height <= 1)
+                    continue;
+
+                assert(nodes[i].isLeaf() == false);
+
+                unsigned int balance = std::abs(nodes[nodes[i].left].height - nodes[nodes[i].right].height);
+                maxBalance = std::max(maxBalance, balance);
+            }
+
+            return maxBalance;
+        }
+
+        //! Compute the surface area ratio of the tree.
+        /*! \return
+                The ratio of the sum of the node surface area to the surface
+                area of the root node.
+         */
+        Scalar computeSurfaceAreaRatio() const
+        {
+            if (root == NULL_NODE) return 0;
+
+            Scalar rootArea = nodes[root].aabb.computeSurfaceArea();
+            Scalar totalArea = 0;
+
+            for (unsigned int i=0; i<nodeCapacity;i++)
+            {
+                if (nodes[i].height < 0) continue;
+
+                totalArea += nodes[i].aabb.computeSurfaceArea();
+            }
+
+            return totalArea / rootArea;
+        }
+
+        /// Validate the tree.
+        void validate() const
+        {
+#ifndef NDEBUG
+            validateStructure(root);
+            validateMetrics(root);
+
+            unsigned int freeCount = 0;
+            unsigned int freeIndex = freeList;
+
+            while (freeIndex != NULL_NODE)
+            {
+                assert(freeIndex < nodeCapacity);
+                freeIndex = nodes[freeIndex].next;
+                freeCount++;
+            }
+
+            assert(getHeight() == computeHeight());
+            assert((nodeCount + freeCount) == nodeCapacity);
+#endif
+        }
+
+        //! Insert particles and rebuild the whole tree around them.
+        /*! This is faster than inserting the particles one at a time when
+            many particles are added at once, e.g. when a world is loaded,
+            and gives a better tree, see rebuild.
+
+            \param particles
+                The indices of the particles.
+
+            \param aabbs
+                The bounding boxes of the particles.
+
+            \param fatAABBs
+                The fattened bounding boxes stored in the tree. Each one must
+                contain the matching bounding box.
+         */
+        void insertParticles(const std::vector<std::size_t>& particles,
+            const std::vector<AABBType>& aabbs,
+            const std::vector<AABBType>& fatAABBs)
+        {
+            if (particles.size() != aabbs.size() ||
+                particles.size() != fatAABBs.size())
+            {
+                throw std::invalid_argument("[ERROR]: Mismatched particle and AABB counts!");
+            }
+
+            for (std::size_t i=0;i<particles.size();i++)
+            {
+                if (particleMap.count(particles[i]) != 0)
+                {
+                    throw std::invalid_argument("[ERROR]: Particle already exists in tree!");
+                }
+                validateBounds(aabbs[i]);
+                validateFatBounds(aabbs[i], fatAABBs[i]);
+            }
+
+            // Detach the existing leaves and add the new ones next to them.
+            detachLeaves();
+            for (std::size_t i=0;i<particles.size();i++)
+            {
+                unsigned int node = allocateNode();
+                nodes[node].aabb = fatAABBs[i];
+                nodes[node].particleAABB = aabbs[i];
+                nodes[node].height = 0;
+                nodes[node].particle = particles[i];
+                nodes[node].mask = DEFAULT_MASK;
+                particleMap.insert({particles[i], node});
+                buildEntries.push_back({node, centroid(fatAABBs[i]), fatAABBs[i]});
+            }
+            buildFromEntries();
+        }
+
+        //! Rebuild the tree with a top-down surface area heuristic.
+        /*! The leaves are split recursively along the axis of largest
+            centroid spread, at the bin boundary that minimises the sum of
+            the surface area of each side times its number of leaves. This
+            takes O(n log n) and gives a tree with a lower query cost than
+            the incremental insertion, see computeSurfaceAreaRatio.
+         */
+        void rebuild()
+        {
+            if (root == NULL_NODE) return;
+
+            detachLeaves();
+            buildFromEntries();
+        }
+
+    private:
+        /// The index of the root node.
+        unsigned int root;
+
+        /// The dynamic tree.
+        std::vector<NodeType> nodes;
+
+        /// The current number of nodes in the tree.
+        unsigned int nodeCount;
+
+        /// The current node capacity.
+        unsigned int nodeCapacity;
+
+        /// The position of node at the top of the free list.
+        unsigned int freeList;
+
+        /// The skin thickness of the fattened AABBs, as a fraction of the AABB base length.
+        Scalar skinThickness;
+
+        /// A map between particle and node indices.
+        std::unordered_map<std::size_t, unsigned int> particleMap;
+
+        /// Does touching count as overlapping in tree queries?
+        bool touchIsOverlap;
+
+        /// A leaf to be placed in the tree by a rebuild.
+        struct BuildEntry
+        {
+            /// The index of the leaf node.
+            unsigned int node;
+
+            /// The centre of the leaf AABB.
+            typename AABBType::Bounds centroid;
+
+            /// The leaf AABB, copied so that the build reads the leaves
+            /// sequentially.
+            AABBType aabb;
+        };
+
+        /// Leaves placed in the tree by the current rebuild.
+        std::vector<BuildEntry> buildEntries;
+
+        /// Number of bins used to evaluate the split candidates.
+        static constexpr unsigned int BUILD_BINS = 16;
+
+        /// Depth below which the leaves are split at the median instead of
+        /// with the surface area heuristic, to bound the recursion.
+        static constexpr unsigned int MAX_SAH_DEPTH = 64;
+
+        //! Compute the centre of an AABB, with infinite bounds mapped to 0.
+        /*! \param aabb
+                The AABB.
+
+            \return
+                The centre of the AABB.
+         */
+        static typename AABBType::Bounds centroid(const AABBType& aabb)
+        {
+            typename AABBType::Bounds c;
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                c[i] = Scalar(0.5) * (aabb.lowerBound[i] + aabb.upperBound[i]);
+                if (!std::isfinite(c[i])) c[i] = 0;
+            }
+            return c;
+        }
+
+        //! Free the internal nodes and store the leaves in buildEntries.
+        void detachLeaves()
+        {
+            buildEntries.clear();
+            buildEntries.reserve(nodeCount);
+            for (unsigned int i=0;i<nodeCapacity;i++)
+            {
+                // Free node.
+                if (nodes[i].height < 0) continue;
+
+                if (nodes[i].isLeaf())
+                {
+                    nodes[i].parent = NULL_NODE;
+                    buildEntries.push_back({i, centroid(nodes[i].aabb), nodes[i].aabb});
+                }
+                else freeNode(i);
+            }
+            root = NULL_NODE;
+        }
+
+        //! Build the tree from the leaves in buildEntries.
+        void buildFromEntries()
+        {
+            if (!buildEntries.empty())
+            {
+                root = buildRange(0, static_cast<unsigned int>(
+                    buildEntries.size()), 0);
+                nodes[root].parent = NULL_NODE;
+            }
+            buildEntries.clear();
+
+            validate();
+        }
+
+        //! Build the sub-tree of a range of buildEntries.
+        /*! \param begin
+                The index of the first entry.
+
+            \param end
+                One past the index of the last entry.
+
+            \param depth
+                The depth of the sub-tree root.
+
+            \return
+                The index of the sub-tree root.
+         */
+        unsigned int buildRange(unsigned int begin, unsigned int end,
+            unsigned int depth)
+        {
+            if (end - begin == 1) return buildEntries[begin].node;
+
+            // Split along the axis of largest centroid spread.
+            typename AABBType::Bounds lower = buildEntries[begin].centroid;
+            typename AABBType::Bounds upper = lower;
+            for (unsigned int i=begin+1;i<end;i++)
+            {
+                for (unsigned int d=0;d<Dimension;d++)
+                {
+                    lower[d] = std::min(lower[d], buildEntries[i].centroid[d]);
+                    upper[d] = std::max(upper[d], buildEntries[i].centroid[d]);
+                }
+            }
+            unsigned int axis = 0;
+            for (unsigned int d=1;d<Dimension;d++)
+            {
+                if (upper[d] - lower[d] > upper[axis] - lower[axis]) axis = d;
+            }
+
+            unsigned int mid = begin;
+            Scalar extent = upper[axis] - lower[axis];
+            if (extent > 0 && depth < MAX_SAH_DEPTH &&
+                end - begin <= BUILD_BINS)
+            {
+                // Few leaves: sort them and evaluate every split.
+                std::sort(buildEntries.begin() + begin,
+                    buildEntries.begin() + end,
+                    [axis](const BuildEntry& a, const BuildEntry& b)
+                    {
+                        return a.centroid[axis] < b.centroid[axis];
+                    });
+
+                std::array<Scalar, BUILD_BINS> rightCosts{};
+                AABBType right = buildEntries[end-1].aabb;
+                for (unsigned int i=end-1;i>begin;i--)
+                {
+                    right.merge(right, buildEntries[i].aabb);
+                    rightCosts[i-begin] = (end - i) * right.getSurfaceArea();
+                }
+
+                Scalar minCost = std::numeric_limits<Scalar>::max();
+                AABBType left = buildEntries[begin].aabb;
+                for (unsigned int i=begin+1;i<end;i++)
+                {
+                    Scalar cost = (i - begin) * left.getSurfaceArea() +
+                        rightCosts[i-begin];
+                    if (cost < minCost)
+                    {
+                        minCost = cost;
+                        mid = i;
+                    }
+                    left.merge(left, buildEntries[i].aabb);
+                }
+            }
+            else if (extent > 0 && depth < MAX_SAH_DEPTH)
+            {
+                // Bin the leaves and find the bin boundary of lowest cost.
+                std::array<AABBType, BUILD_BINS> binAABBs;
+                std::array<unsigned int, BUILD_BINS> binCounts{};
+                Scalar scale = BUILD_BINS / extent;
+                auto binOf = [&](const BuildEntry& entry)
+                {
+                    unsigned int bin = static_cast<unsigned int>(
+                        (entry.centroid[axis] - lower[axis]) * scale);
+                    return std::min(bin, BUILD_BINS - 1);
+                };
+                for (unsigned int i=begin;i<end;i++)
+                {
+                    unsigned int bin = binOf(buildEntries[i]);
+                    const AABBType& aabb = buildEntries[i].aabb;
+                    if (binCounts[bin] == 0) binAABBs[bin] = aabb;
+                    else binAABBs[bin].merge(binAABBs[bin], aabb);
+                    binCounts[bin]++;
+                }
+
+                // Sweep from the right to get the cost of each right side.
+                std::array<Scalar, BUILD_BINS> rightCosts{};
+                AABBType right;
+                unsigned int rightCount = 0;
+                for (unsigned int b=BUILD_BINS-1;b>0;b--)
+                {
+                    if (binCounts[b] > 0)
+                    {
+                        if (rightCount == 0) right = binAABBs[b];
+                        else right.merge(right, binAABBs[b]);
+                        rightCount += binCounts[b];
+                    }
+                    rightCosts[b] = rightCount * right.getSurfaceArea();
+                }
+
+                Scalar minCost = std::numeric_limits<Scalar>::max();
+                unsigned int bestBin = BUILD_BINS;
+                AABBType left;
+                unsigned int leftCount = 0;
+                for (unsigned int b=0;b+1<BUILD_BINS;b++)
+                {
+                    if (binCounts[b] > 0)
+                    {
+                        if (leftCount == 0) left = binAABBs[b];
+                        else left.merge(left, binAABBs[b]);
+                        leftCount += binCounts[b];
+                    }
+                    if (leftCount == 0 || leftCount == end - begin) continue;
+
+                    Scalar cost = leftCount * left.getSurfaceArea() +
+                        rightCosts[b+1];
+                    if (cost < minCost)
+                    {
+                        minCost = cost;
+                        bestBin = b;
+                    }
+                }
+
+                if (bestBin < BUILD_BINS)
+                {
+                    auto it = std::partition(buildEntries.begin() + begin,
+                        buildEntries.begin() + end,
+                        [&](const BuildEntry& entry)
+                        {
+                            return binOf(entry) <= bestBin;
+                        });
+                    mid = static_cast<unsigned int>(
+                        it - buildEntries.begin());
+                }
+            }
+
+            // Split at the median when the heuristic found no split.
+            if (mid == begin || mid == end)
+            {
+                mid = begin + (end - begin) / 2;
+                std::nth_element(buildEntries.begin() + begin,
+                    buildEntries.begin() + mid, buildEntries.begin() + end,
+                    [axis](const BuildEntry& a, const BuildEntry& b)
+                    {
+                        return a.centroid[axis] < b.centroid[axis];
+                    });
+            }
+
+            unsigned int index1 = buildRange(begin, mid, depth + 1);
+            unsigned int index2 = buildRange(mid, end, depth + 1);
+
+            unsigned int parent = allocateNode();
+            nodes[parent].left = index1;
+            nodes[parent].right = index2;
+            nodes[parent].height = 1 + std::max(nodes[index1].height, nodes[index2].height);
+            nodes[parent].aabb.merge(nodes[index1].aabb, nodes[index2].aabb);
+            nodes[parent].mask = nodes[index1].mask | nodes[index2].mask;
+
+            nodes[index1].parent = parent;
+            nodes[index2].parent = parent;
+
+            return parent;
+        }
+
+        //! Validate the bounds of a particle AABB.
+        /*! \param aabb
+                The AABB.
+         */
+        static void validateBounds(const AABBType& aabb)
+        {
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                if (aabb.lowerBound[i] > aabb.upperBound[i])
+                {
+                    throw std::invalid_argument("[ERROR]: AABB lower bound is greater than the upper bound!");
+                }
+            }
+        }
+
+        //! Validate that a fattened AABB contains the particle AABB.
+        /*! \param aabb
+                The particle AABB.
+
+            \param fatAABB
+                The fattened AABB.
+         */
+        static void validateFatBounds(const AABBType& aabb, const AABBType& fatAABB)
+        {
+            if (!fatAABB.contains(aabb))
+            {
+                throw std::invalid_argument("[ERROR]: Fattened AABB does not contain the particle AABB!");
+            }
+        }
+
+        //! Fatten a particle AABB by the skin thickness.
+        /*! \param aabb
+                The AABB.
+
+            \return
+                The fattened AABB.
+         */
+        AABBType fatten(const AABBType& aabb) const
+        {
+            AABBType fat = aabb;
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                Scalar skin = skinThickness * (aabb.upperBound[i] - aabb.lowerBound[i]);
+                fat.lowerBound[i] -= skin;
+                fat.upperBound[i] += skin;
+            }
+            fat.surfaceArea = fat.computeSurfaceArea();
+            return fat;
+        }
+
+        //! Allocate a new node.
+        /*! \return
+                The index of the allocated node.
+         */
+        unsigned int allocateNode()
+        {
+            // Exand the node pool as needed.
+            if (freeList == NULL_NODE)
+            {
+                assert(nodeCount == nodeCapacity);
+
+                // The free list is empty. Rebuild a bigger pool.
+                nodeCapacity *= 2;
+                nodes.resize(nodeCapacity);
+
+                // Build a linked list for the list of free nodes.
+                for (unsigned int i=nodeCount;i<nodeCapacity-1;i++)
+                {
+                    nodes[i].next = i + 1;
+                    nodes[i].height = -1;
+                }
+                nodes[nodeCapacity-1].next = NULL_NODE;
+                nodes[nodeCapacity-1].height = -1;
+
+                // Assign the index of the first free node.
+                freeList = nodeCount;
+            }
+
+            // Peel a node off the free list.
+            unsigned int node = freeList;
+            freeList = nodes[node].next;
+            nodes[node].parent = NULL_NODE;
+            nodes[node].left = NULL_NODE;
+            nodes[node].right = NULL_NODE;
+            nodes[node].height = 0;
+            nodeCount++;
+
+            return node;
+        }
+
+        //! Free an existing node.
+        /*! \param node
+                The index of the node to be freed.
+         */
+        void freeNode(unsigned int node)
+        {
+            assert(node < nodeCapacity);
+            assert(0 < nodeCount);
+
+            nodes[node].next = freeList;
+            nodes[node].height = -1;
+            freeList = node;
+            nodeCount--;
+        }
+
+        //! Insert a leaf into the tree.
+        /*! \param leaf
+                The index of the leaf node.
+         */
+        void insertLeaf(unsigned int leaf)
+        {
+            if (root == NULL_NODE)
+            {
+                root = leaf;
+                nodes[root].parent = NULL_NODE;
+                return;
+            }
+
+            // Find the best sibling for the node.
+
+            const AABBType leafAABB = nodes[leaf].aabb;
+            unsigned int index = root;
+
+            while (!nodes[index].isLeaf())
+            {
+                // Extract the children of the node.
+                unsigned int left  = nodes[index].left;
+                unsigned int right = nodes[index].right;
+
+                Scalar surfaceArea = nodes[index].aabb.getSurfaceArea();
+
+                AABBType combinedAABB;
+                combinedAABB.merge(nodes[index].aabb, leafAABB);
+                Scalar combinedSurfaceArea = combinedAABB.getSurfaceArea();
+
+                // Cost of creating a new parent for this node and the new leaf.
+                Scalar cost = 2 * combinedSurfaceArea;
+
+                // Minimum cost of pushing the leaf further down the tree.
+                Scalar inheritanceCost = 2 * (combinedSurfaceArea - surfaceArea);
+
+                // Cost of descending to the left.
+                Scalar costLeft = descendCost(left, leafAABB) + inheritanceCost;
+
+                // Cost of descending to the right.
+                Scalar costRight = descendCost(right, leafAABB) + inheritanceCost;
+
+                // Descend according to the minimum cost.
+                if ((cost < costLeft) && (cost < costRight)) break;
+
+                // Descend.
+                if (costLeft < costRight) index = left;
+                else                      index = right;
+            }
+
+            unsigned int sibling = index;
+
+            // Create a new parent.
+            unsigned int oldParent = nodes[sibling].parent;
+            unsigned int newParent = allocateNode();
+            nodes[newParent].parent = oldParent;
+            nodes[newParent].aabb.merge(leafAABB, nodes[sibling].aabb);
+            nodes[newParent].mask = nodes[leaf].mask | nodes[sibling].mask;
+            nodes[newParent].height = nodes[sibling].height + 1;
+
+            // The sibling was not the root.
+            if (oldParent != NULL_NODE)
+            {
+                if (nodes[oldParent].left == sibling) nodes[oldParent].left = newParent;
+                else                                  nodes[oldParent].right = newParent;
+            }
+            // The sibling was the root.
+            else
+            {
+                root = newParent;
+            }
+
+            nodes[newParent].left = sibling;
+            nodes[newParent].right = leaf;
+            nodes[sibling].parent = newParent;
+            nodes[leaf].parent = newParent;
+
+            // Walk back up the tree fixing heights and AABBs.
+            index = nodes[leaf].parent;
+            while (index != NULL_NODE)
+            {
+                index = balance(index);
+
+                unsigned int left = nodes[index].left;
+                unsigned int right = nodes[index].right;
+
+                assert(left != NULL_NODE);
+                assert(right != NULL_NODE);
+
+                nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+                nodes[index].aabb.merge(nodes[left].aabb, nodes[right].aabb);
+                nodes[index].mask = nodes[left].mask | nodes[right].mask;
+
+                index = nodes[index].parent;
+            }
+        }
+
+        //! Cost of pushing a leaf down into a child node.
+        /*! \param child
+                The index of the child node.
+
+            \param leafAABB
+                The AABB of the leaf to be inserted.
+
+            \return
+                The increase in surface area.
+         */
+        Scalar descendCost(unsigned int child, const AABBType& leafAABB) const
+        {
+            AABBType aabb;
+            aabb.merge(leafAABB, nodes[child].aabb);
+            if (nodes[child].isLeaf())
+                return aabb.getSurfaceArea();
+            return aabb.getSurfaceArea() - nodes[child].aabb.getSurfaceArea();
+        }
+
+        //! Remove a leaf from the tree.
+        /*! \param leaf
+                The index of the leaf node.
+         */
+        void removeLeaf(unsigned int leaf)
+        {
+            if (leaf == root)
+            {
+                root = NULL_NODE;
+                return;
+            }
+
+            unsigned int parent = nodes[leaf].parent;
+            unsigned int grandParent = nodes[parent].parent;
+            unsigned int sibling;
+
+            if (nodes[parent].left == leaf) sibling = nodes[parent].right;
+            else                            sibling = nodes[parent].left;
+
+            // Destroy the parent and connect the sibling to the grandparent.
+            if (grandParent != NULL_NODE)
+            {
+                if (nodes[grandParent].left == parent) nodes[grandParent].left = sibling;
+                else                                   nodes[grandParent].right = sibling;
+
+                nodes[sibling].parent = grandParent;
+                freeNode(parent);
+
+                // Adjust ancestor bounds.
+                unsigned int index = grandParent;
+                while (index != NULL_NODE)
+                {
+                    index = balance(index);
+
+                    unsigned int left = nodes[index].left;
+                    unsigned int right = nodes[index].right;
+
+                    nodes[index].aabb.merge(nodes[left].aabb, nodes[right].aabb);
+                    nodes[index].mask = nodes[left].mask | nodes[right].mask;
+                    nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+
+                    index = nodes[index].parent;
+                }
+            }
+            else
+            {
+                root = sibling;
+                nodes[sibling].parent = NULL_NODE;
+                freeNode(parent);
+            }
+        }
+
+        //! Balance the tree.
+        /*! \param node
+                The index of the node.
+         */
+        unsigned int balance(unsigned int node)
+        {
+            assert(node != NULL_NODE);
+
+            if (nodes[node].isLeaf() || (nodes[node].height < 2))
+                return node;
+
+            unsigned int left = nodes[node].left;
+            unsigned int right = nodes[node].right;
+
+            assert(left < nodeCapacity);
+            assert(right < nodeCapacity);
+
+            int currentBalance = nodes[right].height - nodes[left].height;
+
+            // Rotate right branch up.
+            if (currentBalance > 1)
+            {
+                rotate(node, right, left);
+                return right;
+            }
+
+            // Rotate left branch up.
+            if (currentBalance < -1)
+            {
+                rotate(node, left, right);
+                return left;
+            }
+
+            return node;
+        }
+
+        //! Rotate a child up to replace its parent.
+        /*! \param node
+                The index of the node to rotate down.
+
+            \param up
+                The index of the child of node that is rotated up.
+
+            \param other
+                The index of the other child of node.
+         */
+        void rotate(unsigned int node, unsigned int up, unsigned int other)
+        {
+            unsigned int upLeft = nodes[up].left;
+            unsigned int upRight = nodes[up].right;
+
+            assert(upLeft < nodeCapacity);
+            assert(upRight < nodeCapacity);
+
+            // Swap node and its child.
+            nodes[up].left = node;
+            nodes[up].parent = nodes[node].parent;
+            nodes[node].parent = up;
+
+            // The node's old parent should now point to its child.
+            if (nodes[up].parent != NULL_NODE)
+            {
+                if (nodes[nodes[up].parent].left == node) nodes[nodes[up].parent].left = up;
+                else
+                {
+                    assert(nodes[nodes[up].parent].right == node);
+                    nodes[nodes[up].parent].right = up;
+                }
+            }
+            else root = up;
+
+            // Keep the taller grandchild under the rotated node.
+            unsigned int keep = upLeft;
+            unsigned int move = upRight;
+            if (nodes[upLeft].height <= nodes[upRight].height)
+            {
+                keep = upRight;
+                move = upLeft;
+            }
+
+            nodes[up].right = keep;
+            if (nodes[node].left == up) nodes[node].left = move;
+            else                        nodes[node].right = move;
+            nodes[move].parent = node;
+
+            nodes[node].aabb.merge(nodes[other].aabb, nodes[move].aabb);
+            nodes[up].aabb.merge(nodes[node].aabb, nodes[keep].aabb);
+            nodes[node].mask = nodes[other].mask | nodes[move].mask;
+            nodes[up].mask = nodes[node].mask | nodes[keep].mask;
+
+            nodes[node].height = 1 + std::max(nodes[other].height, nodes[move].height);
+            nodes[up].height = 1 + std::max(nodes[node].height, nodes[keep].height);
+        }
+
+        //! Compute the height of the tree.
+        /*! \return
+                The height of the entire tree.
+         */
+        unsigned int computeHeight() const
+        {
+            if (root == NULL_NODE) return 0;
+            return computeHeight(root);
+        }
+
+        //! Compute the height of a sub-tree.
+        /*! \param node
+                The index of the root node.
+
+            \return
+                The height of the sub-tree.
+         */
+        unsigned int computeHeight(unsigned int node) const
+        {
+            assert(node < nodeCapacity);
+
+            if (nodes[node].isLeaf()) return 0;
+
+            unsigned int height1 = computeHeight(nodes[node].left);
+            unsigned int height2 = computeHeight(nodes[node].right);
+
+            return 1 + std::max(height1, height2);
+        }
+
+        //! Assert that the sub-tree has a valid structure.
+        /*! \param node
+                The index of the root node.
+         */
+        void validateStructure(unsigned int node) const
+        {
+            if (node == NULL_NODE) return;
+
+            if (node == root) assert(nodes[node].parent == NULL_NODE);
+
+            unsigned int left = nodes[node].left;
+            unsigned int right = nodes[node].right;
+
+            if (nodes[node].isLeaf())
+            {
+                assert(left == NULL_NODE);
+                assert(right == NULL_NODE);
+                assert(nodes[node].height == 0);
+                return;
+            }
+
+            assert(left < nodeCapacity);
+            assert(right < nodeCapacity);
+
+            assert(nodes[left].parent == node);
+            assert(nodes[right].parent == node);
+
+            validateStructure(left);
+            validateStructure(right);
+        }
+
+        //! Assert that the sub-tree has valid metrics.
+        /*! \param node
+                The index of the root node.
+         */
+        void validateMetrics(unsigned int node) const
+        {
+            if (node == NULL_NODE) return;
+
+            unsigned int left = nodes[node].left;
+            unsigned int right = nodes[node].right;
+
+            if (nodes[node].isLeaf())
+            {
+                assert(left == NULL_NODE);
+                assert(right == NULL_NODE);
+                assert(nodes[node].height == 0);
+                return;
+            }
+
+            assert(left < nodeCapacity);
+            assert(right < nodeCapacity);
+
+            int height1 = nodes[left].height;
+            int height2 = nodes[right].height;
+            int height = 1 + std::max(height1, height2);
+            (void)height; // Unused variable in Release build
+            assert(nodes[node].height == height);
+
+            AABBType aabb;
+            aabb.merge(nodes[left].aabb, nodes[right].aabb);
+
+            for (unsigned int i=0;i<Dimension;i++)
+            {
+                assert(std::fabs(aabb.lowerBound[i] - nodes[node].aabb.lowerBound[i]) < 1e-6);
+                assert(std::fabs(aabb.upperBound[i] - nodes[node].aabb.upperBound[i]) < 1e-6);
+            }
+
+            validateMetrics(left);
+            validateMetrics(right);
+        }
+    };
+}
+
+#endif /* _FIXED_AABB_H */
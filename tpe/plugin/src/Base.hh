@@ -18,11 +18,18 @@
 #ifndef GZ_PHYSICS_TPE_PLUGIN_SRC_BASE_HH_
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_BASE_HH_
 
+#include <Eigen/Geometry>
+
+#include <gz/math/eigen3/Conversions.hh>
 #include <gz/physics/Implements.hh>
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "lib/src/World.hh"
 #include "lib/src/Engine.hh"
@@ -59,7 +66,55 @@ struct CollisionInfo
   tpelib::Collision *collision;
 };
 
-class Base : public Implements3d<FeatureList<Feature>>
+/// \brief Sorted ids of the children of a container entity, kept up to
+/// date as entities are added and removed so that indices can be computed
+/// without scanning all the entities.
+struct ContainerChildIds
+{
+  /// \brief Ids of the children of all types
+  std::vector<std::size_t> all;
+
+  /// \brief Ids of the child worlds
+  std::vector<std::size_t> worlds;
+
+  /// \brief Ids of the child models
+  std::vector<std::size_t> models;
+
+  /// \brief Ids of the child links
+  std::vector<std::size_t> links;
+
+  /// \brief Ids of the child collisions
+  std::vector<std::size_t> collisions;
+};
+
+/// \brief Convert a vector of the precision of a feature policy to a
+/// tpelib vector. tpelib always computes in double precision.
+/// \param[in] _vec Vector to convert
+/// \return The vector in double precision
+template <typename Scalar>
+inline math::Vector3d ToTpe(const Eigen::Matrix<Scalar, 3, 1> &_vec)
+{
+  return math::eigen3::convert(Eigen::Vector3d(_vec.template cast<double>()));
+}
+
+/// \brief Convert a pose of the precision of a feature policy to a tpelib
+/// pose
+/// \param[in] _pose Pose to convert
+/// \return The pose in double precision
+template <typename Scalar>
+inline math::Pose3d ToTpe(
+    const Eigen::Transform<Scalar, 3, Eigen::Isometry> &_pose)
+{
+  return math::eigen3::convert(
+      Eigen::Isometry3d(_pose.template cast<double>()));
+}
+
+/// \brief Entity storage shared by the features of the plugin.
+/// \tparam PolicyT Feature policy of the plugin, FeaturePolicy3d or
+/// FeaturePolicy3f. The policy only sets the precision of the values
+/// exchanged with the features, the entities are stored in tpelib.
+template <typename PolicyT>
+class Base : public Implements<PolicyT, FeatureList<Feature>>
 {
   public: inline Identity InitiateEngine(std::size_t /*_engineID*/) override
   {
@@ -68,20 +123,16 @@ class Base : public Implements3d<FeatureList<Feature>>
 
   public: inline std::size_t idToIndexInContainer(std::size_t _id) const
   {
-    std::size_t index = 0;
     auto it = this->childIdToParentId.find(_id);
     if (it != this->childIdToParentId.end())
     {
-      for (const auto &pair : this->childIdToParentId)
+      auto containerIt = this->containerChildIds.find(it->second);
+      if (containerIt != this->containerChildIds.end())
       {
-        if (pair.first == _id && pair.second == it->second)
-        {
-          return index;
-        }
-        else if (pair.second == it->second)
-        {
-          ++index;
-        }
+        const auto &ids = containerIt->second.all;
+        auto idIt = std::lower_bound(ids.begin(), ids.end(), _id);
+        if (idIt != ids.end() && *idIt == _id)
+          return static_cast<std::size_t>(idIt - ids.begin());
       }
     }
     // return invalid index if not found in id map
@@ -94,41 +145,127 @@ class Base : public Implements3d<FeatureList<Feature>>
       const std::size_t _index,
       const std::map<std::size_t, EntityType> &_idMap) const
   {
-    std::size_t counter = 0;
-    auto it = this->childIdToParentId.begin();
-
-    while (counter <= _index && it != this->childIdToParentId.end())
+    auto containerIt = this->containerChildIds.find(_containerId);
+    if (containerIt != this->containerChildIds.end())
     {
-      if (it->second == _containerId)
+      // only the children with the type of the entities in the idMap are
+      // indexed
+      const auto &ids = this->ChildIdsOfType(containerIt->second, _idMap);
+      if (_index < ids.size())
       {
-        auto idMapIt = _idMap.find(it->first);
-        // only count if the entity is found in the idMap. This makes sure we're
-        // counting only the entities with the correct EntityType
+        auto idMapIt = _idMap.find(ids[_index]);
         if (idMapIt != _idMap.end())
-        {
-          if (counter == _index)
-          {
-            return *idMapIt;
-          }
-          else
-          {
-            ++counter;
-          }
-        }
+          return *idMapIt;
       }
-      ++it;
     }
     // return invalid id if entity not found
     return {INVALID_ENTITY_ID, nullptr};
   }
 
+  /// \brief Get the ids of the child worlds of a container
+  /// \param[in] _children Children of the container
+  /// \return Sorted ids of the child worlds
+  public: inline const std::vector<std::size_t> &ChildIdsOfType(
+      const ContainerChildIds &_children,
+      const std::map<std::size_t, std::shared_ptr<WorldInfo>> &) const
+  {
+    return _children.worlds;
+  }
+
+  /// \brief Get the ids of the child models of a container
+  /// \param[in] _children Children of the container
+  /// \return Sorted ids of the child models
+  public: inline const std::vector<std::size_t> &ChildIdsOfType(
+      const ContainerChildIds &_children,
+      const std::map<std::size_t, std::shared_ptr<ModelInfo>> &) const
+  {
+    return _children.models;
+  }
+
+  /// \brief Get the ids of the child links of a container
+  /// \param[in] _children Children of the container
+  /// \return Sorted ids of the child links
+  public: inline const std::vector<std::size_t> &ChildIdsOfType(
+      const ContainerChildIds &_children,
+      const std::map<std::size_t, std::shared_ptr<LinkInfo>> &) const
+  {
+    return _children.links;
+  }
+
+  /// \brief Get the ids of the child collisions of a container
+  /// \param[in] _children Children of the container
+  /// \return Sorted ids of the child collisions
+  public: inline const std::vector<std::size_t> &ChildIdsOfType(
+      const ContainerChildIds &_children,
+      const std::map<std::size_t, std::shared_ptr<CollisionInfo>> &) const
+  {
+    return _children.collisions;
+  }
+
+  /// \brief Insert an id in a sorted vector of ids. Entity ids increase
+  /// so the id is usually appended.
+  /// \param[in,out] _ids Sorted ids
+  /// \param[in] _id Id to insert
+  public: static inline void InsertChildId(std::vector<std::size_t> &_ids,
+      std::size_t _id)
+  {
+    if (_ids.empty() || _ids.back() < _id)
+    {
+      _ids.push_back(_id);
+      return;
+    }
+    auto it = std::lower_bound(_ids.begin(), _ids.end(), _id);
+    if (*it != _id)
+      _ids.insert(it, _id);
+  }
+
+  /// \brief Remove an id from a sorted vector of ids
+  /// \param[in,out] _ids Sorted ids
+  /// \param[in] _id Id to remove
+  public: static inline void RemoveChildId(std::vector<std::size_t> &_ids,
+      std::size_t _id)
+  {
+    auto it = std::lower_bound(_ids.begin(), _ids.end(), _id);
+    if (it != _ids.end() && *it == _id)
+      _ids.erase(it);
+  }
+
+  /// \brief Remove sorted ids from a sorted vector of ids in one pass
+  /// \param[in,out] _ids Sorted ids
+  /// \param[in] _removed Sorted ids to remove
+  public: static inline void RemoveChildIds(std::vector<std::size_t> &_ids,
+      const std::vector<std::size_t> &_removed)
+  {
+    _ids.erase(std::remove_if(_ids.begin(), _ids.end(),
+        [&_removed](std::size_t _id)
+        {
+          return std::binary_search(_removed.begin(), _removed.end(), _id);
+        }), _ids.end());
+  }
+
+  /// \brief Reserve storage for the ids of models about to be added to a
+  /// container
+  /// \param[in] _parentId Id of the container
+  /// \param[in] _count Number of models about to be added
+  public: inline void ReserveModels(std::size_t _parentId, std::size_t _count)
+  {
+    auto &children = this->containerChildIds[_parentId];
+    children.all.reserve(children.all.size() + _count);
+    children.models.reserve(children.models.size() + _count);
+  }
+
   public: inline Identity AddWorld(std::shared_ptr<tpelib::World> _world)
   {
     size_t worldId = _world->GetId();
     auto worldPtr = std::make_shared<WorldInfo>();
     worldPtr->world = _world;
     this->worlds.insert({worldId, worldPtr});
-    this->childIdToParentId.insert({worldId, -1});
+    if (this->childIdToParentId.insert({worldId, -1}).second)
+    {
+      auto &children = this->containerChildIds[-1];
+      InsertChildId(children.all, worldId);
+      InsertChildId(children.worlds, worldId);
+    }
     return this->GenerateIdentity(worldId, worldPtr);
   }
 
@@ -137,9 +274,18 @@ class Base : public Implements3d<FeatureList<Feature>>
     auto modelPtr = std::make_shared<ModelInfo>();
     modelPtr->model = &_model;
     size_t modelId = _model.GetId();
-    this->models.insert({modelId, modelPtr});
+    // entity ids increase so new entities are inserted at the end of the
+    // maps
+    this->models.insert(this->models.end(), {modelId, modelPtr});
     // keep track of model's corresponding world
-    this->childIdToParentId.insert({modelId, _parentId});
+    if (this->childIdToParentId.insert({modelId, _parentId}).second)
+    {
+      auto &children = this->containerChildIds[_parentId];
+      InsertChildId(children.all, modelId);
+      InsertChildId(children.models, modelId);
+    }
+    if (this->worlds.find(_parentId) == this->worlds.end())
+      this->nestedModelIds.insert(modelId);
 
     return this->GenerateIdentity(modelId, modelPtr);
   }
@@ -149,9 +295,16 @@ class Base : public Implements3d<FeatureList<Feature>>
     auto linkPtr = std::make_shared<LinkInfo>();
     linkPtr->link = &_link;
     size_t linkId = _link.GetId();
-    this->links.insert({linkId, linkPtr});
+    this->links.insert(this->links.end(), {linkId, linkPtr});
     // keep track of link's corresponding model
-    this->childIdToParentId.insert({linkId, _modelId});
+    if (this->childIdToParentId.insert({linkId, _modelId}).second)
+    {
+      auto &children = this->containerChildIds[_modelId];
+      InsertChildId(children.all, linkId);
+      InsertChildId(children.links, linkId);
+    }
+    if (this->nestedModelIds.find(_modelId) != this->nestedModelIds.end())
+      this->nestedModelsWithNewLinks.insert(_modelId);
 
     return this->GenerateIdentity(linkId, linkPtr);
   }
@@ -162,9 +315,15 @@ class Base : public Implements3d<FeatureList<Feature>>
     auto collisionPtr = std::make_shared<CollisionInfo>();
     collisionPtr->collision = &_collision;
     size_t collisionId = _collision.GetId();
-    this->collisions.insert({collisionId, collisionPtr});
+    this->collisions.insert(this->collisions.end(),
+        {collisionId, collisionPtr});
     // keep track of collision's corresponding link
-    this->childIdToParentId.insert({collisionId, _linkId});
+    if (this->childIdToParentId.insert({collisionId, _linkId}).second)
+    {
+      auto &children = this->containerChildIds[_linkId];
+      InsertChildId(children.all, collisionId);
+      InsertChildId(children.collisions, collisionId);
+    }
 
     return this->GenerateIdentity(collisionId, collisionPtr);
   }
@@ -212,13 +371,99 @@ class Base : public Implements3d<FeatureList<Feature>>
     return result;
   }
 
+  /// \brief Remove many models at once. The models are grouped by parent
+  /// and each parent removes its models in one batch.
+  /// \param[in] _modelIDs Ids of the models to remove
+  /// \return Number of models removed, not counting their nested models
+  public: std::size_t RemoveModelsImpl(
+      const std::vector<std::size_t> &_modelIDs)
+  {
+    std::map<std::size_t, std::vector<std::size_t>> modelsByParent;
+    for (std::size_t modelId : _modelIDs)
+    {
+      auto parentIt = this->childIdToParentId.find(modelId);
+      if (parentIt != this->childIdToParentId.end() &&
+          this->models.find(modelId) != this->models.end())
+      {
+        modelsByParent[parentIt->second].push_back(modelId);
+      }
+    }
+
+    std::size_t removed = 0u;
+    for (auto &[parentId, modelIds] : modelsByParent)
+    {
+      tpelib::Entity *parentEntity = nullptr;
+      auto worldIt = this->worlds.find(parentId);
+      if (worldIt != this->worlds.end())
+      {
+        parentEntity = worldIt->second->world.get();
+      }
+      else
+      {
+        auto modelIt = this->models.find(parentId);
+        if (modelIt != this->models.end())
+          parentEntity = modelIt->second->model;
+      }
+      if (nullptr == parentEntity)
+        continue;
+
+      std::sort(modelIds.begin(), modelIds.end());
+      modelIds.erase(std::unique(modelIds.begin(), modelIds.end()),
+          modelIds.end());
+
+      for (std::size_t modelId : modelIds)
+      {
+        // nested models are removed one by one
+        tpelib::Model *model = this->models[modelId]->model;
+        std::vector<std::size_t> nestedIds;
+        for (const auto &child : model->GetChildren())
+        {
+          if (dynamic_cast<tpelib::Model *>(child.second.get()))
+            nestedIds.push_back(child.first);
+        }
+        for (std::size_t nestedId : nestedIds)
+          this->RemoveModelImpl(nestedId);
+
+        this->models.erase(modelId);
+        this->nestedModelIds.erase(modelId);
+        this->nestedModelsWithNewLinks.erase(modelId);
+        this->childIdToParentId.erase(modelId);
+      }
+
+      auto containerIt = this->containerChildIds.find(parentId);
+      if (containerIt != this->containerChildIds.end())
+      {
+        RemoveChildIds(containerIt->second.all, modelIds);
+        RemoveChildIds(containerIt->second.models, modelIds);
+      }
+      removed += parentEntity->RemoveChildrenById(modelIds);
+    }
+    return removed;
+  }
+
   public: bool RemoveModelFromParent(std::size_t _modelID,
                                      tpelib::Entity *_parentEntity)
   {
     if (nullptr == _parentEntity)
       return false;
     bool result = this->models.erase(_modelID) == 1;
-    result &= this->childIdToParentId.erase(_modelID) == 1;
+    this->nestedModelIds.erase(_modelID);
+    this->nestedModelsWithNewLinks.erase(_modelID);
+    auto parentIt = this->childIdToParentId.find(_modelID);
+    if (parentIt != this->childIdToParentId.end())
+    {
+      auto containerIt = this->containerChildIds.find(parentIt->second);
+      if (containerIt != this->containerChildIds.end())
+      {
+        RemoveChildId(containerIt->second.all, _modelID);
+        RemoveChildId(containerIt->second.models, _modelID);
+      }
+      this->childIdToParentId.erase(parentIt);
+    }
+    else
+    {
+      result = false;
+    }
     result &= _parentEntity->RemoveChildById(_modelID);
     return result;
   }
@@ -228,6 +473,20 @@ class Base : public Implements3d<FeatureList<Feature>>
   public: std::map<std::size_t, std::shared_ptr<LinkInfo>> links;
   public: std::map<std::size_t, std::shared_ptr<CollisionInfo>> collisions;
   public: std::map<std::size_t, std::size_t> childIdToParentId;
+
+  /// \brief Children of each container entity, by container id
+  public: std::unordered_map<std::size_t, ContainerChildIds>
+      containerChildIds;
+
+  /// \brief Ids of the models nested in other models. Unlike the models of
+  /// a world and their links, they are not tracked by the world when they
+  /// move.
+  public: std::set<std::size_t> nestedModelIds;
+
+  /// \brief Ids of the nested models that got links since their world was
+  /// last stepped. The poses of these links are reported as changed in the
+  /// next step.
+  public: mutable std::set<std::size_t> nestedModelsWithNewLinks;
 };
 
 }
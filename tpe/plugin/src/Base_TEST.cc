@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <vector>
 
 #include <gz/physics/Implements.hh>
 
@@ -36,7 +37,7 @@ using namespace gz::physics;
 
 TEST(BaseClass, AddEntities)
 {
-  tpeplugin::Base base;
+  tpeplugin::Base<FeaturePolicy3d> base;
   base.InitiateEngine(0);
 
   // add world
@@ -181,3 +182,56 @@ TEST(BaseClass, AddEntities)
   EXPECT_EQ(cylinderId,
             base.indexInContainerToId(linkId2, 0u, base.collisions).first);
 }
+
+TEST(BaseClass, ContainerIndices)
+{
+  tpeplugin::Base<FeaturePolicy3d> base;
+  base.InitiateEngine(0);
+
+  auto world = std::make_shared<tpelib::World>();
+  std::size_t worldId = world->GetId();
+  base.AddWorld(world);
+  EXPECT_EQ(0u, base.idToIndexInContainer(worldId));
+
+  // models with a link and a nested model each
+  std::vector<std::size_t> modelIds;
+  for (int i = 0; i < 5; ++i)
+  {
+    auto *model = static_cast<tpelib::Model *>(&world->AddModel());
+    base.AddModel(worldId, *model);
+    modelIds.push_back(model->GetId());
+    auto *link = static_cast<tpelib::Link *>(&model->AddLink());
+    base.AddLink(model->GetId(), *link);
+    auto *nested = static_cast<tpelib::Model *>(&model->AddModel());
+    base.AddModel(model->GetId(), *nested);
+  }
+
+  for (std::size_t i = 0; i < modelIds.size(); ++i)
+  {
+    EXPECT_EQ(i, base.idToIndexInContainer(modelIds[i]));
+    EXPECT_EQ(modelIds[i],
+              base.indexInContainerToId(worldId, i, base.models).first);
+  }
+
+  // children of other types are skipped when indexing by type
+  auto *model0 = base.models.find(modelIds[0])->second->model;
+  std::size_t linkId = model0->GetChildByIndex(0).GetId();
+  std::size_t nestedId = model0->GetChildByIndex(1).GetId();
+  EXPECT_EQ(1u, base.idToIndexInContainer(nestedId));
+  EXPECT_EQ(nestedId,
+            base.indexInContainerToId(modelIds[0], 0u, base.models).first);
+  EXPECT_EQ(linkId,
+            base.indexInContainerToId(modelIds[0], 0u, base.links).first);
+  EXPECT_EQ(INVALID_ENTITY_ID,
+            base.indexInContainerToId(modelIds[0], 1u, base.links).first);
+
+  // indices of the following models are shifted when a model is removed
+  EXPECT_TRUE(base.RemoveModelImpl(modelIds[2]));
+  EXPECT_EQ(static_cast<std::size_t>(-1),
+            base.idToIndexInContainer(modelIds[2]));
+  EXPECT_EQ(2u, base.idToIndexInContainer(modelIds[3]));
+  EXPECT_EQ(modelIds[3],
+            base.indexInContainerToId(worldId, 2u, base.models).first);
+  EXPECT_EQ(INVALID_ENTITY_ID,
+            base.indexInContainerToId(worldId, 4u, base.models).first);
+}
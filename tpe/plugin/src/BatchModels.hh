@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_PLUGIN_SRC_BATCHMODELS_HH_
+#define GZ_PHYSICS_TPE_PLUGIN_SRC_BATCHMODELS_HH_
+
+#include <vector>
+
+#include <sdf/Model.hh>
+
+#include <gz/physics/FeatureList.hh>
+
+namespace gz {
+namespace physics {
+namespace tpeplugin {
+
+/////////////////////////////////////////////////
+/// \brief Construct many model entities from sdf::Model DOM objects in one
+/// call. Storage for the models is reserved once, and the models are added
+/// to the collision detector in bulk on the next step.
+class ConstructSdfModels : public virtual Feature
+{
+  public: template <typename PolicyT, typename FeaturesT>
+  class World : public virtual Feature::World<PolicyT, FeaturesT>
+  {
+    public: using ModelPtrType = ModelPtr<PolicyT, FeaturesT>;
+
+    /// \brief Construct models in this world
+    /// \param[in] _models Models to construct
+    /// \return The constructed models, in the order of _models. Models
+    /// that could not be constructed, or whose pointer is null, are null.
+    public: std::vector<ModelPtrType> ConstructModels(
+        const std::vector<const ::sdf::Model *> &_models);
+  };
+
+  public: template <typename PolicyT>
+  class Implementation : public virtual Feature::Implementation<PolicyT>
+  {
+    public: virtual std::vector<Identity> ConstructSdfModels(
+        const Identity &_worldID,
+        const std::vector<const ::sdf::Model *> &_models) = 0;
+  };
+};
+
+/////////////////////////////////////////////////
+/// \brief Remove many model entities from a world in one call. The child
+/// lookups of the world are rebuilt once instead of once per model.
+class RemoveModelsFromWorld : public virtual Feature
+{
+  public: template <typename PolicyT, typename FeaturesT>
+  class World : public virtual Feature::World<PolicyT, FeaturesT>
+  {
+    /// \brief Remove models from this world
+    /// \param[in] _models Models to remove
+    /// \return Number of models found and removed
+    public: template <typename ModelPtrT>
+    std::size_t RemoveModels(const std::vector<ModelPtrT> &_models);
+  };
+
+  public: template <typename PolicyT>
+  class Implementation : public virtual Feature::Implementation<PolicyT>
+  {
+    public: virtual std::size_t RemoveModels(
+        const Identity &_worldID,
+        const std::vector<std::size_t> &_modelIDs) = 0;
+  };
+};
+
+/////////////////////////////////////////////////
+template <typename PolicyT, typename FeaturesT>
+auto ConstructSdfModels::World<PolicyT, FeaturesT>::ConstructModels(
+    const std::vector<const ::sdf::Model *> &_models)
+    -> std::vector<ModelPtrType>
+{
+  const std::vector<Identity> ids =
+      this->template Interface<ConstructSdfModels>()
+          ->ConstructSdfModels(this->identity, _models);
+
+  std::vector<ModelPtrType> models;
+  models.reserve(ids.size());
+  for (const Identity &id : ids)
+    models.emplace_back(this->pimpl, id);
+  return models;
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT, typename FeaturesT>
+template <typename ModelPtrT>
+std::size_t RemoveModelsFromWorld::World<PolicyT, FeaturesT>::RemoveModels(
+    const std::vector<ModelPtrT> &_models)
+{
+  std::vector<std::size_t> ids;
+  ids.reserve(_models.size());
+  for (const auto &model : _models)
+  {
+    if (model)
+      ids.push_back(model->EntityID());
+  }
+  return this->template Interface<RemoveModelsFromWorld>()
+      ->RemoveModels(this->identity, ids);
+}
+
+}
+}
+}
+
+#endif
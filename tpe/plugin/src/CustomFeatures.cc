@@ -24,7 +24,8 @@ using namespace physics;
 using namespace tpeplugin;
 
 /////////////////////////////////////////////////
-std::shared_ptr<tpelib::World> CustomFeatures::GetTpeLibWorld(
+template <typename PolicyT>
+std::shared_ptr<tpelib::World> CustomFeatures<PolicyT>::GetTpeLibWorld(
   const Identity &_worldID)
 {
   auto it = this->worlds.find(_worldID);
@@ -38,3 +39,26 @@ std::shared_ptr<tpelib::World> CustomFeatures::GetTpeLibWorld(
   }
   return it->second->world;
 }
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+void CustomFeatures<PolicyT>::CastWorldRays(const Identity &_worldID,
+  const std::vector<tpelib::Ray> &_rays,
+  std::vector<tpelib::RayHit> &_hits) const
+{
+  auto it = this->worlds.find(_worldID);
+  if (it == this->worlds.end())
+  {
+    gzerr << "Unable to cast rays in world ["
+      << _worldID.id
+      << "]"
+      << std::endl;
+    _hits.assign(_rays.size(), tpelib::RayHit());
+    return;
+  }
+  it->second->world->CastRays(_rays, _hits);
+}
+
+/////////////////////////////////////////////////
+template class tpeplugin::CustomFeatures<FeaturePolicy3d>;
+template class tpeplugin::CustomFeatures<FeaturePolicy3f>;
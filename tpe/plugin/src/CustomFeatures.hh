@@ -19,6 +19,7 @@
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_CUSTOMFEATURES_HH
 
 #include <memory>
+#include <vector>
 
 #include <gz/physics/Implements.hh>
 
@@ -30,15 +31,21 @@ namespace physics {
 namespace tpeplugin {
 
 using CustomFeatureList = FeatureList<
-  RetrieveWorld
+  RetrieveWorld,
+  CastRaysFeature
 >;
 
+template <typename PolicyT>
 class CustomFeatures :
-  public virtual Base,
-  public virtual Implements3d<CustomFeatureList>
+  public virtual Base<PolicyT>,
+  public virtual Implements<PolicyT, CustomFeatureList>
 {
   public: std::shared_ptr<tpelib::World> GetTpeLibWorld(
     const Identity &_worldID) override;
+
+  public: void CastWorldRays(const Identity &_worldID,
+    const std::vector<tpelib::Ray> &_rays,
+    std::vector<tpelib::RayHit> &_hits) const override;
 };
 
 }
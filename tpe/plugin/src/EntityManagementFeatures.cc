@@ -16,6 +16,7 @@
 */
 
 #include <string>
+#include <type_traits>
 
 #include "EntityManagementFeatures.hh"
 
@@ -24,7 +25,8 @@ using namespace physics;
 using namespace tpeplugin;
 
 /////////////////////////////////////////////////
-const std::string &EntityManagementFeatures::GetEngineName(
+template <typename PolicyT>
+const std::string &EntityManagementFeatures<PolicyT>::GetEngineName(
   const Identity &) const
 {
   // engine name should not change
@@ -33,14 +35,16 @@ const std::string &EntityManagementFeatures::GetEngineName(
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetEngineIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetEngineIndex(
   const Identity &) const
 {
   return 0;
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetWorldCount(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetWorldCount(
   const Identity &) const
 {
   // should always be 1
@@ -48,7 +52,8 @@ std::size_t EntityManagementFeatures::GetWorldCount(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetWorld(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetWorld(
   const Identity &, std::size_t _worldIndex) const
 {
   auto it = this->worlds.begin();
@@ -61,7 +66,8 @@ Identity EntityManagementFeatures::GetWorld(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetWorld(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetWorld(
   const Identity &, const std::string &_worldName) const
 {
   for (auto it = this->worlds.begin(); it != this->worlds.end(); ++it)
@@ -78,14 +84,17 @@ Identity EntityManagementFeatures::GetWorld(
 }
 
 /////////////////////////////////////////////////
-const std::string &EntityManagementFeatures::GetWorldName(
+template <typename PolicyT>
+const std::string &EntityManagementFeatures<PolicyT>::GetWorldName(
   const Identity &_worldID) const
 {
-  return this->ReferenceInterface<WorldInfo>(_worldID)->world->GetNameRef();
+  return this->template ReferenceInterface<WorldInfo>(
+      _worldID)->world->GetNameRef();
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetWorldIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetWorldIndex(
   const Identity &_worldID) const
 {
   // index should be 0 assuming there's only one world
@@ -93,21 +102,25 @@ std::size_t EntityManagementFeatures::GetWorldIndex(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetEngineOfWorld(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetEngineOfWorld(
   const Identity &) const
 {
   return this->GenerateIdentity(0);
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetModelCount(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetModelCount(
   const Identity &_worldID) const
 {
-  return this->ReferenceInterface<WorldInfo>(_worldID)->world->GetChildCount();
+  return this->template ReferenceInterface<WorldInfo>(
+      _worldID)->world->GetChildCount();
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetModel(
   const Identity &_worldID, const std::size_t _modelIndex) const
 {
   const auto &[modelId, modelInfo] =
@@ -120,10 +133,11 @@ Identity EntityManagementFeatures::GetModel(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetModel(
   const Identity &_worldID, const std::string &_modelName) const
 {
-  auto worldInfo = this->ReferenceInterface<WorldInfo>(_worldID);
+  auto worldInfo = this->template ReferenceInterface<WorldInfo>(_worldID);
   if (worldInfo != nullptr)
   {
     tpelib::Entity &modelEnt = worldInfo->world->GetChildByName(_modelName);
@@ -143,21 +157,25 @@ Identity EntityManagementFeatures::GetModel(
 }
 
 /////////////////////////////////////////////////
-const std::string &EntityManagementFeatures::GetModelName(
+template <typename PolicyT>
+const std::string &EntityManagementFeatures<PolicyT>::GetModelName(
   const Identity &_modelID) const
 {
-  return this->ReferenceInterface<ModelInfo>(_modelID)->model->GetNameRef();
+  return this->template ReferenceInterface<ModelInfo>(
+      _modelID)->model->GetNameRef();
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetModelIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetModelIndex(
   const Identity &_modelID) const
 {
   return this->idToIndexInContainer(_modelID.id);
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetWorldOfModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetWorldOfModel(
   const Identity &_modelID) const
 {
   auto it = this->childIdToParentId.find(_modelID.id);
@@ -173,14 +191,17 @@ Identity EntityManagementFeatures::GetWorldOfModel(
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetNestedModelCount(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetNestedModelCount(
   const Identity &_modelID) const
 {
-  return this->ReferenceInterface<ModelInfo>(_modelID)->model->GetModelCount();
+  return this->template ReferenceInterface<ModelInfo>(
+      _modelID)->model->GetModelCount();
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetNestedModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetNestedModel(
   const Identity &_modelID, const std::size_t _modelIndex) const
 {
   const auto &[nestedModelId, nestedModelInfo] =
@@ -193,10 +214,11 @@ Identity EntityManagementFeatures::GetNestedModel(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetNestedModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetNestedModel(
   const Identity &_modelID, const std::string &_modelName) const
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     tpelib::Entity &modelEnt = modelInfo->model->GetChildByName(_modelName);
@@ -210,14 +232,17 @@ Identity EntityManagementFeatures::GetNestedModel(
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetLinkCount(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetLinkCount(
   const Identity &_modelID) const
 {
-  return this->ReferenceInterface<ModelInfo>(_modelID)->model->GetLinkCount();
+  return this->template ReferenceInterface<ModelInfo>(
+      _modelID)->model->GetLinkCount();
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetLink(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetLink(
   const Identity &_modelID, const std::size_t _linkIndex) const
 {
   const auto &[linkId, linkInfo] =
@@ -230,10 +255,11 @@ Identity EntityManagementFeatures::GetLink(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetLink(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetLink(
   const Identity &_modelID, const std::string &_linkName) const
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     tpelib::Entity &linkEnt = modelInfo->model->GetChildByName(_linkName);
@@ -253,21 +279,25 @@ Identity EntityManagementFeatures::GetLink(
 }
 
 /////////////////////////////////////////////////
-const std::string &EntityManagementFeatures::GetLinkName(
+template <typename PolicyT>
+const std::string &EntityManagementFeatures<PolicyT>::GetLinkName(
   const Identity &_linkID) const
 {
-  return this->ReferenceInterface<LinkInfo>(_linkID)->link->GetNameRef();
+  return this->template ReferenceInterface<LinkInfo>(
+      _linkID)->link->GetNameRef();
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetLinkIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetLinkIndex(
   const Identity &_linkID) const
 {
   return this->idToIndexInContainer(_linkID.id);
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetModelOfLink(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetModelOfLink(
   const Identity &_linkID) const
 {
   auto it = this->childIdToParentId.find(_linkID.id);
@@ -283,14 +313,17 @@ Identity EntityManagementFeatures::GetModelOfLink(
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetShapeCount(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetShapeCount(
   const Identity &_linkID) const
 {
-  return this->ReferenceInterface<LinkInfo>(_linkID)->link->GetChildCount();
+  return this->template ReferenceInterface<LinkInfo>(
+      _linkID)->link->GetChildCount();
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetShape(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetShape(
   const Identity &_linkID, const std::size_t _shapeIndex) const
 {
   const auto &[shapeId, shapeInfo] =
@@ -303,10 +336,11 @@ Identity EntityManagementFeatures::GetShape(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetShape(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetShape(
   const Identity &_linkID, const std::string &_shapeName) const
 {
-  auto linkInfo = this->ReferenceInterface<LinkInfo>(_linkID);
+  auto linkInfo = this->template ReferenceInterface<LinkInfo>(_linkID);
   if (linkInfo != nullptr)
   {
     tpelib::Entity &shapeEnt = linkInfo->link->GetChildByName(_shapeName);
@@ -328,22 +362,25 @@ Identity EntityManagementFeatures::GetShape(
 }
 
 /////////////////////////////////////////////////
-const std::string &EntityManagementFeatures::GetShapeName(
+template <typename PolicyT>
+const std::string &EntityManagementFeatures<PolicyT>::GetShapeName(
   const Identity &_shapeID) const
 {
-  return this->ReferenceInterface<CollisionInfo>(
+  return this->template ReferenceInterface<CollisionInfo>(
       _shapeID)->collision->GetNameRef();
 }
 
 /////////////////////////////////////////////////
-std::size_t EntityManagementFeatures::GetShapeIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::GetShapeIndex(
   const Identity &_shapeID) const
 {
   return this->idToIndexInContainer(_shapeID.id);
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::GetLinkOfShape(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::GetLinkOfShape(
   const Identity &_shapeID) const
 {
   auto it = this->childIdToParentId.find(_shapeID.id);
@@ -359,10 +396,11 @@ Identity EntityManagementFeatures::GetLinkOfShape(
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::RemoveModelByIndex(
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::RemoveModelByIndex(
   const Identity &_worldID, std::size_t _modelIndex)
 {
-  auto worldInfo = this->ReferenceInterface<WorldInfo>(_worldID);
+  auto worldInfo = this->template ReferenceInterface<WorldInfo>(_worldID);
   if (worldInfo != nullptr)
   {
     const auto [modelId, modelInfo] =
@@ -376,10 +414,11 @@ bool EntityManagementFeatures::RemoveModelByIndex(
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::RemoveModelByName(
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::RemoveModelByName(
   const Identity &_worldID, const std::string &_modelName)
 {
-  auto worldInfo = this->ReferenceInterface<WorldInfo>(_worldID);
+  auto worldInfo = this->template ReferenceInterface<WorldInfo>(_worldID);
   if (worldInfo != nullptr)
   {
     std::size_t modelId =
@@ -390,13 +429,16 @@ bool EntityManagementFeatures::RemoveModelByName(
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::RemoveModel(const Identity &_modelID)
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::RemoveModel(const Identity &_modelID)
 {
   return this->RemoveModelImpl(_modelID.id);
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::ModelRemoved(const Identity &_modelID) const
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::ModelRemoved(
+    const Identity &_modelID) const
 {
   if (this->models.find(_modelID.id) == this->models.end()
     && this->childIdToParentId.find(_modelID.id) ==
@@ -406,10 +448,35 @@ bool EntityManagementFeatures::ModelRemoved(const Identity &_modelID) const
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::RemoveNestedModelByIndex(
+template <typename PolicyT>
+std::size_t EntityManagementFeatures<PolicyT>::RemoveModels(
+  const Identity &_worldID, const std::vector<std::size_t> &_modelIDs)
+{
+  auto worldInfo = this->template ReferenceInterface<WorldInfo>(_worldID);
+  if (worldInfo == nullptr)
+    return 0u;
+
+  // only the models of this world are removed
+  std::vector<std::size_t> modelIDs;
+  modelIDs.reserve(_modelIDs.size());
+  for (std::size_t modelId : _modelIDs)
+  {
+    auto parentIt = this->childIdToParentId.find(modelId);
+    if (parentIt != this->childIdToParentId.end() &&
+        parentIt->second == _worldID.id)
+    {
+      modelIDs.push_back(modelId);
+    }
+  }
+  return this->RemoveModelsImpl(modelIDs);
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::RemoveNestedModelByIndex(
   const Identity &_modelID, std::size_t _modelIndex)
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     const auto &[nestedModelId, nestedModelInfo] =
@@ -423,10 +490,11 @@ bool EntityManagementFeatures::RemoveNestedModelByIndex(
 }
 
 /////////////////////////////////////////////////
-bool EntityManagementFeatures::RemoveNestedModelByName(
+template <typename PolicyT>
+bool EntityManagementFeatures<PolicyT>::RemoveNestedModelByName(
   const Identity &_modelID, const std::string &_modelName)
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     std::size_t nestedModelId =
@@ -437,19 +505,25 @@ bool EntityManagementFeatures::RemoveNestedModelByName(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::ConstructEmptyWorld(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::ConstructEmptyWorld(
   const Identity &, const std::string &_name)
 {
   auto world = std::make_shared<tpelib::World>();
   world->SetName(_name);
+  // Single precision plugins default to the tree that stores float bounds,
+  // which reduces the memory of the broadphase nodes.
+  if constexpr (std::is_same_v<typename PolicyT::Scalar, float>)
+    world->SetBroadphaseType(tpelib::BroadphaseType::AABB_TREE_FLOAT);
   return this->AddWorld(world);
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::ConstructEmptyModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::ConstructEmptyModel(
   const Identity &_worldID, const std::string &_name)
 {
-  auto worldInfo = this->ReferenceInterface<WorldInfo>(_worldID);
+  auto worldInfo = this->template ReferenceInterface<WorldInfo>(_worldID);
   if (worldInfo != nullptr)
   {
     auto &modelEnt = worldInfo->world->AddModel();
@@ -461,10 +535,11 @@ Identity EntityManagementFeatures::ConstructEmptyModel(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::ConstructEmptyNestedModel(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::ConstructEmptyNestedModel(
   const Identity &_modelID, const std::string &_name)
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     auto &modelEnt = modelInfo->model->AddModel();
@@ -476,10 +551,11 @@ Identity EntityManagementFeatures::ConstructEmptyNestedModel(
 }
 
 /////////////////////////////////////////////////
-Identity EntityManagementFeatures::ConstructEmptyLink(
+template <typename PolicyT>
+Identity EntityManagementFeatures<PolicyT>::ConstructEmptyLink(
   const Identity &_modelID, const std::string &_name)
 {
-  auto modelInfo = this->ReferenceInterface<ModelInfo>(_modelID);
+  auto modelInfo = this->template ReferenceInterface<ModelInfo>(_modelID);
   if (modelInfo != nullptr)
   {
     auto &linkEnt = modelInfo->model->AddLink();
@@ -491,29 +567,36 @@ Identity EntityManagementFeatures::ConstructEmptyLink(
 }
 
 /////////////////////////////////////////////////
-void EntityManagementFeatures::SetCollisionFilterMask(
+template <typename PolicyT>
+void EntityManagementFeatures<PolicyT>::SetCollisionFilterMask(
     const Identity &_shapeID, const uint16_t _mask)
 {
   auto collision =
-      this->ReferenceInterface<CollisionInfo>(_shapeID)->collision;
+      this->template ReferenceInterface<CollisionInfo>(_shapeID)->collision;
   collision->SetCollideBitmask(_mask);
 }
 
 /////////////////////////////////////////////////
-uint16_t EntityManagementFeatures::GetCollisionFilterMask(
+template <typename PolicyT>
+uint16_t EntityManagementFeatures<PolicyT>::GetCollisionFilterMask(
     const Identity &_shapeID) const
 {
   const auto collision =
-      this->ReferenceInterface<CollisionInfo>(_shapeID)->collision;
+      this->template ReferenceInterface<CollisionInfo>(_shapeID)->collision;
   return collision->GetCollideBitmask();
 }
 
 /////////////////////////////////////////////////
-void EntityManagementFeatures::RemoveCollisionFilterMask(
+template <typename PolicyT>
+void EntityManagementFeatures<PolicyT>::RemoveCollisionFilterMask(
     const Identity &_shapeID)
 {
   auto collision =
-      this->ReferenceInterface<CollisionInfo>(_shapeID)->collision;
+      this->template ReferenceInterface<CollisionInfo>(_shapeID)->collision;
   // remove = reset to default bitmask
   collision->SetCollideBitmask(0xFF);
 }
+
+/////////////////////////////////////////////////
+template class tpeplugin::EntityManagementFeatures<FeaturePolicy3d>;
+template class tpeplugin::EntityManagementFeatures<FeaturePolicy3f>;
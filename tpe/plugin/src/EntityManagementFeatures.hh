@@ -19,6 +19,7 @@
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_GETENTITIESFEATURE_HH_
 
 #include <string>
+#include <vector>
 
 #include <gz/physics/ConstructEmpty.hh>
 #include <gz/physics/Shape.hh>
@@ -27,6 +28,7 @@
 #include <gz/physics/Implements.hh>
 
 #include "Base.hh"
+#include "BatchModels.hh"
 
 namespace gz {
 namespace physics {
@@ -40,6 +42,7 @@ struct EntityManagementFeatureList : FeatureList<
   GetLinkFromModel,
   GetShapeFromLink,
   RemoveEntities,
+  RemoveModelsFromWorld,
   ConstructEmptyWorldFeature,
   ConstructEmptyModelFeature,
   ConstructEmptyNestedModelFeature,
@@ -47,9 +50,10 @@ struct EntityManagementFeatureList : FeatureList<
   CollisionFilterMaskFeature
 > { };
 
+template <typename PolicyT>
 class EntityManagementFeatures :
-  public virtual Base,
-  public virtual Implements3d<EntityManagementFeatureList>
+  public virtual Base<PolicyT>,
+  public virtual Implements<PolicyT, EntityManagementFeatureList>
 {
   // ----- Get entities -----
   public: const std::string &GetEngineName(const Identity &) const override;
@@ -139,6 +143,10 @@ class EntityManagementFeatures :
 
   public: bool ModelRemoved(const Identity &_modelID) const override;
 
+  public: std::size_t RemoveModels(
+    const Identity &_worldID,
+    const std::vector<std::size_t> &_modelIDs) override;
+
   public: bool RemoveNestedModelByIndex(
      const Identity &_modelId, std::size_t _modelIndex) override;
 
@@ -30,7 +30,8 @@ using namespace physics;
 using namespace tpeplugin;
 
 /////////////////////////////////////////////////
-Identity FreeGroupFeatures::FindFreeGroupForModel(
+template <typename PolicyT>
+Identity FreeGroupFeatures<PolicyT>::FindFreeGroupForModel(
   const Identity &_modelID) const
 {
   auto it = this->models.find(_modelID.id);
@@ -44,7 +45,8 @@ Identity FreeGroupFeatures::FindFreeGroupForModel(
 }
 
 /////////////////////////////////////////////////
-Identity FreeGroupFeatures::FindFreeGroupForLink(
+template <typename PolicyT>
+Identity FreeGroupFeatures<PolicyT>::FindFreeGroupForLink(
   const Identity &_linkID) const
 {
   auto it = this->links.find(_linkID.id);
@@ -87,7 +89,9 @@ static tpelib::Link *FindModelRootLink(tpelib::Model *_model)
 }
 
 /////////////////////////////////////////////////
-Identity FreeGroupFeatures::GetFreeGroupRootLink(const Identity &_groupID) const
+template <typename PolicyT>
+Identity FreeGroupFeatures<PolicyT>::GetFreeGroupRootLink(
+    const Identity &_groupID) const
 {
   // assume no canonical link for now
   // assume groupID ~= modelID
@@ -113,7 +117,8 @@ Identity FreeGroupFeatures::GetFreeGroupRootLink(const Identity &_groupID) const
 }
 
 /////////////////////////////////////////////////
-void FreeGroupFeatures::SetFreeGroupWorldPose(
+template <typename PolicyT>
+void FreeGroupFeatures<PolicyT>::SetFreeGroupWorldPose(
   const Identity &_groupID,
   const PoseType &_pose)
 {
@@ -146,7 +151,7 @@ void FreeGroupFeatures::SetFreeGroupWorldPose(
     return;
   }
 
-  math::Pose3d targetWorldPose = math::eigen3::convert(_pose);
+  math::Pose3d targetWorldPose = ToTpe(_pose);
   math::Pose3d linkWorldPose = link->GetWorldPose();
   math::Pose3d tfChange = targetWorldPose * linkWorldPose.Inverse();
 
@@ -177,7 +182,8 @@ void FreeGroupFeatures::SetFreeGroupWorldPose(
 }
 
 /////////////////////////////////////////////////
-void FreeGroupFeatures::SetFreeGroupWorldLinearVelocity(
+template <typename PolicyT>
+void FreeGroupFeatures<PolicyT>::SetFreeGroupWorldLinearVelocity(
   const Identity &_groupID,
   const LinearVelocity &_linearVelocity)
 {
@@ -186,7 +192,7 @@ void FreeGroupFeatures::SetFreeGroupWorldLinearVelocity(
   if (it != this->models.end() && it->second != nullptr)
   {
     it->second->model->SetLinearVelocity(
-      math::eigen3::convert(_linearVelocity));
+      ToTpe(_linearVelocity));
   }
   else
   {
@@ -196,13 +202,14 @@ void FreeGroupFeatures::SetFreeGroupWorldLinearVelocity(
       math::Pose3d linkWorldPose = linkIt->second->link->GetWorldPose();
       linkIt->second->link->SetLinearVelocity(
         linkWorldPose.Rot().Inverse() *
-        math::eigen3::convert( _linearVelocity));
+        ToTpe(_linearVelocity));
     }
   }
 }
 
 /////////////////////////////////////////////////
-void FreeGroupFeatures::SetFreeGroupWorldAngularVelocity(
+template <typename PolicyT>
+void FreeGroupFeatures<PolicyT>::SetFreeGroupWorldAngularVelocity(
   const Identity &_groupID, const AngularVelocity &_angularVelocity)
 {
   auto it = this->models.find(_groupID.id);
@@ -210,7 +217,7 @@ void FreeGroupFeatures::SetFreeGroupWorldAngularVelocity(
   if (it != this->models.end() && it->second != nullptr)
   {
     it->second->model->SetAngularVelocity(
-      math::eigen3::convert(_angularVelocity));
+      ToTpe(_angularVelocity));
   }
   else
   {
@@ -220,7 +227,11 @@ void FreeGroupFeatures::SetFreeGroupWorldAngularVelocity(
       math::Pose3d linkWorldPose = linkIt->second->link->GetWorldPose();
       linkIt->second->link->SetAngularVelocity(
         linkWorldPose.Rot().Inverse() *
-        math::eigen3::convert(_angularVelocity));
+        ToTpe(_angularVelocity));
     }
   }
 }
+
+/////////////////////////////////////////////////
+template class tpeplugin::FreeGroupFeatures<FeaturePolicy3d>;
+template class tpeplugin::FreeGroupFeatures<FeaturePolicy3f>;
@@ -32,10 +32,20 @@ struct FreeGroupFeatureList : FeatureList<
   SetFreeGroupWorldVelocity
 > { };
 
+template <typename PolicyT>
 class FreeGroupFeatures :
-  public virtual Base,
-  public virtual Implements3d<FreeGroupFeatureList>
+  public virtual Base<PolicyT>,
+  public virtual Implements<PolicyT, FreeGroupFeatureList>
 {
+  public: using PoseType =
+      typename FromPolicy<PolicyT>::template Use<Pose>;
+
+  public: using LinearVelocity =
+      typename FromPolicy<PolicyT>::template Use<LinearVector>;
+
+  public: using AngularVelocity =
+      typename FromPolicy<PolicyT>::template Use<AngularVector>;
+
   // FindFreeGroupFeature
   Identity FindFreeGroupForModel(const Identity &_modelID) const override;
 
@@ -25,10 +25,11 @@ using namespace physics;
 using namespace tpeplugin;
 
 /////////////////////////////////////////////////
-FrameData3d KinematicsFeatures::FrameDataRelativeToWorld(
-  const FrameID &_id) const
+template <typename PolicyT>
+auto KinematicsFeatures<PolicyT>::FrameDataRelativeToWorld(
+  const FrameID &_id) const -> FrameData
 {
-  FrameData3d data;
+  FrameData data;
 
   // The feature system should never send us the world ID.
   if (_id.IsWorld())
@@ -44,9 +45,12 @@ FrameData3d KinematicsFeatures::FrameDataRelativeToWorld(
   if (modelIt != this->models.end())
   {
     auto model = modelIt->second->model;
-    data.pose = math::eigen3::convert(model->GetWorldPose());
-    data.linearVelocity = math::eigen3::convert(model->GetLinearVelocity());
-    data.angularVelocity = math::eigen3::convert(model->GetAngularVelocity());
+    data.pose = math::eigen3::convert(model->GetWorldPose())
+        .template cast<Scalar>();
+    data.linearVelocity = math::eigen3::convert(model->GetLinearVelocity())
+        .template cast<Scalar>();
+    data.angularVelocity = math::eigen3::convert(model->GetAngularVelocity())
+        .template cast<Scalar>();
   }
   else
   {
@@ -55,14 +59,17 @@ FrameData3d KinematicsFeatures::FrameDataRelativeToWorld(
     if (linkIt != this->links.end())
     {
       auto link = linkIt->second->link;
-      data.pose = math::eigen3::convert(link->GetWorldPose());
+      data.pose = math::eigen3::convert(link->GetWorldPose())
+          .template cast<Scalar>();
       auto modelId = link->GetParent()->GetId();
       auto modelPtr = this->models.find(modelId)->second->model;
       math::Pose3d parentWorldPose = modelPtr->GetWorldPose();
-      data.linearVelocity = math::eigen3::convert(parentWorldPose.Rot().Inverse() *
-          link->GetLinearVelocity() + modelPtr->GetLinearVelocity());
-      data.angularVelocity = math::eigen3::convert(parentWorldPose.Rot().Inverse() *
-          link->GetAngularVelocity() + modelPtr->GetAngularVelocity());
+      data.linearVelocity = math::eigen3::convert(
+          parentWorldPose.Rot().Inverse() * link->GetLinearVelocity() +
+          modelPtr->GetLinearVelocity()).template cast<Scalar>();
+      data.angularVelocity = math::eigen3::convert(
+          parentWorldPose.Rot().Inverse() * link->GetAngularVelocity() +
+          modelPtr->GetAngularVelocity()).template cast<Scalar>();
     }
     else
     {
@@ -71,7 +78,8 @@ FrameData3d KinematicsFeatures::FrameDataRelativeToWorld(
       if (colIt != this->collisions.end())
       {
         auto collision = colIt->second->collision;
-        data.pose = math::eigen3::convert(collision->GetWorldPose());
+        data.pose = math::eigen3::convert(collision->GetWorldPose())
+            .template cast<Scalar>();
       }
       else
       {
@@ -82,3 +90,7 @@ FrameData3d KinematicsFeatures::FrameDataRelativeToWorld(
   }
   return data;
 }
+
+/////////////////////////////////////////////////
+template class tpeplugin::KinematicsFeatures<FeaturePolicy3d>;
+template class tpeplugin::KinematicsFeatures<FeaturePolicy3f>;
@@ -30,11 +30,17 @@ struct KinematicsFeatureList : FeatureList<
   LinkFrameSemantics
 > { };
 
+template <typename PolicyT>
 class KinematicsFeatures :
-  public virtual Base,
-  public virtual Implements3d<KinematicsFeatureList>
+  public virtual Base<PolicyT>,
+  public virtual Implements<PolicyT, KinematicsFeatureList>
 {
-  public: FrameData3d FrameDataRelativeToWorld(
+  public: using Scalar = typename PolicyT::Scalar;
+
+  public: using FrameData =
+      typename FromPolicy<PolicyT>::template Use<gz::physics::FrameData>;
+
+  public: FrameData FrameDataRelativeToWorld(
     const FrameID &_id) const override;
 };
 
@@ -58,31 +58,28 @@ static math::Pose3d ResolveSdfPose(const ::sdf::SemanticPose &_semPose)
 }  // namespace
 
 /////////////////////////////////////////////////
-Identity SDFFeatures::ConstructSdfWorld(
+template <typename PolicyT>
+Identity SDFFeatures<PolicyT>::ConstructSdfWorld(
     const Identity &_engine,
     const ::sdf::World &_sdfWorld)
 {
   const Identity worldID = this->ConstructEmptyWorld(_engine, _sdfWorld.Name());
 
   // construct models
+  std::vector<const ::sdf::Model *> models;
+  models.reserve(_sdfWorld.ModelCount());
   for (std::size_t i = 0; i < _sdfWorld.ModelCount(); ++i)
   {
-    const ::sdf::Model *model = _sdfWorld.ModelByIndex(i);
-    if (model && model->ModelCount() == 0u)
-    {
-      this->ConstructSdfModel(worldID, *model);
-    }
-    else
-    {
-      this->ConstructSdfNestedModel(worldID, *model);
-    }
+    models.push_back(_sdfWorld.ModelByIndex(i));
   }
+  this->ConstructSdfModels(worldID, models);
 
   return worldID;
 }
 
 /////////////////////////////////////////////////
-Identity SDFFeatures::ConstructSdfModel(
+template <typename PolicyT>
+Identity SDFFeatures<PolicyT>::ConstructSdfModel(
   const Identity &_worldID,
   const ::sdf::Model &_sdfModel)
 {
@@ -135,7 +132,60 @@ Identity SDFFeatures::ConstructSdfModel(
 }
 
 /////////////////////////////////////////////////
-Identity SDFFeatures::ConstructSdfNestedModel(
+template <typename PolicyT>
+std::vector<Identity> SDFFeatures<PolicyT>::ConstructSdfModels(
+  const Identity &_worldID,
+  const std::vector<const ::sdf::Model *> &_sdfModels)
+{
+  std::vector<Identity> modelIDs;
+  modelIDs.reserve(_sdfModels.size());
+
+  auto it = this->worlds.find(_worldID.id);
+  if (it == this->worlds.end() || it->second->world == nullptr)
+  {
+    gzwarn << "World [" << _worldID.id << "] is not found." << std::endl;
+    for (std::size_t i = 0; i < _sdfModels.size(); ++i)
+      modelIDs.push_back(this->GenerateInvalidId());
+    return modelIDs;
+  }
+
+  // reserve storage for all the models and their links at once
+  std::size_t modelCount = 0u;
+  std::size_t linkCount = 0u;
+  for (const ::sdf::Model *sdfModel : _sdfModels)
+  {
+    if (sdfModel == nullptr)
+      continue;
+    ++modelCount;
+    linkCount += sdfModel->LinkCount();
+  }
+  it->second->world->ReserveModels(modelCount, linkCount);
+  this->ReserveModels(_worldID.id, modelCount);
+
+  // the models are constructed in order so that their indices in the world
+  // follow the order of _sdfModels
+  for (const ::sdf::Model *sdfModel : _sdfModels)
+  {
+    if (sdfModel == nullptr)
+    {
+      modelIDs.push_back(this->GenerateInvalidId());
+    }
+    else if (sdfModel->ModelCount() == 0u)
+    {
+      modelIDs.push_back(this->ConstructSdfModel(_worldID, *sdfModel));
+    }
+    else
+    {
+      modelIDs.push_back(this->ConstructSdfNestedModel(_worldID, *sdfModel));
+    }
+  }
+
+  return modelIDs;
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+Identity SDFFeatures<PolicyT>::ConstructSdfNestedModel(
   const Identity &_parentID,
   const ::sdf::Model &_sdfModel)
 {
@@ -215,7 +265,8 @@ Identity SDFFeatures::ConstructSdfNestedModel(
 }
 
 /////////////////////////////////////////////////
-Identity SDFFeatures::ConstructSdfLink(
+template <typename PolicyT>
+Identity SDFFeatures<PolicyT>::ConstructSdfLink(
     const Identity &_modelID,
     const ::sdf::Link &_sdfLink)
 {
@@ -251,7 +302,8 @@ Identity SDFFeatures::ConstructSdfLink(
 }
 
 /////////////////////////////////////////////////
-Identity SDFFeatures::ConstructSdfCollision(
+template <typename PolicyT>
+Identity SDFFeatures<PolicyT>::ConstructSdfCollision(
     const Identity &_linkID,
     const ::sdf::Collision &_sdfCollision)
 {
@@ -348,6 +400,10 @@ Identity SDFFeatures::ConstructSdfCollision(
   return collisionIdentity;
 }
 
+/////////////////////////////////////////////////
+template class SDFFeatures<FeaturePolicy3d>;
+template class SDFFeatures<FeaturePolicy3f>;
+
 }
 }
 }
@@ -18,6 +18,8 @@
 #ifndef GZ_PHYSICS_TPE_PLUGIN_SRC_SDFFEATURES_HH_
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_SDFFEATURES_HH_
 
+#include <vector>
+
 #include <gz/physics/sdf/ConstructCollision.hh>
 #include <gz/physics/sdf/ConstructLink.hh>
 #include <gz/physics/sdf/ConstructModel.hh>
@@ -26,6 +28,7 @@
 
 #include <gz/physics/Implements.hh>
 
+#include "BatchModels.hh"
 #include "EntityManagementFeatures.hh"
 
 namespace gz {
@@ -35,14 +38,16 @@ namespace tpeplugin {
 using SDFFeatureList = FeatureList<
   sdf::ConstructSdfWorld,
   sdf::ConstructSdfModel,
+  ConstructSdfModels,
   sdf::ConstructSdfNestedModel,
   sdf::ConstructSdfLink,
   sdf::ConstructSdfCollision
 >;
 
+template <typename PolicyT>
 class SDFFeatures :
-    public virtual EntityManagementFeatures,
-    public virtual Implements3d<SDFFeatureList>
+    public virtual EntityManagementFeatures<PolicyT>,
+    public virtual Implements<PolicyT, SDFFeatureList>
 {
   public: Identity ConstructSdfWorld(
     const Identity &_engine,
@@ -52,6 +57,10 @@ class SDFFeatures :
     const Identity &_worldID,
     const ::sdf::Model &_sdfModel) override;
 
+  public: std::vector<Identity> ConstructSdfModels(
+    const Identity &_worldID,
+    const std::vector<const ::sdf::Model *> &_sdfModels) override;
+
   public: Identity ConstructSdfNestedModel(
     const Identity &_modelID,
     const ::sdf::Model &_sdfModel) override;
@@ -17,7 +17,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include <sdf/Root.hh>
 #include <sdf/World.hh>
@@ -39,10 +41,13 @@
 #include "lib/src/Entity.hh"
 #include "lib/src/Model.hh"
 #include "lib/src/World.hh"
+#include "BatchModels.hh"
 #include "World.hh"
 
 struct TestFeatureList : gz::physics::FeatureList<
     gz::physics::tpeplugin::RetrieveWorld,
+    gz::physics::tpeplugin::ConstructSdfModels,
+    gz::physics::tpeplugin::RemoveModelsFromWorld,
     gz::physics::GetModelFromWorld,
     gz::physics::sdf::ConstructSdfLink,
     gz::physics::sdf::ConstructSdfModel,
@@ -449,3 +454,54 @@ TEST(SDFFeatures_TEST, ConstructModel)
   EXPECT_NE(nullptr, nestedModelByModel);
   EXPECT_EQ("nested_model_by_model", nestedModelByModel->GetName());
 }
+
+// Test ConstructModels and RemoveModels functions.
+TEST(SDFFeatures_TEST, BatchModels)
+{
+  auto engine = LoadEngine();
+  ASSERT_NE(nullptr, engine);
+  sdf::World sdfWorld;
+  sdfWorld.SetName("default");
+  auto world = engine->ConstructWorld(sdfWorld);
+  ASSERT_NE(nullptr, world);
+
+  std::vector<sdf::Model> sdfModels(4);
+  std::vector<const sdf::Model *> sdfModelPtrs;
+  for (std::size_t i = 0; i < sdfModels.size(); ++i)
+  {
+    sdfModels[i].SetName("model_" + std::to_string(i));
+    sdfModelPtrs.push_back(&sdfModels[i]);
+  }
+  sdfModelPtrs.push_back(nullptr);
+
+  auto models = world->ConstructModels(sdfModelPtrs);
+  ASSERT_EQ(5u, models.size());
+  EXPECT_EQ(nullptr, models[4]);
+  models.pop_back();
+  EXPECT_EQ(4u, world->GetModelCount());
+  for (std::size_t i = 0; i < models.size(); ++i)
+  {
+    ASSERT_NE(nullptr, models[i]);
+    EXPECT_EQ("model_" + std::to_string(i), models[i]->GetName());
+    EXPECT_EQ(i, models[i]->GetIndex());
+    EXPECT_EQ(models[i], world->GetModel(i));
+  }
+
+  auto tpeWorld = world->GetTpeLibWorld();
+  ASSERT_NE(nullptr, tpeWorld);
+  EXPECT_EQ(4u, tpeWorld->GetChildCount());
+
+  // the remaining models are indexed in order
+  const decltype(models) removed{models[0], models[2]};
+  EXPECT_EQ(2u, world->RemoveModels(removed));
+  EXPECT_EQ(2u, world->GetModelCount());
+  EXPECT_EQ(2u, tpeWorld->GetChildCount());
+  EXPECT_EQ(models[1], world->GetModel(0));
+  EXPECT_EQ(models[3], world->GetModel(1));
+  EXPECT_EQ(nullptr, world->GetModel("model_0"));
+  EXPECT_EQ(1u, models[3]->GetIndex());
+
+  // removing the same models again does nothing
+  EXPECT_EQ(0u, world->RemoveModels(removed));
+  EXPECT_EQ(2u, world->GetModelCount());
+}
@@ -15,7 +15,11 @@
  *
 */
 
+#include <cmath>
+#include <vector>
+
 #include <gz/math/eigen3/Conversions.hh>
+#include <gz/math/Helpers.hh>
 #include <gz/math/Pose3.hh>
 #include <gz/common/Console.hh>
 
@@ -26,7 +30,8 @@ using namespace physics;
 using namespace tpeplugin;
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToBoxShape(const Identity &_shapeID) const
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToBoxShape(const Identity &_shapeID) const
 {
   // dart::_shapeID = tpelib::_collisionID
   auto it = this->collisions.find(_shapeID);
@@ -40,8 +45,9 @@ Identity ShapeFeatures::CastToBoxShape(const Identity &_shapeID) const
 }
 
 /////////////////////////////////////////////////
-LinearVector3d ShapeFeatures::GetBoxShapeSize(
-  const Identity &_boxID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetBoxShapeSize(
+  const Identity &_boxID) const -> Dimensions
 {
   // _boxID ~= _collisionID
   auto it = this->collisions.find(_boxID);
@@ -51,19 +57,20 @@ LinearVector3d ShapeFeatures::GetBoxShapeSize(
     if (shape != nullptr)
     {
       tpelib::BoxShape *box = static_cast<tpelib::BoxShape*>(shape);
-      return math::eigen3::convert(box->GetSize());
+      return math::eigen3::convert(box->GetSize()).template cast<Scalar>();
     }
   }
   // return invalid box shape size if no collision found
-  return math::eigen3::convert(math::Vector3d(-1.0, -1.0, -1.0));
+  return Dimensions(-1.0, -1.0, -1.0);
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachBoxShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachBoxShape(
   const Identity &_linkID,
   const std::string &_name,
-  const LinearVector3d &_size,
-  const Pose3d &_pose)
+  const Dimensions &_size,
+  const PoseType &_pose)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -71,10 +78,10 @@ Identity ShapeFeatures::AttachBoxShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
     tpelib::BoxShape boxshape;
-    boxshape.SetSize(math::eigen3::convert(_size));
+    boxshape.SetSize(ToTpe(_size));
     collision.SetShape(boxshape);
 
     return this->AddCollision(_linkID, collision);
@@ -83,7 +90,9 @@ Identity ShapeFeatures::AttachBoxShape(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToCylinderShape(const Identity &_shapeID) const
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToCylinderShape(
+    const Identity &_shapeID) const
 {
   auto it = this->collisions.find(_shapeID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -96,7 +105,9 @@ Identity ShapeFeatures::CastToCylinderShape(const Identity &_shapeID) const
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToCapsuleShape(const Identity &_shapeID) const
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToCapsuleShape(
+    const Identity &_shapeID) const
 {
   auto it = this->collisions.find(_shapeID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -109,8 +120,9 @@ Identity ShapeFeatures::CastToCapsuleShape(const Identity &_shapeID) const
 }
 
 /////////////////////////////////////////////////
-double ShapeFeatures::GetCapsuleShapeRadius(
-  const Identity &_capsuleID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetCapsuleShapeRadius(
+  const Identity &_capsuleID) const -> Scalar
 {
   // assume _capsuleID ~= _collisionID
   auto it = this->collisions.find(_capsuleID);
@@ -120,7 +132,7 @@ double ShapeFeatures::GetCapsuleShapeRadius(
     if (shape != nullptr)
     {
       auto *capsule = static_cast<tpelib::CapsuleShape*>(shape);
-      return capsule->GetRadius();
+      return static_cast<Scalar>(capsule->GetRadius());
     }
   }
   // return invalid radius if no collision found
@@ -128,8 +140,9 @@ double ShapeFeatures::GetCapsuleShapeRadius(
 }
 
 /////////////////////////////////////////////////
-double ShapeFeatures::GetCapsuleShapeLength(
-  const Identity &_capsuleID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetCapsuleShapeLength(
+  const Identity &_capsuleID) const -> Scalar
 {
   // assume _capsuleID ~= _collisionID
   auto it = this->collisions.find(_capsuleID);
@@ -139,7 +152,7 @@ double ShapeFeatures::GetCapsuleShapeLength(
     if (shape != nullptr)
     {
       auto *capsule = static_cast<tpelib::CapsuleShape*>(shape);
-      return capsule->GetLength();
+      return static_cast<Scalar>(capsule->GetLength());
     }
   }
   // return invalid height if no collision found
@@ -147,12 +160,13 @@ double ShapeFeatures::GetCapsuleShapeLength(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachCapsuleShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachCapsuleShape(
   const Identity &_linkID,
   const std::string &_name,
-  const double _radius,
-  const double _length,
-  const Pose3d &_pose)
+  const Scalar _radius,
+  const Scalar _length,
+  const PoseType &_pose)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -160,7 +174,7 @@ Identity ShapeFeatures::AttachCapsuleShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
     tpelib::CapsuleShape capsuleshape;
     capsuleshape.SetRadius(_radius);
@@ -173,8 +187,9 @@ Identity ShapeFeatures::AttachCapsuleShape(
 }
 
 /////////////////////////////////////////////////
-double ShapeFeatures::GetCylinderShapeRadius(
-  const Identity &_cylinderID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetCylinderShapeRadius(
+  const Identity &_cylinderID) const -> Scalar
 {
   // assume _cylinderID ~= _collisionID
   auto it = this->collisions.find(_cylinderID);
@@ -184,7 +199,7 @@ double ShapeFeatures::GetCylinderShapeRadius(
     if (shape != nullptr)
     {
       auto *cylinder = static_cast<tpelib::CylinderShape*>(shape);
-      return cylinder->GetRadius();
+      return static_cast<Scalar>(cylinder->GetRadius());
     }
   }
   // return invalid radius if no collision found
@@ -192,8 +207,9 @@ double ShapeFeatures::GetCylinderShapeRadius(
 }
 
 /////////////////////////////////////////////////
-double ShapeFeatures::GetCylinderShapeHeight(
-  const Identity &_cylinderID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetCylinderShapeHeight(
+  const Identity &_cylinderID) const -> Scalar
 {
   // assume _cylinderID ~= _collisionID
   auto it = this->collisions.find(_cylinderID);
@@ -203,7 +219,7 @@ double ShapeFeatures::GetCylinderShapeHeight(
     if (shape != nullptr)
     {
       auto *cylinder = static_cast<tpelib::CylinderShape*>(shape);
-      return cylinder->GetLength();
+      return static_cast<Scalar>(cylinder->GetLength());
     }
   }
   // return invalid height if no collision found
@@ -211,12 +227,13 @@ double ShapeFeatures::GetCylinderShapeHeight(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachCylinderShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachCylinderShape(
   const Identity &_linkID,
   const std::string &_name,
-  const double _radius,
-  const double _height,
-  const Pose3d &_pose)
+  const Scalar _radius,
+  const Scalar _height,
+  const PoseType &_pose)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -224,7 +241,7 @@ Identity ShapeFeatures::AttachCylinderShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
     tpelib::CylinderShape cylindershape;
     cylindershape.SetRadius(_radius);
@@ -237,7 +254,9 @@ Identity ShapeFeatures::AttachCylinderShape(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToEllipsoidShape(const Identity &_shapeID) const
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToEllipsoidShape(
+    const Identity &_shapeID) const
 {
   auto it = this->collisions.find(_shapeID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -250,8 +269,9 @@ Identity ShapeFeatures::CastToEllipsoidShape(const Identity &_shapeID) const
 }
 
 /////////////////////////////////////////////////
-Vector3d ShapeFeatures::GetEllipsoidShapeRadii(
-  const Identity &_capsuleID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetEllipsoidShapeRadii(
+  const Identity &_capsuleID) const -> Dimensions
 {
   // assume _capsuleID ~= _collisionID
   auto it = this->collisions.find(_capsuleID);
@@ -261,19 +281,20 @@ Vector3d ShapeFeatures::GetEllipsoidShapeRadii(
     if (shape != nullptr)
     {
       auto *capsule = static_cast<tpelib::EllipsoidShape*>(shape);
-      return math::eigen3::convert(capsule->GetRadii());
+      return math::eigen3::convert(capsule->GetRadii()).template cast<Scalar>();
     }
   }
   // return invalid radius if no collision found
-  return math::eigen3::convert(math::Vector3d(-1.0, -1.0, -1.0));
+  return Dimensions(-1.0, -1.0, -1.0);
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachEllipsoidShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachEllipsoidShape(
   const Identity &_linkID,
   const std::string &_name,
-  Vector3d _radii,
-  const Pose3d &_pose)
+  Dimensions _radii,
+  const PoseType &_pose)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -281,10 +302,10 @@ Identity ShapeFeatures::AttachEllipsoidShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
     tpelib::EllipsoidShape capsuleshape;
-    capsuleshape.SetRadii(math::eigen3::convert(_radii));
+    capsuleshape.SetRadii(ToTpe(_radii));
     collision.SetShape(capsuleshape);
 
     return this->AddCollision(_linkID, collision);
@@ -293,7 +314,8 @@ Identity ShapeFeatures::AttachEllipsoidShape(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToSphereShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToSphereShape(
   const Identity &_shapeID) const
 {
   auto it = this->collisions.find(_shapeID);
@@ -307,7 +329,9 @@ Identity ShapeFeatures::CastToSphereShape(
 }
 
 /////////////////////////////////////////////////
-double ShapeFeatures::GetSphereShapeRadius(const Identity &_sphereID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetSphereShapeRadius(
+    const Identity &_sphereID) const -> Scalar
 {
   auto it = this->collisions.find(_sphereID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -316,7 +340,7 @@ double ShapeFeatures::GetSphereShapeRadius(const Identity &_sphereID) const
     if (shape != nullptr)
     {
       auto *sphere = static_cast<tpelib::SphereShape*>(shape);
-      return sphere->GetRadius();
+      return static_cast<Scalar>(sphere->GetRadius());
     }
   }
   // return invalid radius if collision not found
@@ -324,11 +348,12 @@ double ShapeFeatures::GetSphereShapeRadius(const Identity &_sphereID) const
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachSphereShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachSphereShape(
   const Identity &_linkID,
   const std::string &_name,
-  const double _radius,
-  const Pose3d &_pose)
+  const Scalar _radius,
+  const PoseType &_pose)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -336,7 +361,7 @@ Identity ShapeFeatures::AttachSphereShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
     tpelib::SphereShape sphereshape;
     sphereshape.SetRadius(_radius);
@@ -348,7 +373,8 @@ Identity ShapeFeatures::AttachSphereShape(
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::CastToMeshShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToMeshShape(
   const Identity &_shapeID) const
 {
   auto it = this->collisions.find(_shapeID);
@@ -362,8 +388,9 @@ Identity ShapeFeatures::CastToMeshShape(
 }
 
 /////////////////////////////////////////////////
-LinearVector3d ShapeFeatures::GetMeshShapeSize(
-  const Identity &_meshID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetMeshShapeSize(
+  const Identity &_meshID) const -> Dimensions
 {
   auto it = this->collisions.find(_meshID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -372,16 +399,18 @@ LinearVector3d ShapeFeatures::GetMeshShapeSize(
     if (shape != nullptr)
     {
       auto *mesh = static_cast<tpelib::MeshShape*>(shape);
-      return math::eigen3::convert(mesh->GetBoundingBox().Size());
+      return math::eigen3::convert(
+          mesh->GetBoundingBox().Size()).template cast<Scalar>();
     }
   }
   // return invalid size if collision not found
-  return math::eigen3::convert(math::Vector3d(-1.0, -1.0, -1.0));
+  return Dimensions(-1.0, -1.0, -1.0);
 }
 
 /////////////////////////////////////////////////
-LinearVector3d ShapeFeatures::GetMeshShapeScale(
-  const Identity &_meshID) const
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetMeshShapeScale(
+  const Identity &_meshID) const -> Dimensions
 {
   auto it = this->collisions.find(_meshID);
   if (it != this->collisions.end() && it->second != nullptr)
@@ -390,20 +419,21 @@ LinearVector3d ShapeFeatures::GetMeshShapeScale(
     if (shape != nullptr)
     {
       auto *mesh = static_cast<tpelib::MeshShape*>(shape);
-      return math::eigen3::convert(mesh->GetScale());
+      return math::eigen3::convert(mesh->GetScale()).template cast<Scalar>();
     }
   }
   // return invalid scale if collision not found
-  return math::eigen3::convert(math::Vector3d(-1.0, -1.0, -1.0));
+  return Dimensions(-1.0, -1.0, -1.0);
 }
 
 /////////////////////////////////////////////////
-Identity ShapeFeatures::AttachMeshShape(
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachMeshShape(
   const Identity &_linkID,
   const std::string &_name,
   const gz::common::Mesh &_mesh,
-  const Pose3d &_pose,
-  const LinearVector3d &_scale)
+  const PoseType &_pose,
+  const Dimensions &_scale)
 {
   auto it = this->links.find(_linkID);
   if (it != this->links.end() && it->second != nullptr)
@@ -411,11 +441,12 @@ Identity ShapeFeatures::AttachMeshShape(
     auto &collision = static_cast<tpelib::Collision&>(
       it->second->link->AddCollision());
     collision.SetName(_name);
-    collision.SetPose(math::eigen3::convert(_pose));
+    collision.SetPose(ToTpe(_pose));
 
+    // the scale is set first so that the hull is only looked up once
     tpelib::MeshShape mesh;
+    mesh.SetScale(ToTpe(_scale));
     mesh.SetMesh(_mesh);
-    mesh.SetScale(math::eigen3::convert(_scale));
     collision.SetShape(mesh);
 
     return this->AddCollision(_linkID, collision);
@@ -423,17 +454,112 @@ Identity ShapeFeatures::AttachMeshShape(
   return this->GenerateInvalidId();
 }
 
-///////////////////////////////////////////////
-AlignedBox3d ShapeFeatures::GetShapeAxisAlignedBoundingBox(
+/////////////////////////////////////////////////
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::CastToHeightmapShape(
   const Identity &_shapeID) const
+{
+  auto it = this->collisions.find(_shapeID);
+  if (it != this->collisions.end() && it->second != nullptr)
+  {
+    auto *shape = it->second->collision->GetShape();
+    if (shape != nullptr && dynamic_cast<tpelib::HeightmapShape*>(shape))
+      return this->GenerateIdentity(_shapeID, it->second);
+  }
+  return this->GenerateInvalidId();
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetHeightmapShapeSize(
+  const Identity &_heightmapID) const -> Dimensions
+{
+  auto it = this->collisions.find(_heightmapID);
+  if (it != this->collisions.end() && it->second != nullptr)
+  {
+    auto *shape = it->second->collision->GetShape();
+    if (shape != nullptr)
+    {
+      auto *heightmap = static_cast<tpelib::HeightmapShape*>(shape);
+      return math::eigen3::convert(
+          heightmap->GetSize()).template cast<Scalar>();
+    }
+  }
+  // return invalid size if collision not found
+  return Dimensions(-1.0, -1.0, -1.0);
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+Identity ShapeFeatures<PolicyT>::AttachHeightmapShape(
+  const Identity &_linkID,
+  const std::string &_name,
+  const common::HeightmapData &_heightmapData,
+  const PoseType &_pose,
+  const Dimensions &_size,
+  int _subSampling)
+{
+  auto it = this->links.find(_linkID);
+  if (it == this->links.end() || it->second == nullptr)
+    return this->GenerateInvalidId();
+
+  // sample the heights the same way as the other engines
+  const int vertSize = (_heightmapData.Width() * _subSampling) -
+      _subSampling + 1;
+  if (vertSize < 2)
+  {
+    gzerr << "Heightmap [" << _name << "] has too few vertices."
+          << std::endl;
+    return this->GenerateInvalidId();
+  }
+  math::Vector3d size = ToTpe(_size);
+  float heightmapSizeZ =
+      _heightmapData.MaxElevation() - _heightmapData.MinElevation();
+  math::Vector3d scale;
+  scale.X(size.X() / vertSize);
+  scale.Y(size.Y() / vertSize);
+  if (math::equal(heightmapSizeZ, 0.0f))
+    scale.Z(1.0);
+  else
+    scale.Z(std::fabs(size.Z()) / heightmapSizeZ);
+
+  std::vector<float> heights;
+  _heightmapData.FillHeightMap(_subSampling, vertSize, size, scale, false,
+      heights);
+
+  tpelib::HeightmapShape heightmap;
+  if (!heightmap.SetHeights(heights, static_cast<unsigned int>(vertSize),
+      size))
+  {
+    return this->GenerateInvalidId();
+  }
+
+  auto &collision = static_cast<tpelib::Collision&>(
+    it->second->link->AddCollision());
+  collision.SetName(_name);
+  collision.SetPose(ToTpe(_pose));
+  collision.SetShape(heightmap);
+
+  return this->AddCollision(_linkID, collision);
+}
+
+///////////////////////////////////////////////
+template <typename PolicyT>
+auto ShapeFeatures<PolicyT>::GetShapeAxisAlignedBoundingBox(
+  const Identity &_shapeID) const -> AlignedBoxType
 {
   auto it = this->collisions.find(_shapeID);
   if (it != this->collisions.end() && it->second != nullptr)
   {
     auto *shape = it->second->collision->GetShape();
     if (shape != nullptr)
-      return math::eigen3::convert(shape->GetBoundingBox());
+      return math::eigen3::convert(
+          shape->GetBoundingBox()).template cast<Scalar>();
   }
   // return invalid bounding box if collision not found
-  return math::eigen3::convert(math::AxisAlignedBox());
+  return math::eigen3::convert(math::AxisAlignedBox()).template cast<Scalar>();
 }
+
+/////////////////////////////////////////////////
+template class tpeplugin::ShapeFeatures<FeaturePolicy3d>;
+template class tpeplugin::ShapeFeatures<FeaturePolicy3f>;
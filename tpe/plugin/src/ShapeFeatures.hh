@@ -25,6 +25,7 @@
 #include <gz/physics/CapsuleShape.hh>
 #include <gz/physics/CylinderShape.hh>
 #include <gz/physics/EllipsoidShape.hh>
+#include <gz/physics/heightmap/HeightmapShape.hh>
 #include <gz/physics/mesh/MeshShape.hh>
 #include <gz/physics/SphereShape.hh>
 
@@ -52,106 +53,136 @@ struct ShapeFeatureList : FeatureList<
   AttachSphereShapeFeature,
 
   mesh::GetMeshShapeProperties,
-  mesh::AttachMeshShapeFeature
+  mesh::AttachMeshShapeFeature,
+
+  heightmap::GetHeightmapShapeProperties,
+  heightmap::AttachHeightmapShapeFeature
 > { };
 
+template <typename PolicyT>
 class ShapeFeatures :
-    public virtual Base,
-    public virtual Implements3d<ShapeFeatureList>
+    public virtual Base<PolicyT>,
+    public virtual Implements<PolicyT, ShapeFeatureList>
 {
+  public: using Scalar = typename PolicyT::Scalar;
+
+  public: using Dimensions =
+      typename FromPolicy<PolicyT>::template Use<LinearVector>;
+
+  public: using PoseType =
+      typename FromPolicy<PolicyT>::template Use<Pose>;
+
+  public: using AlignedBoxType =
+      typename FromPolicy<PolicyT>::template Use<AlignedBox>;
+
   // ----- Box Features -----
   public: Identity CastToBoxShape(
     const Identity &_shapeID) const override;
 
-  public: LinearVector3d GetBoxShapeSize(
+  public: Dimensions GetBoxShapeSize(
     const Identity &_boxID) const override;
 
   public: Identity AttachBoxShape(
     const Identity &_linkID,
     const std::string &_name,
-    const LinearVector3d &_size,
-    const Pose3d &_pose) override;
+    const Dimensions &_size,
+    const PoseType &_pose) override;
 
   // ----- Capsule Features -----
   public: Identity CastToCapsuleShape(
     const Identity &_shapeID) const override;
 
-  public: double GetCapsuleShapeRadius(
+  public: Scalar GetCapsuleShapeRadius(
     const Identity &_capsuleID) const override;
 
-  public: double GetCapsuleShapeLength(
+  public: Scalar GetCapsuleShapeLength(
     const Identity &_capsuleID) const override;
 
   public: Identity AttachCapsuleShape(
     const Identity &_linkID,
     const std::string &_name,
-    double _radius,
-    double _height,
-    const Pose3d &_pose) override;
+    Scalar _radius,
+    Scalar _height,
+    const PoseType &_pose) override;
 
   // ----- Cylinder Features -----
   public: Identity CastToCylinderShape(
     const Identity &_shapeID) const override;
 
-  public: double GetCylinderShapeRadius(
+  public: Scalar GetCylinderShapeRadius(
     const Identity &_cylinderID) const override;
 
-  public: double GetCylinderShapeHeight(
+  public: Scalar GetCylinderShapeHeight(
     const Identity &_cylinderID) const override;
 
   public: Identity AttachCylinderShape(
     const Identity &_linkID,
     const std::string &_name,
-    double _radius,
-    double _height,
-    const Pose3d &_pose) override;
+    Scalar _radius,
+    Scalar _height,
+    const PoseType &_pose) override;
 
   // ----- Capsule Features -----
   public: Identity CastToEllipsoidShape(
     const Identity &_shapeID) const override;
 
-  public: Vector3d GetEllipsoidShapeRadii(
+  public: Dimensions GetEllipsoidShapeRadii(
     const Identity &_capsuleID) const override;
 
   public: Identity AttachEllipsoidShape(
     const Identity &_linkID,
     const std::string &_name,
-    Vector3d _radii,
-    const Pose3d &_pose) override;
+    Dimensions _radii,
+    const PoseType &_pose) override;
 
   // ----- Sphere Features -----
   public: Identity CastToSphereShape(
     const Identity &_shapeID) const override;
 
-  public: double GetSphereShapeRadius(
+  public: Scalar GetSphereShapeRadius(
     const Identity &_sphereID) const override;
 
   public: Identity AttachSphereShape(
     const Identity &_linkID,
     const std::string &_name,
-    double _radius,
-    const Pose3d &_pose) override;
+    Scalar _radius,
+    const PoseType &_pose) override;
 
 
   // ----- Mesh Features -----
   public: Identity CastToMeshShape(
     const Identity &_shapeID) const override;
 
-  public: LinearVector3d GetMeshShapeSize(
+  public: Dimensions GetMeshShapeSize(
     const Identity &_meshID) const override;
 
-  public: LinearVector3d GetMeshShapeScale(
+  public: Dimensions GetMeshShapeScale(
     const Identity &_meshID) const override;
 
   public: Identity AttachMeshShape(
     const Identity &_linkID,
     const std::string &_name,
     const gz::common::Mesh &_mesh,
-    const Pose3d &_pose,
-    const LinearVector3d &_scale) override;
+    const PoseType &_pose,
+    const Dimensions &_scale) override;
+
+  // ----- Heightmap Features -----
+  public: Identity CastToHeightmapShape(
+    const Identity &_shapeID) const override;
+
+  public: Dimensions GetHeightmapShapeSize(
+    const Identity &_heightmapID) const override;
+
+  public: Identity AttachHeightmapShape(
+    const Identity &_linkID,
+    const std::string &_name,
+    const common::HeightmapData &_heightmapData,
+    const PoseType &_pose,
+    const Dimensions &_size,
+    int _subSampling) override;
 
   // ----- Boundingbox Features -----
-  public: AlignedBox3d GetShapeAxisAlignedBoundingBox(
+  public: AlignedBoxType GetShapeAxisAlignedBoundingBox(
     const Identity &_shapeID) const override;
 };
 
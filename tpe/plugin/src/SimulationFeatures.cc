@@ -15,7 +15,7 @@
  *
 */
 
-#include <unordered_map>
+#include <algorithm>
 #include <utility>
 
 #include <gz/common/Console.hh>
@@ -30,7 +30,8 @@ using namespace gz;
 using namespace physics;
 using namespace tpeplugin;
 
-void SimulationFeatures::WorldForwardStep(
+template <typename PolicyT>
+void SimulationFeatures<PolicyT>::WorldForwardStep(
   const Identity &_worldID,
   ForwardStep::Output & _h,
   ForwardStep::State & /*_x*/,
@@ -62,103 +63,160 @@ void SimulationFeatures::WorldForwardStep(
     }
   }
   world->Step();
-  this->Write(_h.Get<ChangedWorldPoses>());
+  this->Write(*world, _h.Get<ChangedWorldPoses>());
 }
 
-void SimulationFeatures::Write(ChangedWorldPoses &_changedPoses) const
+template <typename PolicyT>
+void SimulationFeatures<PolicyT>::Write(ChangedWorldPoses &_changedPoses) const
 {
   // remove link poses from the previous iteration
   _changedPoses.entries.clear();
-  _changedPoses.entries.reserve(this->links.size());
+  for (const auto &[id, info] : this->worlds)
+  {
+    if (info)
+      this->AppendChangedPoses(*info->world, _changedPoses);
+  }
+}
+
+template <typename PolicyT>
+void SimulationFeatures<PolicyT>::Write(const tpelib::World &_world,
+    ChangedWorldPoses &_changedPoses) const
+{
+  // remove link poses from the previous iteration
+  _changedPoses.entries.clear();
+  this->AppendChangedPoses(_world, _changedPoses);
+}
 
-  std::unordered_map<std::size_t, math::Pose3d> newPoses;
-  // Store the updated links to avoid duplicated entries in _changedPoses
-  std::unordered_set<std::size_t> updatedLinkIds;
+template <typename PolicyT>
+void SimulationFeatures<PolicyT>::AppendChangedPoses(
+    const tpelib::World &_world, ChangedWorldPoses &_changedPoses) const
+{
+  GZ_PROFILE("SimulationFeatures::AppendChangedPoses");
+  const std::size_t begin = _changedPoses.entries.size();
 
-  for (const auto &[id, info] : this->links)
+  // Only the entities moved by the last step, and the nested models that
+  // got new links, are visited, so the cost of this function depends on the
+  // number of moving entities rather than on the number of entities in the
+  // world
+  for (std::size_t id : _world.GetMovedEntities())
   {
-    // make sure the link exists
-    if (info)
+    auto linkIt = this->links.find(id);
+    if (linkIt != this->links.end())
     {
-      const auto nextPose = info->link->GetPose();
-      auto iter = this->prevEntityPoses.find(id);
-
-      // If the link's pose is new or has changed, save this new pose and
-      // add it to the output poses. Otherwise, keep the existing link pose
-      if ((iter == this->prevEntityPoses.end()) ||
-          !iter->second.Pos().Equal(nextPose.Pos(), 1e-6) ||
-          !iter->second.Rot().Equal(nextPose.Rot(), 1e-6))
+      if (linkIt->second)
       {
         WorldPose wp;
-        wp.pose = nextPose;
+        wp.pose = linkIt->second->link->GetPose();
         wp.body = id;
         _changedPoses.entries.push_back(wp);
-        updatedLinkIds.insert(id);
-        newPoses[id] = nextPose;
       }
-      else
-        newPoses[id] = iter->second;
+      continue;
     }
+
+    // If a model moved, the poses of all its links and of the links of its
+    // nested models changed
+    auto modelIt = this->models.find(id);
+    if (modelIt == this->models.end() || !modelIt->second ||
+        modelIt->second->model->GetStatic())
+      continue;
+    this->AppendLinkPoses(*modelIt->second->model, _changedPoses);
   }
 
-  // Iterate over models to make sure link velocities for moving models
-  // are calculated and sent
-  for (const auto &[id, info] : this->models)
+  // The links of nested models are not tracked by the world, so the new
+  // ones are reported here
+  for (auto it = this->nestedModelsWithNewLinks.begin();
+      it != this->nestedModelsWithNewLinks.end();)
   {
-    // make sure the model exists
-    if (info)
+    auto modelIt = this->models.find(*it);
+    if (modelIt == this->models.end() || !modelIt->second)
     {
-      if (info->model->GetStatic())
-        continue;
-      const auto nextPose = info->model->GetPose();
-      // Note, now prevEntityPoses also contains prevModelPoses
-      // Data structure has been kept to avoid breaking ABI
-      auto iter = this->prevEntityPoses.find(id);
-
-      // If the models's pose is new or has changed, calculate and add all
-      // the children links' poses to the output poses
-      if ((iter == this->prevEntityPoses.end()) ||
-          !iter->second.Pos().Equal(nextPose.Pos(), 1e-6) ||
-          !iter->second.Rot().Equal(nextPose.Rot(), 1e-6))
-      {
-        for (const auto &linkEnt : info->model->GetChildren())
-        {
-          // Avoid pushing if the link was already updated in the previous loop
-          auto linkId = linkEnt.second->GetId();
-          if (updatedLinkIds.find(linkId) == updatedLinkIds.end())
-          {
-            WorldPose wp;
-            wp.pose = linkEnt.second->GetPose();
-            wp.body = linkId;
-            _changedPoses.entries.push_back(wp);
-            updatedLinkIds.insert(linkId);
-          }
-          newPoses[id] = linkEnt.second->GetPose();
-        }
-      }
-      else
-        newPoses[id] = iter->second;
+      it = this->nestedModelsWithNewLinks.erase(it);
+      continue;
+    }
+    const tpelib::Entity *root = modelIt->second->model;
+    while (root->GetParent())
+      root = root->GetParent();
+    if (root != &_world)
+    {
+      ++it;
+      continue;
     }
+    this->AppendLinkPoses(*modelIt->second->model, _changedPoses);
+    it = this->nestedModelsWithNewLinks.erase(it);
   }
 
-  // Save the new poses so that they can be used to check for updates in the
-  // next iteration. Re-setting this->prevEntityPoses with the contents of
-  // newPoses ensures that we aren't caching data for links that were removed
-  this->prevEntityPoses = std::move(newPoses);
+  // A link is visited twice if both it and its model moved, so remove the
+  // duplicated entries
+  auto byBody = [](const WorldPose &_a, const WorldPose &_b)
+  {
+    return _a.body < _b.body;
+  };
+  auto sameBody = [](const WorldPose &_a, const WorldPose &_b)
+  {
+    return _a.body == _b.body;
+  };
+  std::sort(_changedPoses.entries.begin() + begin,
+      _changedPoses.entries.end(), byBody);
+  _changedPoses.entries.erase(
+      std::unique(_changedPoses.entries.begin() + begin,
+          _changedPoses.entries.end(), sameBody),
+      _changedPoses.entries.end());
 }
 
-std::vector<SimulationFeatures::ContactInternal>
-SimulationFeatures::GetContactsFromLastStep(const Identity &_worldID) const
+template <typename PolicyT>
+void SimulationFeatures<PolicyT>::AppendLinkPoses(
+    const tpelib::Entity &_model, ChangedWorldPoses &_changedPoses) const
+{
+  for (const auto &childEnt : _model.GetChildren())
+  {
+    auto childId = childEnt.first;
+    if (this->links.find(childId) != this->links.end())
+    {
+      WorldPose wp;
+      wp.pose = childEnt.second->GetPose();
+      wp.body = childId;
+      _changedPoses.entries.push_back(wp);
+    }
+    else if (this->nestedModelIds.find(childId) != this->nestedModelIds.end())
+    {
+      this->AppendLinkPoses(*childEnt.second, _changedPoses);
+    }
+  }
+}
+
+template <typename PolicyT>
+auto SimulationFeatures<PolicyT>::GetContactsFromLastStep(
+    const Identity &_worldID) const -> std::vector<ContactInternal>
 {
   GZ_PROFILE("SimulationFeatures::GetContactFromLastStep");
-  std::vector<SimulationFeatures::ContactInternal> outContacts;
-  auto const world = this->ReferenceInterface<WorldInfo>(_worldID)->world;
-  const auto contacts = world->GetContacts();
+  std::vector<ContactInternal> outContacts;
+  auto const world =
+      this->template ReferenceInterface<WorldInfo>(_worldID)->world;
+  const auto &contacts = world->GetContacts();
 
   for (const auto &c : contacts)
   {
     CompositeData extraData;
 
+    // With the narrow phase enabled, contacts are associated with the
+    // collisions in contact and have a normal and depth
+    auto c1 = this->collisions.find(c.collision1);
+    auto c2 = this->collisions.find(c.collision2);
+    if (c1 != this->collisions.end() && c2 != this->collisions.end())
+    {
+      auto &extraContactData = extraData.Get<ExtraContactData>();
+      extraContactData.normal =
+          math::eigen3::convert(c.normal).template cast<Scalar>();
+      extraContactData.depth = c.depth;
+
+      outContacts.push_back(
+          {this->GenerateIdentity(c1->first, c1->second),
+           this->GenerateIdentity(c2->first, c2->second),
+           math::eigen3::convert(c.point).template cast<Scalar>(),
+           extraData});
+      continue;
+    }
+
     // Contact expects identity to be associated with shapes not models
     // but tpe computes collisions between models
     // Workaround is to return the first shape of a model
@@ -168,13 +226,64 @@ SimulationFeatures::GetContactsFromLastStep(const Identity &_worldID) const
     outContacts.push_back(
         {this->GenerateIdentity(s1.GetId(), this->collisions.at(s1.GetId())),
          this->GenerateIdentity(s2.GetId(), this->collisions.at(s2.GetId())),
-         math::eigen3::convert(c.point), extraData});
+         math::eigen3::convert(c.point).template cast<Scalar>(),
+         extraData});
   }
 
   return outContacts;
 }
 
-tpelib::Entity &SimulationFeatures::GetModelCollision(std::size_t _id) const
+template <typename PolicyT>
+auto SimulationFeatures<PolicyT>::GetContactPairChangesFromLastStep(
+    const Identity &_worldID) const -> ContactPairChangesInternal
+{
+  GZ_PROFILE("SimulationFeatures::GetContactPairChangesFromLastStep");
+  ContactPairChangesInternal changes;
+  auto const world =
+      this->template ReferenceInterface<WorldInfo>(_worldID)->world;
+
+  auto convert = [&](const std::vector<tpelib::ContactPair> &_pairs,
+      std::vector<ContactPairInternal> &_out)
+  {
+    _out.reserve(_pairs.size());
+    for (const auto &p : _pairs)
+    {
+      std::size_t c1 = this->ContactCollisionId(p.entity1, p.collision1);
+      std::size_t c2 = this->ContactCollisionId(p.entity2, p.collision2);
+      if (c1 == tpelib::kNullEntityId || c2 == tpelib::kNullEntityId)
+        continue;
+      _out.push_back(
+          {this->GenerateIdentity(c1, this->collisions.at(c1)),
+           this->GenerateIdentity(c2, this->collisions.at(c2))});
+    }
+  };
+  convert(world->GetAddedContactPairs(), changes.added);
+  convert(world->GetRemovedContactPairs(), changes.removed);
+  changes.persistingCount = world->GetPersistingContactPairCount();
+
+  return changes;
+}
+
+template <typename PolicyT>
+std::size_t SimulationFeatures<PolicyT>::ContactCollisionId(
+    std::size_t _modelId, std::size_t _collisionId) const
+{
+  if (this->collisions.find(_collisionId) != this->collisions.end())
+    return _collisionId;
+
+  // Without the narrow phase, contacts are between models. Use the first
+  // shape of the model as in GetContactsFromLastStep.
+  if (this->models.find(_modelId) == this->models.end())
+    return tpelib::kNullEntityId;
+  std::size_t id = this->GetModelCollision(_modelId).GetId();
+  if (this->collisions.find(id) == this->collisions.end())
+    return tpelib::kNullEntityId;
+  return id;
+}
+
+template <typename PolicyT>
+tpelib::Entity &SimulationFeatures<PolicyT>::GetModelCollision(
+    std::size_t _id) const
 {
   auto m = this->models.at(_id);
   if (!m || !m->model)
@@ -186,3 +295,7 @@ tpelib::Entity &SimulationFeatures::GetModelCollision(std::size_t _id) const
 
   return link.GetChildByIndex(0u);
 }
+
+/////////////////////////////////////////////////
+template class tpeplugin::SimulationFeatures<FeaturePolicy3d>;
+template class tpeplugin::SimulationFeatures<FeaturePolicy3f>;
@@ -18,8 +18,8 @@
 #ifndef GZ_PHYSICS_TPE_PLUGIN_SRC_SIMULATIONFEATURES_HH_
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_SIMULATIONFEATURES_HH_
 
-#include <vector>
 #include <unordered_map>
+#include <vector>
 
 #include <gz/math/Pose3.hh>
 
@@ -36,35 +36,85 @@ namespace tpeplugin {
 
 struct SimulationFeatureList : FeatureList<
   ForwardStep,
-  GetContactsFromLastStepFeature
+  GetContactsFromLastStepFeature,
+  GetContactPairChangesFromLastStepFeature
 > { };
 
+template <typename PolicyT>
 class SimulationFeatures :
-  public CanWriteExpectedData<SimulationFeatures,
+  public CanWriteExpectedData<SimulationFeatures<PolicyT>,
     ExpectData<ChangedWorldPoses>>,
-  public virtual Base,
-  public virtual Implements3d<SimulationFeatureList>
+  public virtual Base<PolicyT>,
+  public virtual Implements<PolicyT, SimulationFeatureList>
 {
+  public: using Scalar = typename PolicyT::Scalar;
+
+  public: using ContactInternal = typename GetContactsFromLastStepFeature
+      ::Implementation<PolicyT>::ContactInternal;
+
+  public: using ExtraContactData = typename GetContactsFromLastStepFeature
+      ::Implementation<PolicyT>::ExtraContactData;
+
+  public: using ContactPairInternal =
+      typename GetContactPairChangesFromLastStepFeature
+      ::Implementation<PolicyT>::ContactPairInternal;
+
+  public: using ContactPairChangesInternal =
+      typename GetContactPairChangesFromLastStepFeature
+      ::Implementation<PolicyT>::ContactPairChangesInternal;
+
   public: void WorldForwardStep(
     const Identity &_worldID,
     ForwardStep::Output &_h,
     ForwardStep::State &_x,
     const ForwardStep::Input &_u) override;
 
+  /// \brief Write the poses of the links that moved in the last step of
+  /// each world
+  /// \param[out] _changedPoses Changed link poses
   public: void Write(ChangedWorldPoses &_changedPoses) const;
 
+  /// \brief Write the poses of the links that moved in the last step of a
+  /// world
+  /// \param[in] _world World that was stepped
+  /// \param[out] _changedPoses Changed link poses
+  public: void Write(const tpelib::World &_world,
+      ChangedWorldPoses &_changedPoses) const;
+
   public: std::vector<ContactInternal> GetContactsFromLastStep(
     const Identity &_worldID) const override;
 
+  public: ContactPairChangesInternal GetContactPairChangesFromLastStep(
+    const Identity &_worldID) const override;
+
+  /// \brief Get the collision to report for one side of a tpelib contact
+  /// pair
+  /// \param[in] _modelId Model ID
+  /// \param[in] _collisionId Collision ID. If it is not a known collision,
+  /// the first collision of the canonical link of the model is used.
+  /// \return Collision ID, or tpelib::kNullEntityId if the collision or
+  /// model no longer exist
+  private: std::size_t ContactCollisionId(std::size_t _modelId,
+      std::size_t _collisionId) const;
+
   /// \brief Get a collision from the canonical link of a model
   /// \param[in] _id Model ID
   /// \return Collision entity
   private: tpelib::Entity &GetModelCollision(std::size_t _id) const;
 
-  /// \brief entity poses from the most recent pose change/update.
-  /// The key is the entity's ID, and the value is the entity's pose
-  private: mutable std::unordered_map<std::size_t, math::Pose3d>
-     prevEntityPoses;
+  /// \brief Append the poses of the links that moved in the last step of
+  /// a world
+  /// \param[in] _world World that was stepped
+  /// \param[in,out] _changedPoses Changed link poses to append to
+  private: void AppendChangedPoses(const tpelib::World &_world,
+      ChangedWorldPoses &_changedPoses) const;
+
+  /// \brief Append the poses of the links of a model and of the models
+  /// nested in it
+  /// \param[in] _model Model whose link poses changed
+  /// \param[in,out] _changedPoses Changed link poses to append to
+  private: void AppendLinkPoses(const tpelib::Entity &_model,
+      ChangedWorldPoses &_changedPoses) const;
 };
 
 }
@@ -17,7 +17,12 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+#include <string>
+
 #include <gz/common/Console.hh>
+#include <gz/common/Filesystem.hh>
+#include <gz/common/geospatial/ImageHeightmap.hh>
 #include <gz/math/Vector3.hh>
 #include <gz/math/eigen3/Conversions.hh>
 
@@ -48,6 +53,7 @@
 #include "ShapeFeatures.hh"
 #include "SimulationFeatures.hh"
 #include "World.hh"
+#include "WorldFeatures.hh"
 
 struct TestFeatureList : gz::physics::FeatureList<
   gz::physics::tpeplugin::SimulationFeatureList,
@@ -55,7 +61,10 @@ struct TestFeatureList : gz::physics::FeatureList<
   gz::physics::tpeplugin::EntityManagementFeatureList,
   gz::physics::tpeplugin::FreeGroupFeatureList,
   gz::physics::tpeplugin::RetrieveWorld,
+  gz::physics::tpeplugin::CastRaysFeature,
+  gz::physics::tpeplugin::WorldFeatureList,
   gz::physics::GetContactsFromLastStepFeature,
+  gz::physics::GetContactPairChangesFromLastStepFeature,
   gz::physics::LinkFrameSemantics,
   gz::physics::GetModelBoundingBox,
   gz::physics::sdf::ConstructSdfWorld,
@@ -427,6 +436,53 @@ TEST_P(SimulationFeatures_TEST, ShapeFeatures)
   }
 }
 
+TEST_P(SimulationFeatures_TEST, HeightmapShape)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes.world");
+
+  for (const auto &world : worlds)
+  {
+    auto boxLink = world->GetModel("box")->GetLink(0);
+
+    auto heightmapFilename = gz::common::joinPaths(
+        GZ_PHYSICS_RESOURCE_DIR, "heightmap_bowl.png");
+    gz::common::ImageHeightmap data;
+    ASSERT_EQ(0, data.Load(heightmapFilename));
+
+    const gz::math::Vector3d size(129, 129, 10);
+    auto heightmapShape = boxLink->AttachHeightmapShape("heightmap", data,
+        Eigen::Isometry3d::Identity(), gz::math::eigen3::convert(size));
+    ASSERT_NE(nullptr, heightmapShape);
+    EXPECT_EQ(2u, boxLink->GetShapeCount());
+    EXPECT_NEAR(size.X(), heightmapShape->GetSize()[0], 1e-6);
+    EXPECT_NEAR(size.Y(), heightmapShape->GetSize()[1], 1e-6);
+
+    auto heightmapShapeGeneric = boxLink->GetShape("heightmap");
+    ASSERT_NE(nullptr, heightmapShapeGeneric);
+    EXPECT_EQ(nullptr, heightmapShapeGeneric->CastToBoxShape());
+    auto heightmapShapeRecast = heightmapShapeGeneric->CastToHeightmapShape();
+    ASSERT_NE(nullptr, heightmapShapeRecast);
+    EXPECT_NEAR(size.X(), heightmapShapeRecast->GetSize()[0], 1e-6);
+    EXPECT_NEAR(size.Y(), heightmapShapeRecast->GetSize()[1], 1e-6);
+    EXPECT_EQ(nullptr,
+        boxLink->GetShape(0)->CastToHeightmapShape());
+
+    auto heightmapAABB = heightmapShapeGeneric->GetAxisAlignedBoundingBox(
+        *heightmapShapeGeneric);
+    EXPECT_NEAR(-size.X() * 0.5,
+        gz::math::eigen3::convert(heightmapAABB).Min().X(), 1e-6);
+    EXPECT_NEAR(size.Y() * 0.5,
+        gz::math::eigen3::convert(heightmapAABB).Max().Y(), 1e-6);
+
+    // the world still steps with the heightmap in the ground model
+    StepWorld(world, true);
+  }
+}
+
 TEST_P(SimulationFeatures_TEST, FreeGroup)
 {
   const std::string library = GetParam();
@@ -570,6 +626,53 @@ TEST_P(SimulationFeatures_TEST, CollideBitmasks)
   }
 }
 
+TEST_P(SimulationFeatures_TEST, CollideBitmasksCollisionDetectors)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  // the broadphases skip the pairs whose bitmasks do not share a bit, and
+  // must report the same contacts as the checks done on the candidate pairs
+  for (const std::string detector :
+      {"aabb_tree", "sweep_and_prune", "spatial_hash"})
+  {
+    auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes_bitmask.sdf");
+
+    for (const auto &world : worlds)
+    {
+      world->SetCollisionDetector(detector);
+      EXPECT_EQ(detector, world->GetCollisionDetector());
+
+      auto filteredBox = world->GetModel("box_filtered");
+      auto collidingBox = world->GetModel("box_colliding");
+
+      StepWorld(world, true);
+      auto contacts = world->GetContactsFromLastStep();
+      ASSERT_EQ(1u, contacts.size());
+      const auto &contactPoint = contacts.front().Get<TestContactPoint>();
+      ASSERT_TRUE(contactPoint.collision1);
+      ASSERT_TRUE(contactPoint.collision2);
+      std::set<std::string> names = {
+          contactPoint.collision1->GetLink()->GetModel()->GetName(),
+          contactPoint.collision2->GetLink()->GetModel()->GetName()};
+      EXPECT_EQ(std::set<std::string>({"box_base", "box_colliding"}), names);
+
+      // the boxes do not move, only their bitmasks change
+      auto collidingShape = collidingBox->GetLink(0)->GetShape(0);
+      auto filteredShape = filteredBox->GetLink(0)->GetShape(0);
+      filteredShape->SetCollisionFilterMask(0x01);
+      StepWorld(world, false);
+      EXPECT_EQ(2u, world->GetContactsFromLastStep().size());
+
+      collidingShape->SetCollisionFilterMask(0xF0);
+      filteredShape->SetCollisionFilterMask(0xF0);
+      StepWorld(world, false);
+      EXPECT_EQ(0u, world->GetContactsFromLastStep().size());
+    }
+  }
+}
+
 TEST_P(SimulationFeatures_TEST, RetrieveContacts)
 {
   const std::string library = GetParam();
@@ -747,5 +850,207 @@ TEST_P(SimulationFeatures_TEST, RetrieveContacts)
   }
 }
 
+TEST_P(SimulationFeatures_TEST, RetrieveContactsNarrowPhase)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes.world");
+
+  for (const auto &world : worlds)
+  {
+    auto tpeWorld = world->GetTpeLibWorld();
+    ASSERT_NE(nullptr, tpeWorld);
+    tpeWorld->SetNarrowPhaseEnabled(true);
+
+    auto checkedOutput = StepWorld(world, true);
+    EXPECT_TRUE(checkedOutput);
+    auto contacts = world->GetContactsFromLastStep();
+
+    // each shape touches the large box in the middle. Contacts are
+    // associated with the collisions in contact and have a normal and a
+    // depth.
+    EXPECT_EQ(4u, contacts.size());
+    for (auto &contact : contacts)
+    {
+      const auto &contactPoint = contact.Get<TestContactPoint>();
+      ASSERT_TRUE(contactPoint.collision1);
+      ASSERT_TRUE(contactPoint.collision2);
+      EXPECT_NE(contactPoint.collision1, contactPoint.collision2);
+
+      auto m1 = contactPoint.collision1->GetLink()->GetModel();
+      auto m2 = contactPoint.collision2->GetLink()->GetModel();
+      EXPECT_TRUE(m1->GetName() == "box" || m2->GetName() == "box");
+
+      const auto *extraContactData =
+          contact.Query<gz::physics::World3d<TestFeatureList>::
+          ExtraContactData>();
+      ASSERT_NE(nullptr, extraContactData);
+      EXPECT_NEAR(1.0, extraContactData->normal.norm(), 1e-6);
+      EXPECT_GT(extraContactData->depth, 0.0);
+    }
+  }
+}
+
+TEST_P(SimulationFeatures_TEST, ContactPairChanges)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes.world");
+
+  for (const auto &world : worlds)
+  {
+    auto sphere = world->GetModel("sphere");
+    auto sphereFreeGroup = sphere->FindFreeGroup();
+    ASSERT_NE(nullptr, sphereFreeGroup);
+
+    // the large box in the middle starts touching the sphere, cylinder,
+    // capsule and ellipsoid
+    auto checkedOutput = StepWorld(world, true);
+    EXPECT_TRUE(checkedOutput);
+    auto changes = world->GetContactPairChangesFromLastStep();
+    EXPECT_EQ(4u, changes.added.size());
+    EXPECT_TRUE(changes.removed.empty());
+    EXPECT_EQ(0u, changes.persistingCount);
+    for (const auto &pair : changes.added)
+    {
+      ASSERT_TRUE(pair.collision1);
+      ASSERT_TRUE(pair.collision2);
+      EXPECT_NE(pair.collision1, pair.collision2);
+    }
+
+    // nothing changes
+    checkedOutput = StepWorld(world, false);
+    EXPECT_FALSE(checkedOutput);
+    changes = world->GetContactPairChangesFromLastStep();
+    EXPECT_TRUE(changes.added.empty());
+    EXPECT_TRUE(changes.removed.empty());
+    EXPECT_EQ(4u, changes.persistingCount);
+
+    // move sphere away
+    sphereFreeGroup->SetWorldPose(gz::math::eigen3::convert(
+        gz::math::Pose3d(0, 100, 0.5, 0, 0, 0)));
+    checkedOutput = StepWorld(world, false);
+    EXPECT_FALSE(checkedOutput);
+    changes = world->GetContactPairChangesFromLastStep();
+    EXPECT_TRUE(changes.added.empty());
+    ASSERT_EQ(1u, changes.removed.size());
+    auto m1 = changes.removed[0].collision1->GetLink()->GetModel();
+    auto m2 = changes.removed[0].collision2->GetLink()->GetModel();
+    EXPECT_TRUE(m1->GetName() == "sphere" || m2->GetName() == "sphere");
+    EXPECT_EQ(3u, changes.persistingCount);
+  }
+}
+
+TEST_P(SimulationFeatures_TEST, ChangedWorldPoses)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes.world");
+
+  for (const auto &world : worlds)
+  {
+    // step and get the ids of the links whose pose was reported
+    auto changedLinks = [&world]()
+    {
+      gz::physics::ForwardStep::Input input;
+      gz::physics::ForwardStep::State state;
+      gz::physics::ForwardStep::Output output;
+      world->Step(output, state, input);
+      std::set<std::size_t> ids;
+      for (const auto &entry :
+          output.Get<gz::physics::ChangedWorldPoses>().entries)
+      {
+        ids.insert(entry.body);
+      }
+      return ids;
+    };
+    EXPECT_FALSE(changedLinks().empty());
+    EXPECT_TRUE(changedLinks().empty());
+
+    // a spawned model is reported once even if it does not move
+    auto model = world->ConstructEmptyModel("spawned");
+    ASSERT_NE(nullptr, model);
+    auto link = model->ConstructEmptyLink("link");
+    ASSERT_NE(nullptr, link);
+    auto ids = changedLinks();
+    EXPECT_EQ(1u, ids.size());
+    EXPECT_EQ(1u, ids.count(link->EntityID()));
+    EXPECT_TRUE(changedLinks().empty());
+
+    // so is a link of a nested model
+    auto nestedModel = model->ConstructEmptyNestedModel("nested");
+    ASSERT_NE(nullptr, nestedModel);
+    auto nestedLink = nestedModel->ConstructEmptyLink("nested_link");
+    ASSERT_NE(nullptr, nestedLink);
+    ids = changedLinks();
+    EXPECT_EQ(1u, ids.size());
+    EXPECT_EQ(1u, ids.count(nestedLink->EntityID()));
+    EXPECT_TRUE(changedLinks().empty());
+
+    // moving the model moves the links of its nested model too
+    auto freeGroup = model->FindFreeGroup();
+    ASSERT_NE(nullptr, freeGroup);
+    freeGroup->SetWorldPose(gz::math::eigen3::convert(
+        gz::math::Pose3d(0, 10, 0, 0, 0, 0)));
+    ids = changedLinks();
+    EXPECT_EQ(2u, ids.size());
+    EXPECT_EQ(1u, ids.count(link->EntityID()));
+    EXPECT_EQ(1u, ids.count(nestedLink->EntityID()));
+    EXPECT_TRUE(changedLinks().empty());
+
+    // so does moving the nested model
+    auto nestedFreeGroup = nestedModel->FindFreeGroup();
+    ASSERT_NE(nullptr, nestedFreeGroup);
+    nestedFreeGroup->SetWorldPose(gz::math::eigen3::convert(
+        gz::math::Pose3d(0, 20, 0, 0, 0, 0)));
+    ids = changedLinks();
+    EXPECT_EQ(1u, ids.count(nestedLink->EntityID()));
+    EXPECT_TRUE(changedLinks().empty());
+  }
+}
+
+TEST_P(SimulationFeatures_TEST, CastRays)
+{
+  const std::string library = GetParam();
+  if (library.empty())
+    return;
+
+  auto worlds = LoadWorlds(library, TEST_WORLD_DIR "/shapes.world");
+
+  for (const auto &world : worlds)
+  {
+    StepWorld(world, true);
+
+    // a ray falling onto the sphere, one onto the large box and one going
+    // up that does not hit anything
+    std::vector<gz::physics::tpelib::Ray> rays(3);
+    rays[0].origin = gz::math::Vector3d(0, 1.5, 10);
+    rays[0].direction = gz::math::Vector3d(0, 0, -1);
+    rays[1].origin = gz::math::Vector3d(20, 20, 10);
+    rays[1].direction = gz::math::Vector3d(0, 0, -1);
+    rays[2].origin = gz::math::Vector3d(0, 0, 10);
+    rays[2].direction = gz::math::Vector3d(0, 0, 1);
+    std::vector<gz::physics::tpelib::RayHit> hits;
+    world->CastRays(rays, hits);
+    ASSERT_EQ(3u, hits.size());
+    EXPECT_EQ(world->GetModel("sphere")->EntityID(), hits[0].entity);
+    EXPECT_NEAR(8.5, hits[0].distance, 1e-6);
+    EXPECT_EQ(world->GetModel("box")->EntityID(), hits[1].entity);
+    EXPECT_NEAR(9.0, hits[1].distance, 1e-6);
+    EXPECT_EQ(gz::physics::tpelib::kNullEntityId, hits[2].entity);
+
+    // casting rays does not change the contacts of the next step
+    auto contacts = world->GetContactsFromLastStep();
+    StepWorld(world, false);
+    EXPECT_EQ(contacts.size(), world->GetContactsFromLastStep().size());
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(PhysicsPlugins, SimulationFeatures_TEST,
   ::testing::ValuesIn(gz::physics::test::g_PhysicsPluginLibraries));
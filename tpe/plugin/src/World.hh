@@ -19,6 +19,7 @@
 #define GZ_PHYSICS_TPE_PLUGIN_SRC_WORLD_HH_
 
 #include <memory>
+#include <vector>
 
 #include <gz/physics/FeatureList.hh>
 
@@ -46,6 +47,32 @@ class RetrieveWorld : public virtual Feature
   };
 };
 
+/////////////////////////////////////////////////
+class CastRaysFeature : public virtual Feature
+{
+  public: template <typename PolicyT, typename FeaturesT>
+  class World : public virtual Feature::World<PolicyT, FeaturesT>
+  {
+    /// \brief Cast a batch of rays, e.g. the rays of a lidar scan, against
+    /// the collisions of the world as of the last step. The world is not
+    /// modified, so rays can be cast between steps without changing them.
+    /// \param[in] _rays Rays in world frame
+    /// \param[out] _hits Closest hit of each ray, in the order of the rays.
+    /// The entity and collision ids of the hits are the entity ids of the
+    /// model and shape hit.
+    public: void CastRays(const std::vector<tpelib::Ray> &_rays,
+        std::vector<tpelib::RayHit> &_hits) const;
+  };
+
+  public: template <typename PolicyT>
+  class Implementation : public virtual Feature::Implementation<PolicyT>
+  {
+    public: virtual void CastWorldRays(const Identity &_worldID,
+        const std::vector<tpelib::Ray> &_rays,
+        std::vector<tpelib::RayHit> &_hits) const = 0;
+  };
+};
+
 /////////////////////////////////////////////////
 template <typename PolicyT, typename FeaturesT>
 std::shared_ptr<tpelib::World> RetrieveWorld::World<PolicyT, FeaturesT>
@@ -55,6 +82,16 @@ std::shared_ptr<tpelib::World> RetrieveWorld::World<PolicyT, FeaturesT>
       ->GetTpeLibWorld(this->identity);
 }
 
+/////////////////////////////////////////////////
+template <typename PolicyT, typename FeaturesT>
+void CastRaysFeature::World<PolicyT, FeaturesT>::CastRays(
+    const std::vector<tpelib::Ray> &_rays,
+    std::vector<tpelib::RayHit> &_hits) const
+{
+  this->template Interface<CastRaysFeature>()
+      ->CastWorldRays(this->identity, _rays, _hits);
+}
+
 }
 }
 }
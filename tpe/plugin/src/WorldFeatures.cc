@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <gz/common/Console.hh>
+
+#include "WorldFeatures.hh"
+
+using namespace gz;
+using namespace physics;
+using namespace tpeplugin;
+
+namespace
+{
+/// \brief Collision detector names of the tpelib broadphases, indexed by
+/// tpelib::BroadphaseType. The collision detector of a TPE world selects
+/// the broadphase that finds the candidate pairs. The solver then selects
+/// how contacts are computed from them: from the overlaps of the AABBs, or
+/// from the collision shapes by the narrow phase.
+const std::string kCollisionDetectors[] =
+{
+  "aabb_tree",
+  "sweep_and_prune",
+  "spatial_hash",
+  "aabb_tree_float"
+};
+
+/// \brief Solver names of the ways tpelib computes contacts. The "aabb"
+/// solver reports the overlaps of the shape AABBs, and the "narrow_phase"
+/// solver checks the collision shapes themselves and reports the colliding
+/// collisions with a normal and depth, e.g. for contact sensors.
+const std::string kAabbSolver = "aabb";
+const std::string kNarrowPhaseSolver = "narrow_phase";
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+void WorldFeatures<PolicyT>::SetWorldCollisionDetector(
+    const Identity &_id, const std::string &_collisionDetector)
+{
+  auto world = this->template ReferenceInterface<WorldInfo>(_id)->world;
+  if (_collisionDetector == "aabb_tree")
+  {
+    world->SetBroadphaseType(tpelib::BroadphaseType::AABB_TREE);
+  }
+  else if (_collisionDetector == "sweep_and_prune")
+  {
+    world->SetBroadphaseType(tpelib::BroadphaseType::SWEEP_AND_PRUNE);
+  }
+  else if (_collisionDetector == "spatial_hash")
+  {
+    world->SetBroadphaseType(tpelib::BroadphaseType::SPATIAL_HASH);
+  }
+  else if (_collisionDetector == "aabb_tree_float")
+  {
+    world->SetBroadphaseType(tpelib::BroadphaseType::AABB_TREE_FLOAT);
+  }
+  else
+  {
+    gzerr << "Collision detector [" << _collisionDetector
+           << "] is not supported, defaulting to ["
+           << this->GetWorldCollisionDetector(_id) << "]." << std::endl;
+  }
+
+  gzmsg << "Using [" << this->GetWorldCollisionDetector(_id)
+         << "] collision detector" << std::endl;
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+const std::string &WorldFeatures<PolicyT>::GetWorldCollisionDetector(
+    const Identity &_id) const
+{
+  auto world = this->template ReferenceInterface<WorldInfo>(_id)->world;
+  return kCollisionDetectors[
+      static_cast<std::size_t>(world->GetBroadphaseType())];
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+void WorldFeatures<PolicyT>::SetWorldSolver(const Identity &_id,
+    const std::string &_solver)
+{
+  auto world = this->template ReferenceInterface<WorldInfo>(_id)->world;
+  if (_solver == kAabbSolver)
+  {
+    world->SetNarrowPhaseEnabled(false);
+  }
+  else if (_solver == kNarrowPhaseSolver)
+  {
+    world->SetNarrowPhaseEnabled(true);
+  }
+  else
+  {
+    gzerr << "Solver [" << _solver << "] is not supported, defaulting to ["
+           << this->GetWorldSolver(_id) << "]." << std::endl;
+  }
+
+  gzmsg << "Using [" << this->GetWorldSolver(_id) << "] solver"
+         << std::endl;
+}
+
+/////////////////////////////////////////////////
+template <typename PolicyT>
+const std::string &WorldFeatures<PolicyT>::GetWorldSolver(
+    const Identity &_id) const
+{
+  auto world = this->template ReferenceInterface<WorldInfo>(_id)->world;
+  return world->GetNarrowPhaseEnabled() ? kNarrowPhaseSolver : kAabbSolver;
+}
+
+/////////////////////////////////////////////////
+template class tpeplugin::WorldFeatures<FeaturePolicy3d>;
+template class tpeplugin::WorldFeatures<FeaturePolicy3f>;
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GZ_PHYSICS_TPE_PLUGIN_SRC_WORLDFEATURES_HH_
+#define GZ_PHYSICS_TPE_PLUGIN_SRC_WORLDFEATURES_HH_
+
+#include <string>
+
+#include <gz/physics/World.hh>
+
+#include "Base.hh"
+
+namespace gz {
+namespace physics {
+namespace tpeplugin {
+
+struct WorldFeatureList : FeatureList<
+  CollisionDetector,
+  Solver
+> { };
+
+template <typename PolicyT>
+class WorldFeatures :
+    public virtual Base<PolicyT>,
+    public virtual Implements<PolicyT, WorldFeatureList>
+{
+  // Documentation inherited
+  public: void SetWorldCollisionDetector(
+      const Identity &_id, const std::string &_collisionDetector) override;
+
+  // Documentation inherited
+  public: const std::string &GetWorldCollisionDetector(const Identity &_id)
+      const override;
+
+  // Documentation inherited
+  public: void SetWorldSolver(const Identity &_id, const std::string &_solver)
+      override;
+
+  // Documentation inherited
+  public: const std::string &GetWorldSolver(const Identity &_id) const
+      override;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <gz/plugin/Loader.hh>
+
+#include <gz/physics/RequestEngine.hh>
+
+#include "EntityManagementFeatures.hh"
+#include "World.hh"
+#include "WorldFeatures.hh"
+
+struct TestFeatureList : gz::physics::FeatureList<
+  gz::physics::tpeplugin::EntityManagementFeatureList,
+  gz::physics::tpeplugin::RetrieveWorld,
+  gz::physics::tpeplugin::WorldFeatureList
+> { };
+
+TEST(WorldFeatures_TEST, CollisionDetector)
+{
+  gz::plugin::Loader loader;
+  loader.LoadLib(tpe_plugin_LIB);
+
+  gz::plugin::PluginPtr tpe_plugin =
+    loader.Instantiate("gz::physics::tpeplugin::Plugin");
+
+  auto engine =
+    gz::physics::RequestEngine3d<TestFeatureList>::From(tpe_plugin);
+  ASSERT_NE(nullptr, engine);
+
+  auto world = engine->ConstructEmptyWorld("empty world");
+  ASSERT_NE(nullptr, world);
+  auto tpeWorld = world->GetTpeLibWorld();
+  ASSERT_NE(nullptr, tpeWorld);
+
+  EXPECT_EQ("aabb_tree", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::AABB_TREE,
+      tpeWorld->GetBroadphaseType());
+
+  world->SetCollisionDetector("spatial_hash");
+  EXPECT_EQ("spatial_hash", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::SPATIAL_HASH,
+      tpeWorld->GetBroadphaseType());
+
+  world->SetCollisionDetector("aabb_tree_float");
+  EXPECT_EQ("aabb_tree_float", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::AABB_TREE_FLOAT,
+      tpeWorld->GetBroadphaseType());
+
+  world->SetCollisionDetector("sweep_and_prune");
+  EXPECT_EQ("sweep_and_prune", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::SWEEP_AND_PRUNE,
+      tpeWorld->GetBroadphaseType());
+
+  // unsupported collision detectors keep the current one
+  world->SetCollisionDetector("bullet");
+  EXPECT_EQ("sweep_and_prune", world->GetCollisionDetector());
+
+  world->SetCollisionDetector("aabb_tree");
+  EXPECT_EQ("aabb_tree", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::AABB_TREE,
+      tpeWorld->GetBroadphaseType());
+}
+
+TEST(WorldFeatures_TEST, Solver)
+{
+  gz::plugin::Loader loader;
+  loader.LoadLib(tpe_plugin_LIB);
+
+  gz::plugin::PluginPtr tpe_plugin =
+    loader.Instantiate("gz::physics::tpeplugin::Plugin");
+
+  auto engine =
+    gz::physics::RequestEngine3d<TestFeatureList>::From(tpe_plugin);
+  ASSERT_NE(nullptr, engine);
+
+  auto world = engine->ConstructEmptyWorld("empty world");
+  ASSERT_NE(nullptr, world);
+  auto tpeWorld = world->GetTpeLibWorld();
+  ASSERT_NE(nullptr, tpeWorld);
+
+  EXPECT_EQ("aabb", world->GetSolver());
+  EXPECT_FALSE(tpeWorld->GetNarrowPhaseEnabled());
+
+  world->SetSolver("narrow_phase");
+  EXPECT_EQ("narrow_phase", world->GetSolver());
+  EXPECT_TRUE(tpeWorld->GetNarrowPhaseEnabled());
+
+  // unsupported solvers keep the current one
+  world->SetSolver("DantzigBoxedLcpSolver");
+  EXPECT_EQ("narrow_phase", world->GetSolver());
+  EXPECT_TRUE(tpeWorld->GetNarrowPhaseEnabled());
+
+  world->SetSolver("aabb");
+  EXPECT_EQ("aabb", world->GetSolver());
+  EXPECT_FALSE(tpeWorld->GetNarrowPhaseEnabled());
+}
+
+TEST(WorldFeatures_TEST, SinglePrecision)
+{
+  gz::plugin::Loader loader;
+  loader.LoadLib(tpe_plugin_LIB);
+
+  gz::plugin::PluginPtr tpe_plugin =
+    loader.Instantiate("gz::physics::tpeplugin::Plugin3f");
+
+  auto engine =
+    gz::physics::RequestEngine3f<TestFeatureList>::From(tpe_plugin);
+  ASSERT_NE(nullptr, engine);
+
+  // worlds of the single precision plugin default to the float AABB tree
+  auto world = engine->ConstructEmptyWorld("empty world");
+  ASSERT_NE(nullptr, world);
+  auto tpeWorld = world->GetTpeLibWorld();
+  ASSERT_NE(nullptr, tpeWorld);
+
+  EXPECT_EQ("aabb_tree_float", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::AABB_TREE_FLOAT,
+      tpeWorld->GetBroadphaseType());
+
+  world->SetCollisionDetector("aabb_tree");
+  EXPECT_EQ("aabb_tree", world->GetCollisionDetector());
+  EXPECT_EQ(gz::physics::tpelib::BroadphaseType::AABB_TREE,
+      tpeWorld->GetBroadphaseType());
+}
@@ -26,6 +26,7 @@
 #include "SDFFeatures.hh"
 #include "ShapeFeatures.hh"
 #include "SimulationFeatures.hh"
+#include "WorldFeatures.hh"
 
 namespace gz {
 namespace physics {
@@ -38,22 +39,33 @@ struct TpePluginFeatures : FeatureList<
   KinematicsFeatureList,
   SDFFeatureList,
   ShapeFeatureList,
-  SimulationFeatureList
+  SimulationFeatureList,
+  WorldFeatureList
 > { };
 
-class Plugin :
-  public virtual Implements3d<TpePluginFeatures>,
-  public virtual Base,
-  public virtual CustomFeatures,
-  public virtual EntityManagementFeatures,
-  public virtual FreeGroupFeatures,
-  public virtual KinematicsFeatures,
-  public virtual SDFFeatures,
-  public virtual ShapeFeatures,
-  public virtual SimulationFeatures { };
+/// \brief The TPE plugin, assembled from its features for one policy.
+/// \tparam PolicyT FeaturePolicy3d or FeaturePolicy3f
+template <typename PolicyT>
+class PluginT :
+  public virtual Implements<PolicyT, TpePluginFeatures>,
+  public virtual Base<PolicyT>,
+  public virtual CustomFeatures<PolicyT>,
+  public virtual EntityManagementFeatures<PolicyT>,
+  public virtual FreeGroupFeatures<PolicyT>,
+  public virtual KinematicsFeatures<PolicyT>,
+  public virtual SDFFeatures<PolicyT>,
+  public virtual ShapeFeatures<PolicyT>,
+  public virtual SimulationFeatures<PolicyT>,
+  public virtual WorldFeatures<PolicyT> { };
+
+class Plugin : public PluginT<FeaturePolicy3d> { };
 
 GZ_PHYSICS_ADD_PLUGIN(Plugin, FeaturePolicy3d, TpePluginFeatures)
 
+class Plugin3f : public PluginT<FeaturePolicy3f> { };
+
+GZ_PHYSICS_ADD_PLUGIN(Plugin3f, FeaturePolicy3f, TpePluginFeatures)
+
 }
 }
 }